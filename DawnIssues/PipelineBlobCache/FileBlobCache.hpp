@@ -0,0 +1,282 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <random>
+#include <system_error>
+#include <chrono>
+
+// File-backed, content-addressed blob store that backs dawn's load/store cache callbacks.
+//
+// Every entry lives in its own file named after the hash of the cache key:
+//   <Root>/DawnBlobCache/<hash of Version>/<first two hex digits>/<hash>.blob
+// The file keeps the full key next to the value, so a hash collision is detected and
+// treated as a miss. Entries are written to a temporary file with a name unique to the
+// writer and renamed into place, which makes the store safe to share between several
+// processes.
+//
+// All entries of a different version are deleted when the cache is opened. The version
+// string must therefore change whenever the producer of the blobs (dawn) changes. Only
+// version directories are deleted, so Root may hold other files.
+class FileBlobCache
+{
+public:
+    struct Statistics
+    {
+        uint64_t Hits      = 0;
+        uint64_t Misses    = 0;
+        uint64_t Stores    = 0;
+        uint64_t Evictions = 0;
+        uint64_t Rejected  = 0; // Corrupted entries or key collisions
+    };
+
+    FileBlobCache(const std::filesystem::path& RootDirectory, const std::string& Version, uint64_t MaxSizeInBytes) :
+        m_Directory{RootDirectory / "DawnBlobCache" / HashToString(ComputeHash(Version.data(), Version.size()))},
+        m_MaxSizeInBytes{MaxSizeInBytes},
+        m_TempFileTag{HashToString(std::random_device{}())}
+    {
+        std::error_code ErrorCode;
+        std::filesystem::create_directories(m_Directory, ErrorCode);
+
+        // Entries produced by another dawn revision can never be hit again
+        for (const auto& Entry : std::filesystem::directory_iterator(m_Directory.parent_path(), ErrorCode))
+        {
+            if (Entry.is_directory() && Entry.path() != m_Directory && IsHashString(Entry.path().filename().string()))
+                std::filesystem::remove_all(Entry.path(), ErrorCode);
+        }
+
+        // Temporary files belong to stores in progress, or to writers that crashed when they
+        // are old enough that no store can still be writing them
+        const auto Now = std::filesystem::file_time_type::clock::now();
+        for (const auto& Entry : std::filesystem::recursive_directory_iterator(m_Directory, ErrorCode))
+        {
+            if (!Entry.is_regular_file())
+                continue;
+            if (Entry.path().extension() == ".blob")
+                m_TotalSizeInBytes += Entry.file_size(ErrorCode);
+            else if (Entry.path().extension() == ".tmp" && Now - Entry.last_write_time(ErrorCode) > StaleTempFileAge)
+                std::filesystem::remove(Entry.path(), ErrorCode);
+        }
+    }
+
+    // Follows the dawn protocol: when Value is null or ValueSize is smaller than the
+    // stored value, only the size of the stored value is returned. Zero means a miss.
+    size_t Load(const void* pKey, size_t KeySize, void* pValue, size_t ValueSize)
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+
+        const auto    FilePath = GetEntryPath(pKey, KeySize);
+        std::ifstream Stream{FilePath, std::ios::binary};
+        if (!Stream)
+        {
+            ++m_Statistics.Misses;
+            return 0;
+        }
+
+        EntryHeader Header{};
+        if (!Stream.read(reinterpret_cast<char*>(&Header), sizeof(Header)) || Header.Magic != EntryMagic || Header.KeySize != KeySize)
+        {
+            ++m_Statistics.Rejected;
+            return 0;
+        }
+
+        std::vector<char> StoredKey(KeySize);
+        if (!Stream.read(StoredKey.data(), KeySize) || std::memcmp(StoredKey.data(), pKey, KeySize) != 0)
+        {
+            ++m_Statistics.Rejected;
+            return 0;
+        }
+
+        // A truncated entry must not make dawn allocate for a value that is not there
+        std::error_code ErrorCode;
+        const uint64_t  FileSize = std::filesystem::file_size(FilePath, ErrorCode);
+        if (ErrorCode || Header.ValueSize != FileSize - sizeof(Header) - KeySize)
+        {
+            ++m_Statistics.Rejected;
+            Stream.close();
+            std::filesystem::remove(FilePath, ErrorCode);
+            return 0;
+        }
+
+        if (pValue == nullptr || ValueSize < Header.ValueSize)
+            return static_cast<size_t>(Header.ValueSize);
+
+        if (!Stream.read(static_cast<char*>(pValue), Header.ValueSize) || ComputeHash(pValue, Header.ValueSize) != Header.ValueHash)
+        {
+            ++m_Statistics.Rejected;
+            Stream.close();
+            std::filesystem::remove(FilePath, ErrorCode);
+            return 0;
+        }
+        Stream.close();
+
+        // The modification time is used as the access time for the LRU eviction
+        std::filesystem::last_write_time(FilePath, std::filesystem::file_time_type::clock::now(), ErrorCode);
+
+        ++m_Statistics.Hits;
+        return static_cast<size_t>(Header.ValueSize);
+    }
+
+    void Store(const void* pKey, size_t KeySize, const void* pValue, size_t ValueSize)
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+
+        const uint64_t EntrySize = sizeof(EntryHeader) + KeySize + ValueSize;
+        if (EntrySize > m_MaxSizeInBytes)
+            return;
+
+        const auto      FilePath = GetEntryPath(pKey, KeySize);
+        std::error_code ErrorCode;
+        std::filesystem::create_directories(FilePath.parent_path(), ErrorCode);
+
+        const uint64_t PrevSize = std::filesystem::exists(FilePath, ErrorCode) ? std::filesystem::file_size(FilePath, ErrorCode) : 0;
+
+        auto TempPath = FilePath;
+        TempPath += "." + m_TempFileTag + "." + std::to_string(m_NextTempFileId++) + ".tmp";
+        {
+            EntryHeader Header{};
+            Header.Magic     = EntryMagic;
+            Header.KeySize   = static_cast<uint32_t>(KeySize);
+            Header.ValueSize = ValueSize;
+            Header.ValueHash = ComputeHash(pValue, ValueSize);
+
+            std::ofstream Stream{TempPath, std::ios::binary | std::ios::trunc};
+            Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+            Stream.write(static_cast<const char*>(pKey), KeySize);
+            Stream.write(static_cast<const char*>(pValue), ValueSize);
+            if (!Stream)
+            {
+                Stream.close();
+                std::filesystem::remove(TempPath, ErrorCode);
+                return;
+            }
+        }
+
+        std::filesystem::rename(TempPath, FilePath, ErrorCode);
+        if (ErrorCode)
+        {
+            std::filesystem::remove(TempPath, ErrorCode);
+            return;
+        }
+
+        m_TotalSizeInBytes = m_TotalSizeInBytes - std::min(PrevSize, m_TotalSizeInBytes) + EntrySize;
+        ++m_Statistics.Stores;
+
+        if (m_TotalSizeInBytes > m_MaxSizeInBytes)
+            EvictLeastRecentlyUsed();
+    }
+
+    Statistics GetStatistics() const
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        return m_Statistics;
+    }
+
+    uint64_t GetTotalSize() const
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        return m_TotalSizeInBytes;
+    }
+
+    const std::filesystem::path& GetDirectory() const
+    {
+        return m_Directory;
+    }
+
+private:
+    static constexpr uint32_t EntryMagic = 0x31434244; // 'DBC1'
+
+    static constexpr std::chrono::hours StaleTempFileAge{1};
+
+    struct EntryHeader
+    {
+        uint32_t Magic;
+        uint32_t KeySize;
+        uint64_t ValueSize;
+        uint64_t ValueHash;
+    };
+
+    static uint64_t ComputeHash(const void* pData, size_t Size)
+    {
+        // 64-bit FNV-1a
+        uint64_t    Hash  = 0xcbf29ce484222325ull;
+        const auto* pByte = static_cast<const uint8_t*>(pData);
+        for (size_t i = 0; i < Size; ++i)
+        {
+            Hash ^= pByte[i];
+            Hash *= 0x100000001b3ull;
+        }
+        return Hash;
+    }
+
+    static std::string HashToString(uint64_t Hash)
+    {
+        static constexpr char HexDigits[] = "0123456789abcdef";
+
+        std::string Result(16, '0');
+        for (size_t i = 0; i < 16; ++i)
+            Result[15 - i] = HexDigits[(Hash >> (i * 4)) & 0xF];
+        return Result;
+    }
+
+    static bool IsHashString(const std::string& Name)
+    {
+        return Name.size() == 16 && std::all_of(Name.begin(), Name.end(), [](char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'); });
+    }
+
+    std::filesystem::path GetEntryPath(const void* pKey, size_t KeySize) const
+    {
+        const std::string Name = HashToString(ComputeHash(pKey, KeySize));
+        return m_Directory / Name.substr(0, 2) / (Name + ".blob");
+    }
+
+    void EvictLeastRecentlyUsed()
+    {
+        struct EntryInfo
+        {
+            std::filesystem::path           Path;
+            std::filesystem::file_time_type LastAccess;
+            uint64_t                        Size;
+        };
+
+        std::vector<EntryInfo> Entries;
+        std::error_code        ErrorCode;
+        for (const auto& Entry : std::filesystem::recursive_directory_iterator(m_Directory, ErrorCode))
+        {
+            if (Entry.is_regular_file() && Entry.path().extension() == ".blob")
+                Entries.push_back({Entry.path(), Entry.last_write_time(ErrorCode), Entry.file_size(ErrorCode)});
+        }
+
+        std::sort(Entries.begin(), Entries.end(), [](const EntryInfo& LHS, const EntryInfo& RHS) { return LHS.LastAccess < RHS.LastAccess; });
+
+        // Evict down to 3/4 of the budget so that the next few stores do not rescan the directory
+        const uint64_t TargetSize = m_MaxSizeInBytes - m_MaxSizeInBytes / 4;
+        for (const auto& Entry : Entries)
+        {
+            if (m_TotalSizeInBytes <= TargetSize)
+                break;
+
+            if (std::filesystem::remove(Entry.Path, ErrorCode))
+            {
+                m_TotalSizeInBytes -= std::min(Entry.Size, m_TotalSizeInBytes);
+                ++m_Statistics.Evictions;
+            }
+        }
+    }
+
+private:
+    const std::filesystem::path m_Directory;
+    const uint64_t              m_MaxSizeInBytes;
+    const std::string           m_TempFileTag; // Random, distinguishes processes sharing the directory
+
+    mutable std::mutex m_Mutex;
+    uint64_t           m_TotalSizeInBytes = 0;
+    uint64_t           m_NextTempFileId   = 0;
+    Statistics         m_Statistics       = {};
+};
@@ -0,0 +1,223 @@
+#include <iostream>
+#include <exception>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+
+#include <webgpu/webgpu.h>
+#include "WebGPUObjectWrapper.hpp"
+#include "FileBlobCache.hpp"
+
+#ifndef DAWN_GIT_TAG
+#    define DAWN_GIT_TAG "unknown"
+#endif
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace WGSL
+{
+
+const std::string FillTextureCS = R"(
+override TileSize : u32 = 16u;
+
+@group(0) @binding(0) var g_tex2DUAV : texture_storage_2d<rgba8unorm, write>;
+
+@compute @workgroup_size(16, 16, 1)
+fn main(@builtin(global_invocation_id) DTid : vec3u) {
+    let Dim = textureDimensions(g_tex2DUAV);
+    if (DTid.x >= Dim.x || DTid.y >= Dim.y) {
+        return;
+    }
+    textureStore(g_tex2DUAV, DTid.xy, vec4f(vec2f(DTid.xy % TileSize) / f32(TileSize), 0.0, 1.0));
+}
+)";
+
+} // namespace WGSL
+
+constexpr uint64_t BlobCacheSizeLimit = 256ull << 20;
+
+// Number of distinct pipelines created by the sample. Each one gets its own
+// specialization of 'TileSize', hence its own backend compilation.
+constexpr uint32_t PipelineCount = 64;
+
+std::string ToString(WGPUStringView Message)
+{
+    if (Message.data == nullptr)
+        return {};
+    return Message.length == WGPU_STRLEN ? std::string{Message.data} : std::string{Message.data, Message.length};
+}
+
+WebGPUAdapterWrapper RequestAdapter(WGPUInstance wgpuInstance)
+{
+    struct CallbackUserData
+    {
+        WGPUAdapter              Adapter       = nullptr;
+        WGPURequestAdapterStatus RequestStatus = {};
+        std::string              Message       = {};
+        bool                     IsReady       = false;
+    } UserData;
+
+    WGPURequestAdapterCallbackInfo CallbackInfo{};
+    CallbackInfo.mode      = WGPUCallbackMode_AllowProcessEvents;
+    CallbackInfo.userdata1 = &UserData;
+    CallbackInfo.callback  = [](WGPURequestAdapterStatus Status, WGPUAdapter Adapter, WGPUStringView Message, void* pCallbackUserData, void*) {
+        auto* pUserData          = static_cast<CallbackUserData*>(pCallbackUserData);
+        pUserData->Adapter       = Adapter;
+        pUserData->RequestStatus = Status;
+        pUserData->Message       = ToString(Message);
+        pUserData->IsReady       = true;
+    };
+
+    WGPURequestAdapterOptions Options{};
+    Options.powerPreference = WGPUPowerPreference_HighPerformance;
+    wgpuInstanceRequestAdapter(wgpuInstance, &Options, CallbackInfo);
+    while (!UserData.IsReady)
+        wgpuInstanceProcessEvents(wgpuInstance);
+
+    if (UserData.RequestStatus != WGPURequestAdapterStatus_Success)
+        LOG_ERROR_AND_THROW("Failed to request adapter: ", UserData.Message);
+
+    return WebGPUAdapterWrapper{UserData.Adapter};
+}
+
+WebGPUDeviceWrapper RequestDevice(WGPUInstance wgpuInstance, WGPUAdapter wgpuAdapter, FileBlobCache& BlobCache)
+{
+    struct CallbackUserData
+    {
+        WGPUDevice              Device        = nullptr;
+        WGPURequestDeviceStatus RequestStatus = {};
+        std::string             Message       = {};
+        bool                    IsReady       = false;
+    } UserData;
+
+    // Dawn calls these hooks for every shader module and pipeline it compiles. A hit
+    // skips both Tint and the backend compiler.
+    WGPUDawnCacheDeviceDescriptor CacheDesc{};
+    CacheDesc.chain.sType       = WGPUSType_DawnCacheDeviceDescriptor;
+    CacheDesc.isolationKey      = {DAWN_GIT_TAG, WGPU_STRLEN};
+    CacheDesc.functionUserdata  = &BlobCache;
+    CacheDesc.loadDataFunction  = [](const void* pKey, size_t KeySize, void* pValue, size_t ValueSize, void* pUserData) -> size_t {
+        return static_cast<FileBlobCache*>(pUserData)->Load(pKey, KeySize, pValue, ValueSize);
+    };
+    CacheDesc.storeDataFunction = [](const void* pKey, size_t KeySize, const void* pValue, size_t ValueSize, void* pUserData) {
+        static_cast<FileBlobCache*>(pUserData)->Store(pKey, KeySize, pValue, ValueSize);
+    };
+
+    WGPUDeviceDescriptor DeviceDesc{};
+    DeviceDesc.nextInChain = &CacheDesc.chain;
+
+    WGPURequestDeviceCallbackInfo CallbackInfo{};
+    CallbackInfo.mode      = WGPUCallbackMode_AllowProcessEvents;
+    CallbackInfo.userdata1 = &UserData;
+    CallbackInfo.callback  = [](WGPURequestDeviceStatus Status, WGPUDevice Device, WGPUStringView Message, void* pCallbackUserData, void*) {
+        auto* pUserData          = static_cast<CallbackUserData*>(pCallbackUserData);
+        pUserData->Device        = Device;
+        pUserData->RequestStatus = Status;
+        pUserData->Message       = ToString(Message);
+        pUserData->IsReady       = true;
+    };
+
+    wgpuAdapterRequestDevice(wgpuAdapter, &DeviceDesc, CallbackInfo);
+    while (!UserData.IsReady)
+        wgpuInstanceProcessEvents(wgpuInstance);
+
+    if (UserData.RequestStatus != WGPURequestDeviceStatus_Success)
+        LOG_ERROR_AND_THROW("Failed to request device: ", UserData.Message);
+
+    return WebGPUDeviceWrapper{UserData.Device};
+}
+
+std::vector<WebGPUComputePipelineWrapper> CreatePipelines(WGPUDevice wgpuDevice)
+{
+    WGPUShaderSourceWGSL WGSLDesc{};
+    WGSLDesc.chain.sType = WGPUSType_ShaderSourceWGSL;
+    WGSLDesc.code        = {WGSL::FillTextureCS.c_str(), WGSL::FillTextureCS.size()};
+
+    WGPUShaderModuleDescriptor ShaderModuleDesc{};
+    ShaderModuleDesc.nextInChain = &WGSLDesc.chain;
+
+    WebGPUShaderModuleWrapper wgpuShaderModule{wgpuDeviceCreateShaderModule(wgpuDevice, &ShaderModuleDesc)};
+    if (!wgpuShaderModule)
+        LOG_ERROR_AND_THROW("Failed to create shader module");
+
+    std::vector<WebGPUComputePipelineWrapper> wgpuPipelines;
+    wgpuPipelines.reserve(PipelineCount);
+    for (uint32_t PipelineIdx = 0; PipelineIdx < PipelineCount; ++PipelineIdx)
+    {
+        WGPUConstantEntry Constant{};
+        Constant.key   = {"TileSize", WGPU_STRLEN};
+        Constant.value = static_cast<double>(PipelineIdx + 1);
+
+        WGPUComputePipelineDescriptor PipelineDesc{};
+        PipelineDesc.compute.module        = wgpuShaderModule.Get();
+        PipelineDesc.compute.entryPoint    = {"main", WGPU_STRLEN};
+        PipelineDesc.compute.constantCount = 1;
+        PipelineDesc.compute.constants     = &Constant;
+
+        WebGPUComputePipelineWrapper wgpuPipeline{wgpuDeviceCreateComputePipeline(wgpuDevice, &PipelineDesc)};
+        if (!wgpuPipeline)
+            LOG_ERROR_AND_THROW("Failed to create compute pipeline ", PipelineIdx);
+        wgpuPipelines.emplace_back(std::move(wgpuPipeline));
+    }
+    return wgpuPipelines;
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        // Run the sample twice: the first run populates the cache, the second one
+        // creates all pipelines from the blobs stored on disk.
+        const std::filesystem::path CacheDirectory = argc > 1 ? argv[1] : "PipelineBlobCache";
+
+        FileBlobCache BlobCache{CacheDirectory, DAWN_GIT_TAG, BlobCacheSizeLimit};
+
+        WGPUInstanceDescriptor wgpuInstanceDesc = {};
+        WebGPUInstanceWrapper  wgpuInstance{wgpuCreateInstance(&wgpuInstanceDesc)};
+        if (!wgpuInstance)
+            LOG_ERROR_AND_THROW("Failed to create WebGPU instance");
+
+        auto wgpuAdapter = RequestAdapter(wgpuInstance.Get());
+        auto wgpuDevice  = RequestDevice(wgpuInstance.Get(), wgpuAdapter.Get(), BlobCache);
+
+        const auto StartTime     = std::chrono::high_resolution_clock::now();
+        auto       wgpuPipelines = CreatePipelines(wgpuDevice.Get());
+        const auto EndTime       = std::chrono::high_resolution_clock::now();
+
+        const auto Stats = BlobCache.GetStatistics();
+        LOG_INFO_MESSAGE("Created ", wgpuPipelines.size(), " pipelines in ", std::chrono::duration<double, std::milli>(EndTime - StartTime).count(), " ms");
+        LOG_INFO_MESSAGE("Blob cache '", BlobCache.GetDirectory().string(), "': ",
+                         Stats.Hits, " hits, ", Stats.Misses, " misses, ", Stats.Stores, " stores, ",
+                         Stats.Evictions, " evictions, ", Stats.Rejected, " rejected, ",
+                         BlobCache.GetTotalSize(), " bytes on disk");
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#if defined(_MSC_VER) && CPU_GENERATE_MIPS_X86
+#    include <intrin.h>
+#endif
+
+#include "MipKernels.hpp"
+
+// RGBA32F texture array with a full set of levels. Level 0 holds linear colors: what the
+// sampler returns for the top level. The other levels hold what GenerateMipsCS stores,
+// i.e. sRGB-encoded colors when ConvertToSRGB is set.
+class MipTexture
+{
+public:
+    MipTexture(uint32_t Width, uint32_t Height, uint32_t ArraySize, uint32_t MipLevels) :
+        m_Width{Width},
+        m_Height{Height},
+        m_ArraySize{ArraySize},
+        m_MipLevels{MipLevels}
+    {
+        m_Planes.resize(size_t{ArraySize} * MipLevels);
+        for (uint32_t Slice = 0; Slice < ArraySize; ++Slice)
+        {
+            for (uint32_t Mip = 0; Mip < MipLevels; ++Mip)
+            {
+                const uint32_t MipWidth = GetMipDimension(Width, Mip);
+                m_Planes[GetPlaneIndex(Mip, Slice)].resize(size_t{GetPitch(MipWidth)} * GetMipDimension(Height, Mip) * 4);
+            }
+        }
+    }
+
+    static uint32_t GetFullMipLevels(uint32_t Width, uint32_t Height)
+    {
+        uint32_t MipLevels = 1;
+        while ((std::max(Width, Height) >> MipLevels) != 0)
+            ++MipLevels;
+        return MipLevels;
+    }
+
+    static uint32_t GetMipDimension(uint32_t Size, uint32_t Mip)
+    {
+        return std::max(Size >> Mip, 1u);
+    }
+
+    static uint32_t GetPitch(uint32_t Width)
+    {
+        return (Width + MipRowAlignment - 1) / MipRowAlignment * MipRowAlignment;
+    }
+
+    MipPlane GetPlane(uint32_t Mip, uint32_t Slice) const
+    {
+        MipPlane Plane;
+        Plane.pData  = const_cast<float*>(m_Planes[GetPlaneIndex(Mip, Slice)].data());
+        Plane.Width  = GetMipDimension(m_Width, Mip);
+        Plane.Height = GetMipDimension(m_Height, Mip);
+        Plane.Pitch  = GetPitch(Plane.Width);
+        return Plane;
+    }
+
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+    uint32_t GetArraySize() const { return m_ArraySize; }
+    uint32_t GetMipLevels() const { return m_MipLevels; }
+
+private:
+    size_t GetPlaneIndex(uint32_t Mip, uint32_t Slice) const
+    {
+        return size_t{Slice} * m_MipLevels + Mip;
+    }
+
+private:
+    const uint32_t m_Width;
+    const uint32_t m_Height;
+    const uint32_t m_ArraySize;
+    const uint32_t m_MipLevels;
+
+    std::vector<std::vector<float>> m_Planes;
+};
+
+// One GenerateMipsCS dispatch
+struct GenerateMipsBatch
+{
+    uint32_t SrcMipLevel;
+    uint32_t NumMipLevels;  // [1, 4]
+    uint32_t NonPowerOfTwo; // NON_POWER_OF_TWO of the permutation
+};
+
+// The same split into dispatches as the GPU path, so that every level is produced from
+// the same source level with the same filter. A dispatch only goes on while both
+// dimensions stay even, which keeps the 2x2 reductions of GenerateMipsCS exact.
+inline std::vector<GenerateMipsBatch> PlanGenerateMips(uint32_t Width, uint32_t Height, uint32_t MipLevels)
+{
+    std::vector<GenerateMipsBatch> Batches;
+    for (uint32_t TopMip = 0; TopMip + 1 < MipLevels;)
+    {
+        const uint32_t SrcWidth  = MipTexture::GetMipDimension(Width, TopMip);
+        const uint32_t SrcHeight = MipTexture::GetMipDimension(Height, TopMip);
+        const uint32_t DstWidth  = SrcWidth >> 1;
+        const uint32_t DstHeight = SrcHeight >> 1;
+
+        GenerateMipsBatch Batch;
+        Batch.SrcMipLevel   = TopMip;
+        Batch.NonPowerOfTwo = (SrcWidth & 1) | (SrcHeight & 1) << 1;
+
+        // Number of times both dimensions can be halved. A dimension of one stays one.
+        const uint32_t Bits           = (DstWidth == 1 ? DstHeight : DstWidth) | (DstHeight == 1 ? DstWidth : DstHeight);
+        uint32_t       AdditionalMips = 0;
+        while (AdditionalMips < 3 && (Bits & (1u << AdditionalMips)) == 0)
+            ++AdditionalMips;
+        Batch.NumMipLevels = std::min(1 + AdditionalMips, MipLevels - 1 - TopMip);
+
+        Batches.push_back(Batch);
+        TopMip += Batch.NumMipLevels;
+    }
+    return Batches;
+}
+
+// Kernels of every instruction set the CPU supports, the best one last
+inline std::vector<const MipKernels*> GetSupportedMipKernels()
+{
+    std::vector<const MipKernels*> Kernels{&GetScalarMipKernels()};
+#if CPU_GENERATE_MIPS_X86
+    Kernels.push_back(&GetSSE2MipKernels());
+
+    bool HasAVX2 = false;
+#    if defined(_MSC_VER)
+    int Info[4] = {};
+    __cpuid(Info, 1);
+    // The OS must save YMM registers on context switches
+    if ((Info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6)
+    {
+        __cpuidex(Info, 7, 0);
+        HasAVX2 = (Info[1] & (1 << 5)) != 0;
+    }
+#    else
+    HasAVX2 = __builtin_cpu_supports("avx2");
+#    endif
+    if (HasAVX2)
+        Kernels.push_back(&GetAVX2MipKernels());
+#elif CPU_GENERATE_MIPS_NEON
+    Kernels.push_back(&GetNEONMipKernels());
+#endif
+    return Kernels;
+}
+
+struct CPUGenerateMipsDesc
+{
+    bool              ConvertToSRGB = false;
+    uint32_t          NumThreads    = 0;       // 0 for one per hardware thread
+    const MipKernels* pKernels      = nullptr; // nullptr for the best supported ones
+};
+
+// Rows of the first level of a batch per work item. A multiple of 8, so that the levels
+// below are split at the same rows.
+constexpr uint32_t GenerateMipsBandRows = 32;
+
+// Runs Func(Item) for Item in [0, NumItems) on up to NumThreads threads
+template <typename FuncType>
+void ParallelFor(uint32_t NumItems, uint32_t NumThreads, const FuncType& Func)
+{
+    NumThreads = std::min(NumThreads, NumItems);
+    if (NumThreads <= 1)
+    {
+        for (uint32_t Item = 0; Item < NumItems; ++Item)
+            Func(Item);
+        return;
+    }
+
+    std::atomic<uint32_t> NextItem{0};
+
+    const auto Worker = [&]() {
+        for (uint32_t Item = NextItem.fetch_add(1); Item < NumItems; Item = NextItem.fetch_add(1))
+            Func(Item);
+    };
+
+    std::vector<std::thread> Threads;
+    Threads.reserve(NumThreads - 1);
+    for (uint32_t Thread = 1; Thread < NumThreads; ++Thread)
+        Threads.emplace_back(Worker);
+    Worker();
+    for (auto& Thread : Threads)
+        Thread.join();
+}
+
+// The exact sRGB decode a sampler applies when it reads an sRGB texture
+inline float SRGBToLinear(float x)
+{
+    return x <= 0.04045f ? x / 12.92f : std::pow((x + 0.055f) / 1.055f, 2.4f);
+}
+
+// Produces levels 1.. of every slice from level 0 with the results of GenerateMipsCS.
+// Batches run one after another, and within a batch every slice is split into bands of
+// rows that go through all levels of the batch independently, like the thread groups.
+inline void GenerateMips(MipTexture& Texture, const CPUGenerateMipsDesc& Desc)
+{
+    const MipKernels* pKernels = Desc.pKernels;
+    if (pKernels == nullptr)
+        pKernels = GetSupportedMipKernels().back();
+
+    const uint32_t NumThreads = Desc.NumThreads != 0 ? Desc.NumThreads : std::max(std::thread::hardware_concurrency(), 1u);
+    const uint32_t ArraySize  = Texture.GetArraySize();
+
+    for (const auto& Batch : PlanGenerateMips(Texture.GetWidth(), Texture.GetHeight(), Texture.GetMipLevels()))
+    {
+        const uint32_t SrcWidth   = MipTexture::GetMipDimension(Texture.GetWidth(), Batch.SrcMipLevel);
+        const uint32_t SrcHeight  = MipTexture::GetMipDimension(Texture.GetHeight(), Batch.SrcMipLevel);
+        const uint32_t Mip1Width  = MipTexture::GetMipDimension(SrcWidth, 1);
+        const uint32_t Mip1Height = MipTexture::GetMipDimension(SrcHeight, 1);
+
+        // With sRGB conversion, the stored values are not what the next step reads: keep
+        // linear copies of the source as the sampler decodes it, and of the levels
+        // GenerateMipsCS keeps in LDS. Level 0 is linear already.
+        const bool DecodeSource = Desc.ConvertToSRGB && Batch.SrcMipLevel > 0;
+        MipTexture LinearSrc{SrcWidth, SrcHeight, ArraySize, DecodeSource ? 1u : 0u};
+        MipTexture LinearMips{Mip1Width, Mip1Height, ArraySize, Desc.ConvertToSRGB ? Batch.NumMipLevels - 1 : 0u};
+
+        // Mip is relative to the batch: 0 is the source
+        const auto GetLinearPlane = [&](uint32_t Mip, uint32_t Slice) {
+            if (Mip == 0)
+                return DecodeSource ? LinearSrc.GetPlane(0, Slice) : Texture.GetPlane(Batch.SrcMipLevel, Slice);
+            return Desc.ConvertToSRGB ? LinearMips.GetPlane(Mip - 1, Slice) : Texture.GetPlane(Batch.SrcMipLevel + Mip, Slice);
+        };
+
+        if (DecodeSource)
+        {
+            ParallelFor(ArraySize, NumThreads, [&](uint32_t Slice) {
+                const MipPlane Src = Texture.GetPlane(Batch.SrcMipLevel, Slice);
+                const MipPlane Dst = LinearSrc.GetPlane(0, Slice);
+                for (uint32_t Y = 0; Y < Src.Height; ++Y)
+                {
+                    for (uint32_t X = 0; X < Src.Width; ++X)
+                    {
+                        const float* pSrc = Src.GetTexel(X, Y);
+                        float*       pDst = Dst.GetTexel(X, Y);
+                        for (uint32_t c = 0; c < 3; ++c)
+                            pDst[c] = SRGBToLinear(pSrc[c]);
+                        pDst[3] = pSrc[3];
+                    }
+                }
+            });
+        }
+
+        const uint32_t NumBands   = (Mip1Height + GenerateMipsBandRows - 1) / GenerateMipsBandRows;
+        ParallelFor(ArraySize * NumBands, NumThreads, [&](uint32_t Item) {
+            const uint32_t Slice = Item / NumBands;
+            const uint32_t Band  = Item % NumBands;
+
+            for (uint32_t Mip = 1; Mip <= Batch.NumMipLevels; ++Mip)
+            {
+                const uint32_t DstMip = Batch.SrcMipLevel + Mip;
+                const MipPlane Dst    = Texture.GetPlane(DstMip, Slice);
+
+                const uint32_t FirstRow = (Band * GenerateMipsBandRows) >> (Mip - 1);
+                const uint32_t EndRow   = std::min(((Band + 1) * GenerateMipsBandRows) >> (Mip - 1), Dst.Height);
+                if (FirstRow >= EndRow)
+                    break;
+
+                // The last level of the batch is only read back through its stored values
+                MipPlane        DstLinear;
+                const MipPlane* pDstLinear = nullptr;
+                if (Desc.ConvertToSRGB && Mip < Batch.NumMipLevels)
+                {
+                    DstLinear  = GetLinearPlane(Mip, Slice);
+                    pDstLinear = &DstLinear;
+                }
+
+                if (Mip == 1)
+                    pKernels->SampleRows(GetLinearPlane(0, Slice), Dst, pDstLinear, Batch.NonPowerOfTwo, FirstRow, EndRow - FirstRow, Desc.ConvertToSRGB);
+                else
+                    pKernels->ReduceRows(GetLinearPlane(Mip - 1, Slice), Dst, pDstLinear, FirstRow, EndRow - FirstRow, Desc.ConvertToSRGB);
+            }
+        });
+    }
+}
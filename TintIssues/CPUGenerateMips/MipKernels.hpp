@@ -0,0 +1,270 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One level of one array slice: RGBA32F texels, rows padded to MipRowAlignment texels so
+// that kernels may process whole vectors past the end of a row
+struct MipPlane
+{
+    float*   pData  = nullptr;
+    uint32_t Width  = 0;
+    uint32_t Height = 0;
+    uint32_t Pitch  = 0; // In texels
+
+    float* GetTexel(uint32_t X, uint32_t Y) const
+    {
+        return pData + (size_t{Y} * Pitch + X) * 4;
+    }
+};
+
+constexpr uint32_t MipRowAlignment = 4;
+
+// Row kernels of one instruction set. Both write the values GenerateMipsCS stores to Dst,
+// and the linear values it keeps in LDS to pDstLinear when that is not null.
+struct MipKernels
+{
+    const char* Name;
+
+    // Rows [FirstRow, FirstRow + NumRows) of the first level of a dispatch, sampled from Src
+    // as GenerateMipsCS does in NON_POWER_OF_TWO mode Mode
+    void (*SampleRows)(const MipPlane& Src, const MipPlane& Dst, const MipPlane* pDstLinear, uint32_t Mode, uint32_t FirstRow, uint32_t NumRows, bool ConvertToSRGB);
+
+    // Rows of the following levels: the 2x2 average of the linear values of the level above
+    void (*ReduceRows)(const MipPlane& Src, const MipPlane& Dst, const MipPlane* pDstLinear, uint32_t FirstRow, uint32_t NumRows, bool ConvertToSRGB);
+};
+
+// Every instruction set gets its own translation unit, compiled with the flags it needs.
+// The kernels are templates instantiated with a type local to that unit, so no function
+// compiled for one instruction set can be picked by the linker for another.
+//
+// ISA provides:
+//   Vec                       TexelsPerVec texels
+//   Gather(Ptrs)              loads the texel at each of TexelsPerVec pointers
+//   LoadPairs(Ptr, Even, Odd) loads 2 * TexelsPerVec consecutive texels and splits them into
+//                             the even and the odd ones
+//   Broadcast(Values)         each value repeated over the channels of its texel
+//   Splat, Add, Mul, Store
+//   LinearToSRGB(Vec)         LinearToSRGB of GenerateMipsCS on RGB, alpha unchanged
+template <typename ISA>
+struct MipKernelsImpl
+{
+    using Vec = typename ISA::Vec;
+
+    static constexpr uint32_t N = ISA::TexelsPerVec;
+    static_assert(MipRowAlignment % N == 0, "Rows must hold a whole number of vectors");
+    static_assert(MipRowAlignment % (N * 2) == 0, "LoadBlocks must stay inside the rows of the source");
+
+    // Bilinear filtering with clamp addressing, as BilinearClamp does
+    static Vec Sample(const MipPlane& Src, const float (&U)[N], const float (&V)[N])
+    {
+        const float* Taps[4][N];
+        float        Weights[4][N];
+        for (uint32_t i = 0; i < N; ++i)
+        {
+            const float TX = U[i] * static_cast<float>(Src.Width) - 0.5f;
+            const float TY = V[i] * static_cast<float>(Src.Height) - 0.5f;
+            // TX and TY are never below -0.5, so this is floor()
+            const int   X0 = static_cast<int>(TX + 1.0f) - 1;
+            const int   Y0 = static_cast<int>(TY + 1.0f) - 1;
+            const float FX = TX - static_cast<float>(X0);
+            const float FY = TY - static_cast<float>(Y0);
+
+            const int MaxX = static_cast<int>(Src.Width) - 1;
+            const int MaxY = static_cast<int>(Src.Height) - 1;
+            const int X1   = X0 + 1 > MaxX ? MaxX : X0 + 1;
+            const int Y1   = Y0 + 1 > MaxY ? MaxY : Y0 + 1;
+            const int CX0  = X0 < 0 ? 0 : (X0 > MaxX ? MaxX : X0);
+            const int CY0  = Y0 < 0 ? 0 : (Y0 > MaxY ? MaxY : Y0);
+
+            Taps[0][i]    = Src.GetTexel(CX0, CY0);
+            Taps[1][i]    = Src.GetTexel(X1, CY0);
+            Taps[2][i]    = Src.GetTexel(CX0, Y1);
+            Taps[3][i]    = Src.GetTexel(X1, Y1);
+            Weights[0][i] = (1.0f - FX) * (1.0f - FY);
+            Weights[1][i] = FX * (1.0f - FY);
+            Weights[2][i] = (1.0f - FX) * FY;
+            Weights[3][i] = FX * FY;
+        }
+
+        Vec Color = ISA::Mul(ISA::Gather(Taps[0]), ISA::Broadcast(Weights[0]));
+        for (uint32_t Tap = 1; Tap < 4; ++Tap)
+            Color = ISA::Add(Color, ISA::Mul(ISA::Gather(Taps[Tap]), ISA::Broadcast(Weights[Tap])));
+        return Color;
+    }
+
+    static void Write(const MipPlane& Dst, const MipPlane* pDstLinear, uint32_t X, uint32_t Y, Vec Color, bool ConvertToSRGB)
+    {
+        if (pDstLinear != nullptr)
+            ISA::Store(pDstLinear->GetTexel(X, Y), Color);
+        ISA::Store(Dst.GetTexel(X, Y), ConvertToSRGB ? ISA::LinearToSRGB(Color) : Color);
+    }
+
+    // The 2x2 blocks under N texels of a row of Dst, read from two whole rows of Src. The
+    // vectors are loaded straight from the rows, with no per-texel addressing. Past the end
+    // of Dst, the loads stay inside the padding of Src: its pitch is a multiple of 2 * N.
+    static void LoadBlocks(const MipPlane& Src, uint32_t X, uint32_t Y, Vec (&Taps)[4])
+    {
+        ISA::LoadPairs(Src.GetTexel(X * 2, Y * 2), Taps[0], Taps[1]);
+        ISA::LoadPairs(Src.GetTexel(X * 2, Y * 2 + 1), Taps[2], Taps[3]);
+    }
+
+    // Power-of-two levels in mode 0: every sample falls in the middle of a 2x2 block, so the
+    // weights are exactly 0.25 and the result is the same as that of Sample()
+    static void SampleRowsHalfSize(const MipPlane& Src, const MipPlane& Dst, const MipPlane* pDstLinear, uint32_t FirstRow, uint32_t NumRows, bool ConvertToSRGB)
+    {
+        const Vec Weight = ISA::Splat(0.25f);
+        for (uint32_t Y = FirstRow; Y < FirstRow + NumRows; ++Y)
+        {
+            for (uint32_t X = 0; X < Dst.Width; X += N)
+            {
+                Vec Taps[4];
+                LoadBlocks(Src, X, Y, Taps);
+
+                Vec Color = ISA::Mul(Taps[0], Weight);
+                for (uint32_t Tap = 1; Tap < 4; ++Tap)
+                    Color = ISA::Add(Color, ISA::Mul(Taps[Tap], Weight));
+                Write(Dst, pDstLinear, X, Y, Color, ConvertToSRGB);
+            }
+        }
+    }
+
+    static bool IsPowerOfTwo(uint32_t Value)
+    {
+        return (Value & (Value - 1)) == 0;
+    }
+
+    // Follows the order of operations of GenerateMipsCS
+    static void SampleRows(const MipPlane& Src, const MipPlane& Dst, const MipPlane* pDstLinear, uint32_t Mode, uint32_t FirstRow, uint32_t NumRows, bool ConvertToSRGB)
+    {
+        if (Mode == 0 && Src.Width == Dst.Width * 2 && Src.Height == Dst.Height * 2 && IsPowerOfTwo(Dst.Width) && IsPowerOfTwo(Dst.Height))
+        {
+            SampleRowsHalfSize(Src, Dst, pDstLinear, FirstRow, NumRows, ConvertToSRGB);
+            return;
+        }
+
+        const float TexelSizeX = 1.0f / static_cast<float>(Dst.Width);
+        const float TexelSizeY = 1.0f / static_cast<float>(Dst.Height);
+        const float OffX       = TexelSizeX * 0.5f;
+        const float OffY       = TexelSizeY * 0.5f;
+
+        for (uint32_t Y = FirstRow; Y < FirstRow + NumRows; ++Y)
+        {
+            for (uint32_t X = 0; X < Dst.Width; X += N)
+            {
+                float U1[N], V1[N], U2[N], V2[N];
+                Vec   Color;
+                switch (Mode)
+                {
+                    case 0:
+                        for (uint32_t i = 0; i < N; ++i)
+                        {
+                            U1[i] = TexelSizeX * (static_cast<float>(X + i) + 0.5f);
+                            V1[i] = TexelSizeY * (static_cast<float>(Y) + 0.5f);
+                        }
+                        Color = Sample(Src, U1, V1);
+                        break;
+
+                    case 1:
+                        for (uint32_t i = 0; i < N; ++i)
+                        {
+                            U1[i] = TexelSizeX * (static_cast<float>(X + i) + 0.25f);
+                            V1[i] = TexelSizeY * (static_cast<float>(Y) + 0.5f);
+                            U2[i] = U1[i] + OffX;
+                        }
+                        Color = ISA::Mul(ISA::Splat(0.5f), ISA::Add(Sample(Src, U1, V1), Sample(Src, U2, V1)));
+                        break;
+
+                    case 2:
+                        for (uint32_t i = 0; i < N; ++i)
+                        {
+                            U1[i] = TexelSizeX * (static_cast<float>(X + i) + 0.5f);
+                            V1[i] = TexelSizeY * (static_cast<float>(Y) + 0.25f);
+                            V2[i] = V1[i] + OffY;
+                        }
+                        Color = ISA::Mul(ISA::Splat(0.5f), ISA::Add(Sample(Src, U1, V1), Sample(Src, U1, V2)));
+                        break;
+
+                    default:
+                        for (uint32_t i = 0; i < N; ++i)
+                        {
+                            U1[i] = TexelSizeX * (static_cast<float>(X + i) + 0.25f);
+                            V1[i] = TexelSizeY * (static_cast<float>(Y) + 0.25f);
+                            U2[i] = U1[i] + OffX;
+                            V2[i] = V1[i] + OffY;
+                        }
+                        Color = Sample(Src, U1, V1);
+                        Color = ISA::Add(Color, Sample(Src, U2, V1));
+                        Color = ISA::Add(Color, Sample(Src, U1, V2));
+                        Color = ISA::Add(Color, Sample(Src, U2, V2));
+                        Color = ISA::Mul(Color, ISA::Splat(0.25f));
+                        break;
+                }
+                Write(Dst, pDstLinear, X, Y, Color, ConvertToSRGB);
+            }
+        }
+    }
+
+    // The source is clamped where a level is one texel wide or high. GenerateMipsCS reads
+    // LDS entries that no thread wrote in that case, so only there the results may differ.
+    static void ReduceRows(const MipPlane& Src, const MipPlane& Dst, const MipPlane* pDstLinear, uint32_t FirstRow, uint32_t NumRows, bool ConvertToSRGB)
+    {
+        const Vec Quarter = ISA::Splat(0.25f);
+        // Without clamping, every 2x2 block lies inside the source (odd sizes drop the last
+        // row or column), and whole rows can be loaded
+        if (Src.Width > 1 && Src.Height > 1)
+        {
+            for (uint32_t Y = FirstRow; Y < FirstRow + NumRows; ++Y)
+            {
+                for (uint32_t X = 0; X < Dst.Width; X += N)
+                {
+                    Vec Taps[4];
+                    LoadBlocks(Src, X, Y, Taps);
+
+                    Vec Color = ISA::Add(ISA::Add(ISA::Add(Taps[0], Taps[1]), Taps[2]), Taps[3]);
+                    Write(Dst, pDstLinear, X, Y, ISA::Mul(Quarter, Color), ConvertToSRGB);
+                }
+            }
+            return;
+        }
+
+        for (uint32_t Y = FirstRow; Y < FirstRow + NumRows; ++Y)
+        {
+            const uint32_t Y0 = Y * 2;
+            const uint32_t Y1 = Y0 + 1 < Src.Height ? Y0 + 1 : Src.Height - 1;
+            for (uint32_t X = 0; X < Dst.Width; X += N)
+            {
+                const float* Taps[4][N];
+                for (uint32_t i = 0; i < N; ++i)
+                {
+                    const uint32_t X0 = (X + i) * 2;
+                    const uint32_t X1 = X0 + 1 < Src.Width ? X0 + 1 : Src.Width - 1;
+                    Taps[0][i]        = Src.GetTexel(X0, Y0);
+                    Taps[1][i]        = Src.GetTexel(X1, Y0);
+                    Taps[2][i]        = Src.GetTexel(X0, Y1);
+                    Taps[3][i]        = Src.GetTexel(X1, Y1);
+                }
+
+                Vec Color = ISA::Add(ISA::Add(ISA::Add(ISA::Gather(Taps[0]), ISA::Gather(Taps[1])), ISA::Gather(Taps[2])), ISA::Gather(Taps[3]));
+                Write(Dst, pDstLinear, X, Y, ISA::Mul(Quarter, Color), ConvertToSRGB);
+            }
+        }
+    }
+
+    static const MipKernels& Get(const char* Name)
+    {
+        static const MipKernels Kernels{Name, &SampleRows, &ReduceRows};
+        return Kernels;
+    }
+};
+
+const MipKernels& GetScalarMipKernels();
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define CPU_GENERATE_MIPS_X86 1
+const MipKernels& GetSSE2MipKernels();
+const MipKernels& GetAVX2MipKernels(); // Only valid when the CPU supports AVX2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    define CPU_GENERATE_MIPS_NEON 1
+const MipKernels& GetNEONMipKernels();
+#endif
@@ -0,0 +1,77 @@
+#include "MipKernels.hpp"
+
+#if CPU_GENERATE_MIPS_X86
+
+// Compiled with AVX2 enabled: only call into this unit after checking the CPU
+#    include <immintrin.h>
+
+namespace
+{
+
+// Two texels per register
+struct AVX2ISA
+{
+    static constexpr uint32_t TexelsPerVec = 2;
+
+    using Vec = __m256;
+
+    static Vec Gather(const float* const (&Ptrs)[2])
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(Ptrs[0])), _mm_loadu_ps(Ptrs[1]), 1);
+    }
+
+    // Texels 0, 1 and 2, 3 are loaded whole, then regrouped across the 128-bit lanes
+    static void LoadPairs(const float* pSrc, Vec& Even, Vec& Odd)
+    {
+        const Vec Lo = _mm256_loadu_ps(pSrc);
+        const Vec Hi = _mm256_loadu_ps(pSrc + 8);
+        Even         = _mm256_permute2f128_ps(Lo, Hi, 0x20);
+        Odd          = _mm256_permute2f128_ps(Lo, Hi, 0x31);
+    }
+
+    static Vec Broadcast(const float (&Values)[2])
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(Values[0])), _mm_set1_ps(Values[1]), 1);
+    }
+
+    static Vec Splat(float Value)
+    {
+        return _mm256_set1_ps(Value);
+    }
+
+    static Vec Add(Vec A, Vec B)
+    {
+        return _mm256_add_ps(A, B);
+    }
+
+    static Vec Mul(Vec A, Vec B)
+    {
+        return _mm256_mul_ps(A, B);
+    }
+
+    static void Store(float* pDst, Vec Value)
+    {
+        _mm256_storeu_ps(pDst, Value);
+    }
+
+    static Vec LinearToSRGB(Vec x)
+    {
+        const Vec AbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+        const Vec Linear = _mm256_mul_ps(_mm256_set1_ps(12.92f), x);
+        const Vec Root   = _mm256_sqrt_ps(_mm256_and_ps(_mm256_sub_ps(x, _mm256_set1_ps(0.00228f)), AbsMask));
+        const Vec Curve  = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(1.13005f), Root), _mm256_mul_ps(_mm256_set1_ps(0.13448f), x)), _mm256_set1_ps(0.005719f));
+        const Vec Color  = _mm256_blendv_ps(Curve, Linear, _mm256_cmp_ps(x, _mm256_set1_ps(0.0031308f), _CMP_LT_OQ));
+        // Alpha of both texels unchanged
+        return _mm256_blend_ps(Color, x, 0x88);
+    }
+};
+
+} // namespace
+
+const MipKernels& GetAVX2MipKernels()
+{
+    return MipKernelsImpl<AVX2ISA>::Get("AVX2");
+}
+
+#endif
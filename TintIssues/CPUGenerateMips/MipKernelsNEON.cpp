@@ -0,0 +1,70 @@
+#include "MipKernels.hpp"
+
+#if CPU_GENERATE_MIPS_NEON
+
+#    include <arm_neon.h>
+
+namespace
+{
+
+// One texel per register. NEON is part of AArch64, so no runtime check is needed.
+struct NEONISA
+{
+    static constexpr uint32_t TexelsPerVec = 1;
+
+    using Vec = float32x4_t;
+
+    static Vec Gather(const float* const (&Ptrs)[1])
+    {
+        return vld1q_f32(Ptrs[0]);
+    }
+
+    static void LoadPairs(const float* pSrc, Vec& Even, Vec& Odd)
+    {
+        Even = vld1q_f32(pSrc);
+        Odd  = vld1q_f32(pSrc + 4);
+    }
+
+    static Vec Broadcast(const float (&Values)[1])
+    {
+        return vdupq_n_f32(Values[0]);
+    }
+
+    static Vec Splat(float Value)
+    {
+        return vdupq_n_f32(Value);
+    }
+
+    static Vec Add(Vec A, Vec B)
+    {
+        return vaddq_f32(A, B);
+    }
+
+    static Vec Mul(Vec A, Vec B)
+    {
+        return vmulq_f32(A, B);
+    }
+
+    static void Store(float* pDst, Vec Value)
+    {
+        vst1q_f32(pDst, Value);
+    }
+
+    static Vec LinearToSRGB(Vec x)
+    {
+        const Vec Linear = vmulq_f32(vdupq_n_f32(12.92f), x);
+        const Vec Root   = vsqrtq_f32(vabsq_f32(vsubq_f32(x, vdupq_n_f32(0.00228f))));
+        const Vec Curve  = vaddq_f32(vsubq_f32(vmulq_f32(vdupq_n_f32(1.13005f), Root), vmulq_f32(vdupq_n_f32(0.13448f), x)), vdupq_n_f32(0.005719f));
+        const Vec Color  = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0031308f)), Linear, Curve);
+        return vsetq_lane_f32(vgetq_lane_f32(x, 3), Color, 3);
+    }
+};
+
+} // namespace
+
+const MipKernels& GetNEONMipKernels()
+{
+    return MipKernelsImpl<NEONISA>::Get("NEON");
+}
+
+#endif
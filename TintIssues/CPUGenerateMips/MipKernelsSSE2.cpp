@@ -0,0 +1,77 @@
+#include "MipKernels.hpp"
+
+#if CPU_GENERATE_MIPS_X86
+
+#    include <emmintrin.h>
+
+namespace
+{
+
+// One texel per register. SSE2 is part of x86-64, so no flags and no runtime check are needed.
+struct SSE2ISA
+{
+    static constexpr uint32_t TexelsPerVec = 1;
+
+    using Vec = __m128;
+
+    static Vec Gather(const float* const (&Ptrs)[1])
+    {
+        return _mm_loadu_ps(Ptrs[0]);
+    }
+
+    static void LoadPairs(const float* pSrc, Vec& Even, Vec& Odd)
+    {
+        Even = _mm_loadu_ps(pSrc);
+        Odd  = _mm_loadu_ps(pSrc + 4);
+    }
+
+    static Vec Broadcast(const float (&Values)[1])
+    {
+        return _mm_set1_ps(Values[0]);
+    }
+
+    static Vec Splat(float Value)
+    {
+        return _mm_set1_ps(Value);
+    }
+
+    static Vec Add(Vec A, Vec B)
+    {
+        return _mm_add_ps(A, B);
+    }
+
+    static Vec Mul(Vec A, Vec B)
+    {
+        return _mm_mul_ps(A, B);
+    }
+
+    static void Store(float* pDst, Vec Value)
+    {
+        _mm_storeu_ps(pDst, Value);
+    }
+
+    static Vec Select(Vec Mask, Vec IfTrue, Vec IfFalse)
+    {
+        return _mm_or_ps(_mm_and_ps(Mask, IfTrue), _mm_andnot_ps(Mask, IfFalse));
+    }
+
+    static Vec LinearToSRGB(Vec x)
+    {
+        const Vec AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const Vec RGBMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+        const Vec Linear = _mm_mul_ps(_mm_set1_ps(12.92f), x);
+        const Vec Root   = _mm_sqrt_ps(_mm_and_ps(_mm_sub_ps(x, _mm_set1_ps(0.00228f)), AbsMask));
+        const Vec Curve  = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.13005f), Root), _mm_mul_ps(_mm_set1_ps(0.13448f), x)), _mm_set1_ps(0.005719f));
+        return Select(RGBMask, Select(_mm_cmplt_ps(x, _mm_set1_ps(0.0031308f)), Linear, Curve), x);
+    }
+};
+
+} // namespace
+
+const MipKernels& GetSSE2MipKernels()
+{
+    return MipKernelsImpl<SSE2ISA>::Get("SSE2");
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include <cmath>
+
+#include "MipKernels.hpp"
+
+namespace
+{
+
+// The fallback for CPUs without a supported vector instruction set
+struct ScalarISA
+{
+    static constexpr uint32_t TexelsPerVec = 1;
+
+    struct Vec
+    {
+        float v[4];
+    };
+
+    static Vec Gather(const float* const (&Ptrs)[1])
+    {
+        return {{Ptrs[0][0], Ptrs[0][1], Ptrs[0][2], Ptrs[0][3]}};
+    }
+
+    static void LoadPairs(const float* pSrc, Vec& Even, Vec& Odd)
+    {
+        Even = {{pSrc[0], pSrc[1], pSrc[2], pSrc[3]}};
+        Odd  = {{pSrc[4], pSrc[5], pSrc[6], pSrc[7]}};
+    }
+
+    static Vec Broadcast(const float (&Values)[1])
+    {
+        return Splat(Values[0]);
+    }
+
+    static Vec Splat(float Value)
+    {
+        return {{Value, Value, Value, Value}};
+    }
+
+    static Vec Add(const Vec& A, const Vec& B)
+    {
+        return {{A.v[0] + B.v[0], A.v[1] + B.v[1], A.v[2] + B.v[2], A.v[3] + B.v[3]}};
+    }
+
+    static Vec Mul(const Vec& A, const Vec& B)
+    {
+        return {{A.v[0] * B.v[0], A.v[1] * B.v[1], A.v[2] * B.v[2], A.v[3] * B.v[3]}};
+    }
+
+    static void Store(float* pDst, const Vec& Value)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+            pDst[c] = Value.v[c];
+    }
+
+    static Vec LinearToSRGB(Vec Value)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            const float x = Value.v[c];
+            Value.v[c]    = x < 0.0031308f ? 12.92f * x : 1.13005f * std::sqrt(std::abs(x - 0.00228f)) - 0.13448f * x + 0.005719f;
+        }
+        return Value;
+    }
+};
+
+} // namespace
+
+const MipKernels& GetScalarMipKernels()
+{
+    return MipKernelsImpl<ScalarISA>::Get("Scalar");
+}
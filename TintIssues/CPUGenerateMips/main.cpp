@@ -0,0 +1,378 @@
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <array>
+#include <string>
+#include <limits>
+
+#include "CPUGenerateMips.hpp"
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+
+// Straightforward transcription of GenerateMipsCS, one texel at a time, that the kernels
+// are checked against
+namespace Reference
+{
+
+using float4 = std::array<float, 4>;
+
+float4 operator+(const float4& A, const float4& B)
+{
+    return {A[0] + B[0], A[1] + B[1], A[2] + B[2], A[3] + B[3]};
+}
+
+float4 operator*(float S, const float4& A)
+{
+    return {S * A[0], S * A[1], S * A[2], S * A[3]};
+}
+
+float4 Load(const MipPlane& Plane, int X, int Y)
+{
+    X                = std::clamp(X, 0, static_cast<int>(Plane.Width) - 1);
+    Y                = std::clamp(Y, 0, static_cast<int>(Plane.Height) - 1);
+    const float* pTexel = Plane.GetTexel(X, Y);
+    return {pTexel[0], pTexel[1], pTexel[2], pTexel[3]};
+}
+
+void Store(const MipPlane& Plane, uint32_t X, uint32_t Y, const float4& Color)
+{
+    std::copy(Color.begin(), Color.end(), Plane.GetTexel(X, Y));
+}
+
+// SrcTex.SampleLevel(BilinearClamp, ...)
+float4 SampleLevel(const MipPlane& Src, float U, float V)
+{
+    const float TX = U * Src.Width - 0.5f;
+    const float TY = V * Src.Height - 0.5f;
+    const float X0 = std::floor(TX);
+    const float Y0 = std::floor(TY);
+    const float FX = TX - X0;
+    const float FY = TY - Y0;
+    const int   X  = static_cast<int>(X0);
+    const int   Y  = static_cast<int>(Y0);
+    return ((1.0f - FX) * (1.0f - FY)) * Load(Src, X, Y) + (FX * (1.0f - FY)) * Load(Src, X + 1, Y) +
+        ((1.0f - FX) * FY) * Load(Src, X, Y + 1) + (FX * FY) * Load(Src, X + 1, Y + 1);
+}
+
+float LinearToSRGB(float x)
+{
+    return x < 0.0031308f ? 12.92f * x : 1.13005f * std::sqrt(std::abs(x - 0.00228f)) - 0.13448f * x + 0.005719f;
+}
+
+float4 PackColor(const float4& Linear, bool ConvertToSRGB)
+{
+    if (!ConvertToSRGB)
+        return Linear;
+    return {LinearToSRGB(Linear[0]), LinearToSRGB(Linear[1]), LinearToSRGB(Linear[2]), Linear[3]};
+}
+
+// One dispatch: Src is the source level as the sampler returns it
+void RunDispatch(const MipPlane& Src, const std::vector<MipPlane>& OutMips, uint32_t NonPowerOfTwo, bool ConvertToSRGB)
+{
+    const MipPlane& OutMip1   = OutMips[0];
+    const float     TexelSizeX = 1.0f / OutMip1.Width;
+    const float     TexelSizeY = 1.0f / OutMip1.Height;
+
+    // What the shader keeps in LDS
+    std::vector<float4> Level(size_t{OutMip1.Width} * OutMip1.Height);
+    uint32_t            Width  = OutMip1.Width;
+    uint32_t            Height = OutMip1.Height;
+    for (uint32_t y = 0; y < Height; ++y)
+    {
+        for (uint32_t x = 0; x < Width; ++x)
+        {
+            float4 Src1{};
+            if (NonPowerOfTwo == 0)
+            {
+                Src1 = SampleLevel(Src, TexelSizeX * (x + 0.5f), TexelSizeY * (y + 0.5f));
+            }
+            else if (NonPowerOfTwo == 1)
+            {
+                const float U1  = TexelSizeX * (x + 0.25f);
+                const float V1  = TexelSizeY * (y + 0.5f);
+                const float Off = TexelSizeX * 0.5f;
+                Src1            = 0.5f * (SampleLevel(Src, U1, V1) + SampleLevel(Src, U1 + Off, V1));
+            }
+            else if (NonPowerOfTwo == 2)
+            {
+                const float U1  = TexelSizeX * (x + 0.5f);
+                const float V1  = TexelSizeY * (y + 0.25f);
+                const float Off = TexelSizeY * 0.5f;
+                Src1            = 0.5f * (SampleLevel(Src, U1, V1) + SampleLevel(Src, U1, V1 + Off));
+            }
+            else
+            {
+                const float U1   = TexelSizeX * (x + 0.25f);
+                const float V1   = TexelSizeY * (y + 0.25f);
+                const float OffX = TexelSizeX * 0.5f;
+                const float OffY = TexelSizeY * 0.5f;
+                Src1             = SampleLevel(Src, U1, V1);
+                Src1             = Src1 + SampleLevel(Src, U1 + OffX, V1);
+                Src1             = Src1 + SampleLevel(Src, U1, V1 + OffY);
+                Src1             = Src1 + SampleLevel(Src, U1 + OffX, V1 + OffY);
+                Src1             = 0.25f * Src1;
+            }
+            Level[size_t{y} * Width + x] = Src1;
+            Store(OutMip1, x, y, PackColor(Src1, ConvertToSRGB));
+        }
+    }
+
+    for (size_t Mip = 1; Mip < OutMips.size(); ++Mip)
+    {
+        const MipPlane&     OutMip = OutMips[Mip];
+        std::vector<float4> Next(size_t{OutMip.Width} * OutMip.Height);
+        for (uint32_t y = 0; y < OutMip.Height; ++y)
+        {
+            for (uint32_t x = 0; x < OutMip.Width; ++x)
+            {
+                const auto At = [&](uint32_t sx, uint32_t sy) {
+                    return Level[size_t{std::min(sy, Height - 1)} * Width + std::min(sx, Width - 1)];
+                };
+                const float4 Src1 = 0.25f * (At(2 * x, 2 * y) + At(2 * x + 1, 2 * y) + At(2 * x, 2 * y + 1) + At(2 * x + 1, 2 * y + 1));
+
+                Next[size_t{y} * OutMip.Width + x] = Src1;
+                Store(OutMip, x, y, PackColor(Src1, ConvertToSRGB));
+            }
+        }
+        Level  = std::move(Next);
+        Width  = OutMip.Width;
+        Height = OutMip.Height;
+    }
+}
+
+void GenerateMips(MipTexture& Texture, bool ConvertToSRGB)
+{
+    for (const auto& Batch : PlanGenerateMips(Texture.GetWidth(), Texture.GetHeight(), Texture.GetMipLevels()))
+    {
+        for (uint32_t Slice = 0; Slice < Texture.GetArraySize(); ++Slice)
+        {
+            // An sRGB view decodes the levels the previous dispatches stored
+            MipTexture Decoded{Texture.GetWidth(), Texture.GetHeight(), 1, Batch.SrcMipLevel + 1};
+            MipPlane   Src = Texture.GetPlane(Batch.SrcMipLevel, Slice);
+            if (ConvertToSRGB && Batch.SrcMipLevel > 0)
+            {
+                const MipPlane Linear = Decoded.GetPlane(Batch.SrcMipLevel, 0);
+                for (uint32_t y = 0; y < Src.Height; ++y)
+                {
+                    for (uint32_t x = 0; x < Src.Width; ++x)
+                    {
+                        const float4 Color = Load(Src, x, y);
+                        Store(Linear, x, y, {SRGBToLinear(Color[0]), SRGBToLinear(Color[1]), SRGBToLinear(Color[2]), Color[3]});
+                    }
+                }
+                Src = Linear;
+            }
+
+            std::vector<MipPlane> OutMips;
+            for (uint32_t Mip = 1; Mip <= Batch.NumMipLevels; ++Mip)
+                OutMips.push_back(Texture.GetPlane(Batch.SrcMipLevel + Mip, Slice));
+            RunDispatch(Src, OutMips, Batch.NonPowerOfTwo, ConvertToSRGB);
+        }
+    }
+}
+
+} // namespace Reference
+
+void FillRandom(MipTexture& Texture, uint32_t Seed)
+{
+    std::mt19937                          Random{Seed};
+    std::uniform_real_distribution<float> Distribution{0.0f, 1.0f};
+    for (uint32_t Slice = 0; Slice < Texture.GetArraySize(); ++Slice)
+    {
+        const MipPlane Plane = Texture.GetPlane(0, Slice);
+        for (uint32_t y = 0; y < Plane.Height; ++y)
+        {
+            for (uint32_t x = 0; x < Plane.Width; ++x)
+            {
+                float* pTexel = Plane.GetTexel(x, y);
+                for (uint32_t c = 0; c < 4; ++c)
+                    pTexel[c] = Distribution(Random);
+            }
+        }
+    }
+}
+
+// Fills levels 1.. with NaN, so that any texel GenerateMips does not write fails the comparison
+void PoisonMips(MipTexture& Texture)
+{
+    for (uint32_t Slice = 0; Slice < Texture.GetArraySize(); ++Slice)
+    {
+        for (uint32_t Mip = 1; Mip < Texture.GetMipLevels(); ++Mip)
+        {
+            const MipPlane Plane = Texture.GetPlane(Mip, Slice);
+            std::fill_n(Plane.pData, size_t{Plane.Pitch} * Plane.Height * 4, std::numeric_limits<float>::quiet_NaN());
+        }
+    }
+}
+
+// Largest difference between the texels of levels 1.. of two textures of the same size.
+// Infinite if either texture has a NaN where the other one does not
+float GetMaxDifference(const MipTexture& A, const MipTexture& B)
+{
+    float MaxDifference = 0;
+    for (uint32_t Slice = 0; Slice < A.GetArraySize(); ++Slice)
+    {
+        for (uint32_t Mip = 1; Mip < A.GetMipLevels(); ++Mip)
+        {
+            const MipPlane PlaneA = A.GetPlane(Mip, Slice);
+            const MipPlane PlaneB = B.GetPlane(Mip, Slice);
+            for (uint32_t y = 0; y < PlaneA.Height; ++y)
+            {
+                for (uint32_t x = 0; x < PlaneA.Width; ++x)
+                {
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        const float Difference = std::abs(PlaneA.GetTexel(x, y)[c] - PlaneB.GetTexel(x, y)[c]);
+                        if (std::isnan(Difference))
+                            return std::numeric_limits<float>::infinity();
+                        MaxDifference = std::max(MaxDifference, Difference);
+                    }
+                }
+            }
+        }
+    }
+    return MaxDifference;
+}
+
+// The kernels follow the order of operations of the shader, so only the compiler's
+// contraction of multiplies and adds can make them differ from the reference
+constexpr float MaxAllowedDifference = 1e-5f;
+
+// Compares every supported kernel set with the reference on sizes that cover all four
+// NON_POWER_OF_TWO modes, levels one texel wide or high and partial bands
+bool RunTests(const std::vector<const MipKernels*>& Kernels)
+{
+    const std::pair<uint32_t, uint32_t> Sizes[] = {
+        {1, 1}, {2, 2}, {64, 64}, {7, 5}, {100, 37}, {37, 100}, {256, 1}, {1, 33}, {513, 260}, {96, 200},
+    };
+
+    bool AllPassed = true;
+    for (const auto& Size : Sizes)
+    {
+        for (bool ConvertToSRGB : {false, true})
+        {
+            MipTexture Expected{Size.first, Size.second, 3, MipTexture::GetFullMipLevels(Size.first, Size.second)};
+            FillRandom(Expected, Size.first * 1000 + Size.second);
+            const MipTexture Source = Expected;
+            Reference::GenerateMips(Expected, ConvertToSRGB);
+
+            for (const MipKernels* pKernels : Kernels)
+            {
+                for (uint32_t NumThreads : {1u, 4u})
+                {
+                    // Every run starts from level 0 only: nothing left by an earlier run can pass
+                    MipTexture Actual = Source;
+                    PoisonMips(Actual);
+
+                    CPUGenerateMipsDesc Desc;
+                    Desc.ConvertToSRGB = ConvertToSRGB;
+                    Desc.NumThreads    = NumThreads;
+                    Desc.pKernels      = pKernels;
+                    GenerateMips(Actual, Desc);
+
+                    const float Difference = GetMaxDifference(Expected, Actual);
+                    if (Difference > MaxAllowedDifference)
+                    {
+                        LOG_WARNING_MESSAGE(pKernels->Name, ", ", Size.first, "x", Size.second, ConvertToSRGB ? " sRGB" : "", ", ",
+                                            NumThreads, " threads: differs from the reference by ", Difference);
+                        AllPassed = false;
+                    }
+                }
+            }
+        }
+    }
+    return AllPassed;
+}
+
+// Usage: CPUGenerateMips [--size N] [--slices N] [--threads N] [--srgb]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        uint32_t Size          = 2048;
+        uint32_t ArraySize     = 4;
+        uint32_t NumThreads    = 0;
+        bool     ConvertToSRGB = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--size" && i + 1 < argc)
+                Size = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (Arg == "--slices" && i + 1 < argc)
+                ArraySize = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (Arg == "--threads" && i + 1 < argc)
+                NumThreads = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (Arg == "--srgb")
+                ConvertToSRGB = true;
+            else
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+        }
+
+        const auto Kernels = GetSupportedMipKernels();
+        if (!RunTests(Kernels))
+            LOG_ERROR_AND_THROW("CPU mips do not match the reference");
+        std::cout << "All kernels match the reference\n\n";
+
+        MipTexture Texture{Size, Size, ArraySize, MipTexture::GetFullMipLevels(Size, Size)};
+        FillRandom(Texture, 1);
+
+        // Texels written to all levels, for the throughput
+        uint64_t NumTexels = 0;
+        for (uint32_t Mip = 1; Mip < Texture.GetMipLevels(); ++Mip)
+            NumTexels += uint64_t{MipTexture::GetMipDimension(Size, Mip)} * MipTexture::GetMipDimension(Size, Mip) * ArraySize;
+
+        std::cout << Size << "x" << Size << "x" << ArraySize << (ConvertToSRGB ? " sRGB" : "") << "\n"
+                  << std::left << std::setw(10) << "Kernels" << std::setw(10) << "Threads" << std::setw(12) << "Time, ms" << "MTexels/s\n";
+        for (const MipKernels* pKernels : Kernels)
+        {
+            for (uint32_t Threads : {1u, NumThreads})
+            {
+                CPUGenerateMipsDesc Desc;
+                Desc.ConvertToSRGB = ConvertToSRGB;
+                Desc.NumThreads    = Threads;
+                Desc.pKernels      = pKernels;
+
+                const auto StartTime = std::chrono::high_resolution_clock::now();
+                GenerateMips(Texture, Desc);
+                const auto   EndTime = std::chrono::high_resolution_clock::now();
+                const double TimeMs  = std::chrono::duration<double, std::milli>(EndTime - StartTime).count();
+
+                std::cout << std::setw(10) << pKernels->Name << std::setw(10) << (Threads != 0 ? std::to_string(Threads) : std::string{"all"})
+                          << std::setw(12) << std::fixed << std::setprecision(1) << TimeMs << NumTexels / (TimeMs * 1000.0) << "\n";
+            }
+        }
+        std::cout << std::right;
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
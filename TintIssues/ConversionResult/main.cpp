@@ -0,0 +1,510 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include <iostream>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <variant>
+#include <vector>
+#include <chrono>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+// VARIANT 2 references an undeclared function and VARIANT 3 has a syntax error:
+// a permutation sweep is expected to reject both without aborting the batch.
+const std::string TestCS = R"(
+#ifndef VARIANT
+#   define VARIANT 0
+#endif
+
+RWTexture2D<float4> g_tex2DUAV;
+
+[numthreads(16, 16, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+    float4 Color = float4(float2(DTid.xy % 256u) / 256.0, 0.0, 1.0);
+#if VARIANT == 1
+    Color.rgb = Color.bgr;
+#elif VARIANT == 2
+    Color = UndeclaredFunction(Color);
+#elif VARIANT == 3
+    Color = Color +;
+#endif
+    g_tex2DUAV[DTid.xy] = Color;
+}
+)";
+;
+} // namespace HLSL
+
+enum class ConversionStage
+{
+    Parse,
+    Link,
+    MapIO,
+    Optimize,
+    TintRead,
+    TintWrite,
+};
+
+const char* GetConversionStageName(ConversionStage Stage)
+{
+    switch (Stage)
+    {
+        case ConversionStage::Parse: return "parse";
+        case ConversionStage::Link: return "link";
+        case ConversionStage::MapIO: return "map-io";
+        case ConversionStage::Optimize: return "optimize";
+        case ConversionStage::TintRead: return "tint-read";
+        case ConversionStage::TintWrite: return "tint-write";
+        default: return "unknown";
+    }
+}
+
+enum class DiagnosticSeverity
+{
+    Note,
+    Warning,
+    Error,
+};
+
+// Single structured diagnostic. Line and Column are 1-based; zero means unknown.
+struct Diagnostic
+{
+    ConversionStage    Stage    = ConversionStage::Parse;
+    DiagnosticSeverity Severity = DiagnosticSeverity::Error;
+    std::string        File;
+    uint32_t           Line   = 0;
+    uint32_t           Column = 0;
+    std::string        Message;
+};
+
+std::ostream& operator<<(std::ostream& Stream, const Diagnostic& Diag)
+{
+    static constexpr const char* SeverityNames[] = {"note", "warning", "error"};
+
+    Stream << "[" << GetConversionStageName(Diag.Stage) << "] ";
+    if (!Diag.File.empty() || Diag.Line != 0)
+    {
+        Stream << (Diag.File.empty() ? "<source>" : Diag.File);
+        if (Diag.Line != 0)
+            Stream << ":" << Diag.Line;
+        if (Diag.Column != 0)
+            Stream << ":" << Diag.Column;
+        Stream << " ";
+    }
+    return Stream << SeverityNames[static_cast<int>(Diag.Severity)] << ": " << Diag.Message;
+}
+
+using DiagnosticList = std::vector<Diagnostic>;
+
+// Minimal expected-like type: holds either a value or the diagnostics that explain
+// why the value could not be produced. Diagnostics attached to a successful result
+// (warnings) are preserved as well.
+template <typename ValueType>
+class ConversionResult
+{
+public:
+    ConversionResult(ValueType Value, DiagnosticList Warnings = {}) :
+        m_Value{std::move(Value)}, m_Diagnostics{std::move(Warnings)}
+    {}
+
+    static ConversionResult Failure(DiagnosticList Diagnostics)
+    {
+        return ConversionResult{std::move(Diagnostics)};
+    }
+
+    explicit operator bool() const
+    {
+        return m_Value.index() == 0;
+    }
+
+    ValueType& Value()
+    {
+        return std::get<0>(m_Value);
+    }
+
+    const ValueType& Value() const
+    {
+        return std::get<0>(m_Value);
+    }
+
+    const DiagnosticList& Diagnostics() const
+    {
+        return m_Diagnostics;
+    }
+
+    DiagnosticList TakeDiagnostics()
+    {
+        return std::move(m_Diagnostics);
+    }
+
+private:
+    explicit ConversionResult(DiagnosticList Diagnostics) :
+        m_Value{std::monostate{}}, m_Diagnostics{std::move(Diagnostics)}
+    {}
+
+    std::variant<ValueType, std::monostate> m_Value;
+    DiagnosticList                          m_Diagnostics;
+};
+
+bool HasErrors(const DiagnosticList& Diagnostics)
+{
+    for (const auto& Diag : Diagnostics)
+    {
+        if (Diag.Severity == DiagnosticSeverity::Error)
+            return true;
+    }
+    return false;
+}
+
+bool ParseUInt(std::string_view Str, uint32_t& Value)
+{
+    if (Str.empty())
+        return false;
+
+    Value = 0;
+    for (char c : Str)
+    {
+        if (c < '0' || c > '9')
+            return false;
+        Value = Value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return true;
+}
+
+std::string_view TrimSpaces(std::string_view Str)
+{
+    while (!Str.empty() && (Str.front() == ' ' || Str.front() == '\t'))
+        Str.remove_prefix(1);
+    while (!Str.empty() && (Str.back() == ' ' || Str.back() == '\t' || Str.back() == '\r'))
+        Str.remove_suffix(1);
+    return Str;
+}
+
+// glslang info log lines look like
+//   ERROR: 0:17: 'UndeclaredFunction' : no matching overloaded function found
+//   WARNING: Linking compute stage: ...
+void ParseGlslangInfoLog(const char* InfoLog, ConversionStage Stage, DiagnosticList& Diagnostics)
+{
+    std::string_view Log{InfoLog != nullptr ? InfoLog : ""};
+    while (!Log.empty())
+    {
+        const size_t     LineEnd = Log.find('\n');
+        std::string_view Line    = TrimSpaces(Log.substr(0, LineEnd));
+        Log.remove_prefix(LineEnd == std::string_view::npos ? Log.size() : LineEnd + 1);
+
+        Diagnostic Diag;
+        Diag.Stage = Stage;
+        if (Line.substr(0, 7) == "ERROR: ")
+        {
+            Diag.Severity = DiagnosticSeverity::Error;
+            Line.remove_prefix(7);
+        }
+        else if (Line.substr(0, 9) == "WARNING: ")
+        {
+            Diag.Severity = DiagnosticSeverity::Warning;
+            Line.remove_prefix(9);
+        }
+        else
+        {
+            continue;
+        }
+
+        // Optional "<string>:<line>: " location prefix
+        const size_t FirstColon  = Line.find(':');
+        const size_t SecondColon = FirstColon != std::string_view::npos ? Line.find(':', FirstColon + 1) : std::string_view::npos;
+        if (SecondColon != std::string_view::npos && ParseUInt(Line.substr(FirstColon + 1, SecondColon - FirstColon - 1), Diag.Line))
+        {
+            Diag.File = std::string{Line.substr(0, FirstColon)};
+            Line.remove_prefix(SecondColon + 1);
+        }
+        else
+        {
+            Diag.Line = 0;
+        }
+
+        // Summary lines such as "1 compilation errors.  No code generated." carry no information
+        if (Line.find("compilation errors") != std::string_view::npos)
+            continue;
+
+        Diag.Message = std::string{TrimSpaces(Line)};
+        Diagnostics.emplace_back(std::move(Diag));
+    }
+}
+
+// Tint diagnostics are formatted as
+//   <file>:<line>:<column> error: <message>
+// with the location omitted when it is unknown.
+void ParseTintDiagnostics(const std::string& Text, ConversionStage Stage, DiagnosticList& Diagnostics)
+{
+    static constexpr std::pair<const char*, DiagnosticSeverity> SeverityTags[] = {
+        {"error: ", DiagnosticSeverity::Error},
+        {"warning: ", DiagnosticSeverity::Warning},
+        {"note: ", DiagnosticSeverity::Note},
+    };
+
+    std::string_view Log{Text};
+    while (!Log.empty())
+    {
+        const size_t     LineEnd = Log.find('\n');
+        std::string_view Line    = TrimSpaces(Log.substr(0, LineEnd));
+        Log.remove_prefix(LineEnd == std::string_view::npos ? Log.size() : LineEnd + 1);
+
+        size_t TagPos = std::string_view::npos;
+        size_t TagLen = 0;
+
+        Diagnostic Diag;
+        Diag.Stage = Stage;
+        for (const auto& [Tag, Severity] : SeverityTags)
+        {
+            TagPos = Line.find(Tag);
+            if (TagPos != std::string_view::npos)
+            {
+                TagLen        = std::string_view{Tag}.size();
+                Diag.Severity = Severity;
+                break;
+            }
+        }
+
+        if (TagPos == std::string_view::npos)
+        {
+            // Source snippet and caret lines that follow a diagnostic
+            if (!Diagnostics.empty() && Diagnostics.back().Stage == Stage && !Line.empty())
+                Diagnostics.back().Message.append("\n    ").append(Line);
+            continue;
+        }
+
+        std::string_view Location = TrimSpaces(Line.substr(0, TagPos));
+        const size_t     ColumnSep = Location.rfind(':');
+        const size_t     LineSep   = ColumnSep != std::string_view::npos && ColumnSep > 0 ? Location.rfind(':', ColumnSep - 1) : std::string_view::npos;
+        if (LineSep != std::string_view::npos &&
+            ParseUInt(Location.substr(LineSep + 1, ColumnSep - LineSep - 1), Diag.Line) &&
+            ParseUInt(Location.substr(ColumnSep + 1), Diag.Column))
+        {
+            Diag.File = std::string{Location.substr(0, LineSep)};
+        }
+        else
+        {
+            Diag.Line   = 0;
+            Diag.Column = 0;
+            Diag.File   = std::string{Location};
+        }
+
+        Diag.Message = std::string{Line.substr(TagPos + TagLen)};
+        Diagnostics.emplace_back(std::move(Diag));
+    }
+
+    if (!HasErrors(Diagnostics) && !Text.empty())
+        Diagnostics.push_back({Stage, DiagnosticSeverity::Error, {}, 0, 0, Text});
+}
+
+ConversionResult<std::vector<uint32_t>> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    DiagnosticList Diagnostics;
+
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.SetMessageConsumer([&Diagnostics](spv_message_level_t Level, const char* Source, const spv_position_t& Position, const char* Message) {
+        Diagnostic Diag;
+        Diag.Stage    = ConversionStage::Optimize;
+        Diag.Severity = Level <= SPV_MSG_ERROR ? DiagnosticSeverity::Error : (Level == SPV_MSG_WARNING ? DiagnosticSeverity::Warning : DiagnosticSeverity::Note);
+        Diag.File     = Source != nullptr ? Source : "";
+        Diag.Line     = static_cast<uint32_t>(Position.line);
+        Diag.Column   = static_cast<uint32_t>(Position.column);
+        Diag.Message  = Message != nullptr ? Message : "";
+        // Report the instruction index when there is no textual location
+        if (Diag.Line == 0 && Position.index != 0)
+            Diag.Message += ConcatenateArgs(" (word ", Position.index, ")");
+        Diagnostics.emplace_back(std::move(Diag));
+    });
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+    {
+        if (!HasErrors(Diagnostics))
+            Diagnostics.push_back({ConversionStage::Optimize, DiagnosticSeverity::Error, {}, 0, 0, "spvtools::Optimizer::Run failed"});
+        return ConversionResult<std::vector<uint32_t>>::Failure(std::move(Diagnostics));
+    }
+
+    return {std::move(OptimizedSPIRV), std::move(Diagnostics)};
+}
+
+ConversionResult<std::vector<uint32_t>> ConvertHLSLtoSPIRV(const std::string& HLSL, const std::string& Preamble)
+{
+    GlslangInitilizer InitScope{};
+
+    DiagnosticList Diagnostics;
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto*       pHLSL     = HLSL.c_str();
+    const char* pFileName = "TestCS.hlsl";
+    Shader.setStringsWithLengthsAndNames(&pHLSL, nullptr, &pFileName, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    const bool       IsParsed = Shader.parse(&Resources, 100, false, EShMsgDefault);
+    ParseGlslangInfoLog(Shader.getInfoLog(), ConversionStage::Parse, Diagnostics);
+    if (!IsParsed)
+        return ConversionResult<std::vector<uint32_t>>::Failure(std::move(Diagnostics));
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+    {
+        ParseGlslangInfoLog(Program.getInfoLog(), ConversionStage::Link, Diagnostics);
+        return ConversionResult<std::vector<uint32_t>>::Failure(std::move(Diagnostics));
+    }
+
+    if (!Program.mapIO())
+    {
+        ParseGlslangInfoLog(Program.getInfoLog(), ConversionStage::MapIO, Diagnostics);
+        return ConversionResult<std::vector<uint32_t>>::Failure(std::move(Diagnostics));
+    }
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+    for (auto& Diag : OptimizedSPIRV.TakeDiagnostics())
+        Diagnostics.emplace_back(std::move(Diag));
+
+    if (!OptimizedSPIRV)
+        return ConversionResult<std::vector<uint32_t>>::Failure(std::move(Diagnostics));
+
+    return {std::move(OptimizedSPIRV.Value()), std::move(Diagnostics)};
+}
+
+ConversionResult<std::string> ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    DiagnosticList Diagnostics;
+
+    auto Module = tint::spirv::reader::ReadIR(SPIRV);
+    if (Module != tint::Success)
+    {
+        ParseTintDiagnostics(Module.Failure().reason, ConversionStage::TintRead, Diagnostics);
+        return ConversionResult<std::string>::Failure(std::move(Diagnostics));
+    }
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+    if (Program != tint::Success)
+    {
+        ParseTintDiagnostics(Program.Failure().reason, ConversionStage::TintWrite, Diagnostics);
+        return ConversionResult<std::string>::Failure(std::move(Diagnostics));
+    }
+
+    return {std::move(Program.Get().wgsl), std::move(Diagnostics)};
+}
+
+ConversionResult<std::string> ConvertHLSLtoWGSL(const std::string& HLSL, const std::string& Preamble)
+{
+    auto SPIRV = ConvertHLSLtoSPIRV(HLSL, Preamble);
+    if (!SPIRV)
+        return ConversionResult<std::string>::Failure(SPIRV.TakeDiagnostics());
+
+    auto WGSL = ConvertSPIRVtoWGSL(SPIRV.Value());
+
+    DiagnosticList Diagnostics = SPIRV.TakeDiagnostics();
+    for (auto& Diag : WGSL.TakeDiagnostics())
+        Diagnostics.emplace_back(std::move(Diag));
+
+    if (!WGSL)
+        return ConversionResult<std::string>::Failure(std::move(Diagnostics));
+
+    return {std::move(WGSL.Value()), std::move(Diagnostics)};
+}
+
+int main(int argc, const char* argv[])
+{
+    constexpr int VariantCount = 4;
+
+    uint32_t SucceededCount = 0;
+    uint32_t FailedCount    = 0;
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+    for (int Variant = 0; Variant < VariantCount; ++Variant)
+    {
+        auto WGSL = ConvertHLSLtoWGSL(HLSL::TestCS, ConcatenateArgs("#define VARIANT ", Variant, "\n"));
+        if (WGSL)
+        {
+            ++SucceededCount;
+        }
+        else
+        {
+            ++FailedCount;
+            std::cout << "==== VARIANT " << Variant << " failed ====\n";
+        }
+
+        for (const auto& Diag : WGSL.Diagnostics())
+            std::cout << Diag << "\n";
+    }
+    const auto EndTime = std::chrono::high_resolution_clock::now();
+
+    LOG_INFO_MESSAGE("Converted ", SucceededCount, " of ", VariantCount, " variants (", FailedCount, " expected failures) in ",
+                     std::chrono::duration<double, std::milli>(EndTime - StartTime).count(), " ms");
+
+    return SucceededCount == 2 && FailedCount == 2 ? 0 : -1;
+}
@@ -0,0 +1,462 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <algorithm>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string TestCS = R"(
+
+cbuffer Constants
+{
+    float4 g_Color;
+};
+
+StructuredBuffer<float4> g_StructuredBuffer;
+
+RWTexture2D<float4> Tex2D_0;
+RWTexture2D<float4> Tex2D_1;
+Texture2D<float4>   Tex2D;
+
+RWTexture2D<float4> Tex2D_F2[2];
+Texture2D<float4>   Tex2D_Arr[4];
+
+[numthreads(8, 8, 1)]
+void main(uint3 Gid : SV_GroupID,
+          uint3 GTid : SV_GroupThreadID)
+{
+    float4 Color = Tex2D.Load(int3(GTid.xy, 0));
+    Tex2D_0[GTid.xy] = g_Color;
+    Tex2D_1[GTid.xy] = Color + g_StructuredBuffer[0];
+    Tex2D_F2[0][GTid.xy] = float4(0.0, 0.0, 0.0, 1.0);
+}
+
+[numthreads(8, 8, 1)]
+void ClearCS(uint3 DTid : SV_DispatchThreadID)
+{
+    Tex2D_0[DTid.xy] = Tex2D_Arr[0].Load(int3(DTid.xy, 0)) + Tex2D_Arr[2].Load(int3(DTid.xy, 0));
+}
+)";
+;
+} // namespace HLSL
+
+struct ResourceBindingInfo
+{
+    std::string Name;
+    uint32_t    Set       = 0;
+    uint32_t    Binding   = 0;
+    uint32_t    ArraySize = 0; // Zero for non-array resources
+};
+
+struct BindingEliminationReport
+{
+    std::vector<std::string>         RemovedVariables;
+    std::vector<std::string>         ShrunkArrays;
+    std::vector<ResourceBindingInfo> Bindings;
+};
+
+// Removes resource variables that the entry point never references and shrinks resource
+// arrays that are only indexed with constants to the highest index actually used. Arrays
+// reduced to a single element are replaced with the element itself.
+// Must run on a module with a single entry point, i.e. after per-entry-point compilation
+// and the regular spirv-opt passes.
+class DeadResourceBindingEliminationPass final : public spvtools::opt::Pass
+{
+public:
+    explicit DeadResourceBindingEliminationPass(BindingEliminationReport* pReport) :
+        m_pReport{pReport}
+    {}
+
+    const char* name() const override
+    {
+        return "dead-resource-binding-elimination";
+    }
+
+    Status Process() override
+    {
+        std::vector<spvtools::opt::Instruction*> ResourceVariables;
+        for (auto& Instruction : get_module()->types_values())
+        {
+            if (Instruction.opcode() == spv::Op::OpVariable && IsResourceStorageClass(Instruction.GetSingleWordInOperand(0)))
+                ResourceVariables.push_back(&Instruction);
+        }
+
+        bool IsModified = false;
+        for (auto* pVariable : ResourceVariables)
+        {
+            bool                                     IsUsed      = false;
+            bool                                     CanShrink   = true;
+            uint32_t                                 MaxIndex    = 0;
+            std::vector<spvtools::opt::Instruction*> AccessChains;
+            get_def_use_mgr()->ForEachUser(pVariable, [&](spvtools::opt::Instruction* pUser) {
+                if (spvtools::opt::IsAnnotationInst(pUser->opcode()) || pUser->opcode() == spv::Op::OpName || pUser->opcode() == spv::Op::OpEntryPoint)
+                    return;
+
+                IsUsed = true;
+                if ((pUser->opcode() == spv::Op::OpAccessChain || pUser->opcode() == spv::Op::OpInBoundsAccessChain) && pUser->NumInOperands() >= 2)
+                {
+                    const auto* pIndex = get_def_use_mgr()->GetDef(pUser->GetSingleWordInOperand(1));
+                    if (pIndex->opcode() == spv::Op::OpConstant)
+                    {
+                        MaxIndex = std::max(MaxIndex, pIndex->GetSingleWordInOperand(0));
+                        AccessChains.push_back(pUser);
+                        return;
+                    }
+                }
+                CanShrink = false;
+            });
+
+            if (!IsUsed)
+            {
+                m_pReport->RemovedVariables.push_back(GetVariableName(pVariable));
+                RemoveFromEntryPointInterfaces(pVariable->result_id());
+                context()->KillNamesAndDecorates(pVariable);
+                context()->KillInst(pVariable);
+                IsModified = true;
+                continue;
+            }
+
+            auto* pArrayType = get_def_use_mgr()->GetDef(GetPointeeTypeId(pVariable));
+            if (CanShrink && pArrayType->opcode() == spv::Op::OpTypeArray)
+            {
+                const auto* pLength   = get_def_use_mgr()->GetDef(pArrayType->GetSingleWordInOperand(1));
+                const auto  Length    = pLength->GetSingleWordInOperand(0);
+                const auto  NewLength = MaxIndex + 1;
+                if (pLength->opcode() == spv::Op::OpConstant && NewLength < Length)
+                {
+                    m_pReport->ShrunkArrays.push_back(ConcatenateArgs(GetVariableName(pVariable), ": ", Length, " -> ", NewLength));
+                    ShrinkArray(pVariable, pArrayType, NewLength, AccessChains);
+                    IsModified = true;
+                }
+            }
+        }
+
+        CollectBindings();
+
+        return IsModified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+    }
+
+private:
+    static bool IsResourceStorageClass(uint32_t StorageClass)
+    {
+        switch (static_cast<spv::StorageClass>(StorageClass))
+        {
+            case spv::StorageClass::UniformConstant:
+            case spv::StorageClass::Uniform:
+            case spv::StorageClass::StorageBuffer:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    uint32_t GetPointeeTypeId(const spvtools::opt::Instruction* pVariable)
+    {
+        return get_def_use_mgr()->GetDef(pVariable->type_id())->GetSingleWordInOperand(1);
+    }
+
+    std::string GetName(uint32_t Id)
+    {
+        for (const auto& Name : context()->GetNames(Id))
+            return Name.second->GetInOperand(1).AsString();
+        return {};
+    }
+
+    // cbuffers and structured buffers are usually named through their block type
+    std::string GetVariableName(const spvtools::opt::Instruction* pVariable)
+    {
+        std::string Name = GetName(pVariable->result_id());
+        if (Name.empty())
+            Name = GetName(GetPointeeTypeId(pVariable));
+        return !Name.empty() ? Name : ConcatenateArgs("_", pVariable->result_id());
+    }
+
+    void RemoveFromEntryPointInterfaces(uint32_t VariableId)
+    {
+        for (auto& EntryPoint : get_module()->entry_points())
+        {
+            // In operands: execution model, function, name, interface ids...
+            for (uint32_t OperandIdx = EntryPoint.NumInOperands(); OperandIdx > 3; --OperandIdx)
+            {
+                if (EntryPoint.GetSingleWordInOperand(OperandIdx - 1) == VariableId)
+                    EntryPoint.RemoveInOperand(OperandIdx - 1);
+            }
+        }
+    }
+
+    // Returns an existing type instruction with the given operands or creates a new one
+    uint32_t GetOrAddType(spv::Op Opcode, const spvtools::opt::Instruction::OperandList& Operands)
+    {
+        for (auto& Instruction : get_module()->types_values())
+        {
+            if (Instruction.opcode() != Opcode || Instruction.NumInOperands() != Operands.size())
+                continue;
+
+            bool IsSame = true;
+            for (uint32_t OperandIdx = 0; OperandIdx < Operands.size() && IsSame; ++OperandIdx)
+                IsSame = Instruction.GetSingleWordInOperand(OperandIdx) == Operands[OperandIdx].words[0];
+            if (IsSame)
+                return Instruction.result_id();
+        }
+
+        const uint32_t ResultId = context()->TakeNextId();
+
+        auto pType = std::make_unique<spvtools::opt::Instruction>(context(), Opcode, 0, ResultId, Operands);
+        get_def_use_mgr()->AnalyzeInstDefUse(pType.get());
+        get_module()->AddType(std::move(pType));
+        return ResultId;
+    }
+
+    void ShrinkArray(spvtools::opt::Instruction*                     pVariable,
+                     const spvtools::opt::Instruction*               pArrayType,
+                     uint32_t                                        NewLength,
+                     const std::vector<spvtools::opt::Instruction*>& AccessChains)
+    {
+        const uint32_t ElementTypeId = pArrayType->GetSingleWordInOperand(0);
+        const uint32_t StorageClass  = get_def_use_mgr()->GetDef(pVariable->type_id())->GetSingleWordInOperand(0);
+
+        uint32_t NewPointeeTypeId = ElementTypeId;
+        if (NewLength > 1)
+        {
+            const uint32_t LengthId = context()->get_constant_mgr()->GetUIntConstId(NewLength);
+            NewPointeeTypeId        = GetOrAddType(spv::Op::OpTypeArray, {{SPV_OPERAND_TYPE_ID, {ElementTypeId}}, {SPV_OPERAND_TYPE_ID, {LengthId}}});
+        }
+        const uint32_t NewPointerTypeId = GetOrAddType(spv::Op::OpTypePointer, {{SPV_OPERAND_TYPE_STORAGE_CLASS, {StorageClass}}, {SPV_OPERAND_TYPE_ID, {NewPointeeTypeId}}});
+
+        // The pointer type follows the types and constants it uses. If it was added after the
+        // variable, move the variable to the end of the global section, behind it.
+        const spvtools::opt::Instruction* pPointerType = get_def_use_mgr()->GetDef(NewPointerTypeId);
+        for (auto* pNext = pVariable->NextNode(); pNext != nullptr; pNext = pNext->NextNode())
+        {
+            if (pNext == pPointerType)
+            {
+                pVariable->InsertAfter(&*(--get_module()->types_values_end()));
+                break;
+            }
+        }
+        pVariable->SetResultType(NewPointerTypeId);
+        get_def_use_mgr()->AnalyzeInstUse(pVariable);
+
+        if (NewLength > 1)
+            return;
+
+        for (auto* pAccessChain : AccessChains)
+        {
+            if (pAccessChain->NumInOperands() == 2)
+            {
+                context()->ReplaceAllUsesWith(pAccessChain->result_id(), pVariable->result_id());
+                context()->KillInst(pAccessChain);
+            }
+            else
+            {
+                pAccessChain->RemoveInOperand(1);
+                get_def_use_mgr()->AnalyzeInstUse(pAccessChain);
+            }
+        }
+    }
+
+    void CollectBindings()
+    {
+        for (auto& Instruction : get_module()->types_values())
+        {
+            if (Instruction.opcode() != spv::Op::OpVariable || !IsResourceStorageClass(Instruction.GetSingleWordInOperand(0)))
+                continue;
+
+            ResourceBindingInfo Binding;
+            Binding.Name = GetVariableName(&Instruction);
+            for (auto* pDecoration : get_decoration_mgr()->GetDecorationsFor(Instruction.result_id(), false))
+            {
+                if (pDecoration->opcode() != spv::Op::OpDecorate || pDecoration->NumInOperands() < 3)
+                    continue;
+
+                const auto Decoration = static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(1));
+                if (Decoration == spv::Decoration::DescriptorSet)
+                    Binding.Set = pDecoration->GetSingleWordInOperand(2);
+                else if (Decoration == spv::Decoration::Binding)
+                    Binding.Binding = pDecoration->GetSingleWordInOperand(2);
+            }
+
+            const auto* pPointeeType = get_def_use_mgr()->GetDef(GetPointeeTypeId(&Instruction));
+            if (pPointeeType->opcode() == spv::Op::OpTypeArray)
+                Binding.ArraySize = get_def_use_mgr()->GetDef(pPointeeType->GetSingleWordInOperand(1))->GetSingleWordInOperand(0);
+
+            m_pReport->Bindings.emplace_back(std::move(Binding));
+        }
+
+        std::sort(m_pReport->Bindings.begin(), m_pReport->Bindings.end(), [](const ResourceBindingInfo& LHS, const ResourceBindingInfo& RHS) {
+            return std::make_pair(LHS.Set, LHS.Binding) < std::make_pair(RHS.Set, RHS.Binding);
+        });
+    }
+
+private:
+    BindingEliminationReport* const m_pReport;
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv, BindingEliminationReport& Report)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+    SpirvOptimizer.RegisterPass(spvtools::Optimizer::PassToken{std::make_unique<DeadResourceBindingEliminationPass>(&Report)});
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const char* EntryPoint, BindingEliminationReport& Report)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint(EntryPoint);
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    Shader.parse(&Resources, 100, false, EShMsgDefault);
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0, Report);
+
+    if (!OptimizedSPIRV.empty())
+        return OptimizedSPIRV;
+
+    LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        for (const char* EntryPoint : {"main", "ClearCS"})
+        {
+            BindingEliminationReport Report;
+
+            auto SPIRV = ConvertHLSLtoSPIRV(HLSL::TestCS, EntryPoint, Report);
+            auto WGSL  = ConvertSPIRVtoWGSL(SPIRV);
+
+            std::cout << "==== Entry point '" << EntryPoint << "' ====\n";
+            for (const auto& Name : Report.RemovedVariables)
+                std::cout << "Removed unreferenced resource: " << Name << "\n";
+            for (const auto& Info : Report.ShrunkArrays)
+                std::cout << "Shrunk resource array: " << Info << "\n";
+
+            std::cout << "Final binding set (" << Report.Bindings.size() << " bindings):\n";
+            for (const auto& Binding : Report.Bindings)
+            {
+                std::cout << "    set " << Binding.Set << ", binding " << Binding.Binding << ": " << Binding.Name;
+                if (Binding.ArraySize != 0)
+                    std::cout << "[" << Binding.ArraySize << "]";
+                std::cout << "\n";
+            }
+            std::cout << WGSL << "\n";
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
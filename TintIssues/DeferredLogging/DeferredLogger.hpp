@@ -0,0 +1,518 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <type_traits>
+#include <stdexcept>
+
+// Messages below this severity are compiled out entirely
+#ifndef LOG_COMPILE_TIME_MIN_SEVERITY
+#    define LOG_COMPILE_TIME_MIN_SEVERITY 0
+#endif
+
+enum class LogSeverity : uint8_t
+{
+    Info    = 0,
+    Warning = 1,
+    Error   = 2,
+};
+
+constexpr bool IsLogSeverityCompiledIn(LogSeverity Severity)
+{
+    return Severity >= static_cast<LogSeverity>(LOG_COMPILE_TIME_MIN_SEVERITY);
+}
+
+// Low-overhead logger.
+//
+// Logging threads never format anything: the arguments are copied in binary form into
+// a per-thread single-producer/single-consumer ring buffer together with a pointer to a
+// decoder that knows their types. A single writer thread drains all ring buffers, formats
+// the records and writes them to std::cerr with one flush per batch.
+// Registering a new thread takes a lock once; after that the hot path is lock-free.
+class DeferredLogger
+{
+public:
+    static constexpr size_t RingBufferSize = 256u << 10;
+
+    static DeferredLogger& Get()
+    {
+        static DeferredLogger Logger;
+        return Logger;
+    }
+
+    void SetMinSeverity(LogSeverity Severity)
+    {
+        m_MinSeverity.store(static_cast<uint8_t>(Severity), std::memory_order_relaxed);
+    }
+
+    bool IsEnabled(LogSeverity Severity) const
+    {
+        return static_cast<uint8_t>(Severity) >= m_MinSeverity.load(std::memory_order_relaxed);
+    }
+
+    template <typename... Args>
+    void Write(LogSeverity Severity, const char* File, int Line, const char* Function, const Args&... args)
+    {
+        // Arguments without a binary encoding are formatted here, once
+        WriteEncoded(Severity, File, Line, Function, EncodedType<Args>::Prepare(args)...);
+    }
+
+    // Blocks until every record committed before the call has been written out
+    void Flush()
+    {
+        std::unique_lock<std::mutex> Lock{m_WriterMutex};
+        const uint64_t               Target = ++m_FlushRequests;
+        m_WakeUp.notify_one();
+        m_FlushDone.wait(Lock, [&]() { return m_FlushedRequests >= Target || !m_IsRunning; });
+    }
+
+    ~DeferredLogger()
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_WriterMutex};
+            m_IsRunning = false;
+        }
+        m_WakeUp.notify_one();
+        m_WriterThread.join();
+    }
+
+private:
+    struct RecordHeader
+    {
+        uint32_t    Size;
+        LogSeverity Severity;
+        int         Line;
+        const char* File;
+        const char* Function;
+        int64_t     Timestamp;
+        void (*Decode)(const uint8_t* pPayload, std::ostream& Stream);
+    };
+
+    template <typename... Args>
+    void WriteEncoded(LogSeverity Severity, const char* File, int Line, const char* Function, const Args&... args)
+    {
+        const size_t PayloadSize = (EncodedType<Args>::Size(args) + ... + 0);
+        const size_t RecordSize  = AlignRecordSize(sizeof(RecordHeader) + PayloadSize);
+
+        ThreadBuffer& Buffer = GetThreadBuffer();
+        uint8_t*      pData  = Buffer.Reserve(RecordSize);
+        if (pData == nullptr && Severity >= LogSeverity::Error)
+        {
+            // Errors are never dropped: wait until the writer thread has drained the buffer
+            Flush();
+            pData = Buffer.Reserve(RecordSize);
+        }
+        if (pData == nullptr)
+        {
+            if (Severity >= LogSeverity::Error)
+            {
+                // Larger than the ring buffer, or the writer thread is gone
+                std::vector<uint8_t> Record(RecordSize);
+                EncodeRecord(Record.data(), RecordSize, Severity, File, Line, Function, args...);
+
+                std::ostringstream Stream;
+                FormatRecord(Record.data(), Stream);
+                const std::string Output = Stream.str();
+                std::cerr.write(Output.data(), Output.size());
+                std::cerr.flush();
+                return;
+            }
+
+            // The writer thread is too far behind: drop the message rather than stall the caller
+            Buffer.DroppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        EncodeRecord(pData, RecordSize, Severity, File, Line, Function, args...);
+
+        Buffer.Commit(RecordSize);
+        if ((Severity >= LogSeverity::Error || Buffer.GetUsedSize() > RingBufferSize / 2) && !m_WakeUpRequested.exchange(true, std::memory_order_relaxed))
+            m_WakeUp.notify_one();
+    }
+
+    template <typename... Args>
+    static void EncodeRecord(uint8_t* pData, size_t RecordSize, LogSeverity Severity, const char* File, int Line, const char* Function, const Args&... args)
+    {
+        using DecoderType = RecordDecoder<typename EncodedType<Args>::Type...>;
+
+        RecordHeader Header{};
+        Header.Size      = static_cast<uint32_t>(RecordSize);
+        Header.Severity  = Severity;
+        Header.File      = File;
+        Header.Line      = Line;
+        Header.Function  = Function;
+        Header.Timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        Header.Decode    = &DecoderType::Decode;
+        std::memcpy(pData, &Header, sizeof(Header));
+
+        uint8_t* pPayload = pData + sizeof(RecordHeader);
+        ((pPayload = EncodedType<Args>::Encode(pPayload, args)), ...);
+    }
+
+    // Record size that marks the unused tail of the ring buffer before a wrap-around
+    static constexpr uint32_t PaddingRecord = ~0u;
+
+    static constexpr size_t AlignRecordSize(size_t Size)
+    {
+        return (Size + alignof(RecordHeader) - 1) & ~(alignof(RecordHeader) - 1);
+    }
+
+    // Binary encoding of a single argument. Strings are copied, arithmetic types are
+    // stored as is, and everything else is formatted eagerly by Prepare() as a fallback.
+    template <typename T, typename = void>
+    struct EncodedType
+    {
+        static std::string Prepare(const T& Value)
+        {
+            std::ostringstream Stream;
+            Stream << Value;
+            return Stream.str();
+        }
+    };
+
+    template <typename T>
+    struct EncodedType<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+    {
+        using Type = T;
+
+        static const T&         Prepare(const T& Value) { return Value; }
+        static constexpr size_t Size(const T&) { return sizeof(T); }
+        static uint8_t*         Encode(uint8_t* pDst, const T& Value)
+        {
+            std::memcpy(pDst, &Value, sizeof(T));
+            return pDst + sizeof(T);
+        }
+    };
+
+    template <typename T>
+    struct EncodedType<T, std::enable_if_t<std::is_convertible_v<const T&, std::string_view>>>
+    {
+        using Type = std::string;
+
+        static const T& Prepare(const T& Value) { return Value; }
+        static size_t   Size(const T& Value) { return sizeof(uint32_t) + GetView(Value).size(); }
+        static uint8_t* Encode(uint8_t* pDst, const T& Value) { return EncodeString(pDst, GetView(Value)); }
+
+        static std::string_view GetView(const T& Value)
+        {
+            if constexpr (std::is_pointer_v<T>)
+            {
+                if (Value == nullptr)
+                    return "(null)";
+            }
+            return std::string_view{Value};
+        }
+    };
+
+    static uint8_t* EncodeString(uint8_t* pDst, std::string_view Value)
+    {
+        const uint32_t Length = static_cast<uint32_t>(Value.size());
+        std::memcpy(pDst, &Length, sizeof(Length));
+        std::memcpy(pDst + sizeof(Length), Value.data(), Length);
+        return pDst + sizeof(Length) + Length;
+    }
+
+    template <typename... Types>
+    struct RecordDecoder
+    {
+        static void Decode(const uint8_t* pPayload, std::ostream& Stream)
+        {
+            ((pPayload = DecodeArg<Types>(pPayload, Stream)), ...);
+        }
+
+        template <typename T>
+        static const uint8_t* DecodeArg(const uint8_t* pSrc, std::ostream& Stream)
+        {
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                uint32_t Length = 0;
+                std::memcpy(&Length, pSrc, sizeof(Length));
+                Stream.write(reinterpret_cast<const char*>(pSrc + sizeof(Length)), Length);
+                return pSrc + sizeof(Length) + Length;
+            }
+            else
+            {
+                T Value{};
+                std::memcpy(&Value, pSrc, sizeof(T));
+                if constexpr (sizeof(T) == 1 && std::is_integral_v<T> && !std::is_same_v<T, char>)
+                    Stream << static_cast<int>(Value);
+                else
+                    Stream << Value;
+                return pSrc + sizeof(T);
+            }
+        }
+    };
+
+    struct ThreadBuffer
+    {
+        // Called by the owning thread only
+        uint8_t* Reserve(size_t Size)
+        {
+            const uint64_t Head = m_Head.load(std::memory_order_relaxed);
+            const uint64_t Tail = m_Tail.load(std::memory_order_acquire);
+
+            const size_t Offset    = static_cast<size_t>(Head % RingBufferSize);
+            const size_t Remaining = RingBufferSize - Offset;
+            size_t       Required  = Size;
+            if (Remaining < Size)
+                Required += Remaining; // Records never wrap; skip the tail of the buffer
+            if (Head + Required - Tail > RingBufferSize)
+                return nullptr;
+
+            if (Remaining < Size)
+            {
+                // Offsets are multiples of the record alignment, so the marker always fits
+                std::memcpy(&m_Data[Offset], &PaddingRecord, sizeof(uint32_t));
+                m_Head.store(Head + Remaining, std::memory_order_release);
+                return m_Data.data();
+            }
+            return &m_Data[Offset];
+        }
+
+        void Commit(size_t Size)
+        {
+            m_Head.store(m_Head.load(std::memory_order_relaxed) + Size, std::memory_order_release);
+        }
+
+        // Called by the writer thread only. Records passed to the handler stay valid
+        // until Release() is called with the returned position.
+        template <typename HandlerType>
+        uint64_t Peek(HandlerType&& Handler)
+        {
+            const uint64_t Head = m_Head.load(std::memory_order_acquire);
+            uint64_t       Tail = m_Tail.load(std::memory_order_relaxed);
+            while (Tail < Head)
+            {
+                const size_t Offset    = static_cast<size_t>(Tail % RingBufferSize);
+                const size_t Remaining = RingBufferSize - Offset;
+
+                uint32_t Size = 0;
+                std::memcpy(&Size, &m_Data[Offset], sizeof(uint32_t));
+                if (Size == PaddingRecord)
+                {
+                    Tail += Remaining;
+                    continue;
+                }
+
+                Handler(&m_Data[Offset]);
+                Tail += Size;
+            }
+            return Tail;
+        }
+
+        void Release(uint64_t Tail)
+        {
+            m_Tail.store(Tail, std::memory_order_release);
+        }
+
+        size_t GetUsedSize() const
+        {
+            return static_cast<size_t>(m_Head.load(std::memory_order_relaxed) - m_Tail.load(std::memory_order_relaxed));
+        }
+
+        bool IsEmpty() const
+        {
+            return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_relaxed);
+        }
+
+        std::atomic<uint64_t> DroppedCount{0};
+        std::atomic<bool>     IsOrphaned{false};
+
+    private:
+        alignas(64) std::atomic<uint64_t> m_Head{0};
+        alignas(64) std::atomic<uint64_t> m_Tail{0};
+        std::vector<uint8_t> m_Data = std::vector<uint8_t>(RingBufferSize);
+    };
+
+    // Marks the buffer of an exiting thread so that the writer releases it once drained
+    struct ThreadBufferOwner
+    {
+        std::shared_ptr<ThreadBuffer> pBuffer;
+        ~ThreadBufferOwner()
+        {
+            if (pBuffer)
+                pBuffer->IsOrphaned.store(true, std::memory_order_release);
+        }
+    };
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local ThreadBufferOwner Owner;
+        if (!Owner.pBuffer)
+        {
+            Owner.pBuffer = std::make_shared<ThreadBuffer>();
+
+            std::lock_guard<std::mutex> Lock{m_BuffersMutex};
+            m_Buffers.push_back(Owner.pBuffer);
+        }
+        return *Owner.pBuffer;
+    }
+
+    DeferredLogger() :
+        m_WriterThread{[this]() { WriterThreadProc(); }}
+    {}
+
+    void WriterThreadProc()
+    {
+        struct PendingRecord
+        {
+            int64_t        Timestamp;
+            const uint8_t* pRecord;
+        };
+        std::vector<std::shared_ptr<ThreadBuffer>> Buffers;
+        std::vector<uint64_t>                      ReleasePositions;
+        std::vector<PendingRecord>                 Records;
+        std::ostringstream                         Stream;
+        std::string                                Output;
+
+        for (;;)
+        {
+            bool     IsRunning     = true;
+            uint64_t FlushRequests = 0;
+            {
+                std::unique_lock<std::mutex> Lock{m_WriterMutex};
+                m_WakeUp.wait_for(Lock, std::chrono::milliseconds{10}, [&]() {
+                    return !m_IsRunning || m_FlushRequests > m_FlushedRequests || m_WakeUpRequested.load(std::memory_order_relaxed);
+                });
+                m_WakeUpRequested.store(false, std::memory_order_relaxed);
+                IsRunning     = m_IsRunning;
+                FlushRequests = m_FlushRequests;
+            }
+
+            {
+                std::lock_guard<std::mutex> Lock{m_BuffersMutex};
+                Buffers = m_Buffers;
+            }
+
+            // Records of one batch are merged by timestamp, so the output of different threads
+            // interleaves in (approximately) the order in which it was logged.
+            uint64_t DroppedCount = 0;
+            for (auto& pBuffer : Buffers)
+            {
+                ReleasePositions.push_back(pBuffer->Peek([&](const uint8_t* pRecord) {
+                    RecordHeader Header;
+                    std::memcpy(&Header, pRecord, sizeof(Header));
+                    Records.push_back({Header.Timestamp, pRecord});
+                }));
+                DroppedCount += pBuffer->DroppedCount.exchange(0, std::memory_order_relaxed);
+            }
+            std::stable_sort(Records.begin(), Records.end(), [](const PendingRecord& LHS, const PendingRecord& RHS) { return LHS.Timestamp < RHS.Timestamp; });
+
+            for (const auto& Record : Records)
+                FormatRecord(Record.pRecord, Stream);
+            for (size_t i = 0; i < Buffers.size(); ++i)
+                Buffers[i]->Release(ReleasePositions[i]);
+            Records.clear();
+            ReleasePositions.clear();
+
+            // The thread of an orphaned buffer is gone, so its dropped count is final: fold it
+            // into this batch before the buffer is destroyed
+            {
+                std::lock_guard<std::mutex> Lock{m_BuffersMutex};
+                m_Buffers.erase(std::remove_if(m_Buffers.begin(), m_Buffers.end(),
+                                               [&](const auto& pBuffer) {
+                                                   if (!pBuffer->IsOrphaned.load(std::memory_order_acquire) || !pBuffer->IsEmpty())
+                                                       return false;
+                                                   DroppedCount += pBuffer->DroppedCount.exchange(0, std::memory_order_relaxed);
+                                                   return true;
+                                               }),
+                                m_Buffers.end());
+            }
+            Buffers.clear();
+
+            if (DroppedCount > 0)
+                Stream << "Warning: " << DroppedCount << " log messages were dropped\n";
+
+            Output = Stream.str();
+            if (!Output.empty())
+            {
+                std::cerr.write(Output.data(), Output.size());
+                std::cerr.flush();
+                Stream.str({});
+            }
+
+            {
+                std::lock_guard<std::mutex> Lock{m_WriterMutex};
+                m_FlushedRequests = FlushRequests;
+            }
+            m_FlushDone.notify_all();
+
+            if (!IsRunning)
+                break;
+        }
+    }
+
+    static void FormatRecord(const uint8_t* pRecord, std::ostream& Stream)
+    {
+        static constexpr const char* SeverityPrefix[] = {"Info: ", "Warning: ", "Error: "};
+
+        RecordHeader Header;
+        std::memcpy(&Header, pRecord, sizeof(Header));
+
+        Stream << SeverityPrefix[static_cast<size_t>(Header.Severity)];
+        Header.Decode(pRecord + sizeof(RecordHeader), Stream);
+        if (Header.Severity >= LogSeverity::Error)
+            Stream << " (in " << Header.File << ":" << Header.Line << ", function " << Header.Function << ")";
+        Stream << '\n';
+    }
+
+private:
+    std::atomic<uint8_t> m_MinSeverity{static_cast<uint8_t>(LogSeverity::Info)};
+
+    std::mutex                                 m_BuffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_Buffers;
+
+    std::mutex              m_WriterMutex;
+    std::condition_variable m_WakeUp;
+    std::condition_variable m_FlushDone;
+    std::atomic<bool>       m_WakeUpRequested{false};
+    bool                    m_IsRunning       = true;
+    uint64_t                m_FlushRequests   = 0;
+    uint64_t                m_FlushedRequests = 0;
+
+    std::thread m_WriterThread;
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_MESSAGE(Severity, ...)                                                                  \
+    do                                                                                              \
+    {                                                                                               \
+        if constexpr (IsLogSeverityCompiledIn(Severity))                                            \
+        {                                                                                           \
+            if (DeferredLogger::Get().IsEnabled(Severity))                                          \
+                DeferredLogger::Get().Write(Severity, __FILE__, __LINE__, __func__, __VA_ARGS__);   \
+        }                                                                                           \
+    } while (false)
+
+// The exception needs the formatted message anyway, so errors are formatted eagerly
+// and the log is flushed before throwing.
+#define LOG_ERROR_AND_THROW(...)                                                                    \
+    do                                                                                              \
+    {                                                                                               \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);                                         \
+        DeferredLogger::Get().Write(LogSeverity::Error, __FILE__, __LINE__, __func__, Message);     \
+        DeferredLogger::Get().Flush();                                                              \
+        throw std::runtime_error(Message);                                                          \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...) LOG_MESSAGE(LogSeverity::Warning, __VA_ARGS__)
+#define LOG_INFO_MESSAGE(...)    LOG_MESSAGE(LogSeverity::Info, __VA_ARGS__)
@@ -0,0 +1,239 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include <iostream>
+#include <exception>
+#include <unordered_map>
+#include <tuple>
+
+#include "DeferredLogger.hpp"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+namespace HLSL
+{
+
+const std::string TestCS = R"(
+
+cbuffer Constants
+{
+    float4 g_Color;
+};
+
+StructuredBuffer<float4> g_StructuredBuffer;
+
+RWTexture2D<float4> Tex2D_0;
+RWTexture2D<float4> Tex2D_1;
+Texture2D<float4>   Tex2D;
+
+[numthreads(8, 8, 1)]
+void main(uint3 Gid : SV_GroupID,
+          uint3 GTid : SV_GroupThreadID)
+{
+    float4 Color = Tex2D.Load(int3(GTid.xy, 0));
+    Tex2D_0[GTid.xy] = g_Color;
+    Tex2D_1[GTid.xy] = Color + g_StructuredBuffer[0];
+}
+)";
+;
+} // namespace HLSL
+
+
+using BindingRemapingInfo = std::unordered_map<std::string, std::tuple<uint32_t, uint32_t>>;
+
+// Number of simulated batch jobs and worker threads that log concurrently
+constexpr uint32_t BatchJobCount    = 20000;
+constexpr uint32_t BatchWorkerCount = 8;
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setHlslIoMapping(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    Shader.parse(&Resources, 100, false, EShMsgDefault);
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+
+    if (!OptimizedSPIRV.empty())
+        return OptimizedSPIRV;
+
+    LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+std::vector<tint::inspector::ResourceBinding> GetResourceBindings(const std::string& WGSL)
+{
+    TintInitializer InitScope{};
+
+    tint::Source::File srcFile("", WGSL);
+    tint::Program      Program = tint::wgsl::reader::Parse(&srcFile, {tint::wgsl::AllowedFeatures::Everything()});
+
+    if (!Program.IsValid())
+        LOG_ERROR_AND_THROW("Tint WGSL reader failure:\nParser: ", Program.Diagnostics().Str(), "\n");
+
+    std::vector<tint::inspector::ResourceBinding> Bindings;
+
+    tint::inspector::Inspector Inspector{Program};
+    for (auto& EntryPoint : Inspector.GetEntryPoints())
+    {
+        for (auto& Binding : Inspector.GetResourceBindings(EntryPoint.name))
+            Bindings.push_back(Binding);
+    }
+    return Bindings;
+}
+
+// Mirrors the lookup done by RamapBindingGroupLayoitsWGSL: every binding that is
+// missing from the remap table produces one warning.
+uint32_t RemapBindings(const std::vector<tint::inspector::ResourceBinding>& Bindings, const BindingRemapingInfo& RemapIndices)
+{
+    uint32_t RemappedCount = 0;
+    for (const auto& Binding : Bindings)
+    {
+        auto BindIndices = RemapIndices.find(Binding.variable_name);
+        if (BindIndices != RemapIndices.end())
+        {
+            ++RemappedCount;
+        }
+        else
+        {
+            LOG_WARNING_MESSAGE("Binding for variable '", Binding.variable_name, "' (group ", Binding.bind_group, ", binding ", Binding.binding, ") not found in the remap indices");
+        }
+    }
+    return RemappedCount;
+}
+
+double RunBatch(const std::vector<tint::inspector::ResourceBinding>& Bindings, const BindingRemapingInfo& RemapIndices)
+{
+    std::atomic<uint32_t> NextJob{0};
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> Workers;
+    for (uint32_t WorkerIdx = 0; WorkerIdx < BatchWorkerCount; ++WorkerIdx)
+    {
+        Workers.emplace_back([&]() {
+            while (NextJob.fetch_add(1) < BatchJobCount)
+                RemapBindings(Bindings, RemapIndices);
+        });
+    }
+    for (auto& Worker : Workers)
+        Worker.join();
+
+    const auto EndTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(EndTime - StartTime).count();
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        // Only 'Tex2D_0' and 'Tex2D' are mapped, every other binding emits a warning
+        BindingRemapingInfo RemapIndices;
+        RemapIndices["Tex2D_0"] = {1, 0};
+        RemapIndices["Tex2D"]   = {2, 0};
+
+        auto SPIRV    = ConvertHLSLtoSPIRV(HLSL::TestCS);
+        auto Bindings = GetResourceBindings(ConvertSPIRVtoWGSL(SPIRV));
+
+        DeferredLogger::Get().SetMinSeverity(LogSeverity::Error);
+        const double SuppressedTime = RunBatch(Bindings, RemapIndices);
+
+        DeferredLogger::Get().SetMinSeverity(LogSeverity::Info);
+        const double EnabledTime = RunBatch(Bindings, RemapIndices);
+        DeferredLogger::Get().Flush();
+
+        LOG_INFO_MESSAGE("Remapped ", BatchJobCount, " jobs on ", BatchWorkerCount, " workers: ",
+                         SuppressedTime, " ms with warnings suppressed, ", EnabledTime, " ms with warnings enabled");
+        DeferredLogger::Get().Flush();
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
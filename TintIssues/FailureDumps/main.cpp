@@ -0,0 +1,639 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <chrono>
+#include <fstream>
+#include <functional>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+
+namespace HLSL
+{
+
+const std::string GenerateMipsCS = R"(
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+// The reason for separating channels is to reduce bank conflicts in the
+// local data memory controller.  A large stride will cause more threads
+// to collide on the same memory bank.
+groupshared float gs_R[64];
+groupshared float gs_G[64];
+groupshared float gs_B[64];
+groupshared float gs_A[64];
+
+void StoreColor(uint Index, float4 Color)
+{
+    gs_R[Index] = Color.r;
+    gs_G[Index] = Color.g;
+    gs_B[Index] = Color.b;
+    gs_A[Index] = Color.a;
+}
+
+float4 LoadColor(uint Index)
+{
+    return float4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);
+}
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+[numthreads(8, 8, 1)] 
+void main(uint GI : SV_GroupIndex, uint3 DTid: SV_DispatchThreadID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    bool IsValidThread = all(DTid.xy < DstMipSize);
+    uint ArraySlice    = FirstArraySlice + DTid.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+        // One bilinear sample is insufficient when scaling down by more than 2x.
+        // You will slightly undersample in the case where the source dimension
+        // is odd.  This is why it's a really good idea to only generate mips on
+        // power-of-two sized textures.  Trying to handle the undersampling case
+        // will force this shader to be slower and more complicated as it will
+        // have to take more source texture samples.
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (DTid.xy + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        // > 2:1 in X dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // horizontally.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        // > 2:1 in Y dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // vertically.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        // > 2:1 in in both dimensions
+        // Use 4 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // in both directions.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(DTid.xy, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    if (IsValidThread)
+    {
+        // Without lane swizzle operations, the only way to share data with other
+        // threads is through LDS.
+        StoreColor(GI, Src1);
+    }
+
+    // This guarantees all LDS writes are complete and that all threads have
+    // executed all instructions so far (and therefore have issued their LDS
+    // write instructions.)
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // With low three bits for X and high three bits for Y, this bit mask
+        // (binary: 001001) checks that X and Y are even.
+        if ((GI & 0x9) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x01);
+            float4 Src3 = LoadColor(GI + 0x08);
+            float4 Src4 = LoadColor(GI + 0x09);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip2[uint3(DTid.xy / 2, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 2)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask (binary: 011011) checks that X and Y are multiples of four.
+        if ((GI & 0x1B) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x02);
+            float4 Src3 = LoadColor(GI + 0x10);
+            float4 Src4 = LoadColor(GI + 0x12);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip3[uint3(DTid.xy / 4, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 3)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask would be 111111 (X & Y multiples of 8), but only one
+        // thread fits that criteria.
+        if (GI == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x04);
+            float4 Src3 = LoadColor(GI + 0x20);
+            float4 Src4 = LoadColor(GI + 0x24);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip4[uint3(DTid.xy / 8, ArraySlice)] = PackColor(Src1);
+        }
+    }
+}
+
+)";
+
+// From ConstantBufferNameCollision
+const std::string TestVS = R"(
+struct Inner
+{
+    float2x4 Transform;     // 2x4 matrix -> requires a padded layout struct in a uniform buffer
+    float4   Offset;
+};
+
+cbuffer Params      // source name: "Params"
+{
+    Inner    g_Data;
+    float4x4 g_WorldViewProj;
+}
+
+cbuffer Params_1    // source name: literally "Params_1"
+{
+    float4 g_Color;
+}
+
+void main(out float4 Pos : SV_POSITION)
+{
+    Pos = mul(g_WorldViewProj, g_Data.Offset) + g_Color;
+}
+)";
+// g_Exposure is not declared: glslang fails, and the error refers to the expanded macro
+const std::string BrokenPS = R"(
+#define TONE_MAP(Color) ((Color) / (1.0 + (Color)))
+
+float4 main(in float4 Pos : SV_POSITION) : SV_Target
+{
+    return float4(TONE_MAP(g_Exposure * Pos.xyz), 1.0);
+}
+)";
+} // namespace HLSL
+
+struct ShaderSource
+{
+    std::string        Name;
+    const std::string* pHLSL = nullptr; // Not owned: sources outlive the jobs
+    std::string        Preamble;
+    EShLanguage        Stage = EShLangCompute;
+};
+
+// Everything needed to debug one conversion, kept in the form that costs the least to
+// keep: the inputs by reference, SPIR-V as binary and the output as text. Preprocessing
+// and disassembly only run in Dump(), which is only called for failed and sampled jobs.
+class ConversionArtifacts
+{
+public:
+    enum class Stage
+    {
+        Glslang,   // glslang output
+        Optimized, // spirv-opt output, the input of Tint
+        Count
+    };
+
+    explicit ConversionArtifacts(const ShaderSource& Source) :
+        m_Source{Source}
+    {}
+
+    const std::vector<uint32_t>& SetSPIRV(Stage SPIRVStage, std::vector<uint32_t> SPIRV)
+    {
+        return m_SPIRV[static_cast<size_t>(SPIRVStage)] = std::move(SPIRV);
+    }
+
+    void SetInfoLog(std::string InfoLog)
+    {
+        m_InfoLog = std::move(InfoLog);
+    }
+
+    void SetWGSL(std::string WGSL)
+    {
+        m_WGSL = std::move(WGSL);
+    }
+
+    void SetError(std::string Error)
+    {
+        m_Error = std::move(Error);
+    }
+
+    // Writes every artifact to its own file in Directory, one at a time. A failure to dump
+    // is only reported: it must never fail the job itself.
+    void Dump(const std::filesystem::path& Directory, spv_target_env TargetEnv) const
+    {
+        std::error_code ErrorCode;
+        std::filesystem::create_directories(Directory, ErrorCode);
+        if (ErrorCode)
+        {
+            LOG_WARNING_MESSAGE("Failed to create ", Directory, ": ", ErrorCode.message());
+            return;
+        }
+
+        WriteFile(Directory / "source.hlsl", m_Source.Preamble + *m_Source.pHLSL);
+        WriteFile(Directory / "preprocessed.hlsl", Preprocess());
+        if (!m_InfoLog.empty())
+            WriteFile(Directory / "glslang.log", m_InfoLog);
+
+        static constexpr const char* StageNames[] = {"1-glslang", "2-optimized"};
+        for (size_t StageIdx = 0; StageIdx < static_cast<size_t>(Stage::Count); ++StageIdx)
+        {
+            const auto& SPIRV = m_SPIRV[StageIdx];
+            if (SPIRV.empty())
+                continue;
+
+            const auto BasePath = Directory / StageNames[StageIdx];
+            {
+                std::ofstream File{BasePath.string() + ".spv", std::ios::binary};
+                File.write(reinterpret_cast<const char*>(SPIRV.data()), static_cast<std::streamsize>(SPIRV.size() * sizeof(uint32_t)));
+            }
+
+            // The disassembly of one module is released before the next one is produced
+            spvtools::SpirvTools Tools{TargetEnv};
+            std::string          Disassembly;
+            const uint32_t       Options = SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES | SPV_BINARY_TO_TEXT_OPTION_INDENT | SPV_BINARY_TO_TEXT_OPTION_COMMENT;
+            if (!Tools.Disassemble(SPIRV, &Disassembly, Options))
+                Disassembly = "; Failed to disassemble the module\n";
+            WriteFile(BasePath.string() + ".spvasm", Disassembly);
+        }
+
+        if (!m_WGSL.empty())
+            WriteFile(Directory / "output.wgsl", m_WGSL);
+        if (!m_Error.empty())
+            WriteFile(Directory / "error.txt", m_Error);
+    }
+
+private:
+    static void WriteFile(const std::filesystem::path& Path, const std::string& Content)
+    {
+        std::ofstream File{Path, std::ios::binary};
+        if (!(File << Content))
+            LOG_WARNING_MESSAGE("Failed to write ", Path);
+    }
+
+    // What glslang saw after macro expansion, which is what the line numbers of its
+    // errors refer to
+    std::string Preprocess() const
+    {
+        GlslangInitilizer InitScope{};
+        glslang::TShader  Shader{m_Source.Stage};
+
+        auto* pHLSL = m_Source.pHLSL->c_str();
+        Shader.setStrings(&pHLSL, 1);
+        Shader.setPreamble(m_Source.Preamble.c_str());
+        Shader.setEntryPoint("main");
+        Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+
+        TBuiltInResource                   Resources{};
+        glslang::TShader::ForbidIncluder   Includer;
+        std::string                        Preprocessed;
+        if (!Shader.preprocess(&Resources, 100, ENoProfile, false, false, EShMsgDefault, &Preprocessed, Includer))
+            return ConcatenateArgs("// Failed to preprocess:\n// ", Shader.getInfoLog());
+        return Preprocessed;
+    }
+
+private:
+    const ShaderSource&   m_Source;
+    std::vector<uint32_t> m_SPIRV[static_cast<size_t>(Stage::Count)];
+    std::string           m_InfoLog;
+    std::string           m_WGSL;
+    std::string           m_Error;
+};
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const ShaderSource& Source, ConversionArtifacts& Artifacts)
+{
+    GlslangInitilizer GlslangScope{};
+    glslang::TShader  Shader{Source.Stage};
+
+    auto* pHLSL = Source.pHLSL->c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Source.Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    const bool       IsParsed = Shader.parse(&Resources, 100, false, EShMsgDefault);
+    Artifacts.SetInfoLog(Shader.getInfoLog());
+    if (!IsParsed)
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+    return SPIRV;
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer TintScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+// The artifacts own the intermediate binaries: every stage reads its input from there,
+// so keeping them for a possible dump costs no copies
+std::string ConvertShader(const ShaderSource& Source, ConversionArtifacts& Artifacts)
+{
+    const auto& SPIRV          = Artifacts.SetSPIRV(ConversionArtifacts::Stage::Glslang, ConvertHLSLtoSPIRV(Source, Artifacts));
+    const auto& OptimizedSPIRV = Artifacts.SetSPIRV(ConversionArtifacts::Stage::Optimized, OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0));
+    return ConvertSPIRVtoWGSL(OptimizedSPIRV);
+}
+
+struct DiagnosticsOptions
+{
+    std::filesystem::path DumpDirectory;
+    bool                  DumpFailures = true;
+    uint32_t              SampleEvery  = 0; // Also dump about one in that many successful jobs, 0 for none
+};
+
+// Sampling by the hash of the job name rather than by a counter keeps the choice stable
+// across runs and independent of the job order, so a sampled dump can be reproduced.
+// std::hash is not specified and differs between standard libraries, hence FNV-1a.
+bool IsSampled(const std::string& JobName, uint32_t SampleEvery)
+{
+    uint32_t Hash = 2166136261u;
+    for (char c : JobName)
+        Hash = (Hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    return SampleEvery != 0 && Hash % SampleEvery == 0;
+}
+
+struct JobReport
+{
+    std::string Name;
+    bool        Succeeded = false;
+    bool        Dumped    = false;
+    double      TimeMs    = 0; // Conversion only
+    double      DumpMs    = 0;
+};
+
+JobReport RunJob(const ShaderSource& Source, const DiagnosticsOptions& Options)
+{
+    JobReport Report;
+    Report.Name = Source.Name;
+
+    ConversionArtifacts Artifacts{Source};
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+    try
+    {
+        Artifacts.SetWGSL(ConvertShader(Source, Artifacts));
+        Report.Succeeded = true;
+    }
+    catch (const std::exception& Error)
+    {
+        Artifacts.SetError(Error.what());
+    }
+    const auto EndTime = std::chrono::high_resolution_clock::now();
+    Report.TimeMs      = std::chrono::duration<double, std::milli>(EndTime - StartTime).count();
+
+    Report.Dumped = Report.Succeeded ? IsSampled(Source.Name, Options.SampleEvery) : Options.DumpFailures;
+    if (Report.Dumped)
+    {
+        const auto JobDirectory = Options.DumpDirectory / Source.Name;
+        Artifacts.Dump(JobDirectory, SPV_ENV_VULKAN_1_0);
+        Report.DumpMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - EndTime).count();
+        if (!Report.Succeeded)
+            LOG_INFO_MESSAGE("Artifacts of the failed job ", Source.Name, " are in ", JobDirectory);
+    }
+    return Report;
+}
+
+// Usage: FailureDumps [--dump-dir <directory>] [--sample-every N]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        DiagnosticsOptions Options;
+        Options.DumpDirectory = std::filesystem::temp_directory_path() / ConcatenateArgs("FailureDumps.", std::chrono::system_clock::now().time_since_epoch().count());
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--dump-dir")
+                Options.DumpDirectory = argv[i + 1];
+            else if (Arg == "--sample-every")
+                Options.SampleEvery = static_cast<uint32_t>(std::stoul(argv[i + 1]));
+            else
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+        }
+        if (argc % 2 == 0)
+            LOG_ERROR_AND_THROW("Missing value of '", argv[argc - 1], "'");
+
+        std::vector<ShaderSource> Sources;
+        Sources.push_back({"TestVS", &HLSL::TestVS, "#define WEBGPU 1\n", EShLangVertex});
+        for (uint32_t PermutationIdx = 0; PermutationIdx < 8; ++PermutationIdx)
+        {
+            std::string Preamble = ConcatenateArgs("#define NON_POWER_OF_TWO ", PermutationIdx % 4, "\n");
+            if (PermutationIdx >= 4)
+                Preamble += "#define CONVERT_TO_SRGB\n";
+            Sources.push_back({ConcatenateArgs("GenerateMipsCS.", PermutationIdx), &HLSL::GenerateMipsCS, std::move(Preamble), EShLangCompute});
+        }
+        Sources.push_back({"BrokenPS", &HLSL::BrokenPS, "", EShLangFragment});
+
+        std::cout << "Job                 Result   Convert ms  Dump ms\n";
+        double   ConvertMs = 0;
+        double   DumpMs    = 0;
+        uint32_t NumDumps  = 0;
+        for (const auto& Source : Sources)
+        {
+            const auto Report = RunJob(Source, Options);
+            std::cout << std::left << std::setw(20) << Report.Name << std::setw(9) << (Report.Succeeded ? "ok" : "failed") << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(10) << Report.TimeMs;
+            if (Report.Dumped)
+                std::cout << std::setw(9) << Report.DumpMs << "\n";
+            else
+                std::cout << std::setw(9) << "-" << "\n";
+            ConvertMs += Report.TimeMs;
+            DumpMs += Report.DumpMs;
+            NumDumps += Report.Dumped ? 1 : 0;
+        }
+        std::cout << "\n"
+                  << Sources.size() << " jobs converted in " << ConvertMs << " ms; " << NumDumps << " dumped to "
+                  << Options.DumpDirectory.string() << " in " << DumpMs << " ms\n";
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,424 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string ToneMapPS = R"(
+Texture2D    g_SceneColor;
+SamplerState g_SceneColor_sampler;
+
+Texture2D    g_Bloom;
+SamplerState g_Bloom_sampler;
+
+cbuffer cbPostProcess
+{
+    float4 g_Params; // x: exposure, y: bloom intensity, z: vignette strength, w: grain amount
+    float4 g_ScreenSize;
+}
+
+min16float3 ACESFilm(min16float3 x)
+{
+    const min16float a = 2.51;
+    const min16float b = 0.03;
+    const min16float c = 2.43;
+    const min16float d = 0.59;
+    const min16float e = 0.14;
+    return saturate((x * (a * x + b)) / (x * (c * x + d) + e));
+}
+
+half Vignette(float2 UV, half Strength)
+{
+    half2 Dir = half2(UV - 0.5);
+    return saturate(half(1.0) - dot(Dir, Dir) * Strength);
+}
+
+half Grain(float2 Pos, half Amount)
+{
+    half Noise = half(frac(sin(dot(Pos, float2(12.9898, 78.233))) * 43758.5453));
+    return half(1.0) + (Noise - half(0.5)) * Amount;
+}
+
+float4 main(in float4 Pos : SV_POSITION, in float2 UV : TEXCOORD) : SV_Target
+{
+    min16float3 Color = min16float3(g_SceneColor.Sample(g_SceneColor_sampler, UV).rgb);
+    min16float3 Bloom = min16float3(g_Bloom.Sample(g_Bloom_sampler, UV).rgb);
+
+    Color = Color * min16float(g_Params.x) + Bloom * min16float(g_Params.y);
+    Color = ACESFilm(Color) * Vignette(UV, half(g_Params.z)) * Grain(Pos.xy, half(g_Params.w));
+    return float4(Color, 1.0);
+}
+)";
+
+const std::string BlurCS = R"(
+Texture2D<float4>   g_Input;
+RWTexture2D<float4> g_Output;
+
+static const int  KernelRadius = 4;
+static const uint GroupSize    = 64;
+
+// half4 halves the shared memory footprint of the cache
+groupshared half4 g_Cache[GroupSize + 2 * KernelRadius];
+
+[numthreads(GroupSize, 1, 1)]
+void main(uint3 GroupId : SV_GroupID, uint3 GTid : SV_GroupThreadID)
+{
+    const min16float Weights[KernelRadius + 1] = {0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216};
+
+    int2 Dim;
+    g_Input.GetDimensions(Dim.x, Dim.y);
+
+    int2 Pos = int2(GroupId.x * GroupSize + GTid.x, GroupId.y);
+    g_Cache[GTid.x + KernelRadius] = half4(g_Input.Load(int3(min(Pos, Dim - 1), 0)));
+    if (GTid.x < KernelRadius)
+    {
+        g_Cache[GTid.x]                            = half4(g_Input.Load(int3(max(Pos.x - KernelRadius, 0), Pos.y, 0)));
+        g_Cache[GTid.x + GroupSize + KernelRadius] = half4(g_Input.Load(int3(min(Pos.x + GroupSize, Dim.x - 1), Pos.y, 0)));
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    half4 Sum = g_Cache[GTid.x + KernelRadius] * Weights[0];
+    [unroll]
+    for (int i = 1; i <= KernelRadius; ++i)
+        Sum += (g_Cache[GTid.x + KernelRadius - i] + g_Cache[GTid.x + KernelRadius + i]) * Weights[i];
+
+    if (all(Pos < Dim))
+        g_Output[Pos] = float4(Sum);
+}
+)";
+;
+} // namespace HLSL
+
+// Precision of min16float/half in the generated code
+enum class ShaderPrecision
+{
+    Full, // f32: runs on any device
+    Half, // f16: requires the shader-f16 device feature
+};
+
+const char* GetPrecisionName(ShaderPrecision Precision)
+{
+    return Precision == ShaderPrecision::Half ? "f16" : "f32";
+}
+
+struct ShaderSource
+{
+    const char*        Name;
+    const std::string& HLSL;
+    EShLanguage        Stage;
+};
+
+struct ShaderVariant
+{
+    ShaderPrecision          Precision = ShaderPrecision::Full;
+    std::string              WGSL;
+    std::vector<std::string> RequiredFeatures; // WebGPU device features, e.g. "shader-f16"
+};
+
+// Variants of a shader, in the order of preference
+struct ShaderVariantSet
+{
+    std::string                Name;
+    std::vector<ShaderVariant> Variants;
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+// With EShMsgHlslEnable16BitTypes glslang maps half and min16float to 16-bit floats
+// (Float16 capability). Without it, both are 32-bit floats, min16float only being
+// decorated with RelaxedPrecision, which WGSL has no equivalent for.
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const ShaderSource& Source, ShaderPrecision Precision)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{Source.Stage};
+
+    auto* pHLSL = Source.HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    const auto Messages = static_cast<EShMessages>(Precision == ShaderPrecision::Half ? EShMsgDefault | EShMsgHlslEnable16BitTypes : EShMsgDefault);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, Messages))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(Messages))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    return OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+// The f16 variant comes first and is only kept if it really uses f16: shaders without
+// half-precision types get a single variant. If the f16 conversion fails, the shader
+// still gets its f32 variant.
+ShaderVariantSet ConvertShader(const ShaderSource& Source)
+{
+    ShaderVariantSet VariantSet;
+    VariantSet.Name = Source.Name;
+
+    try
+    {
+        ShaderVariant Variant;
+        Variant.Precision = ShaderPrecision::Half;
+        Variant.WGSL      = ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(Source, ShaderPrecision::Half));
+        if (Variant.WGSL.find("enable f16;") != std::string::npos)
+        {
+            Variant.RequiredFeatures.emplace_back("shader-f16");
+            VariantSet.Variants.emplace_back(std::move(Variant));
+        }
+    }
+    catch (const std::exception&)
+    {
+        LOG_WARNING_MESSAGE("Failed to generate the f16 variant of ", Source.Name, ", only the f32 variant is available");
+    }
+
+    ShaderVariant Fallback;
+    Fallback.Precision = ShaderPrecision::Full;
+    Fallback.WGSL      = ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(Source, ShaderPrecision::Full));
+    VariantSet.Variants.emplace_back(std::move(Fallback));
+
+    return VariantSet;
+}
+
+std::string GetVariantFileName(const ShaderVariantSet& VariantSet, const ShaderVariant& Variant)
+{
+    return VariantSet.Name + "." + GetPrecisionName(Variant.Precision) + ".wgsl";
+}
+
+// Manifest the runtime uses to pick a variant: the first one whose features the device has
+std::string WriteManifest(const std::vector<ShaderVariantSet>& VariantSets)
+{
+    std::ostringstream Json;
+    Json << "{\n  \"shaders\": [";
+    for (size_t SetIdx = 0; SetIdx < VariantSets.size(); ++SetIdx)
+    {
+        const auto& VariantSet = VariantSets[SetIdx];
+        Json << (SetIdx > 0 ? "," : "") << "\n    {\n"
+             << "      \"name\": \"" << VariantSet.Name << "\",\n"
+             << "      \"variants\": [";
+        for (size_t VariantIdx = 0; VariantIdx < VariantSet.Variants.size(); ++VariantIdx)
+        {
+            const auto& Variant = VariantSet.Variants[VariantIdx];
+            Json << (VariantIdx > 0 ? "," : "") << "\n        { \"precision\": \"" << GetPrecisionName(Variant.Precision)
+                 << "\", \"file\": \"" << GetVariantFileName(VariantSet, Variant) << "\", \"features\": [";
+            for (size_t FeatureIdx = 0; FeatureIdx < Variant.RequiredFeatures.size(); ++FeatureIdx)
+                Json << (FeatureIdx > 0 ? ", " : "") << "\"" << Variant.RequiredFeatures[FeatureIdx] << "\"";
+            Json << "] }";
+        }
+        Json << "\n      ]\n    }";
+    }
+    Json << "\n  ]\n}\n";
+    return Json.str();
+}
+
+// What the runtime does with the manifest
+const ShaderVariant& SelectVariant(const ShaderVariantSet& VariantSet, const std::vector<std::string>& DeviceFeatures)
+{
+    for (const auto& Variant : VariantSet.Variants)
+    {
+        const bool IsSupported = std::all_of(Variant.RequiredFeatures.begin(), Variant.RequiredFeatures.end(), [&](const std::string& Feature) {
+            return std::find(DeviceFeatures.begin(), DeviceFeatures.end(), Feature) != DeviceFeatures.end();
+        });
+        if (IsSupported)
+            return Variant;
+    }
+    LOG_ERROR_AND_THROW("No variant of ", VariantSet.Name, " is supported by the device");
+}
+
+size_t CountOccurrences(const std::string& Str, const std::string& Pattern)
+{
+    size_t Count = 0;
+    for (size_t Pos = Str.find(Pattern); Pos != std::string::npos; Pos = Str.find(Pattern, Pos + Pattern.size()))
+        ++Count;
+    return Count;
+}
+
+// Usage: HalfPrecision [--output <directory>]
+// Without --output, the manifest and the WGSL of all variants are printed.
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        std::string OutputDir;
+        if (argc == 3 && std::string{argv[1]} == "--output")
+            OutputDir = argv[2];
+        else if (argc != 1)
+            LOG_ERROR_AND_THROW("Usage: HalfPrecision [--output <directory>]");
+
+        const ShaderSource Shaders[] = {
+            {"ToneMapPS", HLSL::ToneMapPS, EShLangFragment},
+            {"BlurCS", HLSL::BlurCS, EShLangCompute},
+        };
+
+        std::vector<ShaderVariantSet> VariantSets;
+        for (const auto& Shader : Shaders)
+            VariantSets.emplace_back(ConvertShader(Shader));
+
+        std::cout << std::left << std::setw(12) << "Shader" << std::setw(10) << "Variant" << std::setw(14) << "Features" << "f16 uses\n";
+        for (const auto& VariantSet : VariantSets)
+        {
+            for (const auto& Variant : VariantSet.Variants)
+            {
+                std::cout << std::setw(12) << VariantSet.Name << std::setw(10) << GetPrecisionName(Variant.Precision)
+                          << std::setw(14) << (Variant.RequiredFeatures.empty() ? "-" : Variant.RequiredFeatures.front())
+                          << CountOccurrences(Variant.WGSL, "f16") << "\n";
+            }
+        }
+        std::cout << std::right << "\n";
+
+        for (const auto& DeviceFeatures : {std::vector<std::string>{}, std::vector<std::string>{"shader-f16"}})
+        {
+            std::cout << "Device " << (DeviceFeatures.empty() ? "without" : "with") << " shader-f16:";
+            for (const auto& VariantSet : VariantSets)
+                std::cout << " " << GetVariantFileName(VariantSet, SelectVariant(VariantSet, DeviceFeatures));
+            std::cout << "\n";
+        }
+        std::cout << "\n";
+
+        const std::string Manifest = WriteManifest(VariantSets);
+        if (OutputDir.empty())
+        {
+            std::cout << Manifest;
+            for (const auto& VariantSet : VariantSets)
+            {
+                for (const auto& Variant : VariantSet.Variants)
+                    std::cout << "\n---- " << GetVariantFileName(VariantSet, Variant) << " ----\n"
+                              << Variant.WGSL << "\n";
+            }
+            return 0;
+        }
+
+        auto WriteFile = [&](const std::string& Name, const std::string& Content) {
+            const std::string Path = OutputDir + "/" + Name;
+            std::ofstream     File{Path};
+            if (!(File << Content))
+                LOG_ERROR_AND_THROW("Failed to write '", Path, "'");
+        };
+        WriteFile("manifest.json", Manifest);
+        for (const auto& VariantSet : VariantSets)
+        {
+            for (const auto& Variant : VariantSet.Variants)
+                WriteFile(GetVariantFileName(VariantSet, Variant), Variant.WGSL);
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
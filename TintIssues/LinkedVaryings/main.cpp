@@ -0,0 +1,467 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <unordered_set>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+// One vertex shader paired with pixel shaders that each read a different subset of its outputs
+const std::string MaterialFX = R"(
+cbuffer Constants
+{
+    float4x4 g_WorldViewProj;
+    float4x4 g_World;
+    float4   g_LightDir;
+};
+
+Texture2D<float4> g_Texture;
+SamplerState      g_Sampler;
+
+struct VSInput
+{
+    float3 Pos    : ATTRIB0;
+    float4 Color  : ATTRIB1;
+    float2 UV     : ATTRIB2;
+    float3 Normal : ATTRIB3;
+};
+
+struct PSInput
+{
+    float4 Pos      : SV_POSITION;
+    float4 Color    : COLOR0;
+    float2 UV       : TEXCOORD0;
+    float3 Normal   : NORMAL;
+    float3 WorldPos : WORLDPOS;
+};
+
+void VSMain(in VSInput VSIn,
+            out PSInput PSIn)
+{
+    PSIn.Pos      = mul(float4(VSIn.Pos, 1.0), g_WorldViewProj);
+    PSIn.Color    = VSIn.Color;
+    PSIn.UV       = VSIn.UV;
+    PSIn.Normal   = normalize(mul(float4(VSIn.Normal, 0.0), g_World).xyz);
+    PSIn.WorldPos = mul(float4(VSIn.Pos, 1.0), g_World).xyz;
+}
+
+float4 PSColor(in PSInput PSIn) : SV_Target
+{
+    return PSIn.Color;
+}
+
+float4 PSTextured(in PSInput PSIn) : SV_Target
+{
+    return g_Texture.Sample(g_Sampler, PSIn.UV);
+}
+
+float4 PSLit(in PSInput PSIn) : SV_Target
+{
+    float NdotL = saturate(dot(PSIn.Normal, -g_LightDir.xyz));
+    return g_Texture.Sample(g_Sampler, PSIn.UV) * NdotL;
+}
+)";
+;
+} // namespace HLSL
+
+struct Varying
+{
+    std::string Name;
+    uint32_t    Location      = 0;
+    uint32_t    LocationCount = 1;
+};
+
+namespace
+{
+
+// Returns the name of the variable, or the name of its struct member for flattened HLSL structs
+std::string GetVariableName(spvtools::opt::IRContext& Context, uint32_t Id)
+{
+    for (const auto& Name : Context.GetNames(Id))
+        return Name.second->GetInOperand(1).AsString();
+    return ConcatenateArgs("_", Id);
+}
+
+uint32_t GetLocationCount(spvtools::opt::IRContext& Context, uint32_t TypeId)
+{
+    const auto* pType = Context.get_def_use_mgr()->GetDef(TypeId);
+    switch (pType->opcode())
+    {
+        case spv::Op::OpTypeMatrix:
+            return pType->GetSingleWordInOperand(1);
+        case spv::Op::OpTypeArray:
+        {
+            const auto* pLength = Context.get_def_use_mgr()->GetDef(pType->GetSingleWordInOperand(1));
+            return pLength->GetSingleWordInOperand(0) * GetLocationCount(Context, pType->GetSingleWordInOperand(0));
+        }
+        default:
+            return 1;
+    }
+}
+
+bool GetLocation(spvtools::opt::IRContext& Context, uint32_t Id, uint32_t& Location)
+{
+    for (const auto* pDecoration : Context.get_decoration_mgr()->GetDecorationsFor(Id, false))
+    {
+        if (pDecoration->opcode() == spv::Op::OpDecorate &&
+            static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(1)) == spv::Decoration::Location)
+        {
+            Location = pDecoration->GetSingleWordInOperand(2);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Lists user-defined (non-builtin) interface variables of the given storage class, sorted by location
+std::vector<Varying> GetVaryings(const std::vector<uint32_t>& SPIRV, spv::StorageClass StorageClass)
+{
+    auto Context = spvtools::BuildModule(SPV_ENV_VULKAN_1_0, {}, SPIRV.data(), SPIRV.size());
+    if (!Context)
+        LOG_ERROR_AND_THROW("Failed to build SPIR-V module");
+
+    std::vector<Varying> Varyings;
+    for (const auto& Inst : Context->module()->types_values())
+    {
+        if (Inst.opcode() != spv::Op::OpVariable || Inst.GetSingleWordInOperand(0) != static_cast<uint32_t>(StorageClass))
+            continue;
+
+        Varying Var;
+        if (!GetLocation(*Context, Inst.result_id(), Var.Location))
+            continue;
+
+        const auto* pPointerType = Context->get_def_use_mgr()->GetDef(Inst.type_id());
+        Var.Name          = GetVariableName(*Context, Inst.result_id());
+        Var.LocationCount = GetLocationCount(*Context, pPointerType->GetSingleWordInOperand(1));
+        Varyings.emplace_back(std::move(Var));
+    }
+
+    std::sort(Varyings.begin(), Varyings.end(), [](const Varying& LHS, const Varying& RHS) { return LHS.Location < RHS.Location; });
+    return Varyings;
+}
+
+} // namespace
+
+// Rewrites the Location decorations of Input or Output variables through a remap table.
+// Variables whose location is not in the table and that are never accessed are removed
+// together with their decorations and entry point interface entries.
+class RemapVaryingLocationsPass final : public spvtools::opt::Pass
+{
+public:
+    RemapVaryingLocationsPass(spv::StorageClass StorageClass, const std::map<uint32_t, uint32_t>& Remap) :
+        m_StorageClass{StorageClass},
+        m_Remap{Remap}
+    {}
+
+    const char* name() const override
+    {
+        return "remap-varying-locations";
+    }
+
+    Status Process() override
+    {
+        std::vector<spvtools::opt::Instruction*> Variables;
+        for (auto& Inst : get_module()->types_values())
+        {
+            if (Inst.opcode() == spv::Op::OpVariable && Inst.GetSingleWordInOperand(0) == static_cast<uint32_t>(m_StorageClass))
+                Variables.push_back(&Inst);
+        }
+
+        bool IsModified = false;
+        for (auto* pVariable : Variables)
+        {
+            spvtools::opt::Instruction* pLocation = nullptr;
+            for (auto* pDecoration : get_decoration_mgr()->GetDecorationsFor(pVariable->result_id(), false))
+            {
+                if (pDecoration->opcode() == spv::Op::OpDecorate &&
+                    static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(1)) == spv::Decoration::Location)
+                    pLocation = pDecoration;
+            }
+            if (pLocation == nullptr)
+                continue;
+
+            auto NewLocation = m_Remap.find(pLocation->GetSingleWordInOperand(2));
+            if (NewLocation != m_Remap.end())
+            {
+                if (NewLocation->second != NewLocation->first)
+                {
+                    pLocation->SetInOperand(2, {NewLocation->second});
+                    IsModified = true;
+                }
+                continue;
+            }
+
+            const bool IsAccessed = !get_def_use_mgr()->WhileEachUser(pVariable, [](spvtools::opt::Instruction* pUser) {
+                return spvtools::opt::IsAnnotationInst(pUser->opcode()) || pUser->opcode() == spv::Op::OpName || pUser->opcode() == spv::Op::OpEntryPoint;
+            });
+            if (IsAccessed)
+                continue;
+
+            for (auto& EntryPoint : get_module()->entry_points())
+            {
+                for (uint32_t OperandIdx = EntryPoint.NumInOperands(); OperandIdx > 3; --OperandIdx)
+                {
+                    if (EntryPoint.GetSingleWordInOperand(OperandIdx - 1) == pVariable->result_id())
+                        EntryPoint.RemoveInOperand(OperandIdx - 1);
+                }
+            }
+            context()->KillNamesAndDecorates(pVariable);
+            context()->KillInst(pVariable);
+            IsModified = true;
+        }
+        return IsModified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+    }
+
+private:
+    const spv::StorageClass             m_StorageClass;
+    const std::map<uint32_t, uint32_t>& m_Remap;
+};
+
+template <typename... PassTokenTypes>
+std::vector<uint32_t> RunPasses(const std::vector<uint32_t>& SrcSPIRV, PassTokenTypes&&... Passes)
+{
+    spvtools::Optimizer SpirvOptimizer(SPV_ENV_VULKAN_1_0);
+    (SpirvOptimizer.RegisterPass(std::move(Passes)), ...);
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to run SPIR-V passes.");
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+struct LinkedProgramSPIRV
+{
+    std::vector<uint32_t> VS;
+    std::vector<uint32_t> PS;
+};
+
+// Adds both stages to one glslang program so that the interface is validated at link time
+// and both stages get consistent locations.
+LinkedProgramSPIRV ConvertHLSLtoSPIRV(const std::string& HLSL, const char* VSEntryPoint, const char* PSEntryPoint)
+{
+    GlslangInitilizer InitScope{};
+
+    auto* pHLSL = HLSL.c_str();
+
+    glslang::TShader VSShader{EShLangVertex};
+    glslang::TShader PSShader{EShLangFragment};
+    for (auto* pShader : {&VSShader, &PSShader})
+    {
+        pShader->setStrings(&pHLSL, 1);
+        pShader->setEntryPoint(pShader == &VSShader ? VSEntryPoint : PSEntryPoint);
+        pShader->setEnvInput(glslang::EShSourceHlsl, pShader->getStage(), glslang::EShClientVulkan, 100);
+        pShader->setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+        pShader->setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+        pShader->setEnvTargetHlslFunctionality1();
+        pShader->setHlslIoMapping(true);
+        pShader->setDxPositionW(true);
+        pShader->setAutoMapBindings(true);
+        pShader->setAutoMapLocations(true);
+
+        TBuiltInResource Resources{};
+        if (!pShader->parse(&Resources, 100, false, EShMsgDefault))
+            LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", pShader->getInfoLog());
+    }
+
+    glslang::TProgram Program;
+    Program.addShader(&VSShader);
+    Program.addShader(&PSShader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    LinkedProgramSPIRV Result;
+    for (auto Stage : {EShLangVertex, EShLangFragment})
+    {
+        std::vector<uint32_t> SPIRV;
+        glslang::GlslangToSpv(*Program.getIntermediate(Stage), SPIRV);
+
+        auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+        if (OptimizedSPIRV.empty())
+            LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+        (Stage == EShLangVertex ? Result.VS : Result.PS) = std::move(OptimizedSPIRV);
+    }
+    return Result;
+}
+
+// Removes vertex shader outputs the pixel shader never reads and packs the remaining
+// interpolants into consecutive locations in both stages.
+LinkedProgramSPIRV EliminateDeadVaryings(const LinkedProgramSPIRV& Program)
+{
+    std::unordered_set<uint32_t> LiveLocations;
+    std::unordered_set<uint32_t> LiveBuiltins;
+    RunPasses(Program.PS, spvtools::CreateAnalyzeLiveInputPass(&LiveLocations, &LiveBuiltins));
+
+    // The position is always consumed by the rasterizer, whether or not the pixel shader reads it
+    LiveBuiltins.insert(static_cast<uint32_t>(spv::BuiltIn::Position));
+
+    std::unordered_set<uint32_t> WrittenLocations;
+    for (const auto& Output : GetVaryings(Program.VS, spv::StorageClass::Output))
+    {
+        for (uint32_t Location = Output.Location; Location < Output.Location + Output.LocationCount; ++Location)
+            WrittenLocations.insert(Location);
+    }
+    for (const auto& Input : GetVaryings(Program.PS, spv::StorageClass::Input))
+    {
+        if (LiveLocations.count(Input.Location) != 0 && WrittenLocations.count(Input.Location) == 0)
+            LOG_ERROR_AND_THROW("Pixel shader input '", Input.Name, "' at location ", Input.Location, " is not written by the vertex shader");
+    }
+
+    LinkedProgramSPIRV Result;
+    Result.VS = RunPasses(Program.VS,
+                          spvtools::CreateEliminateDeadOutputStoresPass(&LiveLocations, &LiveBuiltins),
+                          spvtools::CreateAggressiveDCEPass(/*preserve_interface = */ false, /*remove_outputs = */ true));
+
+    std::map<uint32_t, uint32_t> Remap;
+    uint32_t                     NextLocation = 0;
+    for (const auto& Output : GetVaryings(Result.VS, spv::StorageClass::Output))
+    {
+        Remap[Output.Location] = NextLocation;
+        NextLocation += Output.LocationCount;
+    }
+
+    Result.VS = RunPasses(Result.VS, spvtools::Optimizer::PassToken{std::make_unique<RemapVaryingLocationsPass>(spv::StorageClass::Output, Remap)});
+    Result.PS = RunPasses(Program.PS, spvtools::Optimizer::PassToken{std::make_unique<RemapVaryingLocationsPass>(spv::StorageClass::Input, Remap)});
+    return Result;
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+std::string FormatVaryings(const std::vector<Varying>& Varyings)
+{
+    std::ostringstream Stream;
+    for (size_t VarIdx = 0; VarIdx < Varyings.size(); ++VarIdx)
+        Stream << (VarIdx > 0 ? ", " : "") << Varyings[VarIdx].Name << "@" << Varyings[VarIdx].Location;
+    return Stream.str();
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        for (const char* PSEntryPoint : {"PSColor", "PSTextured", "PSLit"})
+        {
+            const auto Unlinked = ConvertHLSLtoSPIRV(HLSL::MaterialFX, "VSMain", PSEntryPoint);
+            const auto Linked   = EliminateDeadVaryings(Unlinked);
+
+            const auto UnlinkedOutputs = GetVaryings(Unlinked.VS, spv::StorageClass::Output);
+            const auto LinkedOutputs   = GetVaryings(Linked.VS, spv::StorageClass::Output);
+
+            std::cout << "==== VSMain + " << PSEntryPoint << " ====\n"
+                      << ConvertSPIRVtoWGSL(Linked.VS) << "\n"
+                      << ConvertSPIRVtoWGSL(Linked.PS) << "\n";
+
+            LOG_INFO_MESSAGE(PSEntryPoint, ": VS outputs [", FormatVaryings(UnlinkedOutputs), "] -> [", FormatVaryings(LinkedOutputs), "], ",
+                             "VS SPIR-V ", Unlinked.VS.size() * 4, " -> ", Linked.VS.size() * 4, " bytes");
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,433 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/linker.hpp>
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <unordered_map>
+#include <atomic>
+#include <future>
+#include <chrono>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string CommonH = R"(
+struct VSOutput
+{
+    float4 Pos : SV_Position;
+    float2 UV  : TEXCOORD0;
+};
+
+[[vk::binding(0, 0)]] cbuffer FrameConstants
+{
+    float4x4 g_WorldViewProj;
+    float4   g_Tint;
+};
+
+float4 ApplyTint(float4 Color)
+{
+    return float4(Color.rgb * g_Tint.rgb, Color.a);
+}
+)";
+
+const std::string MaterialFX = R"(
+#include "Common.hlsl"
+
+[[vk::binding(1, 0)]] Texture2D<float4>   g_Texture;
+[[vk::binding(2, 0)]] SamplerState        g_Sampler;
+[[vk::binding(3, 0)]] RWTexture2D<float4> g_Output;
+
+VSOutput VSMain(float3 Pos : ATTRIB0, float2 UV : ATTRIB1)
+{
+    VSOutput Out;
+    Out.Pos = mul(g_WorldViewProj, float4(Pos, 1.0));
+    Out.UV  = UV;
+    return Out;
+}
+
+float4 PSMain(VSOutput In) : SV_Target
+{
+    return ApplyTint(g_Texture.Sample(g_Sampler, In.UV));
+}
+
+[numthreads(8, 8, 1)]
+void CSMain(uint3 DTid : SV_DispatchThreadID)
+{
+    g_Output[DTid.xy] = ApplyTint(g_Texture.Load(int3(DTid.xy, 0)));
+}
+)";
+;
+} // namespace HLSL
+
+struct EntryPointDesc
+{
+    const char* Name;
+    EShLanguage Stage;
+};
+
+// Resolves #include directives from an in-memory file table and counts the resolutions
+class VirtualFileIncluder final : public glslang::TShader::Includer
+{
+public:
+    explicit VirtualFileIncluder(std::unordered_map<std::string, std::string> Files) :
+        m_Files{std::move(Files)}
+    {}
+
+    IncludeResult* includeLocal(const char* HeaderName, const char* IncluderName, size_t InclusionDepth) override
+    {
+        return includeSystem(HeaderName, IncluderName, InclusionDepth);
+    }
+
+    IncludeResult* includeSystem(const char* HeaderName, const char* /*IncluderName*/, size_t /*InclusionDepth*/) override
+    {
+        auto File = m_Files.find(HeaderName);
+        if (File == m_Files.end())
+            return nullptr;
+
+        m_NumResolved.fetch_add(1);
+        return new IncludeResult{File->first, File->second.c_str(), File->second.size(), nullptr};
+    }
+
+    void releaseInclude(IncludeResult* pResult) override
+    {
+        delete pResult;
+    }
+
+    uint32_t GetNumResolved() const
+    {
+        return m_NumResolved.load();
+    }
+
+private:
+    const std::unordered_map<std::string, std::string> m_Files;
+    std::atomic<uint32_t>                              m_NumResolved{0};
+};
+
+void SetupHLSLShader(glslang::TShader& Shader, const char* EntryPoint)
+{
+    Shader.setEntryPoint(EntryPoint);
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+// Parses and compiles one entry point. Source may be either the original file (includes are
+// resolved through Includer) or already preprocessed text.
+std::vector<uint32_t> CompileEntryPoint(const std::string& Source, const EntryPointDesc& EntryPoint, glslang::TShader::Includer& Includer)
+{
+    glslang::TShader Shader{EntryPoint.Stage};
+
+    auto* pHLSL = Source.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    SetupHLSLShader(Shader, EntryPoint.Name);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, ENoProfile, false, false, EShMsgDefault, Includer))
+        LOG_ERROR_AND_THROW("Failed to parse entry point '", EntryPoint.Name, "': \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+
+    if (!OptimizedSPIRV.empty())
+        return OptimizedSPIRV;
+
+    LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+struct MultiEntryPointResult
+{
+    // One WGSL module with all entry points if the per-entry-point SPIR-V could be linked
+    // and converted, otherwise one module per entry point.
+    std::vector<std::string> WGSLModules;
+    bool                     IsLinked = false;
+};
+
+// Compiles all requested entry points of one HLSL file. The file is preprocessed once
+// (macro expansion and include resolution), and every entry point is then parsed from the
+// preprocessed text in parallel. glslang's HLSL front end prunes the AST to one entry point,
+// so the parse itself still happens per entry point.
+class MultiEntryPointJob
+{
+public:
+    MultiEntryPointJob(const std::string& Source, std::vector<EntryPointDesc> EntryPoints) :
+        m_Source{Source},
+        m_EntryPoints{std::move(EntryPoints)}
+    {}
+
+    MultiEntryPointResult Run(glslang::TShader::Includer& Includer) const
+    {
+        const auto Binaries = CompileEntryPoints(Includer);
+
+        MultiEntryPointResult Result;
+        try
+        {
+            Result.WGSLModules = {ConvertSPIRVtoWGSL(Link(Binaries))};
+            Result.IsLinked    = true;
+        }
+        catch (const std::exception& Error)
+        {
+            LOG_WARNING_MESSAGE("Failed to produce a single module (", Error.what(), "), falling back to one module per entry point");
+            for (const auto& SPIRV : Binaries)
+                Result.WGSLModules.emplace_back(ConvertSPIRVtoWGSL(SPIRV));
+        }
+        return Result;
+    }
+
+    // SPIR-V of every entry point, in the order of the entry points
+    std::vector<std::vector<uint32_t>> CompileEntryPoints(glslang::TShader::Includer& Includer) const
+    {
+        GlslangInitilizer InitScope{};
+
+        const std::string Preprocessed = Preprocess(Includer);
+
+        // Preprocessed text has no includes left, so the per-entry-point parses must not resolve any
+        glslang::TShader::ForbidIncluder NoIncluder;
+
+        std::vector<std::future<std::vector<uint32_t>>> Compilations;
+        for (const auto& EntryPoint : m_EntryPoints)
+        {
+            Compilations.emplace_back(std::async(std::launch::async, [&Preprocessed, &EntryPoint, &NoIncluder]() {
+                return CompileEntryPoint(Preprocessed, EntryPoint, NoIncluder);
+            }));
+        }
+
+        std::vector<std::vector<uint32_t>> Binaries;
+        for (auto& Compilation : Compilations)
+            Binaries.emplace_back(Compilation.get());
+        return Binaries;
+    }
+
+private:
+    std::string Preprocess(glslang::TShader::Includer& Includer) const
+    {
+        // The stage does not affect HLSL preprocessing, any entry point can be used
+        glslang::TShader Shader{m_EntryPoints.front().Stage};
+
+        auto* pHLSL = m_Source.c_str();
+        Shader.setStrings(&pHLSL, 1);
+        SetupHLSLShader(Shader, m_EntryPoints.front().Name);
+
+        TBuiltInResource Resources{};
+        std::string      Preprocessed;
+        if (!Shader.preprocess(&Resources, 100, ENoProfile, false, false, EShMsgDefault, &Preprocessed, Includer))
+            LOG_ERROR_AND_THROW("Failed to preprocess: \n", Shader.getInfoLog());
+        return Preprocessed;
+    }
+
+    static std::vector<uint32_t> Link(const std::vector<std::vector<uint32_t>>& Binaries)
+    {
+        std::string Messages;
+
+        spvtools::Context Context{SPV_ENV_VULKAN_1_0};
+        Context.SetMessageConsumer([&Messages](spv_message_level_t, const char*, const spv_position_t&, const char* Message) {
+            Messages += Message;
+            Messages += '\n';
+        });
+
+        std::vector<uint32_t> Linked;
+        if (spvtools::Link(Context, Binaries, &Linked, spvtools::LinkerOptions{}) != SPV_SUCCESS)
+            LOG_ERROR_AND_THROW("Failed to link entry points: \n", Messages);
+        return Linked;
+    }
+
+private:
+    const std::string&                m_Source;
+    const std::vector<EntryPointDesc> m_EntryPoints;
+};
+
+// Baseline of CompileEntryPoints(): the same parallel compilation, but every entry point
+// preprocesses the whole file and resolves its includes on its own
+std::vector<std::vector<uint32_t>> CompileEntryPointsSeparately(const std::string& Source, const std::vector<EntryPointDesc>& EntryPoints, glslang::TShader::Includer& Includer)
+{
+    GlslangInitilizer InitScope{};
+
+    std::vector<std::future<std::vector<uint32_t>>> Compilations;
+    for (const auto& EntryPoint : EntryPoints)
+    {
+        Compilations.emplace_back(std::async(std::launch::async, [&Source, &EntryPoint, &Includer]() {
+            return CompileEntryPoint(Source, EntryPoint, Includer);
+        }));
+    }
+
+    std::vector<std::vector<uint32_t>> Binaries;
+    for (auto& Compilation : Compilations)
+        Binaries.emplace_back(Compilation.get());
+    return Binaries;
+}
+
+// Number of runs averaged for the timings
+constexpr uint32_t TimingIterations = 10;
+
+template <typename FuncType>
+double MeasureTime(FuncType&& Func)
+{
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+    for (uint32_t Iteration = 0; Iteration < TimingIterations; ++Iteration)
+        Func();
+    const auto EndTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(EndTime - StartTime).count() / TimingIterations;
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        VirtualFileIncluder Includer{{{"Common.hlsl", HLSL::CommonH}}};
+
+        const std::vector<EntryPointDesc> EntryPoints = {
+            {"VSMain", EShLangVertex},
+            {"PSMain", EShLangFragment},
+            {"CSMain", EShLangCompute},
+        };
+
+        const MultiEntryPointJob Job{HLSL::MaterialFX, EntryPoints};
+
+        const auto Result = Job.Run(Includer);
+        for (const auto& WGSL : Result.WGSLModules)
+            std::cout << WGSL << "\n";
+
+        // Both paths compile the entry points in parallel and convert every one of them into
+        // its own WGSL module, so they only differ in how often the file is preprocessed.
+        // Linking is not timed.
+        const auto ConvertAll = [](const std::vector<std::vector<uint32_t>>& Binaries) {
+            for (const auto& SPIRV : Binaries)
+                ConvertSPIRVtoWGSL(SPIRV);
+        };
+        const auto RunSeparate = [&]() { ConvertAll(CompileEntryPointsSeparately(HLSL::MaterialFX, EntryPoints, Includer)); };
+        const auto RunShared   = [&]() { ConvertAll(Job.CompileEntryPoints(Includer)); };
+
+        // The first runs also count the include resolutions, and warm up glslang's and Tint's tables
+        uint32_t NumResolved = Includer.GetNumResolved();
+        RunSeparate();
+        const uint32_t SeparateIncludes = Includer.GetNumResolved() - NumResolved;
+        NumResolved                     = Includer.GetNumResolved();
+        RunShared();
+        const uint32_t SharedIncludes = Includer.GetNumResolved() - NumResolved;
+
+        const double SeparateTime = MeasureTime(RunSeparate);
+        const double SharedTime   = MeasureTime(RunShared);
+
+        LOG_INFO_MESSAGE("Preprocessing per entry point: ", SeparateTime, " ms, ", SeparateIncludes, " include resolutions");
+        LOG_INFO_MESSAGE("Preprocessing once:            ", SharedTime, " ms, ", SharedIncludes, " include resolutions");
+        LOG_INFO_MESSAGE("Multi-entry-point job output:  ", Result.WGSLModules.size(), (Result.IsLinked ? " linked module" : " modules (fallback)"));
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
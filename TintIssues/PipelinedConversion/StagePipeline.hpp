@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+// Blocking FIFO with a fixed capacity. Push blocks while the queue is full, which is what
+// propagates backpressure from a slow stage to the stages in front of it.
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t Capacity) :
+        m_Capacity{std::max<size_t>(Capacity, 1)}
+    {}
+
+    // Returns false if the queue was closed
+    bool Push(T Item)
+    {
+        std::unique_lock<std::mutex> Lock{m_Mtx};
+        m_NotFullCV.wait(Lock, [this]() { return m_Items.size() < m_Capacity || m_IsClosed; });
+        if (m_IsClosed)
+            return false;
+
+        m_Items.emplace_back(std::move(Item));
+        m_NotEmptyCV.notify_one();
+        return true;
+    }
+
+    // Returns std::nullopt once the queue is closed and drained
+    std::optional<T> Pop()
+    {
+        std::unique_lock<std::mutex> Lock{m_Mtx};
+        m_NotEmptyCV.wait(Lock, [this]() { return !m_Items.empty() || m_IsClosed; });
+        if (m_Items.empty())
+            return std::nullopt;
+
+        T Item = std::move(m_Items.front());
+        m_Items.pop_front();
+        m_NotFullCV.notify_one();
+        return Item;
+    }
+
+    // Pending items are still delivered by Pop
+    void Close()
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_IsClosed = true;
+        m_NotEmptyCV.notify_all();
+        m_NotFullCV.notify_all();
+    }
+
+private:
+    const size_t            m_Capacity;
+    std::mutex              m_Mtx;
+    std::condition_variable m_NotEmptyCV;
+    std::condition_variable m_NotFullCV;
+    std::deque<T>           m_Items;
+    bool                    m_IsClosed = false;
+};
+
+struct StageStatistics
+{
+    std::string Name;
+    uint32_t    NumWorkers    = 0;
+    uint32_t    NumProcessed  = 0;
+    double      BusyMs        = 0; // Running the stage function
+    double      StarvedMs     = 0; // Waiting for input
+    double      BlockedMs     = 0; // Waiting for space in the next stage's queue, or in the sink
+    double      Utilization   = 0; // BusyMs / (wall time * NumWorkers)
+    double      AverageCostMs = 0; // BusyMs / NumProcessed
+};
+
+struct StagePipelineStatistics
+{
+    double                       WallMs = 0;
+    std::vector<StageStatistics> Stages;
+
+    // Stage with the highest utilization
+    const StageStatistics* GetBottleneck() const
+    {
+        auto It = std::max_element(Stages.begin(), Stages.end(), [](const StageStatistics& A, const StageStatistics& B) { return A.Utilization < B.Utilization; });
+        return It != Stages.end() ? &*It : nullptr;
+    }
+
+    // Splits TotalWorkers between the stages proportionally to their average cost per item,
+    // which balances the stage throughputs. Every stage gets at least one worker.
+    std::vector<uint32_t> SuggestWorkerSplit(uint32_t TotalWorkers) const
+    {
+        double TotalCost = 0;
+        for (const auto& Stage : Stages)
+            TotalCost += Stage.AverageCostMs;
+
+        std::vector<uint32_t> Split(Stages.size(), 1);
+        if (TotalCost <= 0 || TotalWorkers <= Stages.size())
+            return Split;
+
+        // Largest remainder distribution of the workers left after the minimum of one
+        const uint32_t      Spare = TotalWorkers - static_cast<uint32_t>(Stages.size());
+        std::vector<double> Remainders(Stages.size());
+        uint32_t            Assigned = 0;
+        for (size_t i = 0; i < Stages.size(); ++i)
+        {
+            const double Share = Spare * Stages[i].AverageCostMs / TotalCost;
+            Split[i] += static_cast<uint32_t>(Share);
+            Assigned += static_cast<uint32_t>(Share);
+            Remainders[i] = Share - static_cast<uint32_t>(Share);
+        }
+        for (; Assigned < Spare; ++Assigned)
+        {
+            const size_t i = std::max_element(Remainders.begin(), Remainders.end()) - Remainders.begin();
+            ++Split[i];
+            Remainders[i] = -1;
+        }
+        return Split;
+    }
+};
+
+// Runs items through a sequence of stages. Every stage has its own group of worker threads
+// and its own bounded input queue, so at most
+//   sum(QueueCapacity) + sum(NumWorkers)
+// items are in flight no matter how many are submitted. Items are passed between stages as
+// std::unique_ptr<ItemType>, so a stage can move large intermediate results (SPIR-V, WGSL)
+// into the item without copying.
+//
+// A stage function that throws marks the item as failed through OnError; the item then skips
+// the remaining stages and is delivered to the sink as is.
+template <typename ItemType>
+class StagePipeline
+{
+public:
+    using ItemPtr       = std::unique_ptr<ItemType>;
+    using StageFunction = std::function<void(ItemType&)>;
+    using ErrorFunction = std::function<void(ItemType&, const std::exception&)>;
+    using SinkFunction  = std::function<void(ItemPtr)>;
+
+    struct StageDesc
+    {
+        std::string   Name;
+        uint32_t      NumWorkers    = 1;
+        size_t        QueueCapacity = 4;
+        StageFunction Function;
+    };
+
+    StagePipeline(std::vector<StageDesc> Stages, ErrorFunction OnError) :
+        m_Stages{std::move(Stages)},
+        m_OnError{std::move(OnError)}
+    {
+        if (m_Stages.empty())
+            throw std::invalid_argument("Stage pipeline needs at least one stage");
+    }
+
+    // Feeds Items through all stages and hands every finished item to Sink. Sink is called
+    // from the workers of the last stage and must be thread-safe.
+    StagePipelineStatistics Run(std::vector<ItemPtr> Items, const SinkFunction& Sink)
+    {
+        struct Envelope
+        {
+            ItemPtr pItem;
+            bool    IsFailed = false;
+        };
+
+        struct StageState
+        {
+            BoundedQueue<Envelope> Input;
+            std::mutex             StatsMtx;
+            StageStatistics        Stats;
+
+            explicit StageState(size_t Capacity) :
+                Input{Capacity}
+            {}
+        };
+
+        std::vector<std::unique_ptr<StageState>> States;
+        for (const auto& Stage : m_Stages)
+        {
+            States.emplace_back(std::make_unique<StageState>(Stage.QueueCapacity));
+            States.back()->Stats.Name       = Stage.Name;
+            States.back()->Stats.NumWorkers = std::max(Stage.NumWorkers, 1u);
+        }
+
+        const auto StartTime = Clock::now();
+
+        std::vector<std::vector<std::thread>> Workers(m_Stages.size());
+        for (size_t StageIdx = 0; StageIdx < m_Stages.size(); ++StageIdx)
+        {
+            for (uint32_t i = 0; i < States[StageIdx]->Stats.NumWorkers; ++i)
+            {
+                Workers[StageIdx].emplace_back([&, StageIdx]() {
+                    auto& State = *States[StageIdx];
+                    auto* pNext = StageIdx + 1 < States.size() ? States[StageIdx + 1].get() : nullptr;
+
+                    double   BusyMs = 0, StarvedMs = 0, BlockedMs = 0;
+                    uint32_t NumProcessed = 0;
+                    for (;;)
+                    {
+                        auto WaitStart = Clock::now();
+                        auto Item      = State.Input.Pop();
+                        StarvedMs += ElapsedMs(WaitStart);
+                        if (!Item)
+                            break;
+
+                        if (!Item->IsFailed)
+                        {
+                            const auto WorkStart = Clock::now();
+                            try
+                            {
+                                m_Stages[StageIdx].Function(*Item->pItem);
+                            }
+                            catch (const std::exception& Error)
+                            {
+                                m_OnError(*Item->pItem, Error);
+                                Item->IsFailed = true;
+                            }
+                            BusyMs += ElapsedMs(WorkStart);
+                            ++NumProcessed;
+                        }
+
+                        WaitStart = Clock::now();
+                        if (pNext != nullptr)
+                            pNext->Input.Push(std::move(*Item));
+                        else
+                            Sink(std::move(Item->pItem));
+                        BlockedMs += ElapsedMs(WaitStart);
+                    }
+
+                    std::lock_guard<std::mutex> Lock{State.StatsMtx};
+                    State.Stats.BusyMs += BusyMs;
+                    State.Stats.StarvedMs += StarvedMs;
+                    State.Stats.BlockedMs += BlockedMs;
+                    State.Stats.NumProcessed += NumProcessed;
+                });
+            }
+        }
+
+        // The feeder blocks as soon as the first stage's queue is full
+        for (auto& Item : Items)
+            States.front()->Input.Push(Envelope{std::move(Item)});
+
+        // Shut the stages down front to back: a stage's queue is closed only after every
+        // worker of the previous stage has pushed its last item.
+        for (size_t StageIdx = 0; StageIdx < m_Stages.size(); ++StageIdx)
+        {
+            States[StageIdx]->Input.Close();
+            for (auto& Worker : Workers[StageIdx])
+                Worker.join();
+        }
+
+        StagePipelineStatistics Stats;
+        Stats.WallMs = ElapsedMs(StartTime);
+        for (auto& State : States)
+        {
+            auto& Stage         = State->Stats;
+            Stage.Utilization   = Stats.WallMs > 0 ? Stage.BusyMs / (Stats.WallMs * Stage.NumWorkers) : 0;
+            Stage.AverageCostMs = Stage.NumProcessed > 0 ? Stage.BusyMs / Stage.NumProcessed : 0;
+            Stats.Stages.emplace_back(std::move(Stage));
+        }
+
+        return Stats;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static double ElapsedMs(Clock::time_point Start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+    }
+
+private:
+    const std::vector<StageDesc> m_Stages;
+    const ErrorFunction          m_OnError;
+};
@@ -0,0 +1,511 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+
+#include "StagePipeline.hpp"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string GenerateMipsCS = R"(
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+// The reason for separating channels is to reduce bank conflicts in the
+// local data memory controller.  A large stride will cause more threads
+// to collide on the same memory bank.
+groupshared float gs_R[64];
+groupshared float gs_G[64];
+groupshared float gs_B[64];
+groupshared float gs_A[64];
+
+void StoreColor(uint Index, float4 Color)
+{
+    gs_R[Index] = Color.r;
+    gs_G[Index] = Color.g;
+    gs_B[Index] = Color.b;
+    gs_A[Index] = Color.a;
+}
+
+float4 LoadColor(uint Index)
+{
+    return float4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);
+}
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+[numthreads(8, 8, 1)] 
+void main(uint GI : SV_GroupIndex, uint3 DTid: SV_DispatchThreadID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    bool IsValidThread = all(DTid.xy < DstMipSize);
+    uint ArraySlice    = FirstArraySlice + DTid.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+        // One bilinear sample is insufficient when scaling down by more than 2x.
+        // You will slightly undersample in the case where the source dimension
+        // is odd.  This is why it's a really good idea to only generate mips on
+        // power-of-two sized textures.  Trying to handle the undersampling case
+        // will force this shader to be slower and more complicated as it will
+        // have to take more source texture samples.
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (DTid.xy + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        // > 2:1 in X dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // horizontally.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        // > 2:1 in Y dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // vertically.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        // > 2:1 in in both dimensions
+        // Use 4 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // in both directions.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(DTid.xy, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    if (IsValidThread)
+    {
+        // Without lane swizzle operations, the only way to share data with other
+        // threads is through LDS.
+        StoreColor(GI, Src1);
+    }
+
+    // This guarantees all LDS writes are complete and that all threads have
+    // executed all instructions so far (and therefore have issued their LDS
+    // write instructions.)
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // With low three bits for X and high three bits for Y, this bit mask
+        // (binary: 001001) checks that X and Y are even.
+        if ((GI & 0x9) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x01);
+            float4 Src3 = LoadColor(GI + 0x08);
+            float4 Src4 = LoadColor(GI + 0x09);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip2[uint3(DTid.xy / 2, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 2)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask (binary: 011011) checks that X and Y are multiples of four.
+        if ((GI & 0x1B) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x02);
+            float4 Src3 = LoadColor(GI + 0x10);
+            float4 Src4 = LoadColor(GI + 0x12);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip3[uint3(DTid.xy / 4, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 3)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask would be 111111 (X & Y multiples of 8), but only one
+        // thread fits that criteria.
+        if (GI == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x04);
+            float4 Src3 = LoadColor(GI + 0x20);
+            float4 Src4 = LoadColor(GI + 0x24);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip4[uint3(DTid.xy / 8, ArraySlice)] = PackColor(Src1);
+        }
+    }
+}
+
+)";
+;
+} // namespace HLSL
+
+struct ConversionJob
+{
+    uint32_t              Id = 0;
+    std::string           Preamble;
+    std::vector<uint32_t> SPIRV;
+    std::string           WGSL;
+    std::string           Error;
+};
+
+// Front-end stage: glslang parse, link and SPIR-V generation
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const std::string& Preamble)
+{
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+    return SPIRV;
+}
+
+// Optimizer stage
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+// Tint stage. Tint is initialized once in main(): conversions run on several threads.
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+std::vector<std::unique_ptr<ConversionJob>> CreateJobs(uint32_t NumJobs)
+{
+    std::vector<std::unique_ptr<ConversionJob>> Jobs;
+    for (uint32_t JobIdx = 0; JobIdx < NumJobs; ++JobIdx)
+    {
+        auto pJob = std::make_unique<ConversionJob>();
+        pJob->Id  = JobIdx;
+
+        // Cycle through the 8 permutations of the shader
+        pJob->Preamble = ConcatenateArgs("#define NON_POWER_OF_TWO ", JobIdx % 4, "\n");
+        if ((JobIdx / 4) % 2 != 0)
+            pJob->Preamble += "#define CONVERT_TO_SRGB\n";
+        Jobs.emplace_back(std::move(pJob));
+    }
+    return Jobs;
+}
+
+// Baseline: every thread runs whole jobs
+double RunJobPerThread(std::vector<std::unique_ptr<ConversionJob>>& Jobs, uint32_t NumThreads)
+{
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    std::atomic<size_t>      NextJob{0};
+    std::vector<std::thread> Threads;
+    for (uint32_t i = 0; i < NumThreads; ++i)
+    {
+        Threads.emplace_back([&]() {
+            for (size_t JobIdx = NextJob++; JobIdx < Jobs.size(); JobIdx = NextJob++)
+            {
+                auto& Job = *Jobs[JobIdx];
+                try
+                {
+                    Job.WGSL = ConvertSPIRVtoWGSL(OptimizeSPIRV(ConvertHLSLtoSPIRV(HLSL::GenerateMipsCS, Job.Preamble), SPV_ENV_VULKAN_1_0));
+                }
+                catch (const std::exception& Error)
+                {
+                    Job.Error = Error.what();
+                }
+            }
+        });
+    }
+    for (auto& Thread : Threads)
+        Thread.join();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+std::vector<uint32_t> ParseWorkerCounts(const std::string& Arg)
+{
+    std::vector<uint32_t> Counts;
+    std::istringstream    Stream{Arg};
+    for (std::string Count; std::getline(Stream, Count, ',');)
+        Counts.push_back(static_cast<uint32_t>(std::stoul(Count)));
+    if (Counts.size() != 3)
+        LOG_ERROR_AND_THROW("Expected three worker counts (front-end,optimizer,tint), got '", Arg, "'");
+    if (std::find(Counts.begin(), Counts.end(), 0u) != Counts.end())
+        LOG_ERROR_AND_THROW("Every stage needs at least one worker, got '", Arg, "'");
+    return Counts;
+}
+
+// Usage: PipelinedConversion [--jobs N] [--workers FE,OPT,TINT] [--queue N]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        const uint32_t        NumThreads    = std::max(std::thread::hardware_concurrency(), 3u);
+        uint32_t              NumJobs       = 64;
+        size_t                QueueCapacity = 4;
+        std::vector<uint32_t> NumWorkers    = {NumThreads / 3, NumThreads / 3, NumThreads - 2 * (NumThreads / 3)};
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--jobs" && i + 1 < argc)
+                NumJobs = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (Arg == "--workers" && i + 1 < argc)
+                NumWorkers = ParseWorkerCounts(argv[++i]);
+            else if (Arg == "--queue" && i + 1 < argc)
+                QueueCapacity = std::stoul(argv[++i]);
+            else
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+        }
+
+        TintInitializer   TintScope{};
+        GlslangInitilizer GlslangScope{};
+
+        auto         BaselineJobs = CreateJobs(NumJobs);
+        const double BaselineMs   = RunJobPerThread(BaselineJobs, NumWorkers[0] + NumWorkers[1] + NumWorkers[2]);
+
+        StagePipeline<ConversionJob> Pipeline{
+            {
+                {"glslang", NumWorkers[0], QueueCapacity, [](ConversionJob& Job) { Job.SPIRV = ConvertHLSLtoSPIRV(HLSL::GenerateMipsCS, Job.Preamble); }},
+                {"spirv-opt", NumWorkers[1], QueueCapacity, [](ConversionJob& Job) { Job.SPIRV = OptimizeSPIRV(Job.SPIRV, SPV_ENV_VULKAN_1_0); }},
+                {"Tint", NumWorkers[2], QueueCapacity, [](ConversionJob& Job) {
+                     Job.WGSL = ConvertSPIRVtoWGSL(Job.SPIRV);
+                     // Release the intermediate result as early as possible
+                     Job.SPIRV = {};
+                 }},
+            },
+            [](ConversionJob& Job, const std::exception& Error) { Job.Error = Error.what(); },
+        };
+
+        std::mutex                                  ResultsMtx;
+        std::vector<std::unique_ptr<ConversionJob>> Results(NumJobs);
+
+        const auto Stats = Pipeline.Run(CreateJobs(NumJobs), [&](std::unique_ptr<ConversionJob> pJob) {
+            std::lock_guard<std::mutex> Lock{ResultsMtx};
+            Results[pJob->Id] = std::move(pJob);
+        });
+
+        uint32_t NumFailed = 0;
+        for (uint32_t JobIdx = 0; JobIdx < NumJobs; ++JobIdx)
+        {
+            if (!Results[JobIdx]->Error.empty())
+            {
+                LOG_WARNING_MESSAGE("Job ", JobIdx, " failed: ", Results[JobIdx]->Error);
+                ++NumFailed;
+            }
+            else if (Results[JobIdx]->WGSL != BaselineJobs[JobIdx]->WGSL)
+            {
+                LOG_ERROR_AND_THROW("Job ", JobIdx, ": pipelined and job-per-thread conversions produced different WGSL");
+            }
+        }
+
+        std::cout << "Stage       Workers  Processed  Avg cost ms  Busy ms  Starved ms  Blocked ms  Utilization\n";
+        for (const auto& Stage : Stats.Stages)
+        {
+            std::cout << std::left << std::setw(12) << Stage.Name << std::right
+                      << std::setw(7) << Stage.NumWorkers
+                      << std::setw(11) << Stage.NumProcessed
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(13) << Stage.AverageCostMs
+                      << std::setw(9) << Stage.BusyMs
+                      << std::setw(12) << Stage.StarvedMs
+                      << std::setw(12) << Stage.BlockedMs
+                      << std::setw(12) << Stage.Utilization * 100.0 << "%\n";
+        }
+
+        size_t MaxInFlight = 0;
+        for (uint32_t Count : NumWorkers)
+            MaxInFlight += Count + QueueCapacity;
+
+        const uint32_t TotalWorkers = NumWorkers[0] + NumWorkers[1] + NumWorkers[2];
+        const auto     Split        = Stats.SuggestWorkerSplit(TotalWorkers);
+
+        LOG_INFO_MESSAGE("Job per thread: ", BaselineMs, " ms, pipelined: ", Stats.WallMs, " ms for ", NumJobs, " jobs (", NumFailed, " failed, at most ", MaxInFlight, " in flight)");
+        LOG_INFO_MESSAGE("Bottleneck stage: ", Stats.GetBottleneck()->Name, ", suggested split for ", TotalWorkers, " workers: --workers ", Split[0], ",", Split[1], ",", Split[2]);
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,522 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Framing between the pool and its workers. Both ends are built from the same binary, so
+// headers are sent in native layout.
+namespace WorkerProtocol
+{
+
+struct RequestHeader
+{
+    uint32_t Attempt   = 0; // 1 for the first run of a job
+    uint32_t Reserved  = 0;
+    uint64_t InputSize = 0;
+};
+
+enum class ResponseStatus : uint32_t
+{
+    Ok,
+    Failed,      // The handler threw, the output is the error message
+    OutOfMemory, // The handler ran out of address space, the worker exits after responding
+};
+
+struct ResponseHeader
+{
+    ResponseStatus Status     = ResponseStatus::Ok;
+    uint32_t       Reserved   = 0;
+    uint64_t       OutputSize = 0;
+    uint64_t       MaxRssKb   = 0; // Peak resident set size of the worker so far
+};
+
+inline bool WriteAll(int Fd, const void* pData, size_t Size)
+{
+    const auto* pBytes = static_cast<const uint8_t*>(pData);
+    while (Size > 0)
+    {
+        const ssize_t Written = write(Fd, pBytes, Size);
+        if (Written < 0 && errno == EINTR)
+            continue;
+        if (Written <= 0)
+            return false;
+        pBytes += Written;
+        Size -= static_cast<size_t>(Written);
+    }
+    return true;
+}
+
+inline bool ReadAll(int Fd, void* pData, size_t Size)
+{
+    auto* pBytes = static_cast<uint8_t*>(pData);
+    while (Size > 0)
+    {
+        const ssize_t Read = read(Fd, pBytes, Size);
+        if (Read < 0 && errno == EINTR)
+            continue;
+        if (Read <= 0)
+            return false;
+        pBytes += Read;
+        Size -= static_cast<size_t>(Read);
+    }
+    return true;
+}
+
+} // namespace WorkerProtocol
+
+// Converts one job input into its output in the worker process. Attempt is 1 for the first
+// run of the job and grows every time the job is retried after its worker crashed.
+using WorkerJobHandler = std::function<std::string(const std::string& Input, uint32_t Attempt)>;
+
+// Body of a worker process: runs jobs until the pool closes the request pipe. Returns the
+// exit code of the worker.
+inline int RunWorkerLoop(int RequestFd, int ResponseFd, const WorkerJobHandler& Handler)
+{
+    using namespace WorkerProtocol;
+
+    for (RequestHeader Request; ReadAll(RequestFd, &Request, sizeof(Request));)
+    {
+        std::string Input(Request.InputSize, '\0');
+        if (!ReadAll(RequestFd, Input.data(), Input.size()))
+            return 1;
+
+        ResponseHeader Response;
+        std::string    Output;
+        try
+        {
+            Output = Handler(Input, Request.Attempt);
+        }
+        catch (const std::bad_alloc&)
+        {
+            Response.Status = ResponseStatus::OutOfMemory;
+            Output          = "Out of memory";
+        }
+        catch (const std::exception& Error)
+        {
+            Response.Status = ResponseStatus::Failed;
+            Output          = Error.what();
+        }
+
+        rusage Usage{};
+        getrusage(RUSAGE_SELF, &Usage);
+        Response.MaxRssKb   = static_cast<uint64_t>(Usage.ru_maxrss);
+        Response.OutputSize = Output.size();
+        if (!WriteAll(ResponseFd, &Response, sizeof(Response)) || !WriteAll(ResponseFd, Output.data(), Output.size()))
+            return 1;
+
+        // glslang's pool allocator and Tint keep global state that may be inconsistent
+        // after an allocation failed half way: never run another job in this process
+        if (Response.Status == ResponseStatus::OutOfMemory)
+            return 2;
+    }
+    return 0;
+}
+
+struct WorkerPoolDesc
+{
+    // argv of the worker executable. The pool appends the request and response pipe fds,
+    // which the worker passes to RunWorkerLoop().
+    std::vector<std::string> WorkerCommand;
+
+    uint32_t NumWorkers       = 4;
+    uint64_t MemoryLimit      = 0; // RLIMIT_AS of every worker in bytes, 0 for no limit
+    uint32_t MaxJobsPerWorker = 0; // Workers are replaced after that many jobs, 0 to never recycle
+    uint32_t MaxAttempts      = 2; // Runs of a job whose worker keeps crashing before it is marked crashed
+
+    std::chrono::milliseconds JobTimeout{0}; // 0 for no timeout
+};
+
+enum class JobStatus
+{
+    Succeeded,
+    Failed,      // The job reported an error
+    OutOfMemory, // The job exceeded the memory limit
+    Crashed,     // The worker died on every attempt
+    TimedOut,    // The job did not finish in time, its worker was killed
+};
+
+struct JobResult
+{
+    JobStatus   Status   = JobStatus::Failed;
+    std::string Output; // The job output, or the error
+    uint32_t    Attempts = 0;
+};
+
+// Runs jobs in forked worker processes, so that a crash or a runaway allocation in glslang
+// or Tint only takes down the worker. Every worker is served by one dispatcher thread that
+// sends it one job at a time. A worker that dies is replaced and its job is retried up to
+// MaxAttempts times; a worker that exceeds its memory limit is replaced and its job fails,
+// as running it again would fail the same way. Workers are also replaced after
+// MaxJobsPerWorker jobs, which returns the memory fragmented by earlier jobs to the OS.
+class ProcessWorkerPool
+{
+public:
+    struct Statistics
+    {
+        uint32_t Spawned     = 0;
+        uint32_t Recycled    = 0;
+        uint32_t Crashes     = 0;
+        uint32_t OutOfMemory = 0;
+        uint32_t Timeouts    = 0;
+        uint32_t Retries     = 0;
+        uint64_t MaxRssKb    = 0; // Largest peak RSS reported by any worker
+    };
+
+    explicit ProcessWorkerPool(WorkerPoolDesc Desc) :
+        m_Desc{std::move(Desc)}
+    {
+        if (m_Desc.WorkerCommand.empty())
+            throw std::invalid_argument("Worker command is empty");
+        m_Desc.NumWorkers  = std::max(m_Desc.NumWorkers, 1u);
+        m_Desc.MaxAttempts = std::max(m_Desc.MaxAttempts, 1u);
+    }
+
+    // Runs all jobs and returns their results in the order of the inputs
+    std::vector<JobResult> Run(const std::vector<std::string>& Inputs)
+    {
+        m_pInputs = &Inputs;
+        m_NextJob = 0;
+        m_Results.assign(Inputs.size(), JobResult{});
+
+        std::vector<std::thread> Dispatchers;
+        for (size_t i = 0; i < std::min<size_t>(m_Desc.NumWorkers, Inputs.size()); ++i)
+            Dispatchers.emplace_back([this]() { Dispatch(); });
+        for (auto& Dispatcher : Dispatchers)
+            Dispatcher.join();
+
+        m_pInputs = nullptr;
+        return std::move(m_Results);
+    }
+
+    Statistics GetStatistics() const
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        return m_Stats;
+    }
+
+private:
+    class Worker
+    {
+    public:
+        enum class ExchangeResult
+        {
+            Completed,
+            Died,
+            TimedOut,
+        };
+
+        explicit Worker(const WorkerPoolDesc& Desc)
+        {
+            int RequestPipe[2]  = {-1, -1};
+            int ResponsePipe[2] = {-1, -1};
+            // O_CLOEXEC: workers spawned later must not inherit the pipes of this one,
+            // or its death would not be seen as end of file
+            if (pipe2(RequestPipe, O_CLOEXEC) != 0 || pipe2(ResponsePipe, O_CLOEXEC) != 0)
+            {
+                const std::string Error = std::strerror(errno);
+                for (int Fd : {RequestPipe[0], RequestPipe[1], ResponsePipe[0], ResponsePipe[1]})
+                {
+                    if (Fd >= 0)
+                        close(Fd);
+                }
+                throw std::runtime_error("pipe2() failed: " + Error);
+            }
+
+            // Everything the child needs is prepared before fork(): between fork() and
+            // exec() only async-signal-safe functions may be called
+            std::vector<std::string> Args = Desc.WorkerCommand;
+            Args.push_back(std::to_string(RequestPipe[0]));
+            Args.push_back(std::to_string(ResponsePipe[1]));
+            std::vector<char*> Argv;
+            for (auto& Arg : Args)
+                Argv.push_back(Arg.data());
+            Argv.push_back(nullptr);
+
+            const rlimit MemoryLimit{Desc.MemoryLimit, Desc.MemoryLimit};
+
+            m_Pid = fork();
+            if (m_Pid == 0)
+            {
+                fcntl(RequestPipe[0], F_SETFD, 0);
+                fcntl(ResponsePipe[1], F_SETFD, 0);
+                if (Desc.MemoryLimit != 0)
+                    setrlimit(RLIMIT_AS, &MemoryLimit);
+
+                // The dispatcher thread blocks SIGPIPE; the mask would survive exec()
+                sigset_t SignalMask;
+                sigemptyset(&SignalMask);
+                sigprocmask(SIG_SETMASK, &SignalMask, nullptr);
+
+                execv(Argv[0], Argv.data());
+                _exit(127);
+            }
+
+            const int ForkError = errno;
+            close(RequestPipe[0]);
+            close(ResponsePipe[1]);
+            m_RequestFd  = RequestPipe[1];
+            m_ResponseFd = ResponsePipe[0];
+            if (m_Pid < 0)
+            {
+                CloseFds();
+                throw std::runtime_error(std::string{"fork() failed: "} + std::strerror(ForkError));
+            }
+        }
+
+        ~Worker()
+        {
+            Kill();
+        }
+
+        Worker(const Worker&) = delete;
+        Worker& operator=(const Worker&) = delete;
+
+        ExchangeResult Exchange(const std::string& Input, uint32_t Attempt, std::chrono::milliseconds Timeout, WorkerProtocol::ResponseHeader& Response, std::string& Output)
+        {
+            using namespace WorkerProtocol;
+
+            RequestHeader Request;
+            Request.Attempt   = Attempt;
+            Request.InputSize = Input.size();
+            if (!WriteAll(m_RequestFd, &Request, sizeof(Request)) || !WriteAll(m_RequestFd, Input.data(), Input.size()))
+                return ExchangeResult::Died;
+
+            // The timeout covers the whole response, not only its first bytes
+            const auto  Deadline  = std::chrono::steady_clock::now() + Timeout;
+            const auto* pDeadline = Timeout.count() > 0 ? &Deadline : nullptr;
+
+            ExchangeResult Result = ReadResponse(&Response, sizeof(Response), pDeadline);
+            if (Result != ExchangeResult::Completed)
+                return Result;
+            Output.resize(Response.OutputSize);
+            Result = ReadResponse(Output.data(), Output.size(), pDeadline);
+            if (Result != ExchangeResult::Completed)
+                return Result;
+
+            ++m_NumJobs;
+            return ExchangeResult::Completed;
+        }
+
+        // Closing the request pipe asks the worker to exit once it is idle
+        void Stop()
+        {
+            CloseFds();
+            Wait();
+        }
+
+        void Kill()
+        {
+            if (m_Pid > 0)
+                kill(m_Pid, SIGKILL);
+            Stop();
+        }
+
+        // Waits for a worker that died or is exiting and describes how it ended
+        std::string Reap()
+        {
+            CloseFds();
+            const int Status = Wait();
+            if (WIFSIGNALED(Status))
+                return std::string{"Worker was killed by signal "} + std::to_string(WTERMSIG(Status)) + " (" + strsignal(WTERMSIG(Status)) + ")";
+            if (WIFEXITED(Status))
+                return "Worker exited with code " + std::to_string(WEXITSTATUS(Status));
+            return "Worker ended";
+        }
+
+        uint32_t GetNumJobs() const
+        {
+            return m_NumJobs;
+        }
+
+    private:
+        // ReadAll() that gives up at the deadline, if there is one
+        ExchangeResult ReadResponse(void* pData, size_t Size, const std::chrono::steady_clock::time_point* pDeadline)
+        {
+            auto* pBytes = static_cast<uint8_t*>(pData);
+            while (Size > 0)
+            {
+                if (pDeadline != nullptr)
+                {
+                    const auto Remaining = std::chrono::ceil<std::chrono::milliseconds>(*pDeadline - std::chrono::steady_clock::now());
+                    if (Remaining.count() <= 0)
+                        return ExchangeResult::TimedOut;
+
+                    pollfd    PollFd{m_ResponseFd, POLLIN, 0};
+                    const int NumReady = poll(&PollFd, 1, static_cast<int>(Remaining.count()));
+                    if (NumReady < 0 && errno == EINTR)
+                        continue;
+                    if (NumReady == 0)
+                        return ExchangeResult::TimedOut;
+                }
+
+                const ssize_t Read = read(m_ResponseFd, pBytes, Size);
+                if (Read < 0 && errno == EINTR)
+                    continue;
+                if (Read <= 0)
+                    return ExchangeResult::Died;
+                pBytes += Read;
+                Size -= static_cast<size_t>(Read);
+            }
+            return ExchangeResult::Completed;
+        }
+
+        void CloseFds()
+        {
+            for (int* pFd : {&m_RequestFd, &m_ResponseFd})
+            {
+                if (*pFd >= 0)
+                    close(*pFd);
+                *pFd = -1;
+            }
+        }
+
+        int Wait()
+        {
+            int Status = 0;
+            if (m_Pid > 0)
+            {
+                while (waitpid(m_Pid, &Status, 0) < 0 && errno == EINTR)
+                    continue;
+                m_Pid = -1;
+            }
+            return Status;
+        }
+
+    private:
+        pid_t    m_Pid        = -1;
+        int      m_RequestFd  = -1;
+        int      m_ResponseFd = -1;
+        uint32_t m_NumJobs    = 0;
+    };
+
+    void Dispatch()
+    {
+        // Writing to a worker that just died must fail with EPIPE instead of killing the
+        // whole process. Blocking the signal in this thread leaves the rest of the process alone.
+        sigset_t SignalMask;
+        sigemptyset(&SignalMask);
+        sigaddset(&SignalMask, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &SignalMask, nullptr);
+
+        std::unique_ptr<Worker> pWorker;
+        while (true)
+        {
+            size_t JobIdx = 0;
+            {
+                std::lock_guard<std::mutex> Lock{m_Mutex};
+                if (m_NextJob >= m_pInputs->size())
+                    break;
+                JobIdx = m_NextJob++;
+            }
+
+            JobResult& Result = m_Results[JobIdx];
+            for (uint32_t Attempt = 1;; ++Attempt)
+            {
+                if (!pWorker)
+                {
+                    try
+                    {
+                        pWorker = std::make_unique<Worker>(m_Desc);
+                    }
+                    catch (const std::exception& Error)
+                    {
+                        // Out of processes or file descriptors: the job fails, the pool goes on
+                        Result.Status = JobStatus::Failed;
+                        Result.Output = std::string{"Failed to start a worker: "} + Error.what();
+                        break;
+                    }
+                    UpdateStatistics([](Statistics& Stats) { ++Stats.Spawned; });
+                }
+
+                Result.Attempts = Attempt;
+
+                WorkerProtocol::ResponseHeader Response;
+                const auto                     Exchange = pWorker->Exchange((*m_pInputs)[JobIdx], Attempt, m_Desc.JobTimeout, Response, Result.Output);
+                if (Exchange == Worker::ExchangeResult::Completed)
+                {
+                    UpdateStatistics([&](Statistics& Stats) { Stats.MaxRssKb = std::max(Stats.MaxRssKb, Response.MaxRssKb); });
+                    if (Response.Status == WorkerProtocol::ResponseStatus::Ok)
+                    {
+                        Result.Status = JobStatus::Succeeded;
+                    }
+                    else if (Response.Status == WorkerProtocol::ResponseStatus::Failed)
+                    {
+                        Result.Status = JobStatus::Failed;
+                    }
+                    else
+                    {
+                        Result.Status = JobStatus::OutOfMemory;
+                        pWorker->Reap();
+                        pWorker.reset();
+                        UpdateStatistics([](Statistics& Stats) { ++Stats.OutOfMemory; });
+                    }
+
+                    if (pWorker && m_Desc.MaxJobsPerWorker != 0 && pWorker->GetNumJobs() >= m_Desc.MaxJobsPerWorker)
+                    {
+                        pWorker->Stop();
+                        pWorker.reset();
+                        UpdateStatistics([](Statistics& Stats) { ++Stats.Recycled; });
+                    }
+                    break;
+                }
+
+                if (Exchange == Worker::ExchangeResult::TimedOut)
+                {
+                    pWorker.reset();
+                    Result.Status = JobStatus::TimedOut;
+                    Result.Output = "Job did not finish in " + std::to_string(m_Desc.JobTimeout.count()) + " ms";
+                    UpdateStatistics([](Statistics& Stats) { ++Stats.Timeouts; });
+                    break;
+                }
+
+                Result.Output = pWorker->Reap();
+                pWorker.reset();
+                UpdateStatistics([](Statistics& Stats) { ++Stats.Crashes; });
+                if (Attempt >= m_Desc.MaxAttempts)
+                {
+                    Result.Status = JobStatus::Crashed;
+                    break;
+                }
+                UpdateStatistics([](Statistics& Stats) { ++Stats.Retries; });
+            }
+        }
+
+        if (pWorker)
+            pWorker->Stop();
+    }
+
+    template <typename UpdaterType>
+    void UpdateStatistics(UpdaterType&& Updater)
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        Updater(m_Stats);
+    }
+
+private:
+    WorkerPoolDesc m_Desc;
+
+    mutable std::mutex              m_Mutex;
+    const std::vector<std::string>* m_pInputs = nullptr;
+    size_t                          m_NextJob = 0;
+    std::vector<JobResult>          m_Results;
+    Statistics                      m_Stats;
+};
@@ -0,0 +1,501 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <csignal>
+#include <memory>
+
+#include "WorkerPool.hpp"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+
+namespace HLSL
+{
+
+const std::string GenerateMipsCS = R"(
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+// The reason for separating channels is to reduce bank conflicts in the
+// local data memory controller.  A large stride will cause more threads
+// to collide on the same memory bank.
+groupshared float gs_R[64];
+groupshared float gs_G[64];
+groupshared float gs_B[64];
+groupshared float gs_A[64];
+
+void StoreColor(uint Index, float4 Color)
+{
+    gs_R[Index] = Color.r;
+    gs_G[Index] = Color.g;
+    gs_B[Index] = Color.b;
+    gs_A[Index] = Color.a;
+}
+
+float4 LoadColor(uint Index)
+{
+    return float4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);
+}
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+[numthreads(8, 8, 1)] 
+void main(uint GI : SV_GroupIndex, uint3 DTid: SV_DispatchThreadID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    bool IsValidThread = all(DTid.xy < DstMipSize);
+    uint ArraySlice    = FirstArraySlice + DTid.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+        // One bilinear sample is insufficient when scaling down by more than 2x.
+        // You will slightly undersample in the case where the source dimension
+        // is odd.  This is why it's a really good idea to only generate mips on
+        // power-of-two sized textures.  Trying to handle the undersampling case
+        // will force this shader to be slower and more complicated as it will
+        // have to take more source texture samples.
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (DTid.xy + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        // > 2:1 in X dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // horizontally.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        // > 2:1 in Y dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // vertically.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        // > 2:1 in in both dimensions
+        // Use 4 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // in both directions.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(DTid.xy, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    if (IsValidThread)
+    {
+        // Without lane swizzle operations, the only way to share data with other
+        // threads is through LDS.
+        StoreColor(GI, Src1);
+    }
+
+    // This guarantees all LDS writes are complete and that all threads have
+    // executed all instructions so far (and therefore have issued their LDS
+    // write instructions.)
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // With low three bits for X and high three bits for Y, this bit mask
+        // (binary: 001001) checks that X and Y are even.
+        if ((GI & 0x9) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x01);
+            float4 Src3 = LoadColor(GI + 0x08);
+            float4 Src4 = LoadColor(GI + 0x09);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip2[uint3(DTid.xy / 2, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 2)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask (binary: 011011) checks that X and Y are multiples of four.
+        if ((GI & 0x1B) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x02);
+            float4 Src3 = LoadColor(GI + 0x10);
+            float4 Src4 = LoadColor(GI + 0x12);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip3[uint3(DTid.xy / 4, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 3)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask would be 111111 (X & Y multiples of 8), but only one
+        // thread fits that criteria.
+        if (GI == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x04);
+            float4 Src3 = LoadColor(GI + 0x20);
+            float4 Src4 = LoadColor(GI + 0x24);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip4[uint3(DTid.xy / 8, ArraySlice)] = PackColor(Src1);
+        }
+    }
+}
+
+)";
+;
+} // namespace HLSL
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const std::string& Preamble)
+{
+    GlslangInitilizer GlslangScope{};
+    glslang::TShader  Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+    return SPIRV;
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer TintScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+std::vector<std::string> CreatePermutations()
+{
+    std::vector<std::string> Preambles;
+    for (uint32_t PermutationIdx = 0; PermutationIdx < 8; ++PermutationIdx)
+    {
+        std::string Preamble = ConcatenateArgs("#define NON_POWER_OF_TWO ", PermutationIdx % 4, "\n");
+        if (PermutationIdx >= 4)
+            Preamble += "#define CONVERT_TO_SRGB\n";
+        Preambles.emplace_back(std::move(Preamble));
+    }
+    return Preambles;
+}
+
+bool HasDefine(const std::string& Preamble, const char* Name)
+{
+    return Preamble.find(ConcatenateArgs("#define ", Name, "\n")) != std::string::npos;
+}
+
+// Job handler of the workers. The FAULT_* macros stand in for the pathological shaders
+// that crash glslang or Tint, or make them allocate without bound.
+std::string ConvertPermutation(const std::string& Preamble, uint32_t Attempt)
+{
+    if (HasDefine(Preamble, "FAULT_CRASH_ON_FIRST_ATTEMPT") && Attempt == 1)
+        std::raise(SIGSEGV);
+    if (HasDefine(Preamble, "FAULT_CRASH"))
+        std::abort();
+    if (HasDefine(Preamble, "FAULT_EXHAUST_MEMORY"))
+    {
+        std::vector<std::unique_ptr<char[]>> Blocks;
+        while (true)
+            Blocks.emplace_back(new char[64 << 20]);
+    }
+
+    return ConvertSPIRVtoWGSL(OptimizeSPIRV(ConvertHLSLtoSPIRV(HLSL::GenerateMipsCS, Preamble), SPV_ENV_VULKAN_1_0));
+}
+
+const char* GetJobStatusName(JobStatus Status)
+{
+    switch (Status)
+    {
+        case JobStatus::Succeeded: return "succeeded";
+        case JobStatus::Failed: return "failed";
+        case JobStatus::OutOfMemory: return "out of memory";
+        case JobStatus::Crashed: return "crashed";
+        case JobStatus::TimedOut: return "timed out";
+        default: return "unknown";
+    }
+}
+
+void Expect(bool Condition, const char* Description)
+{
+    if (!Condition)
+        LOG_ERROR_AND_THROW("Expected ", Description);
+}
+
+// Usage: ProcessWorkerPool [--workers N] [--memory-limit MB] [--jobs-per-worker N] [--rounds N]
+//        ProcessWorkerPool --worker <request fd> <response fd>   Worker process, started by the pool
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        if (argc == 4 && std::string{argv[1]} == "--worker")
+            return RunWorkerLoop(std::stoi(argv[2]), std::stoi(argv[3]), ConvertPermutation);
+
+        WorkerPoolDesc Desc;
+        Desc.WorkerCommand    = {"/proc/self/exe", "--worker"};
+        Desc.NumWorkers       = std::max(std::thread::hardware_concurrency(), 1u);
+        Desc.MemoryLimit      = uint64_t{2048} << 20;
+        Desc.MaxJobsPerWorker = 8;
+        Desc.MaxAttempts      = 2;
+        Desc.JobTimeout       = std::chrono::seconds{60};
+
+        uint32_t NumRounds = 4;
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const std::string Arg   = argv[i];
+            const uint32_t    Value = static_cast<uint32_t>(std::stoul(argv[i + 1]));
+            if (Arg == "--workers")
+                Desc.NumWorkers = Value;
+            else if (Arg == "--memory-limit")
+                Desc.MemoryLimit = uint64_t{Value} << 20;
+            else if (Arg == "--jobs-per-worker")
+                Desc.MaxJobsPerWorker = Value;
+            else if (Arg == "--rounds")
+                NumRounds = Value;
+            else
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+        }
+        if (argc % 2 == 0)
+            LOG_ERROR_AND_THROW("Missing value of '", argv[argc - 1], "'");
+
+        // Every permutation several times, like the same shaders in many materials of a
+        // large build, followed by the faulty jobs
+        const auto               Permutations = CreatePermutations();
+        std::vector<std::string> Jobs;
+        for (uint32_t Round = 0; Round < NumRounds; ++Round)
+            Jobs.insert(Jobs.end(), Permutations.begin(), Permutations.end());
+
+        const size_t CrashOnceJob = Jobs.size();
+        Jobs.push_back(Permutations[0] + "#define FAULT_CRASH_ON_FIRST_ATTEMPT\n");
+        const size_t CrashJob = Jobs.size();
+        Jobs.push_back(Permutations[0] + "#define FAULT_CRASH\n");
+        // Without a limit, this job would take all memory of the machine
+        const size_t OutOfMemoryJob = Desc.MemoryLimit != 0 ? Jobs.size() : SIZE_MAX;
+        if (Desc.MemoryLimit != 0)
+            Jobs.push_back(Permutations[0] + "#define FAULT_EXHAUST_MEMORY\n");
+
+        ProcessWorkerPool Pool{Desc};
+
+        const auto StartTime = std::chrono::high_resolution_clock::now();
+        const auto Results   = Pool.Run(Jobs);
+        const auto TimeMs    = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+        std::cout << "Job  Status          Attempts  Output\n";
+        for (size_t JobIdx = 0; JobIdx < Results.size(); ++JobIdx)
+        {
+            const auto& Result = Results[JobIdx];
+            if (Result.Status == JobStatus::Succeeded && Result.Attempts == 1)
+                continue;
+            std::cout << std::left << std::setw(5) << JobIdx << std::setw(16) << GetJobStatusName(Result.Status)
+                      << std::setw(10) << Result.Attempts << std::right
+                      << (Result.Status == JobStatus::Succeeded ? std::string{"WGSL"} : Result.Output) << "\n";
+        }
+
+        const auto Stats = Pool.GetStatistics();
+        std::cout << "\n"
+                  << Jobs.size() << " jobs in " << std::fixed << std::setprecision(2) << TimeMs << " ms on " << Desc.NumWorkers << " workers\n"
+                  << "Spawned " << Stats.Spawned << ", recycled " << Stats.Recycled << ", crashes " << Stats.Crashes
+                  << ", retries " << Stats.Retries << ", out of memory " << Stats.OutOfMemory << ", timeouts " << Stats.Timeouts << "\n"
+                  << "Largest worker peak RSS: " << Stats.MaxRssKb / 1024 << " MB\n";
+
+        // The same permutation must produce the same WGSL in whichever worker it ran
+        for (size_t JobIdx = 0; JobIdx < Permutations.size() * NumRounds; ++JobIdx)
+        {
+            Expect(Results[JobIdx].Status == JobStatus::Succeeded, "every permutation to be converted");
+            Expect(Results[JobIdx].Output == Results[JobIdx % Permutations.size()].Output, "identical WGSL for identical permutations");
+        }
+        Expect(Results[CrashOnceJob].Status == JobStatus::Succeeded && Results[CrashOnceJob].Attempts == 2, "the job that crashed once to succeed when retried");
+        Expect(Results[CrashOnceJob].Output == Results[0].Output, "the retried job to produce the same WGSL");
+        Expect(Results[CrashJob].Status == JobStatus::Crashed && Results[CrashJob].Attempts == Desc.MaxAttempts, "the job that always crashes to be marked crashed");
+        if (OutOfMemoryJob != SIZE_MAX)
+            Expect(Results[OutOfMemoryJob].Status == JobStatus::OutOfMemory, "the runaway allocation to hit the memory limit");
+
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <concepts>
+
+#include <spirv/unified1/spirv.hpp11>
+
+// Streaming reader of the module-level sections of a SPIR-V binary.
+//
+// Bindings, decorations and entry points all live in the module header sections, which
+// precede the first OpFunction, so the scanner walks the words once up to that point and
+// never looks at function bodies. Nothing is allocated: the callbacks receive views that
+// point into the binary. When the scanner is created over mutable words
+// (SPIRVBinaryPatcher), the views are mutable too and operands can be patched in place;
+// the word count of an instruction cannot change.
+//
+// The visitor may implement any subset of:
+//   void OnEntryPoint(const EntryPoint&);
+//   void OnExecutionMode(const ExecutionMode&);
+//   void OnName(const Name&);
+//   void OnDecoration(const Decoration&);
+//   void OnVariable(const Variable&);
+//   bool OnInstruction(const Instruction&);   // Return false to stop the scan
+template <typename WordType>
+class BasicSPIRVBinaryScanner
+{
+    static_assert(std::is_same_v<std::remove_const_t<WordType>, uint32_t>, "WordType must be uint32_t or const uint32_t");
+
+public:
+    static constexpr uint32_t HeaderSize = 5;
+    static constexpr uint32_t NoMember   = ~0u;
+
+    struct Instruction
+    {
+        spv::Op   Opcode;
+        uint32_t  WordCount;
+        uint32_t  Offset; // Word offset of the instruction in the binary
+        WordType* pWords; // pWords[0] is the opcode/word count word
+    };
+
+    struct EntryPoint
+    {
+        spv::ExecutionModel Model;
+        uint32_t            Id;
+        std::string_view    Name;
+        WordType*           pInterface; // Ids of the interface variables
+        uint32_t            NumInterface;
+    };
+
+    struct ExecutionMode
+    {
+        uint32_t           EntryPointId;
+        spv::ExecutionMode Mode;
+        WordType*          pLiterals; // OpExecutionMode literals or OpExecutionModeId ids
+        uint32_t           NumLiterals;
+        bool               IsId;
+    };
+
+    struct Name
+    {
+        uint32_t         Target;
+        uint32_t         Member; // NoMember for OpName
+        std::string_view Value;
+    };
+
+    struct Decoration
+    {
+        uint32_t  Target;
+        uint32_t  Member;      // NoMember for OpDecorate
+        WordType* pDecoration; // The decoration enum word, can be rewritten by the patcher
+        WordType* pOperands;   // Decoration literals, e.g. the binding index
+        uint32_t  NumOperands;
+
+        spv::Decoration GetKind() const
+        {
+            return static_cast<spv::Decoration>(*pDecoration);
+        }
+    };
+
+    struct Variable
+    {
+        uint32_t          ResultType;
+        uint32_t          Id;
+        spv::StorageClass StorageClass;
+    };
+
+    BasicSPIRVBinaryScanner(WordType* pWords, size_t NumWords) :
+        m_pWords{pWords},
+        m_NumWords{NumWords}
+    {}
+
+    // Only native-endian modules are accepted
+    bool IsValidHeader() const
+    {
+        return m_pWords != nullptr && m_NumWords >= HeaderSize && m_pWords[0] == spv::MagicNumber;
+    }
+
+    uint32_t GetVersion() const
+    {
+        return IsValidHeader() ? m_pWords[1] : 0;
+    }
+
+    uint32_t GetIdBound() const
+    {
+        return IsValidHeader() ? m_pWords[3] : 0;
+    }
+
+    // Returns false if the binary is malformed. A scan stopped by the visitor is not an error.
+    template <typename VisitorType>
+    bool Scan(VisitorType&& Visitor) const
+    {
+        if (!IsValidHeader())
+            return false;
+
+        for (size_t Offset = HeaderSize; Offset < m_NumWords;)
+        {
+            WordType*      pInst     = m_pWords + Offset;
+            const uint32_t WordCount = pInst[0] >> spv::WordCountShift;
+            if (WordCount == 0 || Offset + WordCount > m_NumWords)
+                return false;
+
+            const Instruction Inst{static_cast<spv::Op>(pInst[0] & spv::OpCodeMask), WordCount, static_cast<uint32_t>(Offset), pInst};
+            Offset += WordCount;
+
+            // Everything that is looked for precedes the function definitions
+            if (Inst.Opcode == spv::Op::OpFunction)
+                break;
+
+            if constexpr (requires { { Visitor.OnInstruction(Inst) } -> std::convertible_to<bool>; })
+            {
+                if (!Visitor.OnInstruction(Inst))
+                    break;
+            }
+
+            if (!Dispatch(Inst, Visitor))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    template <typename VisitorType>
+    static bool Dispatch(const Instruction& Inst, VisitorType& Visitor)
+    {
+        WordType* pOperands = Inst.pWords + 1;
+        uint32_t  NumWords  = Inst.WordCount - 1;
+
+        switch (Inst.Opcode)
+        {
+            case spv::Op::OpEntryPoint:
+                if constexpr (requires(EntryPoint EP) { Visitor.OnEntryPoint(EP); })
+                {
+                    if (NumWords < 3)
+                        return false;
+
+                    const uint32_t NameWords = GetStringWordCount(pOperands + 2, NumWords - 2);
+                    if (NameWords == 0)
+                        return false;
+
+                    Visitor.OnEntryPoint(EntryPoint{
+                        static_cast<spv::ExecutionModel>(pOperands[0]),
+                        pOperands[1],
+                        GetString(pOperands + 2, NameWords),
+                        pOperands + 2 + NameWords,
+                        NumWords - 2 - NameWords,
+                    });
+                }
+                break;
+
+            case spv::Op::OpExecutionMode:
+            case spv::Op::OpExecutionModeId:
+                if constexpr (requires(ExecutionMode EM) { Visitor.OnExecutionMode(EM); })
+                {
+                    if (NumWords < 2)
+                        return false;
+
+                    Visitor.OnExecutionMode(ExecutionMode{
+                        pOperands[0],
+                        static_cast<spv::ExecutionMode>(pOperands[1]),
+                        pOperands + 2,
+                        NumWords - 2,
+                        Inst.Opcode == spv::Op::OpExecutionModeId,
+                    });
+                }
+                break;
+
+            case spv::Op::OpName:
+            case spv::Op::OpMemberName:
+                if constexpr (requires(Name N) { Visitor.OnName(N); })
+                {
+                    const bool     IsMember  = Inst.Opcode == spv::Op::OpMemberName;
+                    const uint32_t FirstWord = IsMember ? 2 : 1;
+                    if (NumWords <= FirstWord)
+                        return false;
+
+                    const uint32_t NameWords = GetStringWordCount(pOperands + FirstWord, NumWords - FirstWord);
+                    if (NameWords == 0)
+                        return false;
+
+                    Visitor.OnName(Name{pOperands[0], IsMember ? pOperands[1] : NoMember, GetString(pOperands + FirstWord, NameWords)});
+                }
+                break;
+
+            case spv::Op::OpDecorate:
+            case spv::Op::OpMemberDecorate:
+                if constexpr (requires(Decoration D) { Visitor.OnDecoration(D); })
+                {
+                    const bool     IsMember       = Inst.Opcode == spv::Op::OpMemberDecorate;
+                    const uint32_t DecorationWord = IsMember ? 2 : 1;
+                    if (NumWords <= DecorationWord)
+                        return false;
+
+                    Visitor.OnDecoration(Decoration{
+                        pOperands[0],
+                        IsMember ? pOperands[1] : NoMember,
+                        pOperands + DecorationWord,
+                        pOperands + DecorationWord + 1,
+                        NumWords - DecorationWord - 1,
+                    });
+                }
+                break;
+
+            case spv::Op::OpVariable:
+                if constexpr (requires(Variable V) { Visitor.OnVariable(V); })
+                {
+                    if (NumWords < 3)
+                        return false;
+
+                    Visitor.OnVariable(Variable{pOperands[0], pOperands[1], static_cast<spv::StorageClass>(pOperands[2])});
+                }
+                break;
+
+            default:
+                break;
+        }
+        return true;
+    }
+
+    // Number of words taken by the nul-terminated literal string, 0 if it is not terminated
+    static uint32_t GetStringWordCount(const uint32_t* pWords, uint32_t MaxWords)
+    {
+        for (uint32_t i = 0; i < MaxWords; ++i)
+        {
+            // Literal strings are packed low-order byte first, which matches the memory
+            // layout on little-endian hosts, so the bytes can be inspected directly.
+            if (std::memchr(pWords + i, 0, sizeof(uint32_t)) != nullptr)
+                return i + 1;
+        }
+        return 0;
+    }
+
+    static std::string_view GetString(const uint32_t* pWords, uint32_t NumWords)
+    {
+        const char* pChars = reinterpret_cast<const char*>(pWords);
+        return std::string_view{pChars, strnlen(pChars, NumWords * sizeof(uint32_t))};
+    }
+
+private:
+    WordType* const m_pWords;
+    const size_t    m_NumWords;
+};
+
+using SPIRVBinaryScanner = BasicSPIRVBinaryScanner<const uint32_t>;
+using SPIRVBinaryPatcher = BasicSPIRVBinaryScanner<uint32_t>;
@@ -0,0 +1,424 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <algorithm>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+
+#include "SPIRVBinaryScanner.hpp"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+// Pixel shader with NumTextures textures and a chain of NumFunctions functions. Unoptimized,
+// it compiles to a large module that is typical for big material libraries.
+std::string GenerateLargePS(uint32_t NumTextures, uint32_t NumFunctions)
+{
+    std::ostringstream Source;
+    Source << "cbuffer Constants\n"
+              "{\n"
+              "    float4x4 g_Transform;\n"
+              "    float4   g_Params[16];\n"
+              "};\n"
+              "SamplerState g_Sampler;\n";
+    for (uint32_t i = 0; i < NumTextures; ++i)
+        Source << "Texture2D<float4> g_Texture" << i << ";\n";
+
+    Source << "float4 Func0(float2 UV) { return g_Texture0.Sample(g_Sampler, UV); }\n";
+    for (uint32_t i = 1; i < NumFunctions; ++i)
+    {
+        Source << "float4 Func" << i << "(float2 UV)\n"
+               << "{\n"
+               << "    float4 Color = g_Texture" << i % NumTextures << ".Sample(g_Sampler, UV * " << i + 1 << ".0);\n"
+               << "    return mul(g_Transform, Color) * g_Params[" << i % 16 << "] + Func" << i - 1 << "(UV.yx) * 0.5;\n"
+               << "}\n";
+    }
+
+    Source << "float4 main(float4 Pos : SV_Position, float2 UV : TEXCOORD0, float4 Color : COLOR0) : SV_Target\n"
+           << "{\n"
+           << "    return Func" << NumFunctions - 1 << "(UV) * Color;\n"
+           << "}\n";
+    return Source.str();
+}
+
+} // namespace HLSL
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, EShLanguage Stage)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{Stage};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    // Not optimized: the unoptimized module is the large one
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+    return SPIRV;
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+// What a cache key or a binding remapper needs from a module, folded into counters and a
+// hash so that the scanner and the IRContext path can be compared without allocating.
+struct ReflectionSummary
+{
+    uint32_t NumEntryPoints    = 0;
+    uint32_t NumExecutionModes = 0;
+    uint32_t NumBindings       = 0;
+    uint32_t NumLocations      = 0;
+    uint32_t NumRowMajor       = 0;
+    uint64_t Hash              = 14695981039346656037ull;
+
+    void Mix(uint32_t Value)
+    {
+        Hash = (Hash ^ Value) * 1099511628211ull;
+    }
+
+    void AddDecoration(uint32_t Target, uint32_t Member, spv::Decoration Decoration, uint32_t Literal)
+    {
+        switch (Decoration)
+        {
+            case spv::Decoration::DescriptorSet:
+            case spv::Decoration::Binding:
+                ++NumBindings;
+                break;
+            case spv::Decoration::Location:
+                ++NumLocations;
+                break;
+            case spv::Decoration::RowMajor:
+                ++NumRowMajor;
+                break;
+            default:
+                return;
+        }
+        Mix(Target);
+        Mix(Member);
+        Mix(static_cast<uint32_t>(Decoration));
+        Mix(Literal);
+    }
+
+    bool operator==(const ReflectionSummary&) const = default;
+};
+
+ReflectionSummary ReflectWithScanner(const std::vector<uint32_t>& SPIRV)
+{
+    struct Visitor
+    {
+        ReflectionSummary Summary;
+
+        void OnEntryPoint(const SPIRVBinaryScanner::EntryPoint& EntryPoint)
+        {
+            ++Summary.NumEntryPoints;
+            Summary.Mix(static_cast<uint32_t>(EntryPoint.Model));
+            Summary.Mix(EntryPoint.Id);
+        }
+
+        void OnExecutionMode(const SPIRVBinaryScanner::ExecutionMode& Mode)
+        {
+            ++Summary.NumExecutionModes;
+            Summary.Mix(Mode.EntryPointId);
+            Summary.Mix(static_cast<uint32_t>(Mode.Mode));
+        }
+
+        void OnDecoration(const SPIRVBinaryScanner::Decoration& Decoration)
+        {
+            Summary.AddDecoration(Decoration.Target, Decoration.Member, Decoration.GetKind(), Decoration.NumOperands > 0 ? Decoration.pOperands[0] : 0);
+        }
+    } Visitor;
+
+    if (!SPIRVBinaryScanner{SPIRV.data(), SPIRV.size()}.Scan(Visitor))
+        LOG_ERROR_AND_THROW("Malformed SPIR-V binary");
+    return Visitor.Summary;
+}
+
+// The same information extracted the way MatrixOrder does it
+ReflectionSummary ReflectWithIRContext(const std::vector<uint32_t>& SPIRV)
+{
+    std::unique_ptr<spvtools::opt::IRContext> Context = spvtools::BuildModule(SPV_ENV_VULKAN_1_0, {}, SPIRV.data(), SPIRV.size());
+    if (!Context)
+        LOG_ERROR_AND_THROW("Failed to parse SPIR-V binary");
+
+    ReflectionSummary Summary;
+    for (const auto& EntryPoint : Context->module()->entry_points())
+    {
+        ++Summary.NumEntryPoints;
+        Summary.Mix(EntryPoint.GetSingleWordInOperand(0));
+        Summary.Mix(EntryPoint.GetSingleWordInOperand(1));
+    }
+    for (const auto& Mode : Context->module()->execution_modes())
+    {
+        ++Summary.NumExecutionModes;
+        Summary.Mix(Mode.GetSingleWordInOperand(0));
+        Summary.Mix(Mode.GetSingleWordInOperand(1));
+    }
+    for (const auto& Annotation : Context->module()->annotations())
+    {
+        if (Annotation.opcode() == spv::Op::OpDecorate)
+        {
+            Summary.AddDecoration(Annotation.GetSingleWordInOperand(0), SPIRVBinaryScanner::NoMember,
+                                  static_cast<spv::Decoration>(Annotation.GetSingleWordInOperand(1)),
+                                  Annotation.NumInOperands() > 2 ? Annotation.GetSingleWordInOperand(2) : 0);
+        }
+        else if (Annotation.opcode() == spv::Op::OpMemberDecorate)
+        {
+            Summary.AddDecoration(Annotation.GetSingleWordInOperand(0), Annotation.GetSingleWordInOperand(1),
+                                  static_cast<spv::Decoration>(Annotation.GetSingleWordInOperand(2)),
+                                  Annotation.NumInOperands() > 3 ? Annotation.GetSingleWordInOperand(3) : 0);
+        }
+    }
+    return Summary;
+}
+
+struct ResourceBinding
+{
+    std::string Name;
+    uint32_t    Set     = 0;
+    uint32_t    Binding = 0;
+};
+
+std::map<uint32_t, ResourceBinding> GetResourceBindings(const std::vector<uint32_t>& SPIRV)
+{
+    struct Visitor
+    {
+        std::map<uint32_t, ResourceBinding> Bindings;
+        std::map<uint32_t, std::string>     Names;
+
+        void OnName(const SPIRVBinaryScanner::Name& Name)
+        {
+            if (Name.Member == SPIRVBinaryScanner::NoMember)
+                Names[Name.Target] = Name.Value;
+        }
+
+        void OnDecoration(const SPIRVBinaryScanner::Decoration& Decoration)
+        {
+            if (Decoration.GetKind() == spv::Decoration::DescriptorSet)
+                Bindings[Decoration.Target].Set = Decoration.pOperands[0];
+            else if (Decoration.GetKind() == spv::Decoration::Binding)
+                Bindings[Decoration.Target].Binding = Decoration.pOperands[0];
+        }
+    } Visitor;
+
+    if (!SPIRVBinaryScanner{SPIRV.data(), SPIRV.size()}.Scan(Visitor))
+        LOG_ERROR_AND_THROW("Malformed SPIR-V binary");
+
+    for (auto& [Id, Binding] : Visitor.Bindings)
+        Binding.Name = Visitor.Names[Id];
+    return Visitor.Bindings;
+}
+
+// Moves every resource of DescriptorSet to another set and shifts its binding, in place
+void RemapDescriptorSet(std::vector<uint32_t>& SPIRV, uint32_t DescriptorSet, uint32_t NewDescriptorSet, uint32_t BindingOffset)
+{
+    // Set and binding are separate decorations, and the binding may come first, so the
+    // variables of the set are found in a first pass.
+    struct SetCollector
+    {
+        const uint32_t        Set;
+        std::vector<uint32_t> Targets;
+
+        void OnDecoration(const SPIRVBinaryScanner::Decoration& Decoration)
+        {
+            if (Decoration.GetKind() == spv::Decoration::DescriptorSet && Decoration.pOperands[0] == Set)
+                Targets.push_back(Decoration.Target);
+        }
+    } Collector{DescriptorSet, {}};
+
+    struct Patcher
+    {
+        const std::vector<uint32_t>& Targets;
+        const uint32_t               NewSet;
+        const uint32_t               BindingOffset;
+
+        void OnDecoration(const SPIRVBinaryPatcher::Decoration& Decoration)
+        {
+            if (std::find(Targets.begin(), Targets.end(), Decoration.Target) == Targets.end())
+                return;
+
+            if (Decoration.GetKind() == spv::Decoration::DescriptorSet)
+                Decoration.pOperands[0] = NewSet;
+            else if (Decoration.GetKind() == spv::Decoration::Binding)
+                Decoration.pOperands[0] += BindingOffset;
+        }
+    };
+
+    if (!SPIRVBinaryScanner{SPIRV.data(), SPIRV.size()}.Scan(Collector) ||
+        !SPIRVBinaryPatcher{SPIRV.data(), SPIRV.size()}.Scan(Patcher{Collector.Targets, NewDescriptorSet, BindingOffset}))
+        LOG_ERROR_AND_THROW("Malformed SPIR-V binary");
+}
+
+template <typename FunctionType>
+double MeasureAverageTime(uint32_t NumIterations, FunctionType&& Function)
+{
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < NumIterations; ++i)
+        Function();
+    return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - StartTime).count() / NumIterations;
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        auto SPIRV = ConvertHLSLtoSPIRV(HLSL::GenerateLargePS(64, 256), EShLangFragment);
+
+        // Both paths must see exactly the same decorations and entry points
+        const auto Summary = ReflectWithScanner(SPIRV);
+        if (!(Summary == ReflectWithIRContext(SPIRV)))
+            LOG_ERROR_AND_THROW("Scanner and IRContext reflection disagree");
+
+        LOG_INFO_MESSAGE("Module: ", SPIRV.size() * sizeof(uint32_t), " bytes, ", Summary.NumEntryPoints, " entry point(s), ",
+                         Summary.NumExecutionModes, " execution mode(s), ", Summary.NumBindings, " set/binding decorations, ",
+                         Summary.NumLocations, " locations, ", Summary.NumRowMajor, " row-major members");
+
+        constexpr uint32_t NumIterations = 200;
+
+        volatile uint64_t Sink        = 0;
+        const double      ScannerUs   = MeasureAverageTime(NumIterations, [&]() { Sink = Sink + ReflectWithScanner(SPIRV).Hash; });
+        const double      IRContextUs = MeasureAverageTime(NumIterations, [&]() { Sink = Sink + ReflectWithIRContext(SPIRV).Hash; });
+
+        LOG_INFO_MESSAGE("Scanner:   ", std::fixed, std::setprecision(1), ScannerUs, " us");
+        LOG_INFO_MESSAGE("IRContext: ", std::fixed, std::setprecision(1), IRContextUs, " us (", IRContextUs / ScannerUs, "x slower)");
+
+        // Move set 0 to set 1 and shift its bindings, then make sure the module is still valid
+        RemapDescriptorSet(SPIRV, 0, 1, 16);
+
+        spvtools::SpirvTools Tools{SPV_ENV_VULKAN_1_0};
+        if (!Tools.Validate(SPIRV))
+            LOG_ERROR_AND_THROW("Patched SPIR-V failed validation");
+
+        for (const auto& [Id, Binding] : GetResourceBindings(SPIRV))
+            std::cout << "%" << Id << " " << Binding.Name << ": set " << Binding.Set << ", binding " << Binding.Binding << "\n";
+
+        auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+        if (OptimizedSPIRV.empty())
+            LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+        std::cout << ConvertSPIRVtoWGSL(OptimizedSPIRV) << "\n";
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+
+// Texture samples on both sides of one structured selection
+struct BranchCost
+{
+    std::string           Header; // Header block, e.g. '%52'
+    std::vector<uint64_t> TargetSamples;
+};
+
+// Static cost of one entry point. Metrics are kept as an ordered name/value list so that
+// the JSON writer and the diff don't need to know about individual counters.
+struct EntryPointCost
+{
+    std::string                                   Shader;
+    std::string                                   EntryPoint;
+    std::string                                   Stage;
+    std::vector<std::pair<std::string, uint64_t>> Metrics;
+    std::vector<BranchCost>                       Branches;
+
+    std::string GetKey() const
+    {
+        return Shader + "/" + EntryPoint;
+    }
+
+    const uint64_t* FindMetric(const std::string& Name) const
+    {
+        for (const auto& Metric : Metrics)
+        {
+            if (Metric.first == Name)
+                return &Metric.second;
+        }
+        return nullptr;
+    }
+};
+
+using ShaderCostReport = std::vector<EntryPointCost>;
+
+namespace CostReportJson
+{
+
+inline std::string Escape(const std::string& Str)
+{
+    std::string Result;
+    for (char c : Str)
+    {
+        if (c == '"' || c == '\\')
+            Result += '\\';
+        Result += c;
+    }
+    return Result;
+}
+
+inline std::string Write(const ShaderCostReport& Report)
+{
+    std::ostringstream Json;
+    Json << "{\n  \"shaders\": [";
+    for (size_t EntryIdx = 0; EntryIdx < Report.size(); ++EntryIdx)
+    {
+        const auto& Entry = Report[EntryIdx];
+        Json << (EntryIdx > 0 ? "," : "") << "\n    {\n"
+             << "      \"shader\": \"" << Escape(Entry.Shader) << "\",\n"
+             << "      \"entry_point\": \"" << Escape(Entry.EntryPoint) << "\",\n"
+             << "      \"stage\": \"" << Escape(Entry.Stage) << "\",\n"
+             << "      \"metrics\": {";
+        for (size_t MetricIdx = 0; MetricIdx < Entry.Metrics.size(); ++MetricIdx)
+            Json << (MetricIdx > 0 ? ", " : " ") << "\"" << Escape(Entry.Metrics[MetricIdx].first) << "\": " << Entry.Metrics[MetricIdx].second;
+        Json << " },\n"
+             << "      \"branches\": [";
+        for (size_t BranchIdx = 0; BranchIdx < Entry.Branches.size(); ++BranchIdx)
+        {
+            const auto& Branch = Entry.Branches[BranchIdx];
+            Json << (BranchIdx > 0 ? "," : "") << "\n        { \"header\": \"" << Escape(Branch.Header) << "\", \"samples\": [";
+            for (size_t TargetIdx = 0; TargetIdx < Branch.TargetSamples.size(); ++TargetIdx)
+                Json << (TargetIdx > 0 ? ", " : "") << Branch.TargetSamples[TargetIdx];
+            Json << "] }";
+        }
+        Json << (Entry.Branches.empty() ? "]\n" : "\n      ]\n") << "    }";
+    }
+    Json << "\n  ]\n}\n";
+    return Json.str();
+}
+
+// Minimal reader for the format produced by Write(). Objects are read generically, unknown
+// keys are skipped so that reports from newer builds can still be compared.
+class Reader
+{
+public:
+    explicit Reader(const std::string& Json) :
+        m_Json{Json}
+    {}
+
+    ShaderCostReport Read()
+    {
+        ShaderCostReport Report;
+        ReadObject([&](const std::string& Key) {
+            if (Key != "shaders")
+                return SkipValue();
+
+            ReadArray([&]() {
+                EntryPointCost Entry;
+                ReadObject([&](const std::string& EntryKey) {
+                    if (EntryKey == "shader")
+                        Entry.Shader = ReadString();
+                    else if (EntryKey == "entry_point")
+                        Entry.EntryPoint = ReadString();
+                    else if (EntryKey == "stage")
+                        Entry.Stage = ReadString();
+                    else if (EntryKey == "metrics")
+                        ReadObject([&](const std::string& Name) { Entry.Metrics.emplace_back(Name, ReadNumber()); });
+                    else if (EntryKey == "branches")
+                        ReadArray([&]() {
+                            BranchCost Branch;
+                            ReadObject([&](const std::string& BranchKey) {
+                                if (BranchKey == "header")
+                                    Branch.Header = ReadString();
+                                else if (BranchKey == "samples")
+                                    ReadArray([&]() { Branch.TargetSamples.push_back(ReadNumber()); });
+                                else
+                                    SkipValue();
+                            });
+                            Entry.Branches.emplace_back(std::move(Branch));
+                        });
+                    else
+                        SkipValue();
+                });
+                Report.emplace_back(std::move(Entry));
+            });
+        });
+        return Report;
+    }
+
+private:
+    void SkipWhitespace()
+    {
+        while (m_Pos < m_Json.size() && std::isspace(static_cast<unsigned char>(m_Json[m_Pos])))
+            ++m_Pos;
+    }
+
+    char Peek()
+    {
+        SkipWhitespace();
+        return m_Pos < m_Json.size() ? m_Json[m_Pos] : '\0';
+    }
+
+    void Expect(char c)
+    {
+        if (Peek() != c)
+            throw std::runtime_error(std::string{"Malformed cost report: expected '"} + c + "' at offset " + std::to_string(m_Pos));
+        ++m_Pos;
+    }
+
+    std::string ReadString()
+    {
+        Expect('"');
+        std::string Result;
+        while (m_Pos < m_Json.size() && m_Json[m_Pos] != '"')
+        {
+            if (m_Json[m_Pos] == '\\' && m_Pos + 1 < m_Json.size())
+                ++m_Pos;
+            Result += m_Json[m_Pos++];
+        }
+        Expect('"');
+        return Result;
+    }
+
+    uint64_t ReadNumber()
+    {
+        SkipWhitespace();
+        size_t Length = 0;
+        double Value  = std::stod(m_Json.substr(m_Pos, 32), &Length);
+        m_Pos += Length;
+        return static_cast<uint64_t>(Value);
+    }
+
+    template <typename HandlerType>
+    void ReadObject(HandlerType&& Handler)
+    {
+        Expect('{');
+        if (Peek() == '}')
+        {
+            ++m_Pos;
+            return;
+        }
+        for (;;)
+        {
+            const std::string Key = ReadString();
+            Expect(':');
+            Handler(Key);
+            if (Peek() != ',')
+                break;
+            ++m_Pos;
+        }
+        Expect('}');
+    }
+
+    template <typename HandlerType>
+    void ReadArray(HandlerType&& Handler)
+    {
+        Expect('[');
+        if (Peek() == ']')
+        {
+            ++m_Pos;
+            return;
+        }
+        for (;;)
+        {
+            Handler();
+            if (Peek() != ',')
+                break;
+            ++m_Pos;
+        }
+        Expect(']');
+    }
+
+    void SkipValue()
+    {
+        switch (Peek())
+        {
+            case '{': ReadObject([&](const std::string&) { SkipValue(); }); break;
+            case '[': ReadArray([&]() { SkipValue(); }); break;
+            case '"': ReadString(); break;
+            default:
+                while (m_Pos < m_Json.size() && m_Json[m_Pos] != ',' && m_Json[m_Pos] != '}' && m_Json[m_Pos] != ']')
+                    ++m_Pos;
+        }
+    }
+
+private:
+    const std::string& m_Json;
+    size_t             m_Pos = 0;
+};
+
+inline ShaderCostReport Load(const std::string& FilePath)
+{
+    std::ifstream File{FilePath};
+    if (!File)
+        throw std::runtime_error("Failed to open cost report '" + FilePath + "'");
+
+    std::stringstream Buffer;
+    Buffer << File.rdbuf();
+    const std::string Json = Buffer.str();
+    return Reader{Json}.Read();
+}
+
+} // namespace CostReportJson
+
+// Prints per-metric changes between two reports. Every metric is "lower is better", so an
+// increase above ThresholdPercent is reported as a regression. Returns the number of regressions.
+inline uint32_t DiffCostReports(const ShaderCostReport& Base, const ShaderCostReport& Current, double ThresholdPercent, std::ostream& Output)
+{
+    uint32_t NumRegressions = 0;
+    for (const auto& Entry : Current)
+    {
+        const EntryPointCost* pBase = nullptr;
+        for (const auto& BaseEntry : Base)
+        {
+            if (BaseEntry.GetKey() == Entry.GetKey())
+                pBase = &BaseEntry;
+        }
+        if (pBase == nullptr)
+        {
+            Output << Entry.GetKey() << ": new entry point\n";
+            continue;
+        }
+
+        Output << Entry.GetKey() << ":\n";
+        for (const auto& Metric : Entry.Metrics)
+        {
+            const uint64_t* pBaseValue = pBase->FindMetric(Metric.first);
+            if (pBaseValue == nullptr)
+            {
+                Output << "    " << std::left << std::setw(20) << Metric.first << "(new) " << Metric.second << "\n";
+                continue;
+            }
+            if (*pBaseValue == Metric.second)
+                continue;
+
+            const double Delta        = static_cast<double>(Metric.second) - static_cast<double>(*pBaseValue);
+            const double DeltaPercent = *pBaseValue != 0 ? Delta * 100.0 / static_cast<double>(*pBaseValue) : INFINITY;
+            const bool   IsRegression = Delta > 0 && DeltaPercent > ThresholdPercent;
+
+            Output << "    " << std::left << std::setw(20) << Metric.first << *pBaseValue << " -> " << Metric.second
+                   << " (" << (Delta > 0 ? "+" : "") << std::fixed << std::setprecision(1) << DeltaPercent << "%)"
+                   << (IsRegression ? "  REGRESSION" : "") << "\n";
+            Output.unsetf(std::ios::floatfield);
+            NumRegressions += IsRegression ? 1 : 0;
+        }
+    }
+
+    for (const auto& BaseEntry : Base)
+    {
+        bool IsFound = false;
+        for (const auto& Entry : Current)
+            IsFound = IsFound || Entry.GetKey() == BaseEntry.GetKey();
+        if (!IsFound)
+            Output << BaseEntry.GetKey() << ": removed\n";
+    }
+    return NumRegressions;
+}
@@ -0,0 +1,866 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opcode.h"
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+
+#include "ShaderCostReport.hpp"
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string GenerateMipsCS = R"(
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+// The reason for separating channels is to reduce bank conflicts in the
+// local data memory controller.  A large stride will cause more threads
+// to collide on the same memory bank.
+groupshared float gs_R[64];
+groupshared float gs_G[64];
+groupshared float gs_B[64];
+groupshared float gs_A[64];
+
+void StoreColor(uint Index, float4 Color)
+{
+    gs_R[Index] = Color.r;
+    gs_G[Index] = Color.g;
+    gs_B[Index] = Color.b;
+    gs_A[Index] = Color.a;
+}
+
+float4 LoadColor(uint Index)
+{
+    return float4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);
+}
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+[numthreads(8, 8, 1)] 
+void main(uint GI : SV_GroupIndex, uint3 DTid: SV_DispatchThreadID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    bool IsValidThread = all(DTid.xy < DstMipSize);
+    uint ArraySlice    = FirstArraySlice + DTid.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+        // One bilinear sample is insufficient when scaling down by more than 2x.
+        // You will slightly undersample in the case where the source dimension
+        // is odd.  This is why it's a really good idea to only generate mips on
+        // power-of-two sized textures.  Trying to handle the undersampling case
+        // will force this shader to be slower and more complicated as it will
+        // have to take more source texture samples.
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (DTid.xy + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        // > 2:1 in X dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // horizontally.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        // > 2:1 in Y dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // vertically.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        // > 2:1 in in both dimensions
+        // Use 4 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // in both directions.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(DTid.xy, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    if (IsValidThread)
+    {
+        // Without lane swizzle operations, the only way to share data with other
+        // threads is through LDS.
+        StoreColor(GI, Src1);
+    }
+
+    // This guarantees all LDS writes are complete and that all threads have
+    // executed all instructions so far (and therefore have issued their LDS
+    // write instructions.)
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // With low three bits for X and high three bits for Y, this bit mask
+        // (binary: 001001) checks that X and Y are even.
+        if ((GI & 0x9) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x01);
+            float4 Src3 = LoadColor(GI + 0x08);
+            float4 Src4 = LoadColor(GI + 0x09);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip2[uint3(DTid.xy / 2, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 2)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask (binary: 011011) checks that X and Y are multiples of four.
+        if ((GI & 0x1B) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x02);
+            float4 Src3 = LoadColor(GI + 0x10);
+            float4 Src4 = LoadColor(GI + 0x12);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip3[uint3(DTid.xy / 4, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 3)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask would be 111111 (X & Y multiples of 8), but only one
+        // thread fits that criteria.
+        if (GI == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x04);
+            float4 Src3 = LoadColor(GI + 0x20);
+            float4 Src4 = LoadColor(GI + 0x24);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip4[uint3(DTid.xy / 8, ArraySlice)] = PackColor(Src1);
+        }
+    }
+}
+
+)";
+
+const std::string BlurPS = R"(
+Texture2D<float4> g_Texture;
+SamplerState      g_Sampler;
+
+cbuffer Constants
+{
+    float4 g_Params; // x: alpha threshold, zw: blur offset
+};
+
+float4 main(float4 Pos : SV_Position, float2 UV : TEXCOORD0) : SV_Target
+{
+    float4 Color = g_Texture.Sample(g_Sampler, UV);
+    if (Color.a < g_Params.x)
+    {
+        [unroll]
+        for (int i = 1; i <= 4; ++i)
+            Color += g_Texture.Sample(g_Sampler, UV + g_Params.zw * i);
+        Color *= 0.2;
+    }
+    return Color;
+}
+)";
+;
+} // namespace HLSL
+
+struct ShaderSource
+{
+    const char*        Name;
+    const std::string& HLSL;
+    EShLanguage        Stage;
+    const char*        EntryPoint;
+};
+
+// Computes static cost metrics of every entry point of an optimized SPIR-V module.
+// The numbers are meant for catching regressions between builds, not for predicting
+// absolute GPU timings.
+class ShaderCostAnalyzer
+{
+public:
+    explicit ShaderCostAnalyzer(spvtools::opt::IRContext& Context) :
+        m_Context{Context},
+        m_DefUse{*Context.get_def_use_mgr()}
+    {}
+
+    EntryPointCost Analyze(const spvtools::opt::Instruction& EntryPoint, const std::string& ShaderName)
+    {
+        EntryPointCost Cost;
+        Cost.Shader     = ShaderName;
+        Cost.EntryPoint = EntryPoint.GetInOperand(2).AsString();
+        Cost.Stage      = GetStageName(static_cast<spv::ExecutionModel>(EntryPoint.GetSingleWordInOperand(0)));
+
+        uint64_t Instructions = 0, Alu = 0, AluScalar = 0, Texture = 0, Samples = 0;
+        uint64_t MemoryGlobal = 0, MemoryShared = 0, Barriers = 0, MaxLiveScalars = 0, MaxBranchSamples = 0;
+
+        std::set<uint32_t> WorkgroupVariables;
+        for (auto* pFunction : GetCallTree(EntryPoint.GetSingleWordInOperand(1)))
+        {
+            std::unordered_map<uint32_t, uint64_t> BlockSamples;
+            for (const auto& Block : *pFunction)
+            {
+                Block.ForEachInst([&](const spvtools::opt::Instruction* pInst) {
+                    if (pInst->opcode() == spv::Op::OpLabel)
+                        return;
+
+                    ++Instructions;
+                    pInst->ForEachInId([&](const uint32_t* pId) {
+                        const auto* pDef = m_DefUse.GetDef(*pId);
+                        if (pDef != nullptr && pDef->opcode() == spv::Op::OpVariable && pDef->GetSingleWordInOperand(0) == static_cast<uint32_t>(spv::StorageClass::Workgroup))
+                            WorkgroupVariables.insert(*pId);
+                    });
+
+                    const spv::Op Opcode = pInst->opcode();
+                    if (IsSampleOp(Opcode))
+                    {
+                        ++Samples;
+                        ++BlockSamples[Block.id()];
+                    }
+
+                    if (IsTextureOp(Opcode))
+                    {
+                        ++Texture;
+                    }
+                    else if (Opcode == spv::Op::OpControlBarrier || Opcode == spv::Op::OpMemoryBarrier)
+                    {
+                        ++Barriers;
+                    }
+                    else if (Opcode == spv::Op::OpLoad || Opcode == spv::Op::OpStore || spvOpcodeIsAtomicOp(Opcode))
+                    {
+                        switch (GetPointerStorageClass(pInst->GetSingleWordInOperand(0)))
+                        {
+                            case spv::StorageClass::Uniform:
+                            case spv::StorageClass::StorageBuffer:
+                            case spv::StorageClass::PushConstant:
+                            case spv::StorageClass::PhysicalStorageBuffer:
+                                ++MemoryGlobal;
+                                break;
+                            case spv::StorageClass::Workgroup:
+                                ++MemoryShared;
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+                    else if (IsAluOp(*pInst))
+                    {
+                        ++Alu;
+                        AluScalar += GetComponentCount(pInst->type_id());
+                    }
+                });
+            }
+
+            MaxLiveScalars = std::max(MaxLiveScalars, EstimateMaxLiveScalars(*pFunction));
+
+            for (auto& Branch : GetBranchCosts(*pFunction, BlockSamples))
+            {
+                for (uint64_t TargetSamples : Branch.TargetSamples)
+                    MaxBranchSamples = std::max(MaxBranchSamples, TargetSamples);
+                Cost.Branches.emplace_back(std::move(Branch));
+            }
+        }
+
+        uint64_t WorkgroupBytes = 0;
+        for (uint32_t VariableId : WorkgroupVariables)
+            WorkgroupBytes += GetTypeSize(GetPointeeTypeId(m_DefUse.GetDef(VariableId)->type_id()));
+
+        Cost.Metrics = {
+            {"instructions", Instructions},
+            {"alu", Alu},
+            {"alu_scalar", AluScalar},
+            {"texture", Texture},
+            {"samples", Samples},
+            {"max_branch_samples", MaxBranchSamples},
+            {"memory_global", MemoryGlobal},
+            {"memory_shared", MemoryShared},
+            {"barriers", Barriers},
+            {"workgroup_bytes", WorkgroupBytes},
+            {"max_live_scalars", MaxLiveScalars},
+        };
+        return Cost;
+    }
+
+private:
+    static const char* GetStageName(spv::ExecutionModel Model)
+    {
+        switch (Model)
+        {
+            case spv::ExecutionModel::Vertex: return "Vertex";
+            case spv::ExecutionModel::Fragment: return "Fragment";
+            case spv::ExecutionModel::GLCompute: return "GLCompute";
+            case spv::ExecutionModel::Geometry: return "Geometry";
+            case spv::ExecutionModel::TessellationControl: return "TessellationControl";
+            case spv::ExecutionModel::TessellationEvaluation: return "TessellationEvaluation";
+            default: return "Unknown";
+        }
+    }
+
+    static bool IsSampleOp(spv::Op Opcode)
+    {
+        switch (Opcode)
+        {
+            case spv::Op::OpImageSampleImplicitLod:
+            case spv::Op::OpImageSampleExplicitLod:
+            case spv::Op::OpImageSampleDrefImplicitLod:
+            case spv::Op::OpImageSampleDrefExplicitLod:
+            case spv::Op::OpImageSampleProjImplicitLod:
+            case spv::Op::OpImageSampleProjExplicitLod:
+            case spv::Op::OpImageSampleProjDrefImplicitLod:
+            case spv::Op::OpImageSampleProjDrefExplicitLod:
+            case spv::Op::OpImageGather:
+            case spv::Op::OpImageDrefGather:
+            case spv::Op::OpImageFetch:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool IsTextureOp(spv::Op Opcode)
+    {
+        return IsSampleOp(Opcode) ||
+            Opcode == spv::Op::OpImageRead ||
+            Opcode == spv::Op::OpImageWrite ||
+            Opcode == spv::Op::OpImageQuerySizeLod ||
+            Opcode == spv::Op::OpImageQuerySize ||
+            Opcode == spv::Op::OpImageQueryLod ||
+            Opcode == spv::Op::OpImageQueryLevels ||
+            Opcode == spv::Op::OpImageQuerySamples;
+    }
+
+    // Everything that computes a value in registers. Data movement (composites, shuffles,
+    // copies), phis and resource handles are free or folded into other instructions on
+    // most hardware and are not counted.
+    bool IsAluOp(const spvtools::opt::Instruction& Inst) const
+    {
+        if (!Inst.HasResultType())
+            return false;
+
+        switch (Inst.opcode())
+        {
+            case spv::Op::OpPhi:
+            case spv::Op::OpUndef:
+            case spv::Op::OpVariable:
+            case spv::Op::OpFunctionCall:
+            case spv::Op::OpFunctionParameter:
+            case spv::Op::OpAccessChain:
+            case spv::Op::OpInBoundsAccessChain:
+            case spv::Op::OpCompositeConstruct:
+            case spv::Op::OpCompositeExtract:
+            case spv::Op::OpCompositeInsert:
+            case spv::Op::OpVectorShuffle:
+            case spv::Op::OpCopyObject:
+            case spv::Op::OpSampledImage:
+            case spv::Op::OpImage:
+                return false;
+            default:
+                return !spvOpcodeIsConstant(Inst.opcode()) && m_DefUse.GetDef(Inst.type_id())->opcode() != spv::Op::OpTypePointer;
+        }
+    }
+
+    uint32_t GetPointeeTypeId(uint32_t PointerTypeId) const
+    {
+        return m_DefUse.GetDef(PointerTypeId)->GetSingleWordInOperand(1);
+    }
+
+    spv::StorageClass GetPointerStorageClass(uint32_t PointerId) const
+    {
+        const auto* pPointerType = m_DefUse.GetDef(m_DefUse.GetDef(PointerId)->type_id());
+        return pPointerType->opcode() == spv::Op::OpTypePointer ?
+            static_cast<spv::StorageClass>(pPointerType->GetSingleWordInOperand(0)) :
+            spv::StorageClass::Max;
+    }
+
+    uint64_t GetComponentCount(uint32_t TypeId) const
+    {
+        const auto* pType = m_DefUse.GetDef(TypeId);
+        switch (pType->opcode())
+        {
+            case spv::Op::OpTypeVector:
+                return pType->GetSingleWordInOperand(1);
+            case spv::Op::OpTypeMatrix:
+                return pType->GetSingleWordInOperand(1) * GetComponentCount(pType->GetSingleWordInOperand(0));
+            default:
+                return 1;
+        }
+    }
+
+    uint64_t GetTypeSize(uint32_t TypeId) const
+    {
+        const auto* pType = m_DefUse.GetDef(TypeId);
+        switch (pType->opcode())
+        {
+            case spv::Op::OpTypeBool:
+                return 4;
+            case spv::Op::OpTypeInt:
+            case spv::Op::OpTypeFloat:
+                return pType->GetSingleWordInOperand(0) / 8;
+            case spv::Op::OpTypeVector:
+            case spv::Op::OpTypeMatrix:
+                return pType->GetSingleWordInOperand(1) * GetTypeSize(pType->GetSingleWordInOperand(0));
+            case spv::Op::OpTypeArray:
+                return m_DefUse.GetDef(pType->GetSingleWordInOperand(1))->GetSingleWordInOperand(0) * GetTypeSize(pType->GetSingleWordInOperand(0));
+            case spv::Op::OpTypeStruct:
+            {
+                uint64_t Size = 0;
+                for (uint32_t MemberIdx = 0; MemberIdx < pType->NumInOperands(); ++MemberIdx)
+                    Size += GetTypeSize(pType->GetSingleWordInOperand(MemberIdx));
+                return Size;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    std::vector<spvtools::opt::Function*> GetCallTree(uint32_t EntryFunctionId)
+    {
+        std::unordered_map<uint32_t, spvtools::opt::Function*> Functions;
+        for (auto& Function : *m_Context.module())
+            Functions[Function.result_id()] = &Function;
+
+        std::vector<spvtools::opt::Function*> CallTree;
+        std::vector<uint32_t>                 Worklist{EntryFunctionId};
+        std::unordered_set<uint32_t>          Visited{EntryFunctionId};
+        while (!Worklist.empty())
+        {
+            auto* pFunction = Functions.at(Worklist.back());
+            Worklist.pop_back();
+            CallTree.push_back(pFunction);
+
+            pFunction->ForEachInst([&](spvtools::opt::Instruction* pInst) {
+                if (pInst->opcode() == spv::Op::OpFunctionCall && Visited.insert(pInst->GetSingleWordInOperand(0)).second)
+                    Worklist.push_back(pInst->GetSingleWordInOperand(0));
+            });
+        }
+        return CallTree;
+    }
+
+    // SSA values that occupy registers: function-local results of non-pointer type
+    bool IsRegisterValue(uint32_t Id, const std::unordered_set<uint32_t>& LocalIds) const
+    {
+        if (LocalIds.count(Id) == 0)
+            return false;
+        const auto* pDef = m_DefUse.GetDef(Id);
+        return pDef->type_id() != 0 && m_DefUse.GetDef(pDef->type_id())->opcode() != spv::Op::OpTypePointer;
+    }
+
+    // Classic backward liveness over the CFG, weighting every live value by its component
+    // count. Returns the highest number of live scalars at any instruction boundary.
+    uint64_t EstimateMaxLiveScalars(spvtools::opt::Function& Function) const
+    {
+        std::unordered_set<uint32_t> LocalIds;
+        Function.ForEachParam([&](const spvtools::opt::Instruction* pParam) { LocalIds.insert(pParam->result_id()); });
+        Function.ForEachInst([&](const spvtools::opt::Instruction* pInst) {
+            if (pInst->HasResultId() && pInst->opcode() != spv::Op::OpLabel)
+                LocalIds.insert(pInst->result_id());
+        });
+
+        struct BlockLiveness
+        {
+            std::set<uint32_t> Uses; // Upward-exposed uses
+            std::set<uint32_t> Defs;
+            std::set<uint32_t> PhiDefs;
+            std::set<uint32_t> LiveIn;
+            std::set<uint32_t> LiveOut;
+
+            std::vector<uint32_t>                               Successors;
+            std::unordered_map<uint32_t, std::vector<uint32_t>> PhiUsesByPredecessor;
+            std::vector<const spvtools::opt::Instruction*>      Instructions;
+        };
+        std::unordered_map<uint32_t, BlockLiveness> Blocks;
+        std::vector<uint32_t>                       BlockOrder;
+
+        for (const auto& Block : Function)
+        {
+            auto& Liveness = Blocks[Block.id()];
+            BlockOrder.push_back(Block.id());
+            Block.ForEachSuccessorLabel([&](const uint32_t SuccessorId) { Liveness.Successors.push_back(SuccessorId); });
+            Block.ForEachInst([&](const spvtools::opt::Instruction* pInst) {
+                if (pInst->opcode() == spv::Op::OpLabel)
+                    return;
+                Liveness.Instructions.push_back(pInst);
+
+                if (pInst->opcode() == spv::Op::OpPhi)
+                {
+                    Liveness.PhiDefs.insert(pInst->result_id());
+                    for (uint32_t OperandIdx = 0; OperandIdx + 1 < pInst->NumInOperands(); OperandIdx += 2)
+                    {
+                        const uint32_t ValueId = pInst->GetSingleWordInOperand(OperandIdx);
+                        if (IsRegisterValue(ValueId, LocalIds))
+                            Liveness.PhiUsesByPredecessor[pInst->GetSingleWordInOperand(OperandIdx + 1)].push_back(ValueId);
+                    }
+                    return;
+                }
+
+                pInst->ForEachInId([&](const uint32_t* pId) {
+                    if (IsRegisterValue(*pId, LocalIds) && Liveness.Defs.count(*pId) == 0 && Liveness.PhiDefs.count(*pId) == 0)
+                        Liveness.Uses.insert(*pId);
+                });
+                if (pInst->HasResultId())
+                    Liveness.Defs.insert(pInst->result_id());
+            });
+        }
+
+        for (bool IsChanged = true; IsChanged;)
+        {
+            IsChanged = false;
+            for (auto BlockIt = BlockOrder.rbegin(); BlockIt != BlockOrder.rend(); ++BlockIt)
+            {
+                auto& Liveness = Blocks[*BlockIt];
+
+                std::set<uint32_t> LiveOut;
+                for (uint32_t SuccessorId : Liveness.Successors)
+                {
+                    const auto& Successor = Blocks[SuccessorId];
+                    for (uint32_t Id : Successor.LiveIn)
+                    {
+                        if (Successor.PhiDefs.count(Id) == 0)
+                            LiveOut.insert(Id);
+                    }
+                    auto PhiUses = Successor.PhiUsesByPredecessor.find(*BlockIt);
+                    if (PhiUses != Successor.PhiUsesByPredecessor.end())
+                        LiveOut.insert(PhiUses->second.begin(), PhiUses->second.end());
+                }
+
+                std::set<uint32_t> LiveIn = Liveness.Uses;
+                for (uint32_t Id : LiveOut)
+                {
+                    if (Liveness.Defs.count(Id) == 0)
+                        LiveIn.insert(Id);
+                }
+                LiveIn.insert(Liveness.PhiDefs.begin(), Liveness.PhiDefs.end());
+
+                if (LiveIn != Liveness.LiveIn || LiveOut != Liveness.LiveOut)
+                {
+                    Liveness.LiveIn  = std::move(LiveIn);
+                    Liveness.LiveOut = std::move(LiveOut);
+                    IsChanged        = true;
+                }
+            }
+        }
+
+        uint64_t MaxLiveScalars = 0;
+        for (const auto& BlockIt : Blocks)
+        {
+            const auto& Liveness = BlockIt.second;
+
+            std::set<uint32_t> Live = Liveness.LiveOut;
+            for (auto InstIt = Liveness.Instructions.rbegin(); InstIt != Liveness.Instructions.rend(); ++InstIt)
+            {
+                const auto* pInst = *InstIt;
+                if (pInst->opcode() == spv::Op::OpPhi)
+                    break;
+
+                if (pInst->HasResultId())
+                    Live.erase(pInst->result_id());
+                pInst->ForEachInId([&](const uint32_t* pId) {
+                    if (IsRegisterValue(*pId, LocalIds))
+                        Live.insert(*pId);
+                });
+
+                uint64_t LiveScalars = 0;
+                for (uint32_t Id : Live)
+                    LiveScalars += GetComponentCount(m_DefUse.GetDef(Id)->type_id());
+                MaxLiveScalars = std::max(MaxLiveScalars, LiveScalars);
+            }
+        }
+        return MaxLiveScalars;
+    }
+
+    // For every structured selection, counts the samples in the blocks each target dominates
+    std::vector<BranchCost> GetBranchCosts(spvtools::opt::Function& Function, const std::unordered_map<uint32_t, uint64_t>& BlockSamples)
+    {
+        auto* pDominators = m_Context.GetDominatorAnalysis(&Function);
+
+        std::vector<BranchCost> Branches;
+        for (const auto& Block : Function)
+        {
+            const auto* pTerminator = &*Block.ctail();
+            const auto* pMerge      = pTerminator->PreviousNode();
+            if (pMerge == nullptr || pMerge->opcode() != spv::Op::OpSelectionMerge)
+                continue;
+
+            const uint32_t MergeId = pMerge->GetSingleWordInOperand(0);
+
+            BranchCost Branch;
+            Branch.Header = ConcatenateArgs("%", Block.id());
+            for (const auto& Name : m_Context.GetNames(Block.id()))
+                Branch.Header = "%" + Name.second->GetInOperand(1).AsString();
+
+            Block.ForEachSuccessorLabel([&](const uint32_t TargetId) {
+                uint64_t TargetSamples = 0;
+                if (TargetId != MergeId)
+                {
+                    for (const auto& SamplesIt : BlockSamples)
+                    {
+                        if (pDominators->Dominates(TargetId, SamplesIt.first))
+                            TargetSamples += SamplesIt.second;
+                    }
+                }
+                Branch.TargetSamples.push_back(TargetSamples);
+            });
+            Branches.emplace_back(std::move(Branch));
+        }
+        return Branches;
+    }
+
+private:
+    spvtools::opt::IRContext&               m_Context;
+    spvtools::opt::analysis::DefUseManager& m_DefUse;
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const ShaderSource& Source, const std::string& Preamble)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{Source.Stage};
+
+    auto* pHLSL = Source.HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint(Source.EntryPoint);
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse ", Source.Name, ": \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+
+    if (!OptimizedSPIRV.empty())
+        return OptimizedSPIRV;
+
+    LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+}
+
+// Usage:
+//   ShaderCostAnalyzer [--define NAME=VALUE]... [--output report.json]
+//   ShaderCostAnalyzer --diff base.json current.json [--threshold percent]
+// In diff mode the exit code is 1 if any metric regressed by more than the threshold.
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        std::vector<std::string> Args{argv + 1, argv + argc};
+        if (!Args.empty() && Args[0] == "--diff")
+        {
+            if (Args.size() < 3)
+                LOG_ERROR_AND_THROW("--diff requires two report files");
+
+            double Threshold = 2.0;
+            if (Args.size() >= 5 && Args[3] == "--threshold")
+                Threshold = std::stod(Args[4]);
+
+            const auto Base    = CostReportJson::Load(Args[1]);
+            const auto Current = CostReportJson::Load(Args[2]);
+
+            const uint32_t NumRegressions = DiffCostReports(Base, Current, Threshold, std::cout);
+            std::cout << NumRegressions << " metric(s) regressed by more than " << Threshold << "%\n";
+            return NumRegressions > 0 ? 1 : 0;
+        }
+
+        std::string Preamble;
+        std::string OutputPath;
+        for (size_t ArgIdx = 0; ArgIdx + 1 < Args.size(); ArgIdx += 2)
+        {
+            if (Args[ArgIdx] == "--define")
+            {
+                std::string Define = Args[ArgIdx + 1];
+                std::replace(Define.begin(), Define.end(), '=', ' ');
+                Preamble += "#define " + Define + "\n";
+            }
+            else if (Args[ArgIdx] == "--output")
+            {
+                OutputPath = Args[ArgIdx + 1];
+            }
+            else
+            {
+                LOG_ERROR_AND_THROW("Unknown argument '", Args[ArgIdx], "'");
+            }
+        }
+
+        const ShaderSource Shaders[] = {
+            {"GenerateMipsCS", HLSL::GenerateMipsCS, EShLangCompute, "main"},
+            {"BlurPS", HLSL::BlurPS, EShLangFragment, "main"},
+        };
+
+        ShaderCostReport Report;
+        for (const auto& Shader : Shaders)
+        {
+            auto SPIRV   = ConvertHLSLtoSPIRV(Shader, Preamble);
+            auto Context = spvtools::BuildModule(SPV_ENV_VULKAN_1_0, {}, SPIRV.data(), SPIRV.size());
+            if (!Context)
+                LOG_ERROR_AND_THROW("Failed to build SPIR-V module for ", Shader.Name);
+
+            ShaderCostAnalyzer Analyzer{*Context};
+            for (const auto& EntryPoint : Context->module()->entry_points())
+                Report.emplace_back(Analyzer.Analyze(EntryPoint, Shader.Name));
+        }
+
+        const std::string Json = CostReportJson::Write(Report);
+        if (OutputPath.empty())
+        {
+            std::cout << Json;
+        }
+        else
+        {
+            std::ofstream File{OutputPath};
+            if (!(File << Json))
+                LOG_ERROR_AND_THROW("Failed to write '", OutputPath, "'");
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
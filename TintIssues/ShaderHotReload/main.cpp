@@ -0,0 +1,938 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <map>
+#include <unordered_map>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string CommonH = R"(
+struct VSOutput
+{
+    float4 Pos : SV_Position;
+    float2 UV  : TEXCOORD0;
+};
+
+[[vk::binding(0, 0)]] cbuffer FrameConstants
+{
+    float4x4 g_WorldViewProj;
+    float4   g_Tint;
+};
+
+float4 ApplyTint(float4 Color)
+{
+    return float4(Color.rgb * g_Tint.rgb, Color.a);
+}
+)";
+
+const std::string MaterialFX = R"(
+#include "Common.hlsl"
+
+[[vk::binding(1, 0)]] Texture2D<float4> g_Texture;
+[[vk::binding(2, 0)]] SamplerState      g_Sampler;
+
+VSOutput VSMain(float3 Pos : ATTRIB0, float2 UV : ATTRIB1)
+{
+    VSOutput Out;
+    Out.Pos = mul(g_WorldViewProj, float4(Pos, 1.0));
+    Out.UV  = UV;
+    return Out;
+}
+
+float4 PSMain(VSOutput In) : SV_Target
+{
+    float4 Color = g_Texture.Sample(g_Sampler, In.UV);
+#if ALPHA_TEST
+    clip(Color.a - 0.5);
+#endif
+    return ApplyTint(Color);
+}
+)";
+
+const std::string PostFX = R"(
+[[vk::binding(0, 0)]] Texture2D<float4>   g_Input;
+[[vk::binding(1, 0)]] RWTexture2D<float4> g_Output;
+
+[numthreads(8, 8, 1)]
+void CSMain(uint3 DTid : SV_DispatchThreadID)
+{
+    float4 Color = g_Input.Load(int3(DTid.xy, 0));
+    g_Output[DTid.xy] = float4(Color.rgb / (Color.rgb + 1.0), Color.a);
+}
+)";
+;
+} // namespace HLSL
+
+// One line per compiled shader: <file> <entry point> <vs|ps|cs> [NAME[=VALUE] ...]
+const std::string ShaderManifest = R"(
+Material.hlsl VSMain vs
+Material.hlsl PSMain ps
+Material.hlsl PSMain ps ALPHA_TEST=1
+Post.hlsl     CSMain cs
+)";
+
+struct ShaderJob
+{
+    std::filesystem::path    File; // Relative to the library root
+    std::string              EntryPoint;
+    EShLanguage              Stage = EShLangVertex;
+    std::vector<std::string> Defines;
+
+    std::string GetName() const
+    {
+        std::string Name = File.string() + ":" + EntryPoint;
+        for (const auto& Define : Defines)
+            Name += " " + Define;
+        return Name;
+    }
+};
+
+std::string ReadFile(const std::filesystem::path& Path)
+{
+    std::ifstream Stream{Path, std::ios::binary};
+    if (!Stream)
+        LOG_ERROR_AND_THROW("Failed to open '", Path.string(), "'");
+
+    std::ostringstream Content;
+    Content << Stream.rdbuf();
+    return Content.str();
+}
+
+void WriteFile(const std::filesystem::path& Path, const std::string& Content)
+{
+    std::ofstream Stream{Path, std::ios::binary | std::ios::trunc};
+    if (!Stream.write(Content.data(), Content.size()))
+        LOG_ERROR_AND_THROW("Failed to write '", Path.string(), "'");
+}
+
+std::vector<ShaderJob> ParseShaderManifest(const std::string& Manifest)
+{
+    const std::unordered_map<std::string, EShLanguage> Stages = {
+        {"vs", EShLangVertex},
+        {"ps", EShLangFragment},
+        {"cs", EShLangCompute},
+    };
+
+    std::vector<ShaderJob> Jobs;
+    std::istringstream     Lines{Manifest};
+    for (std::string Line; std::getline(Lines, Line);)
+    {
+        std::istringstream Tokens{Line.substr(0, Line.find('#'))};
+
+        ShaderJob   Job;
+        std::string File, Stage;
+        if (!(Tokens >> File))
+            continue;
+        if (!(Tokens >> Job.EntryPoint >> Stage) || Stages.count(Stage) == 0)
+            LOG_ERROR_AND_THROW("Invalid manifest line: '", Line, "'");
+
+        Job.File  = std::filesystem::path{File}.lexically_normal();
+        Job.Stage = Stages.at(Stage);
+        for (std::string Define; Tokens >> Define;)
+            Job.Defines.emplace_back(std::move(Define));
+        Jobs.emplace_back(std::move(Job));
+    }
+    return Jobs;
+}
+
+// Loads includes from the library directory and records every file the compilation
+// opened, which is what the include graph is built from. Paths are relative to the root.
+class LibraryIncluder final : public glslang::TShader::Includer
+{
+public:
+    explicit LibraryIncluder(const std::filesystem::path& Root) :
+        m_Root{Root}
+    {}
+
+    IncludeResult* includeLocal(const char* HeaderName, const char* IncluderName, size_t /*InclusionDepth*/) override
+    {
+        // Relative to the including file first, then to the library root
+        const auto Relative = (std::filesystem::path{IncluderName}.parent_path() / HeaderName).lexically_normal();
+        if (auto* pResult = Include(Relative))
+            return pResult;
+        return Include(std::filesystem::path{HeaderName}.lexically_normal());
+    }
+
+    IncludeResult* includeSystem(const char* HeaderName, const char* /*IncluderName*/, size_t /*InclusionDepth*/) override
+    {
+        return Include(std::filesystem::path{HeaderName}.lexically_normal());
+    }
+
+    void releaseInclude(IncludeResult* pResult) override
+    {
+        if (pResult != nullptr)
+            delete static_cast<std::string*>(pResult->userData);
+        delete pResult;
+    }
+
+    const std::set<std::filesystem::path>& GetDependencies() const
+    {
+        return m_Dependencies;
+    }
+
+private:
+    IncludeResult* Include(const std::filesystem::path& Path)
+    {
+        std::ifstream Stream{m_Root / Path, std::ios::binary};
+        if (!Stream)
+            return nullptr;
+
+        // A header that failed to open is not recorded: the job is recompiled when the file
+        // it actually resolved to changes.
+        m_Dependencies.insert(Path);
+
+        std::ostringstream Content;
+        Content << Stream.rdbuf();
+        auto* pContent = new std::string{Content.str()};
+        return new IncludeResult{Path.generic_string(), pContent->c_str(), pContent->size(), pContent};
+    }
+
+private:
+    const std::filesystem::path     m_Root;
+    std::set<std::filesystem::path> m_Dependencies;
+};
+
+void SetupHLSLShader(glslang::TShader& Shader, const char* EntryPoint)
+{
+    Shader.setEntryPoint(EntryPoint);
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+// Tint is initialized once for the whole process: conversions run on several worker threads
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+// Compiles one job from disk. IsStale is polled between the stages; glslang, spirv-opt and
+// Tint cannot be interrupted, so a stale compilation is abandoned at the next stage boundary
+// and std::nullopt is returned. Dependencies receives the files the compilation opened, even
+// if it fails, so that fixing a broken header triggers a recompile.
+std::optional<std::string> CompileShaderJob(const std::filesystem::path&     Root,
+                                            const ShaderJob&                 Job,
+                                            const std::function<bool()>&     IsStale,
+                                            std::set<std::filesystem::path>& Dependencies)
+{
+    LibraryIncluder Includer{Root};
+
+    Dependencies = {Job.File};
+    struct DependencyRecorder
+    {
+        std::set<std::filesystem::path>& Dst;
+        const LibraryIncluder&           Src;
+        ~DependencyRecorder()
+        {
+            Dst.insert(Src.GetDependencies().begin(), Src.GetDependencies().end());
+        }
+    } Recorder{Dependencies, Includer};
+
+    const std::string Source = ReadFile(Root / Job.File);
+
+    std::string Preamble;
+    for (auto Define : Job.Defines)
+    {
+        std::replace(Define.begin(), Define.end(), '=', ' ');
+        Preamble += "#define " + Define + "\n";
+    }
+
+    glslang::TShader Shader{Job.Stage};
+
+    const char* pHLSL  = Source.c_str();
+    const int   Length = static_cast<int>(Source.size());
+    const auto  Name   = Job.File.generic_string();
+    const char* pName  = Name.c_str();
+    Shader.setStringsWithLengthsAndNames(&pHLSL, &Length, &pName, 1);
+    Shader.setPreamble(Preamble.c_str());
+    SetupHLSLShader(Shader, Job.EntryPoint.c_str());
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, ENoProfile, false, false, EShMsgDefault, Includer))
+        LOG_ERROR_AND_THROW("Failed to parse '", Job.GetName(), "': \n", Shader.getInfoLog());
+    if (IsStale())
+        return std::nullopt;
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+    if (IsStale())
+        return std::nullopt;
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+    if (OptimizedSPIRV.empty())
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+    if (IsStale())
+        return std::nullopt;
+
+    return ConvertSPIRVtoWGSL(OptimizedSPIRV);
+}
+
+// Reverse include graph: file -> jobs whose last compilation opened it
+class IncludeGraph
+{
+public:
+    void SetDependencies(size_t JobIndex, const std::set<std::filesystem::path>& Dependencies)
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        if (JobIndex >= m_JobDependencies.size())
+            m_JobDependencies.resize(JobIndex + 1);
+
+        for (const auto& File : m_JobDependencies[JobIndex])
+            m_Dependents[File].erase(JobIndex);
+        for (const auto& File : Dependencies)
+            m_Dependents[File].insert(JobIndex);
+        m_JobDependencies[JobIndex] = Dependencies;
+    }
+
+    std::set<size_t> GetAffectedJobs(const std::filesystem::path& File) const
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+
+        auto It = m_Dependents.find(File);
+        return It != m_Dependents.end() ? It->second : std::set<size_t>{};
+    }
+
+private:
+    mutable std::mutex                                m_Mtx;
+    std::map<std::filesystem::path, std::set<size_t>> m_Dependents;
+    std::vector<std::set<std::filesystem::path>>      m_JobDependencies;
+};
+
+// Watches a directory tree with inotify. Watches are not recursive, so every subdirectory
+// gets its own watch, including the ones created later.
+class InotifyWatcher
+{
+public:
+    struct Events
+    {
+        std::set<std::filesystem::path> Files; // Relative to the root
+        bool                            IsOverflow = false;
+
+        bool IsEmpty() const
+        {
+            return Files.empty() && !IsOverflow;
+        }
+    };
+
+    explicit InotifyWatcher(const std::filesystem::path& Root) :
+        m_Root{Root},
+        m_Fd{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)}
+    {
+        if (m_Fd < 0)
+            LOG_ERROR_AND_THROW("inotify_init1 failed: ", std::strerror(errno));
+
+        AddDirectory(m_Root);
+        for (const auto& Entry : std::filesystem::recursive_directory_iterator{m_Root})
+        {
+            if (Entry.is_directory())
+                AddDirectory(Entry.path());
+        }
+    }
+
+    ~InotifyWatcher()
+    {
+        close(m_Fd);
+    }
+
+    InotifyWatcher(const InotifyWatcher&)            = delete;
+    InotifyWatcher& operator=(const InotifyWatcher&) = delete;
+
+    // Waits up to TimeoutMs for events and returns everything that is queued
+    Events Wait(int TimeoutMs)
+    {
+        Events Result;
+
+        pollfd Fd{m_Fd, POLLIN, 0};
+        if (poll(&Fd, 1, TimeoutMs) <= 0)
+            return Result;
+
+        alignas(inotify_event) char Buffer[16 * 1024];
+        for (;;)
+        {
+            const ssize_t Size = read(m_Fd, Buffer, sizeof(Buffer));
+            if (Size <= 0)
+                break;
+
+            for (ssize_t Offset = 0; Offset < Size;)
+            {
+                const auto* pEvent = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+                Offset += sizeof(inotify_event) + pEvent->len;
+
+                if (pEvent->mask & IN_Q_OVERFLOW)
+                {
+                    Result.IsOverflow = true;
+                    continue;
+                }
+
+                auto Directory = m_Directories.find(pEvent->wd);
+                if (Directory == m_Directories.end() || pEvent->len == 0)
+                    continue;
+
+                const auto Path = Directory->second / pEvent->name;
+                if (pEvent->mask & IN_ISDIR)
+                {
+                    if (pEvent->mask & (IN_CREATE | IN_MOVED_TO))
+                        AddDirectory(Path);
+                }
+                else
+                {
+                    Result.Files.insert(Path.lexically_relative(m_Root));
+                }
+            }
+        }
+        return Result;
+    }
+
+private:
+    void AddDirectory(const std::filesystem::path& Directory)
+    {
+        // IN_CLOSE_WRITE rather than IN_MODIFY: one save produces many IN_MODIFY events.
+        // IN_MOVED_TO catches editors that save to a temporary file and rename it.
+        const int Wd = inotify_add_watch(m_Fd, Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+        if (Wd < 0)
+            LOG_WARNING_MESSAGE("Failed to watch '", Directory.string(), "': ", std::strerror(errno));
+        else
+            m_Directories[Wd] = Directory;
+    }
+
+private:
+    const std::filesystem::path                    m_Root;
+    const int                                      m_Fd;
+    std::unordered_map<int, std::filesystem::path> m_Directories;
+};
+
+// Compiles the shader library once, then recompiles the jobs affected by every change to
+// the library directory and publishes the new WGSL.
+//  - Changes are debounced: a burst of saves is collected until the directory has been
+//    quiet for DebounceMs (but at most MaxBatchMs) and then handled as one batch.
+//  - Only jobs whose last compilation opened a changed file are recompiled.
+//  - Every job has a generation counter that is bumped when the job is scheduled. A
+//    compilation that sees a newer generation is abandoned, and a job is queued at most
+//    once, so a flurry of saves never builds up a backlog of outdated work.
+//  - A failed compilation is reported and the previously published WGSL stays in use.
+class ShaderHotReloadService
+{
+public:
+    using PublishCallback = std::function<void(const ShaderJob& Job, const std::string& WGSL, uint64_t Generation)>;
+
+    struct CreateInfo
+    {
+        std::filesystem::path  Root;
+        std::vector<ShaderJob> Jobs;
+        PublishCallback        Publish;
+        uint32_t               DebounceMs = 30;
+        uint32_t               MaxBatchMs = 250;
+        uint32_t               NumWorkers = 0; // 0 - hardware concurrency
+    };
+
+    explicit ShaderHotReloadService(CreateInfo CI) :
+        m_CI{std::move(CI)},
+        m_JobStates(m_CI.Jobs.size()),
+        m_Watcher{m_CI.Root}
+    {
+        uint32_t NumWorkers = m_CI.NumWorkers != 0 ? m_CI.NumWorkers : std::max(std::thread::hardware_concurrency(), 1u);
+        for (uint32_t i = 0; i < NumWorkers; ++i)
+            m_Workers.emplace_back(&ShaderHotReloadService::WorkerThread, this);
+
+        const auto Now = Clock::now();
+        for (size_t JobIndex = 0; JobIndex < m_CI.Jobs.size(); ++JobIndex)
+            Schedule(JobIndex, Now);
+
+        m_WatcherThread = std::thread{&ShaderHotReloadService::WatcherThread, this};
+    }
+
+    ~ShaderHotReloadService()
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+            m_IsRunning = false;
+        }
+        m_QueueCV.notify_all();
+
+        m_WatcherThread.join();
+        for (auto& Worker : m_Workers)
+            Worker.join();
+    }
+
+    // Waits until the queue is empty and no compilation is running
+    void WaitIdle()
+    {
+        std::unique_lock<std::mutex> Lock{m_QueueMtx};
+        m_IdleCV.wait(Lock, [this]() { return m_Queue.empty() && m_NumActive == 0; });
+    }
+
+    uint64_t GetNumBatches()
+    {
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        return m_NumBatches;
+    }
+
+    // Waits until the watcher has handled more than NumBatches change batches and the
+    // resulting compilations have finished. Returns false on timeout.
+    bool WaitForBatch(uint64_t NumBatches, uint32_t TimeoutMs)
+    {
+        std::unique_lock<std::mutex> Lock{m_QueueMtx};
+        return m_IdleCV.wait_for(Lock, std::chrono::milliseconds{TimeoutMs}, [&]() {
+            return m_NumBatches > NumBatches && m_Queue.empty() && m_NumActive == 0;
+        });
+    }
+
+    uint32_t GetNumCompiled() const { return m_NumCompiled.load(); }
+    uint32_t GetNumCancelled() const { return m_NumCancelled.load(); }
+    uint32_t GetNumFailed() const { return m_NumFailed.load(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct JobState
+    {
+        std::atomic<uint64_t> Generation{0};
+        bool                  IsQueued            = false; // Protected by m_QueueMtx
+        Clock::time_point     ChangeTime;                  // Protected by m_QueueMtx
+        uint64_t              PublishedGeneration = 0;     // Protected by m_PublishMtx
+    };
+
+    void Schedule(size_t JobIndex, Clock::time_point ChangeTime)
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+
+            auto& State = m_JobStates[JobIndex];
+            State.Generation.fetch_add(1);
+            if (State.IsQueued)
+                return;
+
+            State.IsQueued   = true;
+            State.ChangeTime = ChangeTime;
+            m_Queue.push_back(JobIndex);
+        }
+        m_QueueCV.notify_one();
+    }
+
+    void WorkerThread()
+    {
+        for (;;)
+        {
+            size_t            JobIndex   = 0;
+            uint64_t          Generation = 0;
+            Clock::time_point ChangeTime;
+            {
+                std::unique_lock<std::mutex> Lock{m_QueueMtx};
+                m_QueueCV.wait(Lock, [this]() { return !m_Queue.empty() || !m_IsRunning; });
+                if (!m_IsRunning)
+                    return;
+
+                JobIndex = m_Queue.front();
+                m_Queue.pop_front();
+
+                auto& State    = m_JobStates[JobIndex];
+                State.IsQueued = false;
+                Generation     = State.Generation.load();
+                ChangeTime     = State.ChangeTime;
+                ++m_NumActive;
+            }
+
+            Compile(JobIndex, Generation, ChangeTime);
+
+            {
+                std::lock_guard<std::mutex> Lock{m_QueueMtx};
+                --m_NumActive;
+            }
+            m_IdleCV.notify_all();
+        }
+    }
+
+    void Compile(size_t JobIndex, uint64_t Generation, Clock::time_point ChangeTime)
+    {
+        const auto& Job   = m_CI.Jobs[JobIndex];
+        auto&       State = m_JobStates[JobIndex];
+
+        auto IsStale = [&]() { return State.Generation.load() != Generation || !m_IsRunning; };
+
+        std::set<std::filesystem::path> Dependencies;
+        std::optional<std::string>      WGSL;
+        try
+        {
+            WGSL = CompileShaderJob(m_CI.Root, Job, IsStale, Dependencies);
+        }
+        catch (const std::exception&)
+        {
+            if (!IsStale())
+            {
+                LOG_WARNING_MESSAGE("Failed to recompile '", Job.GetName(), "', keeping the previous version");
+                ++m_NumFailed;
+            }
+        }
+        // Dependencies of an abandoned compilation may already be outdated
+        if (!IsStale())
+            m_IncludeGraph.SetDependencies(JobIndex, Dependencies);
+
+        if (!WGSL)
+        {
+            if (IsStale())
+                ++m_NumCancelled;
+            return;
+        }
+
+        std::lock_guard<std::mutex> Lock{m_PublishMtx};
+        // A newer compilation may have finished first: never publish over it
+        if (IsStale() || Generation <= State.PublishedGeneration)
+        {
+            ++m_NumCancelled;
+            return;
+        }
+        State.PublishedGeneration = Generation;
+        ++m_NumCompiled;
+
+        const double Latency = std::chrono::duration<double, std::milli>(Clock::now() - ChangeTime).count();
+        LOG_INFO_MESSAGE("Published '", Job.GetName(), "' (generation ", Generation, ") ", Latency, " ms after the change");
+        m_CI.Publish(Job, *WGSL, Generation);
+    }
+
+    void WatcherThread()
+    {
+        while (m_IsRunning)
+        {
+            auto Batch = m_Watcher.Wait(100);
+            if (Batch.IsEmpty())
+                continue;
+
+            // Debounce: extend the batch until the directory is quiet
+            const auto BatchStart = Clock::now();
+            while (Clock::now() - BatchStart < std::chrono::milliseconds{m_CI.MaxBatchMs})
+            {
+                auto More = m_Watcher.Wait(static_cast<int>(m_CI.DebounceMs));
+                if (More.IsEmpty())
+                    break;
+                Batch.Files.merge(More.Files);
+                Batch.IsOverflow = Batch.IsOverflow || More.IsOverflow;
+            }
+
+            std::set<size_t> AffectedJobs;
+            if (Batch.IsOverflow)
+            {
+                // Events were lost, the only safe option is a full rebuild
+                LOG_WARNING_MESSAGE("inotify queue overflow, recompiling the whole library");
+                for (size_t JobIndex = 0; JobIndex < m_CI.Jobs.size(); ++JobIndex)
+                    AffectedJobs.insert(JobIndex);
+            }
+            for (const auto& File : Batch.Files)
+                AffectedJobs.merge(m_IncludeGraph.GetAffectedJobs(File));
+
+            if (!AffectedJobs.empty())
+            {
+                LOG_INFO_MESSAGE(Batch.Files.size(), " file(s) changed, recompiling ", AffectedJobs.size(), " of ", m_CI.Jobs.size(), " job(s)");
+                for (size_t JobIndex : AffectedJobs)
+                    Schedule(JobIndex, BatchStart);
+            }
+
+            // Jobs of the batch are queued before it is counted, so WaitForBatch never
+            // observes the new count together with an empty queue too early
+            {
+                std::lock_guard<std::mutex> Lock{m_QueueMtx};
+                ++m_NumBatches;
+            }
+            m_IdleCV.notify_all();
+        }
+    }
+
+private:
+    const CreateInfo      m_CI;
+    std::vector<JobState> m_JobStates;
+    IncludeGraph          m_IncludeGraph;
+    InotifyWatcher        m_Watcher;
+
+    std::mutex              m_QueueMtx;
+    std::condition_variable m_QueueCV;
+    std::condition_variable m_IdleCV;
+    std::deque<size_t>      m_Queue;
+    uint32_t                m_NumActive  = 0;
+    uint64_t                m_NumBatches = 0;
+    std::atomic<bool>       m_IsRunning{true};
+
+    std::mutex m_PublishMtx;
+
+    std::atomic<uint32_t> m_NumCompiled{0};
+    std::atomic<uint32_t> m_NumCancelled{0};
+    std::atomic<uint32_t> m_NumFailed{0};
+
+    std::vector<std::thread> m_Workers;
+    std::thread              m_WatcherThread;
+};
+
+void Expect(bool Condition, const char* Description)
+{
+    if (!Condition)
+        LOG_ERROR_AND_THROW("Self-test failed: expected ", Description);
+}
+
+// Usage:
+//   ShaderHotReload                                     - self-test on a temporary library
+//   ShaderHotReload --watch <dir> [--debounce <ms>]     - watch <dir> using <dir>/shaders.txt
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        std::filesystem::path WatchDir;
+        uint32_t              DebounceMs = 30;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--watch" && i + 1 < argc)
+                WatchDir = argv[++i];
+            else if (Arg == "--debounce" && i + 1 < argc)
+                DebounceMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+        }
+
+        const bool IsSelfTest = WatchDir.empty();
+        if (IsSelfTest)
+        {
+            WatchDir = std::filesystem::temp_directory_path() / ConcatenateArgs("ShaderHotReload-", getpid());
+            std::filesystem::create_directories(WatchDir);
+            WriteFile(WatchDir / "Common.hlsl", HLSL::CommonH);
+            WriteFile(WatchDir / "Material.hlsl", HLSL::MaterialFX);
+            WriteFile(WatchDir / "Post.hlsl", HLSL::PostFX);
+            WriteFile(WatchDir / "shaders.txt", ShaderManifest);
+        }
+        WatchDir = std::filesystem::canonical(WatchDir);
+
+        TintInitializer   TintScope{};
+        GlslangInitilizer GlslangScope{};
+
+        std::mutex                         LibraryMtx;
+        std::map<std::string, std::string> Library;
+        std::set<std::string>              Published; // Jobs published since the last scenario
+
+        ShaderHotReloadService::CreateInfo CI;
+        CI.Root       = WatchDir;
+        CI.Jobs       = ParseShaderManifest(ReadFile(WatchDir / "shaders.txt"));
+        CI.DebounceMs = DebounceMs;
+        CI.Publish    = [&](const ShaderJob& Job, const std::string& WGSL, uint64_t /*Generation*/) {
+            std::lock_guard<std::mutex> Lock{LibraryMtx};
+            Library[Job.GetName()] = WGSL;
+            Published.insert(Job.GetName());
+        };
+
+        auto StartTime = std::chrono::high_resolution_clock::now();
+
+        ShaderHotReloadService Service{std::move(CI)};
+        Service.WaitIdle();
+
+        LOG_INFO_MESSAGE("Initial build: ", Service.GetNumCompiled(), " job(s) in ",
+                         std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count(), " ms");
+
+        if (!IsSelfTest)
+        {
+            LOG_INFO_MESSAGE("Watching '", WatchDir.string(), "'");
+            for (;;)
+                std::this_thread::sleep_for(std::chrono::seconds{1});
+        }
+
+        // Runs one scenario and returns the jobs it published
+        constexpr uint32_t BatchTimeoutMs = 10000;
+        auto               RunScenario    = [&](const std::function<void()>& MakeChanges) {
+            {
+                std::lock_guard<std::mutex> Lock{LibraryMtx};
+                Published.clear();
+            }
+            const uint64_t NumBatches = Service.GetNumBatches();
+            MakeChanges();
+            Expect(Service.WaitForBatch(NumBatches, BatchTimeoutMs), "the changes to be handled within the timeout");
+
+            std::lock_guard<std::mutex> Lock{LibraryMtx};
+            return Published;
+        };
+        auto GetPublished = [&](const std::string& Name) {
+            std::lock_guard<std::mutex> Lock{LibraryMtx};
+            return Library.at(Name);
+        };
+
+        std::set<std::string> MaterialJobs;
+        for (const auto& Job : ParseShaderManifest(ShaderManifest))
+        {
+            if (Job.File == "Material.hlsl")
+                MaterialJobs.insert(Job.GetName());
+        }
+        const std::string PostJob = "Post.hlsl:CSMain";
+
+        // An editor saving the shared header three times in quick succession: one batch,
+        // every job that includes it is recompiled once with the last version.
+        const std::string PostBefore = GetPublished(PostJob);
+        Expect(RunScenario([&]() {
+                   for (int Save = 0; Save < 3; ++Save)
+                   {
+                       std::string Header = HLSL::CommonH;
+                       Header.replace(Header.find("Color.rgb * g_Tint.rgb"), 22, ConcatenateArgs("Color.rgb * g_Tint.rgb * ", Save + 2, ".0"));
+                       WriteFile(WatchDir / "Common.hlsl", Header);
+                       std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                   }
+               }) == MaterialJobs,
+               "only the jobs that include Common.hlsl to be recompiled");
+        Expect(GetPublished(PostJob) == PostBefore, "the post-processing job to be left alone");
+
+        // Save via a temporary file and rename: only the post-processing job is affected
+        Expect(RunScenario([&]() {
+                   std::string Post = HLSL::PostFX;
+                   Post.replace(Post.find("Color.rgb + 1.0"), 15, "Color.rgb + 0.5");
+                   WriteFile(WatchDir / "Post.hlsl.tmp", Post);
+                   std::filesystem::rename(WatchDir / "Post.hlsl.tmp", WatchDir / "Post.hlsl");
+               }) == std::set<std::string>{PostJob},
+               "only the post-processing job to be recompiled");
+        const std::string PostEdited = GetPublished(PostJob);
+        Expect(PostEdited != PostBefore, "the edited post-processing shader to be published");
+
+        // A broken save must not replace the published WGSL
+        const uint32_t NumFailed = Service.GetNumFailed();
+        Expect(RunScenario([&]() {
+                   WriteFile(WatchDir / "Post.hlsl", "[numthreads(8, 8, 1)] void CSMain() { undeclared = 1; }");
+               }).empty(),
+               "nothing to be published for a broken save");
+        Expect(Service.GetNumFailed() == NumFailed + 1, "the broken save to be reported as a failure");
+        Expect(GetPublished(PostJob) == PostEdited, "the previous WGSL to stay in use after a broken save");
+
+        // Fixing the error recovers
+        Expect(RunScenario([&]() {
+                   WriteFile(WatchDir / "Post.hlsl", HLSL::PostFX);
+               }) == std::set<std::string>{PostJob},
+               "the fixed post-processing shader to be recompiled");
+        Expect(GetPublished(PostJob) == PostBefore, "the fixed shader to be published");
+
+        for (const auto& [Name, WGSL] : Library)
+            std::cout << "// " << Name << "\n" << WGSL << "\n";
+
+        LOG_INFO_MESSAGE("Compiled: ", Service.GetNumCompiled(), ", cancelled: ", Service.GetNumCancelled(), ", failed: ", Service.GetNumFailed());
+
+        std::filesystem::remove_all(WatchDir);
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
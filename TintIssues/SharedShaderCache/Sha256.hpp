@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <string>
+#include <algorithm>
+
+// SHA-256 (FIPS 180-4). Entries of the shared cache are addressed and verified by it: with
+// dozens of machines writing to one store, a non-cryptographic hash such as FNV-1a would
+// make accidental key collisions and undetected corruption realistic.
+class Sha256
+{
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256()
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        m_State      = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        m_BlockSize  = 0;
+        m_TotalBytes = 0;
+    }
+
+    Sha256& Update(const void* pData, size_t Size)
+    {
+        const auto* pBytes = static_cast<const uint8_t*>(pData);
+        m_TotalBytes += Size;
+        while (Size > 0)
+        {
+            const size_t Count = std::min(Size, m_Block.size() - m_BlockSize);
+            std::memcpy(m_Block.data() + m_BlockSize, pBytes, Count);
+            m_BlockSize += Count;
+            pBytes += Count;
+            Size -= Count;
+            if (m_BlockSize == m_Block.size())
+            {
+                ProcessBlock(m_Block.data());
+                m_BlockSize = 0;
+            }
+        }
+        return *this;
+    }
+
+    Sha256& Update(const std::string& Str)
+    {
+        return Update(Str.data(), Str.size());
+    }
+
+    // Fields of variable size must be separated unambiguously: hash the size first
+    Sha256& UpdateSized(const std::string& Str)
+    {
+        const uint64_t Size = Str.size();
+        return Update(&Size, sizeof(Size)).Update(Str);
+    }
+
+    Digest Finish()
+    {
+        const uint64_t BitCount = m_TotalBytes * 8;
+
+        const uint8_t Pad = 0x80;
+        Update(&Pad, 1);
+        const uint8_t Zero = 0;
+        while (m_BlockSize != 56)
+            Update(&Zero, 1);
+
+        uint8_t Length[8];
+        for (int i = 0; i < 8; ++i)
+            Length[i] = static_cast<uint8_t>(BitCount >> (56 - 8 * i));
+        Update(Length, sizeof(Length));
+
+        Digest Result;
+        for (size_t i = 0; i < m_State.size(); ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                Result[i * 4 + j] = static_cast<uint8_t>(m_State[i] >> (24 - 8 * j));
+        }
+        Reset();
+        return Result;
+    }
+
+    static Digest Compute(const void* pData, size_t Size)
+    {
+        return Sha256{}.Update(pData, Size).Finish();
+    }
+
+    static std::string ToString(const Digest& Hash)
+    {
+        static constexpr char HexDigits[] = "0123456789abcdef";
+
+        std::string Result(Hash.size() * 2, '0');
+        for (size_t i = 0; i < Hash.size(); ++i)
+        {
+            Result[i * 2]     = HexDigits[Hash[i] >> 4];
+            Result[i * 2 + 1] = HexDigits[Hash[i] & 0xF];
+        }
+        return Result;
+    }
+
+private:
+    static uint32_t RotateRight(uint32_t Value, uint32_t Count)
+    {
+        return (Value >> Count) | (Value << (32 - Count));
+    }
+
+    void ProcessBlock(const uint8_t* pBlock)
+    {
+        static constexpr uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        uint32_t W[64];
+        for (int i = 0; i < 16; ++i)
+            W[i] = (uint32_t{pBlock[i * 4]} << 24) | (uint32_t{pBlock[i * 4 + 1]} << 16) | (uint32_t{pBlock[i * 4 + 2]} << 8) | uint32_t{pBlock[i * 4 + 3]};
+        for (int i = 16; i < 64; ++i)
+        {
+            const uint32_t S0 = RotateRight(W[i - 15], 7) ^ RotateRight(W[i - 15], 18) ^ (W[i - 15] >> 3);
+            const uint32_t S1 = RotateRight(W[i - 2], 17) ^ RotateRight(W[i - 2], 19) ^ (W[i - 2] >> 10);
+            W[i]              = W[i - 16] + S0 + W[i - 7] + S1;
+        }
+
+        uint32_t a = m_State[0], b = m_State[1], c = m_State[2], d = m_State[3];
+        uint32_t e = m_State[4], f = m_State[5], g = m_State[6], h = m_State[7];
+        for (int i = 0; i < 64; ++i)
+        {
+            const uint32_t S1    = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+            const uint32_t Ch    = (e & f) ^ (~e & g);
+            const uint32_t Temp1 = h + S1 + Ch + K[i] + W[i];
+            const uint32_t S0    = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+            const uint32_t Maj   = (a & b) ^ (a & c) ^ (b & c);
+            const uint32_t Temp2 = S0 + Maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + Temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = Temp1 + Temp2;
+        }
+
+        m_State[0] += a;
+        m_State[1] += b;
+        m_State[2] += c;
+        m_State[3] += d;
+        m_State[4] += e;
+        m_State[5] += f;
+        m_State[6] += g;
+        m_State[7] += h;
+    }
+
+private:
+    std::array<uint32_t, 8> m_State;
+    std::array<uint8_t, 64> m_Block;
+    size_t                  m_BlockSize  = 0;
+    uint64_t                m_TotalBytes = 0;
+};
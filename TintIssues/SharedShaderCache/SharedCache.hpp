@@ -0,0 +1,653 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <deque>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <system_error>
+#include <stdexcept>
+#include <algorithm>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Sha256.hpp"
+
+using CacheKey = Sha256::Digest;
+
+// Content-addressed blob store in a directory:
+//   <Root>/<first two hex digits>/<key>
+// Every file starts with the SHA-256 of the value, which is verified on every read; a
+// corrupted entry is deleted and reported as a miss. Entries are written to a uniquely
+// named temporary file and renamed into place, so several processes can share the store.
+class DirectoryBlobStore
+{
+public:
+    explicit DirectoryBlobStore(const std::filesystem::path& Root) :
+        m_Root{Root}
+    {
+        std::error_code ErrorCode;
+        std::filesystem::create_directories(m_Root, ErrorCode);
+    }
+
+    // Returns std::nullopt on a miss and on a corrupted entry. pIsCorrupted distinguishes the two.
+    std::optional<std::vector<uint8_t>> Get(const CacheKey& Key, bool* pIsCorrupted = nullptr) const
+    {
+        if (pIsCorrupted != nullptr)
+            *pIsCorrupted = false;
+
+        const auto    FilePath = GetEntryPath(Key);
+        std::ifstream Stream{FilePath, std::ios::binary};
+        if (!Stream)
+            return std::nullopt;
+
+        EntryHeader Header{};
+        if (Stream.read(reinterpret_cast<char*>(&Header), sizeof(Header)) && Header.Magic == EntryMagic && Header.ValueSize <= MaxValueSize)
+        {
+            std::vector<uint8_t> Value(static_cast<size_t>(Header.ValueSize));
+            if (Stream.read(reinterpret_cast<char*>(Value.data()), Value.size()) && Sha256::Compute(Value.data(), Value.size()) == Header.ValueHash)
+                return Value;
+        }
+
+        Stream.close();
+        std::error_code ErrorCode;
+        std::filesystem::remove(FilePath, ErrorCode);
+        if (pIsCorrupted != nullptr)
+            *pIsCorrupted = true;
+        return std::nullopt;
+    }
+
+    // ValueHash must be the SHA-256 of Value, otherwise nothing is stored and false is returned
+    bool Put(const CacheKey& Key, const std::vector<uint8_t>& Value, const Sha256::Digest& ValueHash)
+    {
+        if (Value.size() > MaxValueSize || Sha256::Compute(Value.data(), Value.size()) != ValueHash)
+            return false;
+
+        const auto      FilePath = GetEntryPath(Key);
+        std::error_code ErrorCode;
+        std::filesystem::create_directories(FilePath.parent_path(), ErrorCode);
+
+        auto TempPath = FilePath;
+        TempPath += ConcatenateTempSuffix();
+        {
+            EntryHeader Header{};
+            Header.Magic     = EntryMagic;
+            Header.ValueSize = Value.size();
+            Header.ValueHash = ValueHash;
+
+            std::ofstream Stream{TempPath, std::ios::binary | std::ios::trunc};
+            Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+            Stream.write(reinterpret_cast<const char*>(Value.data()), Value.size());
+            if (!Stream)
+            {
+                Stream.close();
+                std::filesystem::remove(TempPath, ErrorCode);
+                return false;
+            }
+        }
+
+        // Identical content under the same key: a concurrent writer replacing the file is harmless
+        std::filesystem::rename(TempPath, FilePath, ErrorCode);
+        if (ErrorCode)
+        {
+            std::filesystem::remove(TempPath, ErrorCode);
+            return false;
+        }
+        return true;
+    }
+
+    std::filesystem::path GetEntryPath(const CacheKey& Key) const
+    {
+        const std::string Name = Sha256::ToString(Key);
+        return m_Root / Name.substr(0, 2) / Name;
+    }
+
+    static constexpr uint64_t MaxValueSize = 256ull << 20;
+
+private:
+    static constexpr uint32_t EntryMagic = 0x31424353; // 'SCB1'
+
+    struct EntryHeader
+    {
+        uint32_t       Magic;
+        uint32_t       Reserved;
+        uint64_t       ValueSize;
+        Sha256::Digest ValueHash;
+    };
+
+    static std::string ConcatenateTempSuffix()
+    {
+        static std::atomic<uint32_t> Counter{0};
+        return "." + std::to_string(getpid()) + "." + std::to_string(Counter++) + ".tmp";
+    }
+
+private:
+    const std::filesystem::path m_Root;
+};
+
+// Wire protocol of the shared cache. A connection carries any number of requests, each
+// answered by exactly one response:
+//   Get: RequestHeader                   -> ResponseHeader [+ value if Ok]
+//   Put: RequestHeader + value           -> ResponseHeader
+// Headers are sent in the native layout: client and server are built from the same code.
+// Values travel with their SHA-256, and both ends verify it.
+namespace SharedCacheProtocol
+{
+
+constexpr uint32_t Magic = 0x31435353; // 'SSC1'
+
+enum class Opcode : uint32_t
+{
+    Get = 1,
+    Put = 2,
+};
+
+enum class Status : uint32_t
+{
+    Ok       = 0,
+    NotFound = 1,
+    Rejected = 2, // Malformed request or hash mismatch
+};
+
+struct RequestHeader
+{
+    uint32_t       Magic = SharedCacheProtocol::Magic;
+    Opcode         Op    = Opcode::Get;
+    CacheKey       Key{};
+    uint64_t       ValueSize = 0;
+    Sha256::Digest ValueHash{};
+};
+
+struct ResponseHeader
+{
+    uint32_t       Magic     = SharedCacheProtocol::Magic;
+    Status         Result    = Status::Ok;
+    uint64_t       ValueSize = 0;
+    Sha256::Digest ValueHash{};
+};
+
+inline bool SendAll(int Fd, const void* pData, size_t Size)
+{
+    const auto* pBytes = static_cast<const uint8_t*>(pData);
+    while (Size > 0)
+    {
+        // MSG_NOSIGNAL: a peer that went away must not kill the process with SIGPIPE
+        const ssize_t Sent = send(Fd, pBytes, Size, MSG_NOSIGNAL);
+        if (Sent < 0 && errno == EINTR)
+            continue;
+        if (Sent <= 0)
+            return false;
+        pBytes += Sent;
+        Size -= static_cast<size_t>(Sent);
+    }
+    return true;
+}
+
+inline bool ReceiveAll(int Fd, void* pData, size_t Size)
+{
+    auto* pBytes = static_cast<uint8_t*>(pData);
+    while (Size > 0)
+    {
+        const ssize_t Received = recv(Fd, pBytes, Size, 0);
+        if (Received < 0 && errno == EINTR)
+            continue;
+        if (Received <= 0)
+            return false;
+        pBytes += Received;
+        Size -= static_cast<size_t>(Received);
+    }
+    return true;
+}
+
+inline sockaddr_un MakeAddress(const std::filesystem::path& SocketPath)
+{
+    sockaddr_un Address{};
+    Address.sun_family = AF_UNIX;
+    std::strncpy(Address.sun_path, SocketPath.c_str(), sizeof(Address.sun_path) - 1);
+    return Address;
+}
+
+} // namespace SharedCacheProtocol
+
+// Stand-in for the build farm's cache service: serves a DirectoryBlobStore on a Unix
+// domain socket, one detached thread per connection. Every live connection has its socket
+// in m_ClientFds until its thread is done with the server.
+class SharedCacheServer
+{
+public:
+    SharedCacheServer(const std::filesystem::path& SocketPath, const std::filesystem::path& StoreDirectory) :
+        m_SocketPath{SocketPath},
+        m_Store{StoreDirectory}
+    {
+        if (SocketPath.native().size() >= sizeof(sockaddr_un::sun_path))
+            throw std::runtime_error("Socket path is too long: " + SocketPath.string());
+
+        m_ListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_ListenFd < 0)
+            throw std::runtime_error(std::string{"socket() failed: "} + std::strerror(errno));
+
+        unlink(SocketPath.c_str());
+        const auto Address = SharedCacheProtocol::MakeAddress(SocketPath);
+        if (bind(m_ListenFd, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) != 0 || listen(m_ListenFd, 64) != 0)
+        {
+            const std::string Error = std::strerror(errno);
+            close(m_ListenFd);
+            throw std::runtime_error("Failed to listen on " + SocketPath.string() + ": " + Error);
+        }
+    }
+
+    ~SharedCacheServer()
+    {
+        Stop();
+        {
+            std::unique_lock<std::mutex> Lock{m_Mtx};
+            m_ConnectionClosed.wait(Lock, [this]() { return m_ClientFds.empty(); });
+        }
+        unlink(m_SocketPath.c_str());
+    }
+
+    SharedCacheServer(const SharedCacheServer&)            = delete;
+    SharedCacheServer& operator=(const SharedCacheServer&) = delete;
+
+    // Serves connections until Stop() is called
+    void Run()
+    {
+        while (m_IsRunning)
+        {
+            const int Fd = accept4(m_ListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (Fd < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            if (!m_IsRunning)
+            {
+                close(Fd);
+                break;
+            }
+            // The thread can't remove Fd before it is added: that takes the lock held here
+            std::thread{&SharedCacheServer::ServeConnection, this, Fd}.detach();
+            m_ClientFds.push_back(Fd);
+        }
+    }
+
+    void Stop()
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        if (!m_IsRunning.exchange(false))
+            return;
+
+        // Wakes up accept() and every recv() in the connection threads
+        shutdown(m_ListenFd, SHUT_RDWR);
+        close(m_ListenFd);
+        for (int Fd : m_ClientFds)
+            shutdown(Fd, SHUT_RDWR);
+    }
+
+private:
+    void ServeConnection(int Fd)
+    {
+        using namespace SharedCacheProtocol;
+
+        for (RequestHeader Request; ReceiveAll(Fd, &Request, sizeof(Request));)
+        {
+            if (Request.Magic != Magic)
+                break;
+
+            ResponseHeader Response;
+            if (Request.Op == Opcode::Get)
+            {
+                // The store verifies the value hash and drops corrupted entries
+                auto Value = m_Store.Get(Request.Key);
+                if (!Value)
+                {
+                    Response.Result = Status::NotFound;
+                    if (!SendAll(Fd, &Response, sizeof(Response)))
+                        break;
+                    continue;
+                }
+
+                Response.ValueSize = Value->size();
+                Response.ValueHash = Sha256::Compute(Value->data(), Value->size());
+                if (!SendAll(Fd, &Response, sizeof(Response)) || !SendAll(Fd, Value->data(), Value->size()))
+                    break;
+            }
+            else if (Request.Op == Opcode::Put && Request.ValueSize <= DirectoryBlobStore::MaxValueSize)
+            {
+                std::vector<uint8_t> Value(static_cast<size_t>(Request.ValueSize));
+                if (!ReceiveAll(Fd, Value.data(), Value.size()))
+                    break;
+
+                Response.Result = m_Store.Put(Request.Key, Value, Request.ValueHash) ? Status::Ok : Status::Rejected;
+                if (!SendAll(Fd, &Response, sizeof(Response)))
+                    break;
+            }
+            else
+            {
+                // The request size is unknown, the stream cannot be resynchronized
+                Response.Result = Status::Rejected;
+                SendAll(Fd, &Response, sizeof(Response));
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_ClientFds.erase(std::find(m_ClientFds.begin(), m_ClientFds.end(), Fd));
+        close(Fd);
+        m_ConnectionClosed.notify_all();
+    }
+
+private:
+    const std::filesystem::path m_SocketPath;
+    DirectoryBlobStore          m_Store;
+    int                         m_ListenFd = -1;
+    std::atomic<bool>           m_IsRunning{true};
+
+    std::mutex              m_Mtx;
+    std::condition_variable m_ConnectionClosed;
+    std::vector<int>        m_ClientFds;
+};
+
+// Client of the shared cache.
+//  - Get() is synchronous and verifies the SHA-256 of what it receives.
+//  - Put() only queues the value; a background thread uploads it over its own connection.
+//    When the queue is full the upload is dropped: the cache must never slow a build down.
+//  - Any connection failure is handled as a miss (or a dropped upload), followed by one
+//    reconnection attempt on the next request.
+class SharedCacheClient
+{
+public:
+    struct Statistics
+    {
+        uint64_t Hits           = 0;
+        uint64_t Misses         = 0;
+        uint64_t Rejected       = 0; // Values that failed verification
+        uint64_t Uploads        = 0;
+        uint64_t DroppedUploads = 0;
+        uint64_t Errors         = 0; // Connection failures
+    };
+
+    explicit SharedCacheClient(const std::filesystem::path& SocketPath, size_t MaxPendingUploads = 64) :
+        m_SocketPath{SocketPath},
+        m_MaxPendingUploads{MaxPendingUploads},
+        m_Uploader{&SharedCacheClient::UploadThread, this}
+    {}
+
+    ~SharedCacheClient()
+    {
+        Flush();
+        {
+            std::lock_guard<std::mutex> Lock{m_UploadMtx};
+            m_IsRunning = false;
+        }
+        m_UploadCV.notify_all();
+        m_Uploader.join();
+
+        CloseConnection(m_GetFd);
+    }
+
+    SharedCacheClient(const SharedCacheClient&)            = delete;
+    SharedCacheClient& operator=(const SharedCacheClient&) = delete;
+
+    std::optional<std::vector<uint8_t>> Get(const CacheKey& Key)
+    {
+        using namespace SharedCacheProtocol;
+
+        std::lock_guard<std::mutex> Lock{m_GetMtx};
+
+        RequestHeader Request;
+        Request.Op  = Opcode::Get;
+        Request.Key = Key;
+
+        ResponseHeader Response;
+        if (!Exchange(m_GetFd, Request, nullptr, Response))
+        {
+            Count(&Statistics::Errors);
+            return std::nullopt;
+        }
+        if (Response.Result != Status::Ok)
+        {
+            Count(&Statistics::Misses);
+            return std::nullopt;
+        }
+
+        // The size comes from the server: validate it before allocating. The value is not
+        // drained, so the connection is out of sync and must be dropped.
+        if (Response.ValueSize > DirectoryBlobStore::MaxValueSize)
+        {
+            CloseConnection(m_GetFd);
+            Count(&Statistics::Errors);
+            return std::nullopt;
+        }
+
+        std::vector<uint8_t> Value(static_cast<size_t>(Response.ValueSize));
+        if (!ReceiveAll(m_GetFd, Value.data(), Value.size()))
+        {
+            CloseConnection(m_GetFd);
+            Count(&Statistics::Errors);
+            return std::nullopt;
+        }
+        if (Sha256::Compute(Value.data(), Value.size()) != Response.ValueHash)
+        {
+            Count(&Statistics::Rejected);
+            return std::nullopt;
+        }
+
+        Count(&Statistics::Hits);
+        return Value;
+    }
+
+    void Put(const CacheKey& Key, std::vector<uint8_t> Value)
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_UploadMtx};
+            if (m_PendingUploads.size() >= m_MaxPendingUploads)
+            {
+                Count(&Statistics::DroppedUploads);
+                return;
+            }
+            m_PendingUploads.push_back({Key, std::move(Value)});
+        }
+        m_UploadCV.notify_all();
+    }
+
+    // Waits until every queued upload has been sent
+    void Flush()
+    {
+        std::unique_lock<std::mutex> Lock{m_UploadMtx};
+        m_FlushCV.wait(Lock, [this]() { return m_PendingUploads.empty() && !m_IsUploading; });
+    }
+
+    Statistics GetStatistics() const
+    {
+        std::lock_guard<std::mutex> Lock{m_StatsMtx};
+        return m_Statistics;
+    }
+
+private:
+    struct Upload
+    {
+        CacheKey             Key;
+        std::vector<uint8_t> Value;
+    };
+
+    void Count(uint64_t Statistics::*pCounter)
+    {
+        std::lock_guard<std::mutex> Lock{m_StatsMtx};
+        ++(m_Statistics.*pCounter);
+    }
+
+    int Connect() const
+    {
+        const int Fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (Fd < 0)
+            return -1;
+
+        const auto Address = SharedCacheProtocol::MakeAddress(m_SocketPath);
+        if (connect(Fd, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) != 0)
+        {
+            close(Fd);
+            return -1;
+        }
+        return Fd;
+    }
+
+    static void CloseConnection(int& Fd)
+    {
+        if (Fd >= 0)
+            close(Fd);
+        Fd = -1;
+    }
+
+    // Sends the request (and the value) and receives the response header. A broken cached
+    // connection is reopened once: the server may have restarted since the last request.
+    bool Exchange(int& Fd, const SharedCacheProtocol::RequestHeader& Request, const std::vector<uint8_t>* pValue, SharedCacheProtocol::ResponseHeader& Response)
+    {
+        using namespace SharedCacheProtocol;
+
+        for (int Attempt = 0; Attempt < 2; ++Attempt)
+        {
+            if (Fd < 0 && (Fd = Connect()) < 0)
+                return false;
+
+            if (SendAll(Fd, &Request, sizeof(Request)) &&
+                (pValue == nullptr || SendAll(Fd, pValue->data(), pValue->size())) &&
+                ReceiveAll(Fd, &Response, sizeof(Response)) &&
+                Response.Magic == Magic)
+                return true;
+
+            CloseConnection(Fd);
+        }
+        return false;
+    }
+
+    void UploadThread()
+    {
+        using namespace SharedCacheProtocol;
+
+        int Fd = -1;
+        for (;;)
+        {
+            Upload Item;
+            {
+                std::unique_lock<std::mutex> Lock{m_UploadMtx};
+                m_UploadCV.wait(Lock, [this]() { return !m_PendingUploads.empty() || !m_IsRunning; });
+                if (m_PendingUploads.empty())
+                    break;
+
+                Item = std::move(m_PendingUploads.front());
+                m_PendingUploads.pop_front();
+                m_IsUploading = true;
+            }
+
+            RequestHeader Request;
+            Request.Op        = Opcode::Put;
+            Request.Key       = Item.Key;
+            Request.ValueSize = Item.Value.size();
+            Request.ValueHash = Sha256::Compute(Item.Value.data(), Item.Value.size());
+
+            ResponseHeader Response;
+            if (!Exchange(Fd, Request, &Item.Value, Response))
+                Count(&Statistics::Errors);
+            else if (Response.Result != Status::Ok)
+                Count(&Statistics::Rejected);
+            else
+                Count(&Statistics::Uploads);
+
+            {
+                std::lock_guard<std::mutex> Lock{m_UploadMtx};
+                m_IsUploading = false;
+            }
+            m_FlushCV.notify_all();
+        }
+        CloseConnection(Fd);
+    }
+
+private:
+    const std::filesystem::path m_SocketPath;
+    const size_t                m_MaxPendingUploads;
+
+    std::mutex m_GetMtx;
+    int        m_GetFd = -1;
+
+    std::mutex              m_UploadMtx;
+    std::condition_variable m_UploadCV;
+    std::condition_variable m_FlushCV;
+    std::deque<Upload>      m_PendingUploads;
+    bool                    m_IsUploading = false;
+    bool                    m_IsRunning   = true;
+
+    mutable std::mutex m_StatsMtx;
+    Statistics         m_Statistics;
+
+    std::thread m_Uploader;
+};
+
+// Read-through cache: the local store is checked first, then the shared one (a hit is
+// copied to the local store), and only then the value is produced, stored locally and
+// uploaded in the background.
+class TieredShaderCache
+{
+public:
+    struct Statistics
+    {
+        uint64_t LocalHits  = 0;
+        uint64_t RemoteHits = 0;
+        uint64_t Misses     = 0;
+    };
+
+    TieredShaderCache(const std::filesystem::path& LocalDirectory, SharedCacheClient* pRemote) :
+        m_Local{LocalDirectory},
+        m_pRemote{pRemote}
+    {}
+
+    template <typename ProducerType>
+    std::vector<uint8_t> GetOrProduce(const CacheKey& Key, ProducerType&& Producer)
+    {
+        if (auto Value = m_Local.Get(Key))
+        {
+            ++m_Statistics.LocalHits;
+            return std::move(*Value);
+        }
+
+        if (m_pRemote != nullptr)
+        {
+            if (auto Value = m_pRemote->Get(Key))
+            {
+                ++m_Statistics.RemoteHits;
+                m_Local.Put(Key, *Value, Sha256::Compute(Value->data(), Value->size()));
+                return std::move(*Value);
+            }
+        }
+
+        ++m_Statistics.Misses;
+        std::vector<uint8_t> Value = Producer();
+        m_Local.Put(Key, Value, Sha256::Compute(Value.data(), Value.size()));
+        if (m_pRemote != nullptr)
+            m_pRemote->Put(Key, Value);
+        return Value;
+    }
+
+    const Statistics& GetStatistics() const
+    {
+        return m_Statistics;
+    }
+
+private:
+    DirectoryBlobStore       m_Local;
+    SharedCacheClient* const m_pRemote;
+    Statistics               m_Statistics;
+};
@@ -0,0 +1,616 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <chrono>
+#include <csignal>
+
+#include <sys/wait.h>
+
+#include "SharedCache.hpp"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string GenerateMipsCS = R"(
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+// The reason for separating channels is to reduce bank conflicts in the
+// local data memory controller.  A large stride will cause more threads
+// to collide on the same memory bank.
+groupshared float gs_R[64];
+groupshared float gs_G[64];
+groupshared float gs_B[64];
+groupshared float gs_A[64];
+
+void StoreColor(uint Index, float4 Color)
+{
+    gs_R[Index] = Color.r;
+    gs_G[Index] = Color.g;
+    gs_B[Index] = Color.b;
+    gs_A[Index] = Color.a;
+}
+
+float4 LoadColor(uint Index)
+{
+    return float4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);
+}
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+[numthreads(8, 8, 1)] 
+void main(uint GI : SV_GroupIndex, uint3 DTid: SV_DispatchThreadID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    bool IsValidThread = all(DTid.xy < DstMipSize);
+    uint ArraySlice    = FirstArraySlice + DTid.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+        // One bilinear sample is insufficient when scaling down by more than 2x.
+        // You will slightly undersample in the case where the source dimension
+        // is odd.  This is why it's a really good idea to only generate mips on
+        // power-of-two sized textures.  Trying to handle the undersampling case
+        // will force this shader to be slower and more complicated as it will
+        // have to take more source texture samples.
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (DTid.xy + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        // > 2:1 in X dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // horizontally.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        // > 2:1 in Y dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // vertically.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        // > 2:1 in in both dimensions
+        // Use 4 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // in both directions.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(DTid.xy, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    if (IsValidThread)
+    {
+        // Without lane swizzle operations, the only way to share data with other
+        // threads is through LDS.
+        StoreColor(GI, Src1);
+    }
+
+    // This guarantees all LDS writes are complete and that all threads have
+    // executed all instructions so far (and therefore have issued their LDS
+    // write instructions.)
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // With low three bits for X and high three bits for Y, this bit mask
+        // (binary: 001001) checks that X and Y are even.
+        if ((GI & 0x9) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x01);
+            float4 Src3 = LoadColor(GI + 0x08);
+            float4 Src4 = LoadColor(GI + 0x09);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip2[uint3(DTid.xy / 2, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 2)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask (binary: 011011) checks that X and Y are multiples of four.
+        if ((GI & 0x1B) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x02);
+            float4 Src3 = LoadColor(GI + 0x10);
+            float4 Src4 = LoadColor(GI + 0x12);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip3[uint3(DTid.xy / 4, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 3)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask would be 111111 (X & Y multiples of 8), but only one
+        // thread fits that criteria.
+        if (GI == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x04);
+            float4 Src3 = LoadColor(GI + 0x20);
+            float4 Src4 = LoadColor(GI + 0x24);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip4[uint3(DTid.xy / 8, ArraySlice)] = PackColor(Src1);
+        }
+    }
+}
+
+)";
+;
+} // namespace HLSL
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const std::string& Preamble)
+{
+    GlslangInitilizer GlslangScope{};
+    glslang::TShader  Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+    return SPIRV;
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer TintScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+// Everything that affects the output is part of the key. The version string stands for the
+// revisions of glslang, SPIRV-Tools and Tint and for the conversion options used above:
+// bump it whenever any of them changes, or stale WGSL will be served from the shared cache.
+const std::string ConverterVersion = "glslang:vulkan1.0/spv1.0;spirv-opt:legalization+performance;tint:WgslFromIR;v1";
+
+CacheKey ComputeCacheKey(const std::string& Source, const std::string& Preamble, const std::string& EntryPoint)
+{
+    Sha256 Hasher;
+    Hasher.UpdateSized(ConverterVersion);
+    Hasher.UpdateSized(EntryPoint);
+    Hasher.UpdateSized(Preamble);
+    Hasher.UpdateSized(Source);
+    return Hasher.Finish();
+}
+
+std::vector<std::string> CreatePermutations()
+{
+    std::vector<std::string> Preambles;
+    for (uint32_t PermutationIdx = 0; PermutationIdx < 8; ++PermutationIdx)
+    {
+        std::string Preamble = ConcatenateArgs("#define NON_POWER_OF_TWO ", PermutationIdx % 4, "\n");
+        if (PermutationIdx >= 4)
+            Preamble += "#define CONVERT_TO_SRGB\n";
+        Preambles.emplace_back(std::move(Preamble));
+    }
+    return Preambles;
+}
+
+struct PassReport
+{
+    std::string                   Name;
+    double                        TimeMs = 0;
+    TieredShaderCache::Statistics Cache;
+    SharedCacheClient::Statistics Remote;
+};
+
+// One build of all permutations on a "machine" that owns the given local cache
+PassReport RunPass(const std::string& Name, TieredShaderCache& Cache, SharedCacheClient& Remote, const std::vector<std::string>& Preambles, std::vector<std::string>& WGSL)
+{
+    const auto CacheStatsBefore  = Cache.GetStatistics();
+    const auto RemoteStatsBefore = Remote.GetStatistics();
+    const auto StartTime         = std::chrono::high_resolution_clock::now();
+
+    WGSL.resize(Preambles.size());
+    for (size_t PermutationIdx = 0; PermutationIdx < Preambles.size(); ++PermutationIdx)
+    {
+        const auto& Preamble = Preambles[PermutationIdx];
+        const auto  Value    = Cache.GetOrProduce(ComputeCacheKey(HLSL::GenerateMipsCS, Preamble, "main"), [&]() {
+            const std::string Result = ConvertSPIRVtoWGSL(OptimizeSPIRV(ConvertHLSLtoSPIRV(HLSL::GenerateMipsCS, Preamble), SPV_ENV_VULKAN_1_0));
+            return std::vector<uint8_t>(Result.begin(), Result.end());
+        });
+        WGSL[PermutationIdx].assign(Value.begin(), Value.end());
+    }
+    // Uploads are asynchronous; wait for them only to make the statistics of the pass complete
+    Remote.Flush();
+
+    PassReport Report;
+    Report.Name   = Name;
+    Report.TimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+    const auto CacheStats   = Cache.GetStatistics();
+    Report.Cache.LocalHits  = CacheStats.LocalHits - CacheStatsBefore.LocalHits;
+    Report.Cache.RemoteHits = CacheStats.RemoteHits - CacheStatsBefore.RemoteHits;
+    Report.Cache.Misses     = CacheStats.Misses - CacheStatsBefore.Misses;
+
+    const auto RemoteStats       = Remote.GetStatistics();
+    Report.Remote.Uploads        = RemoteStats.Uploads - RemoteStatsBefore.Uploads;
+    Report.Remote.DroppedUploads = RemoteStats.DroppedUploads - RemoteStatsBefore.DroppedUploads;
+    Report.Remote.Rejected       = RemoteStats.Rejected - RemoteStatsBefore.Rejected;
+    Report.Remote.Errors         = RemoteStats.Errors - RemoteStatsBefore.Errors;
+    return Report;
+}
+
+void Expect(bool Condition, const std::string& PassName, const char* Description)
+{
+    if (!Condition)
+        LOG_ERROR_AND_THROW(PassName, ": expected ", Description);
+}
+
+// Runs SharedCacheServer in a child process, like the real service running on another host
+class ServerProcess
+{
+public:
+    ServerProcess(const std::filesystem::path& SocketPath, const std::filesystem::path& StoreDirectory)
+    {
+        m_Pid = fork();
+        if (m_Pid < 0)
+            LOG_ERROR_AND_THROW("fork() failed: ", std::strerror(errno));
+
+        if (m_Pid == 0)
+        {
+            int ExitCode = 0;
+            try
+            {
+                SharedCacheServer Server{SocketPath, StoreDirectory};
+                Server.Run();
+            }
+            catch (const std::exception& Error)
+            {
+                std::cerr << "Error: " << Error.what() << std::endl;
+                ExitCode = 1;
+            }
+            _exit(ExitCode);
+        }
+
+        // Wait until the server accepts connections
+        for (int Attempt = 0; Attempt < 500; ++Attempt)
+        {
+            const int  Fd      = socket(AF_UNIX, SOCK_STREAM, 0);
+            const auto Address = SharedCacheProtocol::MakeAddress(SocketPath);
+            const bool IsReady = Fd >= 0 && connect(Fd, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) == 0;
+            if (Fd >= 0)
+                close(Fd);
+            if (IsReady)
+                return;
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        Stop();
+        LOG_ERROR_AND_THROW("Shared cache server did not start");
+    }
+
+    ~ServerProcess()
+    {
+        Stop();
+    }
+
+    // Entries are renamed into place, so killing the server never leaves partial entries behind
+    void Stop()
+    {
+        if (m_Pid <= 0)
+            return;
+        kill(m_Pid, SIGTERM);
+        waitpid(m_Pid, nullptr, 0);
+        m_Pid = -1;
+    }
+
+private:
+    pid_t m_Pid = -1;
+};
+
+void RunSelfTest(const std::filesystem::path& Root)
+{
+    const auto SocketPath      = Root / "cache.sock";
+    const auto ServerDirectory = Root / "server";
+
+    // Fork before glslang and Tint are initialized: the child only serves the store
+    ServerProcess Server{SocketPath, ServerDirectory};
+
+    const auto               Preambles = CreatePermutations();
+    std::vector<PassReport>  Reports;
+    std::vector<std::string> ReferenceWGSL;
+    std::vector<std::string> WGSL;
+
+    // Machine A builds everything and populates the shared cache
+    {
+        SharedCacheClient Remote{SocketPath};
+        TieredShaderCache Cache{Root / "machine-a", &Remote};
+
+        Reports.push_back(RunPass("A: cold", Cache, Remote, Preambles, ReferenceWGSL));
+        Expect(Reports.back().Cache.Misses == Preambles.size(), Reports.back().Name, "every permutation to be converted");
+        Expect(Reports.back().Remote.Uploads == Preambles.size(), Reports.back().Name, "every permutation to be uploaded");
+    }
+
+    // Machine B has an empty local cache: everything comes from the shared one, then from the local one
+    {
+        SharedCacheClient Remote{SocketPath};
+        TieredShaderCache Cache{Root / "machine-b", &Remote};
+
+        Reports.push_back(RunPass("B: shared", Cache, Remote, Preambles, WGSL));
+        Expect(Reports.back().Cache.RemoteHits == Preambles.size(), Reports.back().Name, "only shared cache hits");
+        Expect(WGSL == ReferenceWGSL, Reports.back().Name, "the WGSL produced by machine A");
+
+        Reports.push_back(RunPass("B: local", Cache, Remote, Preambles, WGSL));
+        Expect(Reports.back().Cache.LocalHits == Preambles.size(), Reports.back().Name, "only local cache hits");
+        Expect(WGSL == ReferenceWGSL, Reports.back().Name, "the WGSL produced by machine A");
+    }
+
+    // Corrupt one entry of the server store: it must be detected and recomputed, never served
+    {
+        const DirectoryBlobStore ServerStore{ServerDirectory};
+        const auto               EntryPath = ServerStore.GetEntryPath(ComputeCacheKey(HLSL::GenerateMipsCS, Preambles[5], "main"));
+
+        std::fstream Entry{EntryPath, std::ios::in | std::ios::out | std::ios::binary};
+        Entry.seekg(-1, std::ios::end);
+        const char LastChar = static_cast<char>(Entry.get());
+        Entry.seekp(-1, std::ios::end);
+        Entry.put(static_cast<char>(LastChar ^ 0x20));
+        if (!Entry)
+            LOG_ERROR_AND_THROW("Failed to corrupt ", EntryPath);
+    }
+    {
+        SharedCacheClient Remote{SocketPath};
+        TieredShaderCache Cache{Root / "machine-c", &Remote};
+
+        Reports.push_back(RunPass("C: corrupted", Cache, Remote, Preambles, WGSL));
+        Expect(Reports.back().Cache.RemoteHits == Preambles.size() - 1 && Reports.back().Cache.Misses == 1, Reports.back().Name, "one recomputed permutation");
+        Expect(Reports.back().Remote.Uploads == 1, Reports.back().Name, "the recomputed permutation to be uploaded again");
+        Expect(WGSL == ReferenceWGSL, Reports.back().Name, "the WGSL produced by machine A");
+    }
+
+    // The shared cache is an accelerator only: without it, builds still succeed
+    Server.Stop();
+    {
+        SharedCacheClient Remote{SocketPath};
+        TieredShaderCache Cache{Root / "machine-d", &Remote};
+
+        Reports.push_back(RunPass("D: offline", Cache, Remote, Preambles, WGSL));
+        Expect(Reports.back().Cache.Misses == Preambles.size(), Reports.back().Name, "every permutation to be converted");
+        Expect(WGSL == ReferenceWGSL, Reports.back().Name, "the WGSL produced by machine A");
+    }
+
+    std::cout << "Pass          Time ms  Local  Shared  Misses  Uploads  Dropped  Rejected  Errors\n";
+    for (const auto& Report : Reports)
+    {
+        std::cout << std::left << std::setw(12) << Report.Name << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(9) << Report.TimeMs
+                  << std::setw(7) << Report.Cache.LocalHits
+                  << std::setw(8) << Report.Cache.RemoteHits
+                  << std::setw(8) << Report.Cache.Misses
+                  << std::setw(9) << Report.Remote.Uploads
+                  << std::setw(9) << Report.Remote.DroppedUploads
+                  << std::setw(10) << Report.Remote.Rejected
+                  << std::setw(8) << Report.Remote.Errors << "\n";
+    }
+    LOG_INFO_MESSAGE("Shared cache hits are ", Reports[0].TimeMs / std::max(Reports[1].TimeMs, 1e-3), "x faster than converting");
+}
+
+// Usage: SharedShaderCache                          Self-test with a local stand-in server
+//        SharedShaderCache --serve <socket> <dir>   Serves the cache stored in <dir>
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        if (argc == 4 && std::string{argv[1]} == "--serve")
+        {
+            SharedCacheServer Server{argv[2], argv[3]};
+            LOG_INFO_MESSAGE("Serving ", argv[3], " on ", argv[2]);
+            Server.Run();
+            return 0;
+        }
+        if (argc != 1)
+            LOG_ERROR_AND_THROW("Unknown arguments, usage: SharedShaderCache [--serve <socket> <dir>]");
+
+        const auto Root = std::filesystem::temp_directory_path() / ConcatenateArgs("SharedShaderCache.", getpid());
+        std::filesystem::remove_all(Root);
+        std::filesystem::create_directories(Root);
+        try
+        {
+            RunSelfTest(Root);
+        }
+        catch (const std::exception&)
+        {
+            std::filesystem::remove_all(Root);
+            throw;
+        }
+        std::filesystem::remove_all(Root);
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
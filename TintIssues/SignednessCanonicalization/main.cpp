@@ -0,0 +1,838 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <optional>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+#include "source/opt/ir_builder.h"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+namespace HLSL
+{
+
+// From ComparisonIntTypes: GetDimensions() returns uint, glslang queries a signed size
+const std::string FillTextureCS = R"(
+
+RWTexture2D</*format=rgba8*/ float4> g_tex2DUAV : register(u0);
+[numthreads(16, 16, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+	uint2 ui2Dim;
+	g_tex2DUAV.GetDimensions(ui2Dim.x, ui2Dim.y);
+	if (DTid.x >= ui2Dim.x || DTid.y >= ui2Dim.y)
+        return;
+
+	g_tex2DUAV[DTid.xy] = float4(float2(DTid.xy % 256u) / 256.0, 0.0, 1.0);
+}
+)";
+
+// Mip-style kernel mixing signed offsets, unsigned thread ids and texture queries
+const std::string DownsampleCS = R"(
+
+Texture2D<float4>                    g_SrcMip;
+RWTexture2D</*format=rgba8*/ float4> g_DstMip;
+
+cbuffer cbDownsample
+{
+    int2 g_SrcOffset;
+    uint g_SrcMipLevel;
+    uint g_Padding;
+};
+
+[numthreads(8, 8, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+    uint2 DstDim;
+    g_DstMip.GetDimensions(DstDim.x, DstDim.y);
+    if (any(DTid.xy >= DstDim))
+        return;
+
+    uint Width, Height, NumLevels;
+    g_SrcMip.GetDimensions(g_SrcMipLevel, Width, Height, NumLevels);
+
+    int2   SrcCoord = int2(DTid.xy * 2u) + g_SrcOffset;
+    int2   MaxCoord = int2(Width - 1u, Height - 1u);
+    float4 Color    = float4(0.0, 0.0, 0.0, 0.0);
+    [unroll] for (int y = 0; y < 2; ++y)
+    {
+        [unroll] for (int x = 0; x < 2; ++x)
+        {
+            int2 Coord = clamp(SrcCoord + int2(x, y), int2(0, 0), MaxCoord);
+            Color += g_SrcMip.Load(int3(Coord, g_SrcMipLevel));
+        }
+    }
+    g_DstMip[DTid.xy] = Color * 0.25;
+}
+)";
+;
+} // namespace HLSL
+
+struct SignednessReport
+{
+    uint32_t BitcastsBefore    = 0;
+    uint32_t BitcastsAfter     = 0;
+    uint32_t FoldedChains      = 0;
+    uint32_t HoistedExtracts   = 0;
+    uint32_t RetypedQueries    = 0;
+    uint32_t BypassedOperands  = 0;
+    uint32_t FlippedOperations = 0;
+};
+
+// Removes OpBitcasts between signed and unsigned integers that only exist because glslang
+// and HLSL disagree on signedness. Tint turns each of them into a bitcast<>() in WGSL, and
+// SPIR-V operands of the wrong signedness into more of them. The pass iterates to a fixed
+// point:
+//  - bitcast chains are folded: bitcast<A>(bitcast<B>(x)) -> x or bitcast<A>(x);
+//  - bitcasts of vector components are hoisted to the vector so that they can be folded
+//    into its producer;
+//  - image queries, whose result signedness is free in SPIR-V, are retyped to unsigned like
+//    their WGSL counterparts;
+//  - a bitcast feeding an operand that accepts the source signedness (image coordinates,
+//    comparisons, arithmetic of the source type) is bypassed;
+//  - sign-agnostic arithmetic whose operands are all cast from the other signedness is
+//    performed in that signedness, when this removes more casts than it adds.
+// Must run after the regular spirv-opt passes, which leave the casts in canonical positions.
+class SignednessCanonicalizationPass final : public spvtools::opt::Pass
+{
+public:
+    explicit SignednessCanonicalizationPass(SignednessReport* pReport) :
+        m_pReport{pReport}
+    {}
+
+    const char* name() const override
+    {
+        return "canonicalize-int-signedness";
+    }
+
+    Status Process() override
+    {
+        m_pReport->BitcastsBefore = CountIntBitcasts();
+
+        bool IsModified = false;
+        for (uint32_t Iteration = 0; Iteration < MaxIterations; ++Iteration)
+        {
+            bool IsChanged = false;
+            IsChanged |= FoldBitcastChains();
+            IsChanged |= HoistBitcastsOverExtracts();
+            IsChanged |= RetypeImageQueries();
+            IsChanged |= BypassOperandBitcasts();
+            IsChanged |= FlipArithmetic();
+            IsChanged |= RemoveDeadBitcasts();
+            if (!IsChanged)
+                break;
+            IsModified = true;
+        }
+
+        m_pReport->BitcastsAfter = CountIntBitcasts();
+
+        return IsModified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+    }
+
+private:
+    static constexpr uint32_t MaxIterations = 8;
+
+    enum class Signedness
+    {
+        Any,
+        Signed,
+        Unsigned,
+    };
+
+    // Analyses kept up to date by the instruction builders of the pass
+    static spvtools::opt::IRContext::Analysis GetBuilderAnalyses()
+    {
+        return spvtools::opt::IRContext::kAnalysisDefUse | spvtools::opt::IRContext::kAnalysisInstrToBlockMapping;
+    }
+
+    static bool IsDebugOrAnnotation(const spvtools::opt::Instruction* pInst)
+    {
+        return spvtools::opt::IsAnnotationInst(pInst->opcode()) || spvtools::opt::IsDebug2Inst(pInst->opcode());
+    }
+
+    static bool IsImageQuery(spv::Op Opcode)
+    {
+        return Opcode == spv::Op::OpImageQuerySize || Opcode == spv::Op::OpImageQuerySizeLod || Opcode == spv::Op::OpImageQueryLevels || Opcode == spv::Op::OpImageQuerySamples;
+    }
+
+    // Operations whose result bits do not depend on the signedness of the operands
+    static bool IsSignednessAgnostic(spv::Op Opcode)
+    {
+        switch (Opcode)
+        {
+            case spv::Op::OpIAdd:
+            case spv::Op::OpISub:
+            case spv::Op::OpIMul:
+            case spv::Op::OpBitwiseAnd:
+            case spv::Op::OpBitwiseOr:
+            case spv::Op::OpBitwiseXor:
+            case spv::Op::OpNot:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    template <typename PredicateType>
+    std::vector<spvtools::opt::Instruction*> CollectInstructions(PredicateType&& Predicate)
+    {
+        std::vector<spvtools::opt::Instruction*> Instructions;
+        for (auto& Function : *get_module())
+        {
+            Function.ForEachInst([&](spvtools::opt::Instruction* pInst) {
+                if (Predicate(*pInst))
+                    Instructions.push_back(pInst);
+            });
+        }
+        return Instructions;
+    }
+
+    uint32_t GetTypeOf(uint32_t Id)
+    {
+        return get_def_use_mgr()->GetDef(Id)->type_id();
+    }
+
+    // Integer component type of an integer scalar or vector type, nullptr for other types
+    const spvtools::opt::analysis::Integer* GetIntComponent(uint32_t TypeId, uint32_t* pNumComponents = nullptr)
+    {
+        const auto* pType = context()->get_type_mgr()->GetType(TypeId);
+        if (pType == nullptr)
+            return nullptr;
+
+        uint32_t NumComponents = 1;
+        if (const auto* pVector = pType->AsVector())
+        {
+            pType         = pVector->element_type();
+            NumComponents = pVector->element_count();
+        }
+        if (pNumComponents != nullptr)
+            *pNumComponents = NumComponents;
+        return pType->AsInteger();
+    }
+
+    bool IsIntType(uint32_t TypeId)
+    {
+        return GetIntComponent(TypeId) != nullptr;
+    }
+
+    bool IsSignedIntType(uint32_t TypeId)
+    {
+        const auto* pInt = GetIntComponent(TypeId);
+        return pInt != nullptr && pInt->IsSigned();
+    }
+
+    // Integer type of the same width and number of components, with the opposite signedness
+    uint32_t GetFlippedIntType(uint32_t TypeId)
+    {
+        const auto* pInt = GetIntComponent(TypeId);
+        if (pInt == nullptr)
+            return 0;
+
+        auto*       pTypeMgr = context()->get_type_mgr();
+        const auto* pVector  = pTypeMgr->GetType(TypeId)->AsVector();
+
+        spvtools::opt::analysis::Integer Flipped{pInt->width(), !pInt->IsSigned()};
+        if (pVector == nullptr)
+            return pTypeMgr->GetTypeInstruction(&Flipped);
+
+        spvtools::opt::analysis::Vector FlippedVector{pTypeMgr->GetRegisteredType(&Flipped), pVector->element_count()};
+        return pTypeMgr->GetTypeInstruction(&FlippedVector);
+    }
+
+    bool AreSameShapeIntTypes(uint32_t TypeIdA, uint32_t TypeIdB)
+    {
+        uint32_t    NumComponentsA = 0;
+        uint32_t    NumComponentsB = 0;
+        const auto* pIntA          = GetIntComponent(TypeIdA, &NumComponentsA);
+        const auto* pIntB          = GetIntComponent(TypeIdB, &NumComponentsB);
+        return pIntA != nullptr && pIntB != nullptr && pIntA->width() == pIntB->width() && NumComponentsA == NumComponentsB;
+    }
+
+    // Returns the defining OpBitcast if the id is a cast between integer types of the same shape
+    spvtools::opt::Instruction* GetIntBitcast(uint32_t Id)
+    {
+        auto* pDef = get_def_use_mgr()->GetDef(Id);
+        if (pDef == nullptr || pDef->opcode() != spv::Op::OpBitcast)
+            return nullptr;
+        return AreSameShapeIntTypes(pDef->type_id(), GetTypeOf(pDef->GetSingleWordInOperand(0))) ? pDef : nullptr;
+    }
+
+    uint32_t CountIntBitcasts()
+    {
+        return static_cast<uint32_t>(CollectInstructions([this](const spvtools::opt::Instruction& Inst) {
+                                         return Inst.opcode() == spv::Op::OpBitcast && GetIntBitcast(Inst.result_id()) != nullptr;
+                                     }).size());
+    }
+
+    // Splits the users of a value into casts to the given type and everything else
+    void GetUsers(spvtools::opt::Instruction* pValue, uint32_t CastTypeId, std::vector<spvtools::opt::Instruction*>& Casts, std::vector<spvtools::opt::Instruction*>& OtherUsers)
+    {
+        get_def_use_mgr()->ForEachUser(pValue, [&](spvtools::opt::Instruction* pUser) {
+            if (IsDebugOrAnnotation(pUser))
+                return;
+            if (pUser->opcode() == spv::Op::OpBitcast && pUser->type_id() == CastTypeId)
+                Casts.push_back(pUser);
+            else if (std::find(OtherUsers.begin(), OtherUsers.end(), pUser) == OtherUsers.end())
+                OtherUsers.push_back(pUser);
+        });
+    }
+
+    void ReplaceCastsWith(const std::vector<spvtools::opt::Instruction*>& Casts, uint32_t ValueId)
+    {
+        for (auto* pCast : Casts)
+        {
+            context()->ReplaceAllUsesWith(pCast->result_id(), ValueId);
+            context()->KillNamesAndDecorates(pCast);
+            context()->KillInst(pCast);
+        }
+    }
+
+    void ReplaceOperand(spvtools::opt::Instruction* pUser, uint32_t OldId, uint32_t NewId)
+    {
+        pUser->ForEachInId([&](uint32_t* pId) {
+            if (*pId == OldId)
+                *pId = NewId;
+        });
+        get_def_use_mgr()->AnalyzeInstUse(pUser);
+    }
+
+    // Same bits as the constant, typed as NewTypeId. Returns 0 if the id is not a constant.
+    uint32_t ReinterpretConstant(uint32_t ConstantId, uint32_t NewTypeId)
+    {
+        auto*       pConstMgr = context()->get_constant_mgr();
+        const auto* pConstant = pConstMgr->FindDeclaredConstant(ConstantId);
+        const auto* pNewType  = context()->get_type_mgr()->GetType(NewTypeId);
+        if (pConstant == nullptr)
+            return 0;
+
+        const spvtools::opt::analysis::Constant* pNewConstant = nullptr;
+        if (pConstant->AsNullConstant() != nullptr)
+        {
+            pNewConstant = pConstMgr->GetConstant(pNewType, {});
+        }
+        else if (const auto* pScalar = pConstant->AsScalarConstant())
+        {
+            pNewConstant = pConstMgr->GetConstant(pNewType, pScalar->words());
+        }
+        else if (const auto* pVector = pConstant->AsVectorConstant())
+        {
+            const uint32_t        ComponentTypeId = context()->get_type_mgr()->GetId(pNewType->AsVector()->element_type());
+            std::vector<uint32_t> ComponentIds;
+            for (const auto* pComponent : pVector->GetComponents())
+            {
+                const uint32_t ComponentId = ReinterpretConstant(pConstMgr->GetDefiningInstruction(pComponent)->result_id(), ComponentTypeId);
+                if (ComponentId == 0)
+                    return 0;
+                ComponentIds.push_back(ComponentId);
+            }
+            pNewConstant = pConstMgr->GetConstant(pNewType, ComponentIds);
+        }
+
+        return pNewConstant != nullptr ? pConstMgr->GetDefiningInstruction(pNewConstant)->result_id() : 0;
+    }
+
+    // bitcast<A>(bitcast<B>(x)) -> x if x is of type A, bitcast<A>(x) otherwise
+    bool FoldBitcastChains()
+    {
+        bool IsChanged = false;
+        for (auto* pBitcast : CollectInstructions([](const spvtools::opt::Instruction& Inst) { return Inst.opcode() == spv::Op::OpBitcast; }))
+        {
+            const auto* pInner = GetIntBitcast(pBitcast->GetSingleWordInOperand(0));
+            if (pInner == nullptr || GetIntBitcast(pBitcast->result_id()) == nullptr)
+                continue;
+
+            const uint32_t SourceId = pInner->GetSingleWordInOperand(0);
+            if (GetTypeOf(SourceId) == pBitcast->type_id())
+            {
+                ReplaceCastsWith({pBitcast}, SourceId);
+            }
+            else
+            {
+                pBitcast->SetInOperand(0, {SourceId});
+                get_def_use_mgr()->AnalyzeInstUse(pBitcast);
+            }
+            ++m_pReport->FoldedChains;
+            IsChanged = true;
+        }
+        return IsChanged;
+    }
+
+    // bitcast<uint>(v.x), bitcast<uint>(v.y) -> bitcast<uint2>(v).x, bitcast<uint2>(v).y
+    // This is the shape of the GetDimensions() outputs, which glslang extracts from a signed
+    // size query. Only done when it removes casts or lets the vector cast fold into the
+    // producer of the vector.
+    bool HoistBitcastsOverExtracts()
+    {
+        std::map<uint32_t, std::vector<spvtools::opt::Instruction*>> ExtractsPerVector;
+        for (auto* pExtract : CollectInstructions([](const spvtools::opt::Instruction& Inst) { return Inst.opcode() == spv::Op::OpCompositeExtract && Inst.NumInOperands() == 2; }))
+        {
+            const uint32_t VectorId = pExtract->GetSingleWordInOperand(0);
+            auto*          pVector  = get_def_use_mgr()->GetDef(VectorId);
+            if (IsIntType(pExtract->type_id()) && context()->get_type_mgr()->GetType(pVector->type_id())->AsVector() != nullptr &&
+                pVector->opcode() != spv::Op::OpPhi && context()->get_instr_block(pVector) != nullptr)
+                ExtractsPerVector[VectorId].push_back(pExtract);
+        }
+
+        bool IsChanged = false;
+        for (auto& [VectorId, Extracts] : ExtractsPerVector)
+        {
+            auto*          pVector             = get_def_use_mgr()->GetDef(VectorId);
+            const uint32_t FlippedVectorTypeId = GetFlippedIntType(pVector->type_id());
+            const uint32_t FlippedScalarTypeId = GetFlippedIntType(Extracts[0]->type_id());
+
+            struct Candidate
+            {
+                spvtools::opt::Instruction*              pExtract;
+                std::vector<spvtools::opt::Instruction*> Casts;
+            };
+            std::vector<Candidate> Candidates;
+            size_t                 NumCasts = 0;
+            for (auto* pExtract : Extracts)
+            {
+                std::vector<spvtools::opt::Instruction*> Casts;
+                std::vector<spvtools::opt::Instruction*> OtherUsers;
+                GetUsers(pExtract, FlippedScalarTypeId, Casts, OtherUsers);
+                if (!Casts.empty() && OtherUsers.empty())
+                {
+                    NumCasts += Casts.size();
+                    Candidates.push_back({pExtract, std::move(Casts)});
+                }
+            }
+
+            const bool IsFoldable = (IsImageQuery(pVector->opcode()) && IsSignedIntType(pVector->type_id())) || GetIntBitcast(VectorId) != nullptr;
+            if (Candidates.empty() || (NumCasts < 2 && !IsFoldable))
+                continue;
+
+            spvtools::opt::InstructionBuilder Builder{context(), pVector->NextNode(), GetBuilderAnalyses()};
+            const uint32_t                    VectorCastId = Builder.AddUnaryOp(FlippedVectorTypeId, spv::Op::OpBitcast, VectorId)->result_id();
+            for (auto& [pExtract, Casts] : Candidates)
+            {
+                pExtract->SetResultType(FlippedScalarTypeId);
+                pExtract->SetInOperand(0, {VectorCastId});
+                get_def_use_mgr()->AnalyzeInstUse(pExtract);
+                ReplaceCastsWith(Casts, pExtract->result_id());
+                ++m_pReport->HoistedExtracts;
+            }
+            IsChanged = true;
+        }
+        return IsChanged;
+    }
+
+    // The signedness of an image query result is free in SPIR-V, while WGSL queries return
+    // u32: glslang's signed queries followed by casts to unsigned become unsigned queries.
+    bool RetypeImageQueries()
+    {
+        bool IsChanged = false;
+        for (auto* pQuery : CollectInstructions([](const spvtools::opt::Instruction& Inst) { return IsImageQuery(Inst.opcode()); }))
+        {
+            const uint32_t SignedTypeId = pQuery->type_id();
+            if (!IsSignedIntType(SignedTypeId))
+                continue;
+
+            std::vector<spvtools::opt::Instruction*> Casts;
+            std::vector<spvtools::opt::Instruction*> OtherUsers;
+            GetUsers(pQuery, GetFlippedIntType(SignedTypeId), Casts, OtherUsers);
+            // Users that need the signed value get one shared cast
+            if (Casts.empty() || (!OtherUsers.empty() && Casts.size() < 2))
+                continue;
+
+            pQuery->SetResultType(GetFlippedIntType(SignedTypeId));
+            get_def_use_mgr()->AnalyzeInstUse(pQuery);
+            if (!OtherUsers.empty())
+            {
+                spvtools::opt::InstructionBuilder Builder{context(), pQuery->NextNode(), GetBuilderAnalyses()};
+                const uint32_t                    SignedId = Builder.AddUnaryOp(SignedTypeId, spv::Op::OpBitcast, pQuery->result_id())->result_id();
+                for (auto* pUser : OtherUsers)
+                    ReplaceOperand(pUser, pQuery->result_id(), SignedId);
+            }
+            ReplaceCastsWith(Casts, pQuery->result_id());
+
+            ++m_pReport->RetypedQueries;
+            IsChanged = true;
+        }
+        return IsChanged;
+    }
+
+    // Signedness Tint expects for the operand. All listed operands accept any integer
+    // signedness in SPIR-V; Tint casts the ones that do not match.
+    std::optional<Signedness> GetOperandSignedness(const spvtools::opt::Instruction& Inst, uint32_t OperandIdx)
+    {
+        switch (Inst.opcode())
+        {
+            // WGSL texture builtins accept both i32 and u32 coordinates and levels
+            case spv::Op::OpImageRead:
+            case spv::Op::OpImageWrite:
+            case spv::Op::OpImageFetch:
+            case spv::Op::OpImageQuerySizeLod:
+                return OperandIdx == 1 ? std::optional<Signedness>{Signedness::Any} : std::nullopt;
+
+            case spv::Op::OpIAdd:
+            case spv::Op::OpISub:
+            case spv::Op::OpIMul:
+            case spv::Op::OpBitwiseAnd:
+            case spv::Op::OpBitwiseOr:
+            case spv::Op::OpBitwiseXor:
+            case spv::Op::OpNot:
+                return IsSignedIntType(Inst.type_id()) ? Signedness::Signed : Signedness::Unsigned;
+
+            // WGSL shift amounts are always u32
+            case spv::Op::OpShiftLeftLogical:
+                return OperandIdx == 0 ? (IsSignedIntType(Inst.type_id()) ? Signedness::Signed : Signedness::Unsigned) : Signedness::Unsigned;
+            case spv::Op::OpShiftRightLogical:
+                return Signedness::Unsigned;
+            case spv::Op::OpShiftRightArithmetic:
+                return OperandIdx == 0 ? Signedness::Signed : Signedness::Unsigned;
+
+            case spv::Op::OpSNegate:
+            case spv::Op::OpSDiv:
+            case spv::Op::OpSRem:
+            case spv::Op::OpSMod:
+            case spv::Op::OpSLessThan:
+            case spv::Op::OpSLessThanEqual:
+            case spv::Op::OpSGreaterThan:
+            case spv::Op::OpSGreaterThanEqual:
+                return Signedness::Signed;
+
+            case spv::Op::OpULessThan:
+            case spv::Op::OpULessThanEqual:
+            case spv::Op::OpUGreaterThan:
+            case spv::Op::OpUGreaterThanEqual:
+                return Signedness::Unsigned;
+
+            default:
+                return std::nullopt;
+        }
+    }
+
+    bool BypassOperandBitcasts()
+    {
+        bool IsChanged = false;
+        for (auto* pInst : CollectInstructions([](const spvtools::opt::Instruction&) { return true; }))
+        {
+            // Equality only needs both operands of the same type
+            if (pInst->opcode() == spv::Op::OpIEqual || pInst->opcode() == spv::Op::OpINotEqual)
+            {
+                const uint32_t LHSId     = pInst->GetSingleWordInOperand(0);
+                const uint32_t RHSId     = pInst->GetSingleWordInOperand(1);
+                const auto*    pLHSCast  = GetIntBitcast(LHSId);
+                const auto*    pRHSCast  = GetIntBitcast(RHSId);
+                const uint32_t LHSSource = pLHSCast != nullptr ? pLHSCast->GetSingleWordInOperand(0) : 0;
+                const uint32_t RHSSource = pRHSCast != nullptr ? pRHSCast->GetSingleWordInOperand(0) : 0;
+                uint32_t       NewLHSId  = LHSId;
+                uint32_t       NewRHSId  = RHSId;
+                if (pLHSCast != nullptr && pRHSCast != nullptr && GetTypeOf(LHSSource) == GetTypeOf(RHSSource))
+                {
+                    NewLHSId = LHSSource;
+                    NewRHSId = RHSSource;
+                }
+                else if (pLHSCast != nullptr && GetTypeOf(LHSSource) == GetTypeOf(RHSId))
+                    NewLHSId = LHSSource;
+                else if (pRHSCast != nullptr && GetTypeOf(RHSSource) == GetTypeOf(LHSId))
+                    NewRHSId = RHSSource;
+                else
+                    continue;
+
+                pInst->SetInOperand(0, {NewLHSId});
+                pInst->SetInOperand(1, {NewRHSId});
+                get_def_use_mgr()->AnalyzeInstUse(pInst);
+                m_pReport->BypassedOperands += (NewLHSId != LHSId ? 1 : 0) + (NewRHSId != RHSId ? 1 : 0);
+                IsChanged = true;
+                continue;
+            }
+
+            for (uint32_t OperandIdx = 0; OperandIdx < pInst->NumInOperands(); ++OperandIdx)
+            {
+                const auto Expected = GetOperandSignedness(*pInst, OperandIdx);
+                if (!Expected)
+                    continue;
+
+                const auto* pCast = GetIntBitcast(pInst->GetSingleWordInOperand(OperandIdx));
+                if (pCast == nullptr)
+                    continue;
+
+                const uint32_t SourceId = pCast->GetSingleWordInOperand(0);
+                if (*Expected != Signedness::Any && IsSignedIntType(GetTypeOf(SourceId)) != (*Expected == Signedness::Signed))
+                    continue;
+
+                pInst->SetInOperand(OperandIdx, {SourceId});
+                get_def_use_mgr()->AnalyzeInstUse(pInst);
+                ++m_pReport->BypassedOperands;
+                IsChanged = true;
+            }
+        }
+        return IsChanged;
+    }
+
+    bool IsOnlyUsedBy(spvtools::opt::Instruction* pValue, const spvtools::opt::Instruction* pUser)
+    {
+        return get_def_use_mgr()->WhileEachUser(pValue, [&](spvtools::opt::Instruction* pOtherUser) {
+            return pOtherUser == pUser || IsDebugOrAnnotation(pOtherUser);
+        });
+    }
+
+    // a_uint = bitcast<uint>(a), c_uint = a_uint + bitcast<uint>(b) -> c_uint = bitcast<uint>(a + b)
+    // The cast of the result then folds into casts back to the signedness of the operands.
+    bool FlipArithmetic()
+    {
+        bool IsChanged = false;
+        for (auto* pInst : CollectInstructions([](const spvtools::opt::Instruction& Inst) { return IsSignednessAgnostic(Inst.opcode()); }))
+        {
+            const uint32_t FlippedTypeId = GetFlippedIntType(pInst->type_id());
+            if (FlippedTypeId == 0 || !get_decoration_mgr()->GetDecorationsFor(pInst->result_id(), false).empty())
+                continue;
+
+            bool                                     CanFlip = true;
+            std::vector<spvtools::opt::Instruction*> RemovedCasts;
+            for (uint32_t OperandIdx = 0; OperandIdx < pInst->NumInOperands() && CanFlip; ++OperandIdx)
+            {
+                const uint32_t OperandId = pInst->GetSingleWordInOperand(OperandIdx);
+                if (auto* pCast = GetIntBitcast(OperandId))
+                {
+                    CanFlip = GetTypeOf(pCast->GetSingleWordInOperand(0)) == FlippedTypeId;
+                    if (CanFlip && IsOnlyUsedBy(pCast, pInst) && std::find(RemovedCasts.begin(), RemovedCasts.end(), pCast) == RemovedCasts.end())
+                        RemovedCasts.push_back(pCast);
+                }
+                else
+                {
+                    CanFlip = context()->get_constant_mgr()->FindDeclaredConstant(OperandId) != nullptr;
+                }
+            }
+
+            std::vector<spvtools::opt::Instruction*> ResultCasts;
+            std::vector<spvtools::opt::Instruction*> OtherUsers;
+            GetUsers(pInst, FlippedTypeId, ResultCasts, OtherUsers);
+
+            // The original result becomes a cast, needed only if something still uses it
+            const size_t NumRemoved = RemovedCasts.size() + ResultCasts.size();
+            const size_t NumAdded   = OtherUsers.empty() ? 0 : 1;
+            if (!CanFlip || NumRemoved <= NumAdded)
+                continue;
+
+            std::vector<uint32_t> Operands;
+            for (uint32_t OperandIdx = 0; OperandIdx < pInst->NumInOperands() && CanFlip; ++OperandIdx)
+            {
+                const uint32_t OperandId = pInst->GetSingleWordInOperand(OperandIdx);
+                if (const auto* pCast = GetIntBitcast(OperandId))
+                    Operands.push_back(pCast->GetSingleWordInOperand(0));
+                else
+                    Operands.push_back(ReinterpretConstant(OperandId, FlippedTypeId));
+                CanFlip = Operands.back() != 0;
+            }
+            if (!CanFlip)
+                continue;
+
+            spvtools::opt::InstructionBuilder Builder{context(), pInst, GetBuilderAnalyses()};
+            const uint32_t                    FlippedId = Builder.AddNaryOp(FlippedTypeId, pInst->opcode(), Operands)->result_id();
+
+            pInst->SetOpcode(spv::Op::OpBitcast);
+            pInst->SetInOperands({{SPV_OPERAND_TYPE_ID, {FlippedId}}});
+            get_def_use_mgr()->AnalyzeInstUse(pInst);
+            ReplaceCastsWith(ResultCasts, FlippedId);
+
+            ++m_pReport->FlippedOperations;
+            IsChanged = true;
+        }
+        return IsChanged;
+    }
+
+    bool RemoveDeadBitcasts()
+    {
+        bool IsChanged = false;
+        for (bool IsRemoved = true; IsRemoved;)
+        {
+            IsRemoved = false;
+            for (auto* pBitcast : CollectInstructions([](const spvtools::opt::Instruction& Inst) { return Inst.opcode() == spv::Op::OpBitcast; }))
+            {
+                if (!IsOnlyUsedBy(pBitcast, nullptr))
+                    continue;
+
+                context()->KillNamesAndDecorates(pBitcast);
+                context()->KillInst(pBitcast);
+                IsRemoved = IsChanged = true;
+            }
+        }
+        return IsChanged;
+    }
+
+private:
+    SignednessReport* const m_pReport;
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv, SignednessReport* pReport)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+    if (pReport != nullptr)
+        SpirvOptimizer.RegisterPass(spvtools::Optimizer::PassToken{std::make_unique<SignednessCanonicalizationPass>(pReport)});
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    spvtools::SpirvTools Tools{TargetEnv};
+    if (!Tools.Validate(OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Optimized SPIR-V is invalid.");
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+    return SPIRV;
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+size_t CountOccurrences(const std::string& Text, const std::string& Pattern)
+{
+    size_t Count = 0;
+    for (size_t Pos = Text.find(Pattern); Pos != std::string::npos; Pos = Text.find(Pattern, Pos + Pattern.size()))
+        ++Count;
+    return Count;
+}
+
+// Usage: SignednessCanonicalization [--print-baseline]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        const bool PrintBaseline = argc > 1 && std::string{argv[1]} == "--print-baseline";
+
+        const std::pair<const char*, const std::string*> Shaders[] = {
+            {"FillTextureCS", &HLSL::FillTextureCS},
+            {"DownsampleCS", &HLSL::DownsampleCS},
+        };
+        for (const auto& [Name, pHLSL] : Shaders)
+        {
+            const auto SPIRV = ConvertHLSLtoSPIRV(*pHLSL);
+
+            SignednessReport Report;
+            const auto       BaselineWGSL  = ConvertSPIRVtoWGSL(OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0, nullptr));
+            const auto       CanonicalWGSL = ConvertSPIRVtoWGSL(OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0, &Report));
+
+            std::cout << "==== " << Name << " ====\n"
+                      << "OpBitcast (int):    " << Report.BitcastsBefore << " -> " << Report.BitcastsAfter << "\n"
+                      << "    folded chains " << Report.FoldedChains << ", hoisted extracts " << Report.HoistedExtracts
+                      << ", retyped queries " << Report.RetypedQueries << ", bypassed operands " << Report.BypassedOperands
+                      << ", flipped operations " << Report.FlippedOperations << "\n"
+                      << "WGSL bitcast<>:     " << CountOccurrences(BaselineWGSL, "bitcast<") << " -> " << CountOccurrences(CanonicalWGSL, "bitcast<") << "\n"
+                      << "WGSL size, bytes:   " << BaselineWGSL.size() << " -> " << CanonicalWGSL.size() << "\n";
+            if (PrintBaseline)
+                std::cout << "---- Baseline ----\n"
+                          << BaselineWGSL << "\n---- Canonicalized ----\n";
+            std::cout << CanonicalWGSL << "\n";
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,522 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+
+namespace HLSL
+{
+
+// Writes up to MAX_MIP_LEVELS levels in one dispatch. Every group of 256 threads reduces a
+// 32x32 tile of level 1 down to one texel of level 6 through LDS, so groups never exchange
+// data. Going past level 6 in the same dispatch would require the last group to read the
+// level 6 texels of the others, which needs globallycoherent writes and DeviceMemoryBarrier()
+// before the completion counter. WGSL has neither (storageBarrier() is workgroup-scoped and
+// only allowed in uniform control flow), so longer chains take one dispatch per six levels.
+const std::string SinglePassDownsamplerCS = R"(
+#ifndef MAX_MIP_LEVELS
+#    define MAX_MIP_LEVELS 6
+#endif
+
+Texture2DArray<float4> SrcTex;
+SamplerState           BilinearClamp;
+
+// WebGPU has no arrays of storage textures: every level is bound separately, and the number
+// of levels a dispatch can write is limited by maxStorageTexturesPerShaderStage.
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+#if MAX_MIP_LEVELS > 4
+RWTexture2DArray<float4> OutMip5;
+RWTexture2DArray<float4> OutMip6;
+#endif
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, MAX_MIP_LEVELS]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+    uint2  Mip1Size;  // OutMip1.Dimensions
+}
+
+// 32x32 texels of level 1 down to one texel of level 6. The two halves are used in turns,
+// so every level needs a single barrier.
+groupshared float4 gs_Color[256 + 64];
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+uint2 MipSize(uint Mip)
+{
+    return max(Mip1Size >> (Mip - 1), uint2(1, 1));
+}
+
+void StoreMip(uint Mip, uint2 Pos, uint ArraySlice, float4 Color)
+{
+    // Out-of-bounds stores are not guaranteed to be discarded in WebGPU
+    if (any(Pos >= MipSize(Mip)))
+        return;
+
+    uint3 Coord = uint3(Pos, ArraySlice);
+    Color       = PackColor(Color);
+    switch (Mip)
+    {
+        case 1: OutMip1[Coord] = Color; break;
+        case 2: OutMip2[Coord] = Color; break;
+        case 3: OutMip3[Coord] = Color; break;
+        case 4: OutMip4[Coord] = Color; break;
+#if MAX_MIP_LEVELS > 4
+        case 5: OutMip5[Coord] = Color; break;
+        case 6: OutMip6[Coord] = Color; break;
+#endif
+        default: break;
+    }
+}
+
+[numthreads(256, 1, 1)]
+void main(uint GI : SV_GroupIndex, uint3 GroupId : SV_GroupID)
+{
+    uint  ArraySlice = FirstArraySlice + GroupId.z;
+    uint2 Pos        = uint2(GI % 16, GI / 16);
+
+    // Every thread samples a 2x2 block of the group's tile of level 1. One bilinear sample
+    // per texel assumes a power-of-two sized source: other sources go to GenerateMipsCS.
+    float4 Color = 0;
+    for (uint i = 0; i < 4; ++i)
+    {
+        uint2  Pos1 = GroupId.xy * 32 + Pos * 2 + uint2(i & 1, i >> 1);
+        float4 Src1 = SrcTex.SampleLevel(BilinearClamp, float3(TexelSize * (Pos1 + 0.5), ArraySlice), SrcMipLevel);
+        StoreMip(1, Pos1, ArraySlice, Src1);
+        Color += Src1;
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    Color *= 0.25;
+    StoreMip(2, GroupId.xy * 16 + Pos, ArraySlice, Color);
+    gs_Color[GI] = Color;
+
+    uint SrcOffset = 0;
+    uint DstOffset = 256;
+    uint SrcWidth  = 16;
+    for (uint Mip = 3; Mip <= NumMipLevels; ++Mip)
+    {
+        GroupMemoryBarrierWithGroupSync();
+
+        uint DstWidth = SrcWidth / 2;
+        if (GI < DstWidth * DstWidth)
+        {
+            uint2 Dst = uint2(GI % DstWidth, GI / DstWidth);
+            uint  Src = SrcOffset + Dst.y * 2 * SrcWidth + Dst.x * 2;
+            Color     = 0.25 * (gs_Color[Src] + gs_Color[Src + 1] + gs_Color[Src + SrcWidth] + gs_Color[Src + SrcWidth + 1]);
+
+            gs_Color[DstOffset + GI] = Color;
+            StoreMip(Mip, GroupId.xy * DstWidth + Dst, ArraySlice, Color);
+        }
+
+        uint Offset = SrcOffset;
+        SrcOffset   = DstOffset;
+        DstOffset   = Offset;
+        SrcWidth    = DstWidth;
+    }
+}
+)";
+
+} // namespace HLSL
+
+// Mirrors of the constants of SinglePassDownsamplerCS
+constexpr uint32_t SPDTileSize     = 32; // Texels of level 1 per group in each dimension
+constexpr uint32_t SPDMaxMipLevels = 6;  // Levels a group reduces its tile to
+
+// GenerateMipsCS runs 8x8 groups over level 1 and writes at most four levels
+constexpr uint32_t GenerateMipsGroupSize    = 8;
+constexpr uint32_t GenerateMipsMaxMipLevels = 4;
+
+struct TextureDesc
+{
+    const char* Name;
+    uint32_t    Width;
+    uint32_t    Height;
+    uint32_t    ArraySize;
+    uint32_t    BytesPerTexel;
+};
+
+struct DownsampleLimits
+{
+    uint32_t MaxStorageTexturesPerShaderStage = 4; // The WebGPU default
+};
+
+enum class MipShader
+{
+    GenerateMips,
+    SinglePass
+};
+
+struct MipDispatch
+{
+    MipShader Shader;
+    uint32_t  NonPowerOfTwo = 0; // NON_POWER_OF_TWO mode of GenerateMipsCS
+    uint32_t  SrcMipLevel;
+    uint32_t  NumMipLevels;
+    uint32_t  FirstArraySlice;
+    uint32_t  GroupsX;
+    uint32_t  GroupsY;
+    uint32_t  GroupsZ; // Array slices
+};
+
+uint32_t GetMipDimension(uint32_t Size, uint32_t Mip)
+{
+    return std::max(Size >> Mip, 1u);
+}
+
+uint32_t GetFullMipLevels(const TextureDesc& Desc)
+{
+    uint32_t MipLevels = 1;
+    while ((std::max(Desc.Width, Desc.Height) >> MipLevels) != 0)
+        ++MipLevels;
+    return MipLevels;
+}
+
+uint64_t GetTexelCount(const TextureDesc& Desc, uint32_t Mip)
+{
+    return uint64_t{GetMipDimension(Desc.Width, Mip)} * GetMipDimension(Desc.Height, Mip);
+}
+
+bool IsPowerOfTwo(uint32_t Size)
+{
+    return (Size & (Size - 1)) == 0;
+}
+
+// One GenerateMipsCS dispatch that downsamples SrcMip, all slices in Z
+MipDispatch GetGenerateMipsDispatch(const TextureDesc& Desc, uint32_t SrcMip, uint32_t MipLevels)
+{
+    const uint32_t SrcWidth  = GetMipDimension(Desc.Width, SrcMip);
+    const uint32_t SrcHeight = GetMipDimension(Desc.Height, SrcMip);
+
+    MipDispatch Dispatch;
+    Dispatch.Shader          = MipShader::GenerateMips;
+    Dispatch.NonPowerOfTwo   = (SrcWidth & 1) | (SrcHeight & 1) << 1;
+    Dispatch.SrcMipLevel     = SrcMip;
+    Dispatch.NumMipLevels    = std::min(GenerateMipsMaxMipLevels, MipLevels - 1 - SrcMip);
+    Dispatch.FirstArraySlice = 0;
+    Dispatch.GroupsX         = (GetMipDimension(Desc.Width, SrcMip + 1) + GenerateMipsGroupSize - 1) / GenerateMipsGroupSize;
+    Dispatch.GroupsY         = (GetMipDimension(Desc.Height, SrcMip + 1) + GenerateMipsGroupSize - 1) / GenerateMipsGroupSize;
+    Dispatch.GroupsZ         = Desc.ArraySize;
+    return Dispatch;
+}
+
+// The current scheme: one dispatch per four levels, all slices in Z
+std::vector<MipDispatch> PlanGenerateMips(const TextureDesc& Desc)
+{
+    const uint32_t MipLevels = GetFullMipLevels(Desc);
+
+    std::vector<MipDispatch> Dispatches;
+    for (uint32_t SrcMip = 0; SrcMip + 1 < MipLevels; SrcMip += Dispatches.back().NumMipLevels)
+        Dispatches.push_back(GetGenerateMipsDispatch(Desc, SrcMip, MipLevels));
+    return Dispatches;
+}
+
+// The largest variant of SinglePassDownsamplerCS the device can bind
+uint32_t GetSPDMaxMipLevels(const DownsampleLimits& Limits)
+{
+    // Both shaders bind at least four storage textures, the minimum WebGPU guarantees
+    if (Limits.MaxStorageTexturesPerShaderStage < GenerateMipsMaxMipLevels)
+        LOG_ERROR_AND_THROW("maxStorageTexturesPerShaderStage (", Limits.MaxStorageTexturesPerShaderStage, ") is below the WebGPU minimum of 4");
+    return Limits.MaxStorageTexturesPerShaderStage >= SPDMaxMipLevels ? SPDMaxMipLevels : GenerateMipsMaxMipLevels;
+}
+
+// Covers the whole chain with one dispatch per MaxMipLevels levels, all slices in Z.
+// SinglePassDownsamplerCS only handles power-of-two sources: a level with an odd-sized
+// dimension is downsampled by GenerateMipsCS, which takes extra samples for it.
+std::vector<MipDispatch> PlanSinglePassDownsample(const TextureDesc& Desc, const DownsampleLimits& Limits)
+{
+    const uint32_t MipLevels    = GetFullMipLevels(Desc);
+    const uint32_t MaxMipLevels = GetSPDMaxMipLevels(Limits);
+
+    std::vector<MipDispatch> Dispatches;
+    for (uint32_t SrcMip = 0; SrcMip + 1 < MipLevels; SrcMip += Dispatches.back().NumMipLevels)
+    {
+        if (!IsPowerOfTwo(GetMipDimension(Desc.Width, SrcMip)) || !IsPowerOfTwo(GetMipDimension(Desc.Height, SrcMip)))
+        {
+            Dispatches.push_back(GetGenerateMipsDispatch(Desc, SrcMip, MipLevels));
+            continue;
+        }
+
+        MipDispatch Dispatch;
+        Dispatch.Shader          = MipShader::SinglePass;
+        Dispatch.SrcMipLevel     = SrcMip;
+        Dispatch.NumMipLevels    = std::min(MaxMipLevels, MipLevels - 1 - SrcMip);
+        Dispatch.FirstArraySlice = 0;
+        Dispatch.GroupsX         = (GetMipDimension(Desc.Width, SrcMip + 1) + SPDTileSize - 1) / SPDTileSize;
+        Dispatch.GroupsY         = (GetMipDimension(Desc.Height, SrcMip + 1) + SPDTileSize - 1) / SPDTileSize;
+        Dispatch.GroupsZ         = Desc.ArraySize;
+        Dispatches.push_back(Dispatch);
+    }
+    return Dispatches;
+}
+
+struct TrafficEstimate
+{
+    uint32_t Dispatches     = 0;
+    uint32_t DependentSteps = 0; // Dispatches that must wait for the previous ones
+    uint64_t BytesRead      = 0;
+    uint64_t BytesWritten   = 0;
+};
+
+// Memory traffic assuming that every texel is fetched from memory once per dispatch that
+// reads it, i.e. that caches absorb the overlap of bilinear footprints
+TrafficEstimate EstimateTraffic(const TextureDesc& Desc, const std::vector<MipDispatch>& Dispatches)
+{
+    TrafficEstimate Estimate;
+    Estimate.Dispatches = static_cast<uint32_t>(Dispatches.size());
+    // Every dispatch reads the last level written by the previous one
+    Estimate.DependentSteps = Estimate.Dispatches > 0 ? Estimate.Dispatches - 1 : 0;
+    for (const auto& Dispatch : Dispatches)
+    {
+        Estimate.BytesRead += GetTexelCount(Desc, Dispatch.SrcMipLevel) * Desc.BytesPerTexel * Dispatch.GroupsZ;
+        for (uint32_t Mip = 1; Mip <= Dispatch.NumMipLevels; ++Mip)
+            Estimate.BytesWritten += GetTexelCount(Desc, Dispatch.SrcMipLevel + Mip) * Desc.BytesPerTexel * Dispatch.GroupsZ;
+    }
+    return Estimate;
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const std::string& Preamble)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    return OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+size_t CountOccurrences(const std::string& Str, const std::string& Pattern)
+{
+    size_t Count = 0;
+    for (size_t Pos = Str.find(Pattern); Pos != std::string::npos; Pos = Str.find(Pattern, Pos + Pattern.size()))
+        ++Count;
+    return Count;
+}
+
+// Usage: SinglePassDownsampler [--max-storage-textures N] [--print-plan] [--print-wgsl]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        DownsampleLimits Limits;
+        Limits.MaxStorageTexturesPerShaderStage = 12;
+
+        bool PrintPlan = false;
+        bool PrintWGSL = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--max-storage-textures" && i + 1 < argc)
+                Limits.MaxStorageTexturesPerShaderStage = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (Arg == "--print-plan")
+                PrintPlan = true;
+            else if (Arg == "--print-wgsl")
+                PrintWGSL = true;
+            else
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+        }
+
+        const uint32_t MaxMipLevels = GetSPDMaxMipLevels(Limits);
+        for (const char* Defines : {"", "#define CONVERT_TO_SRGB\n"})
+        {
+            const auto WGSL = ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(HLSL::SinglePassDownsamplerCS, ConcatenateArgs("#define MAX_MIP_LEVELS ", MaxMipLevels, "\n", Defines)));
+            std::cout << "SinglePassDownsamplerCS, " << MaxMipLevels << " levels" << (*Defines != '\0' ? ", sRGB" : "") << ": "
+                      << WGSL.size() << " bytes of WGSL, " << CountOccurrences(WGSL, "workgroupBarrier()") << " barriers\n";
+            if (PrintWGSL)
+                std::cout << WGSL << "\n";
+        }
+        std::cout << "\n";
+
+        const TextureDesc Textures[] = {
+            {"Albedo 4096x4096", 4096, 4096, 1, 4},
+            {"Terrain 8192x8192", 8192, 8192, 1, 4},
+            {"Cube 2048x2048x6", 2048, 2048, 6, 4},
+            {"Array 1024x512x32", 1024, 512, 32, 4},
+            {"HDR 512x512 RGBA16F", 512, 512, 1, 8},
+            {"Atlas 1000x600", 1000, 600, 1, 4},
+        };
+
+        std::cout << std::left << std::setw(22) << "Texture" << std::setw(20) << "Dispatches"
+                  << std::setw(20) << "Dependent steps" << std::setw(24) << "Est. traffic, MB" << "\n";
+        for (const auto& Texture : Textures)
+        {
+            const auto GenerateMips = PlanGenerateMips(Texture);
+            const auto SinglePass   = PlanSinglePassDownsample(Texture, Limits);
+
+            const auto Baseline = EstimateTraffic(Texture, GenerateMips);
+            const auto SPD      = EstimateTraffic(Texture, SinglePass);
+
+            const auto ToMB = [](uint64_t Bytes) { return static_cast<double>(Bytes) / (1024.0 * 1024.0); };
+            std::cout << std::setw(22) << Texture.Name
+                      << std::setw(20) << ConcatenateArgs(Baseline.Dispatches, " -> ", SPD.Dispatches)
+                      << std::setw(20) << ConcatenateArgs(Baseline.DependentSteps, " -> ", SPD.DependentSteps)
+                      << std::setw(24) << ConcatenateArgs(std::fixed, std::setprecision(2), ToMB(Baseline.BytesRead + Baseline.BytesWritten), " -> ", ToMB(SPD.BytesRead + SPD.BytesWritten))
+                      << "\n";
+
+            if (PrintPlan)
+            {
+                for (const auto& Dispatch : SinglePass)
+                {
+                    std::cout << "    " << (Dispatch.Shader == MipShader::SinglePass ? "SPD" : ConcatenateArgs("GenerateMips NPOT ", Dispatch.NonPowerOfTwo))
+                              << ", src mip " << Dispatch.SrcMipLevel << ", " << Dispatch.NumMipLevels << " levels, slices "
+                              << Dispatch.FirstArraySlice << ".." << Dispatch.FirstArraySlice + Dispatch.GroupsZ - 1 << ", groups "
+                              << Dispatch.GroupsX << "x" << Dispatch.GroupsY << "x" << Dispatch.GroupsZ << "\n";
+                }
+            }
+        }
+        std::cout << std::right;
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,751 @@
+#define ENABLE_HLSL
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <regex>
+#include <algorithm>
+#include <set>
+#include <chrono>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string GenerateMipsCS = R"(
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+// The reason for separating channels is to reduce bank conflicts in the
+// local data memory controller.  A large stride will cause more threads
+// to collide on the same memory bank.
+groupshared float gs_R[64];
+groupshared float gs_G[64];
+groupshared float gs_B[64];
+groupshared float gs_A[64];
+
+void StoreColor(uint Index, float4 Color)
+{
+    gs_R[Index] = Color.r;
+    gs_G[Index] = Color.g;
+    gs_B[Index] = Color.b;
+    gs_A[Index] = Color.a;
+}
+
+float4 LoadColor(uint Index)
+{
+    return float4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);
+}
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+[numthreads(8, 8, 1)] 
+void main(uint GI : SV_GroupIndex, uint3 DTid: SV_DispatchThreadID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    bool IsValidThread = all(DTid.xy < DstMipSize);
+    uint ArraySlice    = FirstArraySlice + DTid.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+        // One bilinear sample is insufficient when scaling down by more than 2x.
+        // You will slightly undersample in the case where the source dimension
+        // is odd.  This is why it's a really good idea to only generate mips on
+        // power-of-two sized textures.  Trying to handle the undersampling case
+        // will force this shader to be slower and more complicated as it will
+        // have to take more source texture samples.
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (DTid.xy + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        // > 2:1 in X dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // horizontally.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        // > 2:1 in Y dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // vertically.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        // > 2:1 in in both dimensions
+        // Use 4 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // in both directions.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(DTid.xy, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    if (IsValidThread)
+    {
+        // Without lane swizzle operations, the only way to share data with other
+        // threads is through LDS.
+        StoreColor(GI, Src1);
+    }
+
+    // This guarantees all LDS writes are complete and that all threads have
+    // executed all instructions so far (and therefore have issued their LDS
+    // write instructions.)
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // With low three bits for X and high three bits for Y, this bit mask
+        // (binary: 001001) checks that X and Y are even.
+        if ((GI & 0x9) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x01);
+            float4 Src3 = LoadColor(GI + 0x08);
+            float4 Src4 = LoadColor(GI + 0x09);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip2[uint3(DTid.xy / 2, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 2)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask (binary: 011011) checks that X and Y are multiples of four.
+        if ((GI & 0x1B) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x02);
+            float4 Src3 = LoadColor(GI + 0x10);
+            float4 Src4 = LoadColor(GI + 0x12);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip3[uint3(DTid.xy / 4, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 3)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask would be 111111 (X & Y multiples of 8), but only one
+        // thread fits that criteria.
+        if (GI == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x04);
+            float4 Src3 = LoadColor(GI + 0x20);
+            float4 Src4 = LoadColor(GI + 0x24);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip4[uint3(DTid.xy / 8, ArraySlice)] = PackColor(Src1);
+        }
+    }
+}
+
+)";
+;
+} // namespace HLSL
+
+enum class SpecConstantType
+{
+    Bool, // Macro tested with #ifdef/#ifndef: defined <=> true
+    UInt  // Macro tested with #if: the value is the macro value
+};
+
+struct SpecializedMacro
+{
+    std::string           Name;
+    SpecConstantType      Type         = SpecConstantType::UInt;
+    uint32_t              DefaultValue = 0;
+    std::vector<uint32_t> Values; // Values the offline permutations are generated for
+};
+
+// One offline permutation: macro values in the order of the SpecializedMacro list
+using MacroValues = std::vector<uint32_t>;
+
+namespace
+{
+
+std::string TrimLeft(const std::string& Str)
+{
+    const auto Pos = Str.find_first_not_of(" \t");
+    return Pos != std::string::npos ? Str.substr(Pos) : std::string{};
+}
+
+std::string Trim(const std::string& Str)
+{
+    std::string Result = TrimLeft(Str);
+    while (!Result.empty() && (Result.back() == ' ' || Result.back() == '\t' || Result.back() == '\r'))
+        Result.pop_back();
+    return Result;
+}
+
+// Splits '#  keyword expression' into keyword and expression. Returns false for non-directive lines.
+bool ParseDirective(const std::string& Line, std::string& Keyword, std::string& Expression)
+{
+    std::string Text = TrimLeft(Line);
+    if (Text.empty() || Text[0] != '#')
+        return false;
+
+    Text = TrimLeft(Text.substr(1));
+
+    const auto KeywordEnd = Text.find_first_of(" \t(");
+    Keyword               = Text.substr(0, KeywordEnd);
+    Expression            = KeywordEnd != std::string::npos ? Trim(Text.substr(KeywordEnd)) : std::string{};
+
+    // Drop trailing line comments, e.g. '#endif // CONVERT_TO_SRGB'
+    const auto CommentPos = Expression.find("//");
+    if (CommentPos != std::string::npos)
+        Expression = Trim(Expression.substr(0, CommentPos));
+    return true;
+}
+
+// Regular expressions over the names of the specialized macros, built once per conversion
+struct MacroPatterns
+{
+    explicit MacroPatterns(const std::vector<SpecializedMacro>& Macros)
+    {
+        for (const auto& Macro : Macros)
+        {
+            Identifiers.emplace_back("\\b" + Macro.Name + "\\b");
+            Defined.emplace_back("defined\\s*(\\(\\s*" + Macro.Name + "\\s*\\)|\\s" + Macro.Name + "\\b)");
+        }
+    }
+
+    std::vector<std::regex> Identifiers;
+    std::vector<std::regex> Defined;
+};
+
+const SpecializedMacro* FindReferencedMacro(const std::string& Expression, const std::vector<SpecializedMacro>& Macros, const MacroPatterns& Patterns)
+{
+    for (size_t MacroIdx = 0; MacroIdx < Macros.size(); ++MacroIdx)
+    {
+        if (std::regex_search(Expression, Patterns.Identifiers[MacroIdx]))
+            return &Macros[MacroIdx];
+    }
+    return nullptr;
+}
+
+// Converts a preprocessor condition into an equivalent HLSL expression over the specialization constants
+std::string ConvertCondition(const std::string& Keyword, const std::string& Expression, const std::vector<SpecializedMacro>& Macros, const MacroPatterns& Patterns)
+{
+    if (Keyword == "ifdef" || Keyword == "ifndef")
+    {
+        const auto* pMacro = FindReferencedMacro(Expression, Macros, Patterns);
+        const bool  IsBool = pMacro->Type == SpecConstantType::Bool;
+        if (Keyword == "ifdef")
+            return IsBool ? pMacro->Name : ConcatenateArgs(pMacro->Name, " != 0");
+        else
+            return IsBool ? ConcatenateArgs("!", pMacro->Name) : ConcatenateArgs(pMacro->Name, " == 0");
+    }
+
+    std::string Condition = Expression;
+    for (size_t MacroIdx = 0; MacroIdx < Macros.size(); ++MacroIdx)
+        Condition = std::regex_replace(Condition, Patterns.Defined[MacroIdx], "(" + Macros[MacroIdx].Name + " != 0)");
+    if (Condition.find("defined") != std::string::npos)
+        LOG_ERROR_AND_THROW("Condition '", Expression, "' mixes specialized macros with 'defined' of other macros");
+    return Condition;
+}
+
+// Follows the braces of the shader to tell function bodies from the bodies of cbuffer and
+// struct declarations and from initializer lists
+class ScopeTracker
+{
+public:
+    void ProcessLine(const std::string& Line)
+    {
+        static const std::regex DeclarationKeyword{"\\b(cbuffer|tbuffer|struct)\\b"};
+
+        const auto CommentPos = Line.find("//");
+        for (size_t Pos = 0; Pos < std::min(Line.size(), CommentPos); ++Pos)
+        {
+            const char c = Line[Pos];
+            if (c == '{')
+            {
+                // A function header has a parameter list and no initializer
+                Scope Kind = Scope::Declaration;
+                if (!std::regex_search(m_Statement, DeclarationKeyword) &&
+                    (IsInFunction() || (m_Statement.find(')') != std::string::npos && m_Statement.find('=') == std::string::npos)))
+                    Kind = Scope::Function;
+                m_Scopes.push_back(Kind);
+                m_Statement.clear();
+            }
+            else if (c == '}')
+            {
+                if (!m_Scopes.empty())
+                    m_Scopes.pop_back();
+                m_Statement.clear();
+            }
+            else if (c == ';')
+            {
+                m_Statement.clear();
+            }
+            else
+            {
+                m_Statement += c;
+            }
+        }
+        m_Statement += ' ';
+    }
+
+    bool IsInFunction() const { return !m_Scopes.empty() && m_Scopes.back() == Scope::Function; }
+    bool IsInDeclaration() const { return !m_Scopes.empty() && m_Scopes.back() == Scope::Declaration; }
+
+private:
+    enum class Scope
+    {
+        Function,
+        Declaration
+    };
+    std::vector<Scope> m_Scopes;
+    std::string        m_Statement; // Text since the last ';', '{' or '}'
+};
+
+} // namespace
+
+// Rewrites every preprocessor conditional that tests one of the given macros into a runtime
+// 'if' over a specialization constant declared with [[vk::constant_id]]. glslang turns these
+// into OpSpecConstant and Tint into WGSL 'override' declarations, so one module covers all
+// permutations and pipelines select one through pipeline constants.
+// Only conditionals inside function bodies can be converted, and every branch must be a
+// self-contained statement list. The '#ifndef M / #define M value / #endif' default guard is
+// recognized and turned into the default value of the constant.
+std::string ConvertMacrosToSpecConstants(const std::string& HLSL, std::vector<SpecializedMacro> Macros)
+{
+    std::vector<std::string> Lines;
+    {
+        std::istringstream Stream{HLSL};
+        for (std::string Line; std::getline(Stream, Line);)
+            Lines.push_back(Line);
+    }
+
+    const MacroPatterns Patterns{Macros};
+
+    std::ostringstream Body;
+    std::vector<bool>  IsConvertedStack;
+    ScopeTracker       Scopes;
+    for (size_t LineIdx = 0; LineIdx < Lines.size(); ++LineIdx)
+    {
+        const auto& Line = Lines[LineIdx];
+
+        std::string Keyword, Expression;
+        if (!ParseDirective(Line, Keyword, Expression))
+        {
+            Scopes.ProcessLine(Line);
+            Body << Line << '\n';
+            continue;
+        }
+
+        const auto  Indent  = Line.substr(0, Line.find('#'));
+        const auto* pMacro  = FindReferencedMacro(Expression, Macros, Patterns);
+        const auto  LineNum = LineIdx + 1;
+        if (Keyword == "if" || Keyword == "ifdef" || Keyword == "ifndef")
+        {
+            if (pMacro != nullptr && Keyword == "ifndef" && LineIdx + 2 < Lines.size())
+            {
+                std::string DefineKeyword, DefineExpression, EndKeyword, EndExpression;
+                if (ParseDirective(Lines[LineIdx + 1], DefineKeyword, DefineExpression) && DefineKeyword == "define" &&
+                    ParseDirective(Lines[LineIdx + 2], EndKeyword, EndExpression) && EndKeyword == "endif")
+                {
+                    std::istringstream DefineStream{DefineExpression};
+                    std::string        Name;
+                    uint32_t           Value = 1;
+                    DefineStream >> Name >> Value;
+                    if (Name == pMacro->Name)
+                    {
+                        std::find_if(Macros.begin(), Macros.end(), [&](const SpecializedMacro& Macro) { return Macro.Name == Name; })->DefaultValue = Value;
+                        LineIdx += 2;
+                        continue;
+                    }
+                }
+            }
+
+            IsConvertedStack.push_back(pMacro != nullptr);
+            if (pMacro == nullptr)
+            {
+                Body << Line << '\n';
+                continue;
+            }
+            if (Scopes.IsInDeclaration())
+                LOG_ERROR_AND_THROW("Line ", LineNum, ": conditional on '", pMacro->Name, "' is inside a cbuffer, struct or initializer list; declarations can't depend on specialization constants");
+            if (!Scopes.IsInFunction())
+                LOG_ERROR_AND_THROW("Line ", LineNum, ": conditional on '", pMacro->Name, "' is outside of a function body and can't be specialized");
+
+            Body << Indent << "if (" << ConvertCondition(Keyword, Expression, Macros, Patterns) << ")\n"
+                 << Indent << "{\n";
+        }
+        else if (Keyword == "elif" || Keyword == "else" || Keyword == "endif")
+        {
+            if (IsConvertedStack.empty())
+                LOG_ERROR_AND_THROW("Line ", LineNum, ": unmatched #", Keyword);
+
+            if (!IsConvertedStack.back())
+            {
+                if (Keyword == "elif" && pMacro != nullptr)
+                    LOG_ERROR_AND_THROW("Line ", LineNum, ": #elif on '", pMacro->Name, "' continues a conditional that is not specialized");
+                Body << Line << '\n';
+            }
+            else if (Keyword == "elif")
+            {
+                Body << Indent << "}\n"
+                     << Indent << "else if (" << ConvertCondition("if", Expression, Macros, Patterns) << ")\n"
+                     << Indent << "{\n";
+            }
+            else if (Keyword == "else")
+            {
+                Body << Indent << "}\n"
+                     << Indent << "else\n"
+                     << Indent << "{\n";
+            }
+            else
+            {
+                Body << Indent << "}\n";
+            }
+
+            if (Keyword == "endif")
+                IsConvertedStack.pop_back();
+        }
+        else
+        {
+            if ((Keyword == "define" || Keyword == "undef") && pMacro != nullptr)
+                LOG_ERROR_AND_THROW("Line ", LineNum, ": specialized macro '", pMacro->Name, "' can't be redefined in the shader");
+            Body << Line << '\n';
+        }
+    }
+
+    if (!IsConvertedStack.empty())
+        LOG_ERROR_AND_THROW("Unterminated conditional at the end of the shader");
+
+    std::ostringstream Declarations;
+    for (size_t ConstantId = 0; ConstantId < Macros.size(); ++ConstantId)
+    {
+        const auto& Macro = Macros[ConstantId];
+        if (Macro.Type == SpecConstantType::Bool)
+            Declarations << "[[vk::constant_id(" << ConstantId << ")]] const bool " << Macro.Name << " = " << (Macro.DefaultValue != 0 ? "true" : "false") << ";\n";
+        else
+            Declarations << "[[vk::constant_id(" << ConstantId << ")]] const uint " << Macro.Name << " = " << Macro.DefaultValue << ";\n";
+    }
+    return Declarations.str() + Body.str();
+}
+
+// Builds the '#define' block that selects one permutation the traditional way
+std::string BuildPermutationPreamble(const std::vector<SpecializedMacro>& Macros, const MacroValues& Values)
+{
+    std::ostringstream Preamble;
+    for (size_t MacroIdx = 0; MacroIdx < Macros.size(); ++MacroIdx)
+    {
+        if (Macros[MacroIdx].Type == SpecConstantType::Bool)
+        {
+            if (Values[MacroIdx] != 0)
+                Preamble << "#define " << Macros[MacroIdx].Name << "\n";
+        }
+        else
+        {
+            Preamble << "#define " << Macros[MacroIdx].Name << " " << Values[MacroIdx] << "\n";
+        }
+    }
+    return Preamble.str();
+}
+
+std::vector<MacroValues> EnumeratePermutations(const std::vector<SpecializedMacro>& Macros)
+{
+    std::vector<MacroValues> Permutations{MacroValues{}};
+    for (const auto& Macro : Macros)
+    {
+        std::vector<MacroValues> Expanded;
+        for (const auto& Permutation : Permutations)
+        {
+            for (uint32_t Value : Macro.Values)
+            {
+                Expanded.push_back(Permutation);
+                Expanded.back().push_back(Value);
+            }
+        }
+        Permutations = std::move(Expanded);
+    }
+    return Permutations;
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const std::string& Preamble)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+
+    if (!OptimizedSPIRV.empty())
+        return OptimizedSPIRV;
+
+    LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+std::vector<tint::inspector::Override> GetOverrides(const std::string& WGSL)
+{
+    TintInitializer InitScope{};
+
+    tint::Source::File srcFile("", WGSL);
+    tint::Program      Program = tint::wgsl::reader::Parse(&srcFile, {tint::wgsl::AllowedFeatures::Everything()});
+
+    if (!Program.IsValid())
+        LOG_ERROR_AND_THROW("Tint WGSL reader failure:\nParser: ", Program.Diagnostics().Str(), "\n");
+
+    std::vector<tint::inspector::Override> Overrides;
+
+    tint::inspector::Inspector Inspector{Program};
+    for (auto& EntryPoint : Inspector.GetEntryPoints())
+    {
+        for (auto& Override : EntryPoint.overrides)
+            Overrides.push_back(Override);
+    }
+    return Overrides;
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        const std::vector<SpecializedMacro> Macros = {
+            {"NON_POWER_OF_TWO", SpecConstantType::UInt, 0, {0, 1, 2, 3}},
+            {"CONVERT_TO_SRGB", SpecConstantType::Bool, 0, {0, 1}},
+        };
+        const auto Permutations = EnumeratePermutations(Macros);
+
+        // Baseline: one module per permutation
+        std::set<std::string> PermutationModules;
+        size_t                PermutationBytes = 0;
+
+        auto StartTime = std::chrono::high_resolution_clock::now();
+        for (const auto& Values : Permutations)
+        {
+            auto WGSL = ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(HLSL::GenerateMipsCS, BuildPermutationPreamble(Macros, Values)));
+            PermutationBytes += WGSL.size();
+            PermutationModules.emplace(std::move(WGSL));
+        }
+        const double PermutationTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+        // Specialized: one module, permutations are selected with pipeline constants
+        StartTime             = std::chrono::high_resolution_clock::now();
+        const auto SpecHLSL   = ConvertMacrosToSpecConstants(HLSL::GenerateMipsCS, Macros);
+        const auto SpecWGSL   = ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(SpecHLSL, ""));
+        const double SpecTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+        std::cout << SpecWGSL << "\n";
+
+        // Pipeline constants are keyed by the numeric override id: Tint may rename identifiers.
+        // The id is the constant_id ConvertMacrosToSpecConstants assigned, i.e. the macro index.
+        const auto            Overrides = GetOverrides(SpecWGSL);
+        std::vector<uint32_t> OverrideIds;
+        for (uint32_t MacroIdx = 0; MacroIdx < Macros.size(); ++MacroIdx)
+        {
+            auto It = std::find_if(Overrides.begin(), Overrides.end(), [&](const tint::inspector::Override& Override) { return Override.id.value == MacroIdx; });
+            if (It == Overrides.end())
+                LOG_ERROR_AND_THROW("Override with id ", MacroIdx, " for '", Macros[MacroIdx].Name, "' is missing in the generated WGSL");
+            OverrideIds.push_back(It->id.value);
+        }
+
+        std::cout << "Pipeline constants per permutation (keyed by override id):\n";
+        for (const auto& Values : Permutations)
+        {
+            std::cout << "    {";
+            for (size_t MacroIdx = 0; MacroIdx < Macros.size(); ++MacroIdx)
+                std::cout << (MacroIdx > 0 ? ", " : " ") << "\"" << OverrideIds[MacroIdx] << "\": " << Values[MacroIdx];
+            std::cout << " }\n";
+        }
+
+        LOG_INFO_MESSAGE("Preprocessor permutations: ", Permutations.size(), " modules (", PermutationModules.size(), " unique), ",
+                         PermutationBytes, " bytes of WGSL, ", PermutationTime, " ms");
+        LOG_INFO_MESSAGE("Specialization constants:  1 module, ", SpecWGSL.size(), " bytes of WGSL, ", SpecTime, " ms");
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,552 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string MaterialPS = R"(
+cbuffer Frame
+{
+    float4x4 g_ViewProj;
+    float4   g_CameraPos;
+};
+
+cbuffer Material
+{
+    float4 g_BaseColor;
+    float  g_Roughness;
+};
+
+Texture2D<float4> g_BaseColorMap;
+Texture2D<float4> g_NormalMap;
+Texture2D<float4> g_RoughnessMap;
+SamplerState      g_LinearSampler;
+
+struct PSInput
+{
+    float4 Pos    : SV_Position;
+    float2 UV     : TEXCOORD0;
+    float3 Normal : NORMAL;
+};
+
+float4 main(PSInput In) : SV_Target
+{
+    float4 Color     = g_BaseColorMap.Sample(g_LinearSampler, In.UV) * g_BaseColor;
+    float3 Normal    = normalize(In.Normal + g_NormalMap.Sample(g_LinearSampler, In.UV).xyz);
+    float  Roughness = g_RoughnessMap.Sample(g_LinearSampler, In.UV).r * g_Roughness;
+    float3 View      = normalize(g_CameraPos.xyz - In.Pos.xyz);
+    return Color * saturate(dot(Normal, View)) * (1.0 - Roughness);
+}
+)";
+
+// Pins the per-frame constants so that they can be shared by all pipelines
+const std::string BindingLayout = R"(
+# name   set  binding
+Frame    0    0
+)";
+;
+} // namespace HLSL
+
+enum class BindingPolicy
+{
+    // Keep whatever the front end assigned (glslang's auto-mapping follows traversal order)
+    Keep,
+
+    // Resources without an explicit binding are numbered in name order. Compact, but adding
+    // or removing a resource shifts the bindings of every resource that sorts after it.
+    SortedByName,
+
+    // The binding is derived from a hash of the resource name, collisions are resolved by
+    // probing in name order. Adding or removing a resource does not move the others unless
+    // they collided with it.
+    NameHash,
+};
+
+struct BindingAssignmentOptions
+{
+    BindingPolicy Policy = BindingPolicy::NameHash;
+
+    // WebGPU's default maxBindingsPerBindGroup
+    uint32_t MaxBindingsPerSet = 1000;
+
+    // Explicit (set, binding) per resource name, e.g. loaded from a layout file. Always takes
+    // precedence over both the policy and the bindings in the source.
+    std::map<std::string, std::pair<uint32_t, uint32_t>> Layout;
+};
+
+struct ResourceBindingInfo
+{
+    std::string Name;
+    uint32_t    Set     = 0;
+    uint32_t    Binding = 0;
+};
+
+struct BindingAssignmentReport
+{
+    std::vector<ResourceBindingInfo> Bindings; // Sorted by name
+    std::string                      Error;
+};
+
+// Lines of "<name> <set> <binding>", '#' starts a comment
+std::map<std::string, std::pair<uint32_t, uint32_t>> ParseBindingLayout(const std::string& Layout)
+{
+    std::map<std::string, std::pair<uint32_t, uint32_t>> Bindings;
+
+    std::istringstream Lines{Layout};
+    for (std::string Line; std::getline(Lines, Line);)
+    {
+        std::istringstream Tokens{Line.substr(0, Line.find('#'))};
+
+        std::string Name;
+        uint32_t    Set = 0, Binding = 0;
+        if (!(Tokens >> Name))
+            continue;
+        if (!(Tokens >> Set >> Binding))
+            LOG_ERROR_AND_THROW("Invalid binding layout line: '", Line, "'");
+        if (!Bindings.emplace(Name, std::make_pair(Set, Binding)).second)
+            LOG_ERROR_AND_THROW("Resource '", Name, "' is listed twice in the binding layout");
+    }
+    return Bindings;
+}
+
+// Assigns DescriptorSet/Binding decorations that depend only on the resource names, the
+// layout and the bindings written in the source, never on declaration or traversal order.
+// Resources that already have a Binding decoration (explicit [[vk::binding]] or register())
+// keep it unless the layout overrides it; their slots are reserved for the others.
+// Runs on the module straight out of glslang, compiled with setAutoMapBindings(false).
+class StableBindingAssignmentPass final : public spvtools::opt::Pass
+{
+public:
+    StableBindingAssignmentPass(const BindingAssignmentOptions& Options, BindingAssignmentReport* pReport) :
+        m_Options{Options},
+        m_pReport{pReport}
+    {}
+
+    const char* name() const override
+    {
+        return "stable-binding-assignment";
+    }
+
+    Status Process() override
+    {
+        struct Resource
+        {
+            spvtools::opt::Instruction* pVariable = nullptr;
+            std::string                 Name;
+            uint32_t                    Set        = 0;
+            uint32_t                    Binding    = 0;
+            bool                        HasBinding = false;
+        };
+
+        std::vector<Resource> Resources;
+        for (auto& Instruction : get_module()->types_values())
+        {
+            if (Instruction.opcode() != spv::Op::OpVariable || !IsResourceStorageClass(Instruction.GetSingleWordInOperand(0)))
+                continue;
+
+            Resource Res{&Instruction, GetVariableName(&Instruction)};
+            if (Res.Name.empty())
+                return Fail(ConcatenateArgs("Resource %", Instruction.result_id(), " has no name"));
+
+            for (auto* pDecoration : get_decoration_mgr()->GetDecorationsFor(Instruction.result_id(), false))
+            {
+                if (pDecoration->opcode() != spv::Op::OpDecorate || pDecoration->NumInOperands() < 3)
+                    continue;
+
+                const auto Decoration = static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(1));
+                if (Decoration == spv::Decoration::DescriptorSet)
+                {
+                    Res.Set = pDecoration->GetSingleWordInOperand(2);
+                }
+                else if (Decoration == spv::Decoration::Binding)
+                {
+                    Res.Binding    = pDecoration->GetSingleWordInOperand(2);
+                    Res.HasBinding = true;
+                }
+            }
+            Resources.emplace_back(std::move(Res));
+        }
+
+        // Ids are assigned in traversal order too, so everything below is ordered by name
+        std::sort(Resources.begin(), Resources.end(), [](const Resource& LHS, const Resource& RHS) { return LHS.Name < RHS.Name; });
+        for (size_t i = 1; i < Resources.size(); ++i)
+        {
+            if (Resources[i].Name == Resources[i - 1].Name)
+                return Fail(ConcatenateArgs("Resource name '", Resources[i].Name, "' is not unique"));
+        }
+
+        if (m_Options.Policy != BindingPolicy::Keep)
+        {
+            std::map<uint32_t, std::set<uint32_t>> UsedBindings; // Set -> bindings
+            std::vector<Resource*>                 Unassigned;
+            for (auto& Res : Resources)
+            {
+                auto Layout = m_Options.Layout.find(Res.Name);
+                if (Layout != m_Options.Layout.end())
+                {
+                    Res.Set        = Layout->second.first;
+                    Res.Binding    = Layout->second.second;
+                    Res.HasBinding = true;
+                }
+
+                if (Res.HasBinding)
+                    UsedBindings[Res.Set].insert(Res.Binding);
+                else
+                    Unassigned.push_back(&Res);
+            }
+
+            for (auto* pRes : Unassigned)
+            {
+                auto&    Used    = UsedBindings[pRes->Set];
+                uint32_t Binding = m_Options.Policy == BindingPolicy::NameHash ? HashName(pRes->Name) % m_Options.MaxBindingsPerSet : 0;
+                for (uint32_t Probe = 0; Used.count(Binding) != 0; ++Probe)
+                {
+                    if (Probe >= m_Options.MaxBindingsPerSet)
+                        return Fail(ConcatenateArgs("Set ", pRes->Set, " has no free binding for '", pRes->Name, "'"));
+                    Binding = (Binding + 1) % m_Options.MaxBindingsPerSet;
+                }
+                Used.insert(Binding);
+                pRes->Binding = Binding;
+            }
+
+            for (const auto& Res : Resources)
+            {
+                const uint32_t Id = Res.pVariable->result_id();
+                get_decoration_mgr()->RemoveDecorationsFrom(Id, [](const spvtools::opt::Instruction& Decoration) {
+                    if (Decoration.opcode() != spv::Op::OpDecorate)
+                        return false;
+                    const auto Kind = static_cast<spv::Decoration>(Decoration.GetSingleWordInOperand(1));
+                    return Kind == spv::Decoration::DescriptorSet || Kind == spv::Decoration::Binding;
+                });
+                get_decoration_mgr()->AddDecorationVal(Id, static_cast<uint32_t>(spv::Decoration::DescriptorSet), Res.Set);
+                get_decoration_mgr()->AddDecorationVal(Id, static_cast<uint32_t>(spv::Decoration::Binding), Res.Binding);
+            }
+        }
+
+        for (const auto& Res : Resources)
+            m_pReport->Bindings.push_back({Res.Name, Res.Set, Res.Binding});
+
+        return m_Options.Policy != BindingPolicy::Keep && !Resources.empty() ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+    }
+
+private:
+    static bool IsResourceStorageClass(uint32_t StorageClass)
+    {
+        switch (static_cast<spv::StorageClass>(StorageClass))
+        {
+            case spv::StorageClass::UniformConstant:
+            case spv::StorageClass::Uniform:
+            case spv::StorageClass::StorageBuffer:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // FNV-1a: must never change, or every binding in every cache moves
+    static uint32_t HashName(const std::string& Name)
+    {
+        uint32_t Hash = 2166136261u;
+        for (char c : Name)
+            Hash = (Hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        return Hash;
+    }
+
+    Status Fail(std::string Error)
+    {
+        m_pReport->Error = std::move(Error);
+        return Status::Failure;
+    }
+
+    uint32_t GetPointeeTypeId(const spvtools::opt::Instruction* pVariable)
+    {
+        return get_def_use_mgr()->GetDef(pVariable->type_id())->GetSingleWordInOperand(1);
+    }
+
+    std::string GetName(uint32_t Id)
+    {
+        for (const auto& Name : context()->GetNames(Id))
+            return Name.second->GetInOperand(1).AsString();
+        return {};
+    }
+
+    // cbuffers and structured buffers are usually named through their block type. A
+    // resource without any name has no stable identity, which is an error.
+    std::string GetVariableName(const spvtools::opt::Instruction* pVariable)
+    {
+        std::string Name = GetName(pVariable->result_id());
+        if (Name.empty())
+            Name = GetName(GetPointeeTypeId(pVariable));
+        return Name;
+    }
+
+private:
+    const BindingAssignmentOptions& m_Options;
+    BindingAssignmentReport* const  m_pReport;
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> AssignBindings(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv, const BindingAssignmentOptions& Options, BindingAssignmentReport& Report)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterPass(spvtools::Optimizer::PassToken{std::make_unique<StableBindingAssignmentPass>(Options, &Report)});
+
+    // Resources have no bindings yet, which the validator rejects
+    spvtools::OptimizerOptions OptimizerOptions;
+    OptimizerOptions.set_run_validator(false);
+
+    std::vector<uint32_t> SPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &SPIRV, OptimizerOptions))
+        LOG_ERROR_AND_THROW("Failed to assign bindings: ", Report.Error);
+
+    return SPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const BindingAssignmentOptions& Options, BindingAssignmentReport& Report)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangFragment};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    // Locations follow the entry point signature, which is already independent of unrelated edits
+    Shader.setAutoMapBindings(Options.Policy == BindingPolicy::Keep);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(AssignBindings(SPIRV, SPV_ENV_VULKAN_1_0, Options, Report), SPV_ENV_VULKAN_1_0);
+
+    if (!OptimizedSPIRV.empty())
+        return OptimizedSPIRV;
+
+    LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+struct ConvertedShader
+{
+    std::string             WGSL;
+    BindingAssignmentReport Report;
+};
+
+ConvertedShader ConvertHLSLtoWGSL(const std::string& HLSL, const BindingAssignmentOptions& Options)
+{
+    ConvertedShader Shader;
+    Shader.WGSL = ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(HLSL, Options, Shader.Report));
+    return Shader;
+}
+
+// Number of resources present in both versions whose (set, binding) differs
+size_t CountMovedBindings(const BindingAssignmentReport& Before, const BindingAssignmentReport& After)
+{
+    size_t NumMoved = 0;
+    for (const auto& Binding : After.Bindings)
+    {
+        auto It = std::find_if(Before.Bindings.begin(), Before.Bindings.end(), [&](const ResourceBindingInfo& Other) { return Other.Name == Binding.Name; });
+        if (It != Before.Bindings.end() && (It->Set != Binding.Set || It->Binding != Binding.Binding))
+            ++NumMoved;
+    }
+    return NumMoved;
+}
+
+void PrintBindings(const char* Title, const BindingAssignmentReport& Report)
+{
+    std::cout << Title << ":\n";
+    for (const auto& Binding : Report.Bindings)
+        std::cout << "    set " << Binding.Set << ", binding " << Binding.Binding << ": " << Binding.Name << "\n";
+}
+
+// Usage: StableBindings [--layout <file>] [--policy keep|sorted|hash]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        BindingAssignmentOptions Options;
+        Options.Layout = ParseBindingLayout(HLSL::BindingLayout);
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--layout" && i + 1 < argc)
+            {
+                std::ifstream     File{argv[++i]};
+                std::stringstream Layout;
+                Layout << File.rdbuf();
+                if (!File)
+                    LOG_ERROR_AND_THROW("Failed to read binding layout '", argv[i], "'");
+                Options.Layout = ParseBindingLayout(Layout.str());
+            }
+            else if (Arg == "--policy" && i + 1 < argc)
+            {
+                const std::string Policy = argv[++i];
+                if (Policy == "keep")
+                    Options.Policy = BindingPolicy::Keep;
+                else if (Policy == "sorted")
+                    Options.Policy = BindingPolicy::SortedByName;
+                else if (Policy == "hash")
+                    Options.Policy = BindingPolicy::NameHash;
+                else
+                    LOG_ERROR_AND_THROW("Unknown binding policy '", Policy, "'");
+            }
+            else
+            {
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+            }
+        }
+
+        // A small edit: a new texture declared (and sampled) before the existing ones
+        std::string EditedPS = HLSL::MaterialPS;
+        EditedPS.replace(EditedPS.find("Texture2D<float4> g_BaseColorMap;"), 0, "Texture2D<float4> g_DetailMap;\n");
+        EditedPS.replace(EditedPS.find("float4 Color     ="), 0, "float4 Detail    = g_DetailMap.Sample(g_LinearSampler, In.UV * 8.0);\n    ");
+        EditedPS.replace(EditedPS.find("return Color *"), 14, "return Detail * Color *");
+
+        BindingAssignmentOptions AutoMapOptions;
+        AutoMapOptions.Policy = BindingPolicy::Keep;
+
+        const auto AutoMapped       = ConvertHLSLtoWGSL(HLSL::MaterialPS, AutoMapOptions);
+        const auto AutoMappedEdited = ConvertHLSLtoWGSL(EditedPS, AutoMapOptions);
+        const auto Stable           = ConvertHLSLtoWGSL(HLSL::MaterialPS, Options);
+        const auto StableEdited     = ConvertHLSLtoWGSL(EditedPS, Options);
+
+        // Identical inputs must produce byte-identical WGSL
+        if (ConvertHLSLtoWGSL(HLSL::MaterialPS, Options).WGSL != Stable.WGSL)
+            LOG_ERROR_AND_THROW("Converting the same source twice produced different WGSL");
+
+        PrintBindings("Auto-mapped bindings", AutoMapped.Report);
+        PrintBindings("Auto-mapped bindings after the edit", AutoMappedEdited.Report);
+        PrintBindings("Stable bindings", Stable.Report);
+        PrintBindings("Stable bindings after the edit", StableEdited.Report);
+        std::cout << StableEdited.WGSL << "\n";
+
+        LOG_INFO_MESSAGE("Existing resources moved by the edit: ", CountMovedBindings(AutoMapped.Report, AutoMappedEdited.Report), " auto-mapped, ",
+                         CountMovedBindings(Stable.Report, StableEdited.Report), " with the stable policy");
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
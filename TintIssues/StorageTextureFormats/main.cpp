@@ -0,0 +1,716 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <algorithm>
+#include <fstream>
+#include <regex>
+#include <map>
+#include <iomanip>
+#include <iterator>
+#include <cctype>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+#define LOG_INFO_MESSAGE(...)                               \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Info: " << Message << std::endl;      \
+    } while (false)
+
+namespace HLSL
+{
+
+// From ComparisonIntTypes
+const std::string FillTextureCS = R"(
+
+RWTexture2D</*format=rgba8*/ float4> g_tex2DUAV : register(u0);
+[numthreads(16, 16, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+	uint2 ui2Dim;
+	g_tex2DUAV.GetDimensions(ui2Dim.x, ui2Dim.y);
+	if (DTid.x >= ui2Dim.x || DTid.y >= ui2Dim.y)
+        return;
+
+	g_tex2DUAV[DTid.xy] = float4(float2(DTid.xy % 256u) / 256.0, 0.0, 1.0);
+}
+)";
+
+// The three ways to give a format: a comment, the sidecar file and the DXC attribute
+const std::string ToneMapCS = R"(
+RWTexture2D</*format=rgba16f*/ float4> g_Output    : register(u0);
+RWTexture2D<float>                     g_Luminance : register(u1); // Format comes from the sidecar
+
+[[vk::image_format("rg32f")]]
+RWTexture2DArray<float2> g_Velocity : register(u2);
+
+Texture2D<float4> g_Input;
+
+[numthreads(8, 8, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+    uint2 Dim;
+    g_Output.GetDimensions(Dim.x, Dim.y);
+    if (DTid.x >= Dim.x || DTid.y >= Dim.y)
+        return;
+
+    float4 Color    = g_Input.Load(int3(DTid.xy, 0));
+    float2 Velocity = g_Velocity[uint3(DTid.xy, 0)];
+    float  AvgLum   = g_Luminance[DTid.xy];
+    float  Lum      = dot(Color.rgb, float3(0.2126, 0.7152, 0.0722));
+
+    g_Luminance[DTid.xy] = lerp(AvgLum, Lum, 0.05);
+    g_Output[DTid.xy]    = float4(Color.rgb / (1.0 + AvgLum), length(Velocity));
+}
+)";
+
+const std::string ToneMapCSFormats = R"(
+# Formats of the storage textures of ToneMapCS that are declared without a hint
+g_Luminance = r32f
+)";
+
+// Read-write access is only allowed for r32 formats in WGSL
+const std::string AccumulateCS = R"(
+RWTexture2D</*format=rgba8*/ float4> g_Accumulation : register(u0);
+
+[numthreads(8, 8, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+    g_Accumulation[DTid.xy] = g_Accumulation[DTid.xy] * 0.9 + 0.1;
+}
+)";
+;
+} // namespace HLSL
+
+// Storage texel formats of core WebGPU. Names follow [[vk::image_format]] (DXC/glslang).
+struct StorageFormatInfo
+{
+    const char*      Name;
+    spv::ImageFormat Format;
+    const char*      WGSLName;
+    char             ComponentType; // 'f', 'i' or 'u'
+    uint32_t         NumComponents;
+    uint32_t         BytesPerTexel;
+};
+
+static constexpr StorageFormatInfo StorageFormats[] = {
+    {"rgba8", spv::ImageFormat::Rgba8, "rgba8unorm", 'f', 4, 4},
+    {"rgba8snorm", spv::ImageFormat::Rgba8Snorm, "rgba8snorm", 'f', 4, 4},
+    {"rgba8ui", spv::ImageFormat::Rgba8ui, "rgba8uint", 'u', 4, 4},
+    {"rgba8i", spv::ImageFormat::Rgba8i, "rgba8sint", 'i', 4, 4},
+    {"rgba16f", spv::ImageFormat::Rgba16f, "rgba16float", 'f', 4, 8},
+    {"rgba16ui", spv::ImageFormat::Rgba16ui, "rgba16uint", 'u', 4, 8},
+    {"rgba16i", spv::ImageFormat::Rgba16i, "rgba16sint", 'i', 4, 8},
+    {"r32f", spv::ImageFormat::R32f, "r32float", 'f', 1, 4},
+    {"r32ui", spv::ImageFormat::R32ui, "r32uint", 'u', 1, 4},
+    {"r32i", spv::ImageFormat::R32i, "r32sint", 'i', 1, 4},
+    {"rg32f", spv::ImageFormat::Rg32f, "rg32float", 'f', 2, 8},
+    {"rg32ui", spv::ImageFormat::Rg32ui, "rg32uint", 'u', 2, 8},
+    {"rg32i", spv::ImageFormat::Rg32i, "rg32sint", 'i', 2, 8},
+    {"rgba32f", spv::ImageFormat::Rgba32f, "rgba32float", 'f', 4, 16},
+    {"rgba32ui", spv::ImageFormat::Rgba32ui, "rgba32uint", 'u', 4, 16},
+    {"rgba32i", spv::ImageFormat::Rgba32i, "rgba32sint", 'i', 4, 16},
+};
+
+// Without a format, the only safe assumption is the widest format of the element type
+static constexpr uint32_t FallbackBytesPerTexel = 16;
+
+// Accepts the attribute names, the GLSL spelling (rgba8_snorm) and the WGSL names
+const StorageFormatInfo* FindStorageFormat(std::string Name)
+{
+    std::transform(Name.begin(), Name.end(), Name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    Name.erase(std::remove(Name.begin(), Name.end(), '_'), Name.end());
+    for (const auto& Format : StorageFormats)
+    {
+        if (Name == Format.Name || Name == Format.WGSLName)
+            return &Format;
+    }
+    return nullptr;
+}
+
+const StorageFormatInfo* FindStorageFormat(spv::ImageFormat Format)
+{
+    for (const auto& Info : StorageFormats)
+    {
+        if (Info.Format == Format)
+            return &Info;
+    }
+    return nullptr;
+}
+
+// WGSL only allows read_write storage textures with r32 formats
+bool IsReadWriteFormat(const StorageFormatInfo& Format)
+{
+    return Format.NumComponents == 1 && Format.BytesPerTexel == 4;
+}
+
+enum class FormatHintSource
+{
+    None,
+    Comment,
+    Sidecar,
+    Attribute,
+};
+
+const char* GetHintSourceName(FormatHintSource Source)
+{
+    switch (Source)
+    {
+        case FormatHintSource::Comment: return "comment";
+        case FormatHintSource::Sidecar: return "sidecar";
+        case FormatHintSource::Attribute: return "attribute";
+        default: return "none";
+    }
+}
+
+struct StorageTextureDecl
+{
+    std::string      Name;
+    std::string      ElementType;
+    size_t           Position = 0; // Start of the declaration in the source
+    std::string      Format;
+    FormatHintSource Source = FormatHintSource::None;
+};
+
+// Finds RW texture declarations together with their format hints:
+//
+//   [[vk::image_format("rgba8")]] RWTexture2D<float4> g_Tex;
+//   RWTexture2D</*format=rgba8*/ float4> g_Tex;
+//   RWTexture2D<float4 /*format=rgba8*/> g_Tex;
+std::vector<StorageTextureDecl> FindStorageTextures(const std::string& HLSL)
+{
+    static const std::regex Declaration{
+        R"((\[\[\s*vk::image_format\s*\(\s*"(\w+)"\s*\)\s*\]\]\s*)?)"
+        R"(\b(RWTexture1D|RWTexture1DArray|RWTexture2D|RWTexture2DArray|RWTexture3D|RWBuffer)\s*<\s*)"
+        R"((?:/\*\s*format\s*=\s*(\w+)\s*\*/\s*)?)"
+        R"(([\w\s]+?)\s*(?:/\*\s*format\s*=\s*(\w+)\s*\*/\s*)?>\s*(\w+))"};
+
+    std::vector<StorageTextureDecl> Textures;
+    for (auto It = std::sregex_iterator{HLSL.begin(), HLSL.end(), Declaration}; It != std::sregex_iterator{}; ++It)
+    {
+        const auto& Match = *It;
+
+        StorageTextureDecl Texture;
+        Texture.Name        = Match[6].str();
+        Texture.ElementType = Match[4].str();
+        Texture.Position    = static_cast<size_t>(Match.position(0));
+        if (Match[2].matched)
+        {
+            Texture.Format = Match[2].str();
+            Texture.Source = FormatHintSource::Attribute;
+        }
+        else if (Match[3].matched || Match[5].matched)
+        {
+            Texture.Format = Match[3].matched ? Match[3].str() : Match[5].str();
+            Texture.Source = FormatHintSource::Comment;
+        }
+        Textures.emplace_back(std::move(Texture));
+    }
+    return Textures;
+}
+
+// Sidecar files list one 'name = format' pair per line, '#' starts a comment
+std::map<std::string, std::string> ParseFormatSidecar(std::istream& Stream)
+{
+    static const std::regex Entry{R"(^\s*(\w+)\s*=\s*(\w+)\s*$)"};
+
+    std::map<std::string, std::string> Formats;
+    std::string                        Line;
+    for (uint32_t LineNumber = 1; std::getline(Stream, Line); ++LineNumber)
+    {
+        Line = Line.substr(0, Line.find('#'));
+        if (Line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::smatch Match;
+        if (!std::regex_match(Line, Match, Entry))
+            LOG_ERROR_AND_THROW("Invalid format sidecar entry at line ", LineNumber, ": '", Line, "'");
+        Formats[Match[1].str()] = Match[2].str();
+    }
+    return Formats;
+}
+
+// Returns the component type ('f', 'i' or 'u') of an RW texture element type such as
+// 'float4' or 'unorm float4', or 0 if the type is not recognized
+char GetComponentType(std::string ElementType)
+{
+    static const std::regex Type{R"(^\s*(?:(?:unorm|snorm)\s+)?(float|half|min16float|int|min16int|uint|min16uint)[1-4]?\s*$)"};
+
+    std::smatch Match;
+    if (!std::regex_match(ElementType, Match, Type))
+        return 0;
+
+    const std::string Scalar = Match[1].str();
+    return Scalar.find("uint") != std::string::npos ? 'u' : Scalar.find("int") != std::string::npos ? 'i' : 'f';
+}
+
+// Resolves the format of every RW texture and adds [[vk::image_format]] where the format
+// came from a comment or the sidecar, so that glslang writes it into OpTypeImage.
+std::string ApplyFormatHints(const std::string& HLSL, const std::map<std::string, std::string>& Sidecar, std::vector<StorageTextureDecl>& Textures)
+{
+    Textures = FindStorageTextures(HLSL);
+
+    for (const auto& [Name, Format] : Sidecar)
+    {
+        auto It = std::find_if(Textures.begin(), Textures.end(), [&](const StorageTextureDecl& Texture) { return Texture.Name == Name; });
+        if (It == Textures.end())
+        {
+            LOG_WARNING_MESSAGE("Sidecar format for '", Name, "' does not match any RW texture");
+            continue;
+        }
+
+        if (It->Source == FormatHintSource::Attribute && FindStorageFormat(It->Format) != FindStorageFormat(Format))
+            LOG_ERROR_AND_THROW("Sidecar format '", Format, "' of '", Name, "' contradicts its [[vk::image_format(\"", It->Format, "\")]] attribute");
+        if (It->Source == FormatHintSource::Comment && FindStorageFormat(It->Format) != FindStorageFormat(Format))
+            LOG_WARNING_MESSAGE("Sidecar format '", Format, "' of '", Name, "' overrides the '", It->Format, "' comment");
+
+        if (It->Source != FormatHintSource::Attribute)
+        {
+            It->Format = Format;
+            It->Source = FormatHintSource::Sidecar;
+        }
+    }
+
+    std::string Result = HLSL;
+    // Insert from the end so that the positions of earlier declarations stay valid
+    for (auto It = Textures.rbegin(); It != Textures.rend(); ++It)
+    {
+        if (It->Source == FormatHintSource::None)
+        {
+            LOG_WARNING_MESSAGE("RW texture '", It->Name, "' has no format hint");
+            continue;
+        }
+
+        const auto* pFormat = FindStorageFormat(It->Format);
+        if (pFormat == nullptr)
+            LOG_ERROR_AND_THROW("'", It->Format, "' of '", It->Name, "' is not a WebGPU storage texture format");
+
+        const char ComponentType = GetComponentType(It->ElementType);
+        if (ComponentType != 0 && ComponentType != pFormat->ComponentType)
+            LOG_ERROR_AND_THROW("Format '", It->Format, "' of '", It->Name, "' does not match its element type '", It->ElementType, "'");
+
+        It->Format = pFormat->Name;
+        if (It->Source != FormatHintSource::Attribute)
+            Result.insert(It->Position, ConcatenateArgs("[[vk::image_format(\"", pFormat->Name, "\")]] "));
+    }
+    return Result;
+}
+
+struct StorageImageInfo
+{
+    std::string      Name;
+    spv::ImageFormat Format    = spv::ImageFormat::Unknown;
+    bool             IsRead    = false;
+    bool             IsWritten = false;
+};
+
+struct StorageImageReport
+{
+    std::vector<StorageImageInfo> Images;
+    std::string                   Error;
+};
+
+// Decorates storage images that are never read with NonReadable and those that are never
+// written with NonWritable. The SPIR-V reader derives the WGSL access mode from these
+// decorations, and without them every storage texture becomes read_write, which WGSL
+// only allows for r32 formats.
+class StorageImageAccessPass final : public spvtools::opt::Pass
+{
+public:
+    explicit StorageImageAccessPass(StorageImageReport* pReport) :
+        m_pReport{pReport}
+    {}
+
+    const char* name() const override
+    {
+        return "infer-storage-image-access";
+    }
+
+    Status Process() override
+    {
+        bool Modified = false;
+        for (auto& Variable : get_module()->types_values())
+        {
+            if (Variable.opcode() != spv::Op::OpVariable || static_cast<spv::StorageClass>(Variable.GetSingleWordInOperand(0)) != spv::StorageClass::UniformConstant)
+                continue;
+
+            const auto* pType = GetDef(GetDef(Variable.type_id())->GetSingleWordInOperand(1));
+            while (pType->opcode() == spv::Op::OpTypeArray || pType->opcode() == spv::Op::OpTypeRuntimeArray)
+                pType = GetDef(pType->GetSingleWordInOperand(0));
+
+            // Sampled == 2: the image is used without a sampler
+            if (pType->opcode() != spv::Op::OpTypeImage || pType->GetSingleWordInOperand(5) != 2 ||
+                static_cast<spv::Dim>(pType->GetSingleWordInOperand(1)) == spv::Dim::SubpassData)
+                continue;
+
+            StorageImageInfo Image;
+            Image.Name   = GetName(Variable.result_id());
+            Image.Format = static_cast<spv::ImageFormat>(pType->GetSingleWordInOperand(6));
+            GetAccess(&Variable, Image.IsRead, Image.IsWritten);
+
+            if (!Image.IsRead)
+                Modified |= AddDecoration(Variable.result_id(), spv::Decoration::NonReadable);
+            if (!Image.IsWritten)
+                Modified |= AddDecoration(Variable.result_id(), spv::Decoration::NonWritable);
+
+            m_pReport->Images.emplace_back(std::move(Image));
+        }
+        return Modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+    }
+
+private:
+    const spvtools::opt::Instruction* GetDef(uint32_t Id)
+    {
+        return get_def_use_mgr()->GetDef(Id);
+    }
+
+    std::string GetName(uint32_t Id)
+    {
+        for (const auto& Name : context()->GetNames(Id))
+        {
+            if (Name.second->opcode() == spv::Op::OpName)
+                return Name.second->GetInOperand(1).AsString();
+        }
+        return ConcatenateArgs("%", Id);
+    }
+
+    bool AddDecoration(uint32_t Id, spv::Decoration Decoration)
+    {
+        if (get_decoration_mgr()->HasDecoration(Id, Decoration))
+            return false;
+
+        get_decoration_mgr()->AddDecoration(Id, static_cast<uint32_t>(Decoration));
+        return true;
+    }
+
+    // Follows the variable through loads and access chains. Any use that is not known to
+    // only read, only write or only query the image counts as both.
+    void GetAccess(spvtools::opt::Instruction* pVariable, bool& IsRead, bool& IsWritten)
+    {
+        std::vector<spvtools::opt::Instruction*> Worklist{pVariable};
+        while (!Worklist.empty())
+        {
+            auto* pInstruction = Worklist.back();
+            Worklist.pop_back();
+
+            get_def_use_mgr()->ForEachUser(pInstruction, [&](spvtools::opt::Instruction* pUser) {
+                if (spvtools::opt::IsAnnotationInst(pUser->opcode()) || spvtools::opt::IsDebug2Inst(pUser->opcode()))
+                    return;
+
+                switch (pUser->opcode())
+                {
+                    case spv::Op::OpEntryPoint:
+                    case spv::Op::OpImageQuerySize:
+                    case spv::Op::OpImageQuerySizeLod:
+                    case spv::Op::OpImageQueryLevels:
+                    case spv::Op::OpImageQuerySamples:
+                        break;
+
+                    case spv::Op::OpLoad:
+                    case spv::Op::OpAccessChain:
+                    case spv::Op::OpInBoundsAccessChain:
+                    case spv::Op::OpCopyObject:
+                        Worklist.push_back(pUser);
+                        break;
+
+                    case spv::Op::OpImageRead:
+                    case spv::Op::OpImageSparseRead:
+                        IsRead = true;
+                        break;
+
+                    case spv::Op::OpImageWrite:
+                        IsWritten = true;
+                        break;
+
+                    default:
+                        IsRead    = true;
+                        IsWritten = true;
+                        break;
+                }
+            });
+        }
+    }
+
+private:
+    StorageImageReport* const m_pReport;
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> InferStorageImageAccess(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv, StorageImageReport& Report)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterPass(spvtools::Optimizer::PassToken{std::make_unique<StorageImageAccessPass>(&Report)});
+
+    std::vector<uint32_t> SPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &SPIRV))
+        LOG_ERROR_AND_THROW("Failed to infer storage image access: ", Report.Error);
+
+    spvtools::SpirvTools Tools{TargetEnv};
+    if (!Tools.Validate(SPIRV))
+        LOG_ERROR_AND_THROW("SPIR-V with storage image access decorations is invalid.");
+
+    return SPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    return OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+const char* GetAccessName(const StorageImageInfo& Image)
+{
+    return Image.IsRead && Image.IsWritten ? "read_write" : Image.IsWritten ? "write" : "read";
+}
+
+// Converts a shader with format hints and checks that every storage texture gets the
+// hinted texel format and the narrowest access mode in WGSL
+std::string ConvertWithFormatHints(const std::string& HLSL, const std::map<std::string, std::string>& Sidecar)
+{
+    std::vector<StorageTextureDecl> Textures;
+
+    const auto         AnnotatedHLSL = ApplyFormatHints(HLSL, Sidecar, Textures);
+    StorageImageReport Report;
+    const auto         SPIRV = InferStorageImageAccess(ConvertHLSLtoSPIRV(AnnotatedHLSL), SPV_ENV_VULKAN_1_0, Report);
+
+    // Catch formats WebGPU would reject at pipeline creation before generating any WGSL
+    for (const auto& Image : Report.Images)
+    {
+        const auto* pFormat = FindStorageFormat(Image.Format);
+        if (pFormat != nullptr && Image.IsRead && Image.IsWritten && !IsReadWriteFormat(*pFormat))
+            LOG_ERROR_AND_THROW("'", Image.Name, "' is read and written, which WGSL only allows for r32 formats, not ", pFormat->WGSLName);
+    }
+
+    const auto WGSL = ConvertSPIRVtoWGSL(SPIRV);
+
+    std::cout << std::left << std::setw(16) << "Texture" << std::setw(11) << "Hint" << std::setw(24) << "WGSL texel format"
+              << std::setw(14) << "Bytes/texel" << "Fallback\n";
+    for (const auto& Image : Report.Images)
+    {
+        auto It = std::find_if(Textures.begin(), Textures.end(), [&](const StorageTextureDecl& Texture) { return Texture.Name == Image.Name; });
+
+        const auto* pFormat = FindStorageFormat(Image.Format);
+        const auto  Texel   = pFormat != nullptr ? ConcatenateArgs(pFormat->WGSLName, ", ", GetAccessName(Image)) : std::string{"unknown"};
+        if (pFormat != nullptr && WGSL.find("<" + Texel + ">") == std::string::npos)
+            LOG_ERROR_AND_THROW("WGSL does not declare '", Image.Name, "' as <", Texel, ">");
+
+        std::cout << std::setw(16) << Image.Name << std::setw(11) << GetHintSourceName(It != Textures.end() ? It->Source : FormatHintSource::None)
+                  << std::setw(24) << Texel << std::setw(14) << (pFormat != nullptr ? pFormat->BytesPerTexel : FallbackBytesPerTexel)
+                  << FallbackBytesPerTexel << "\n";
+    }
+    std::cout << std::right;
+
+    return WGSL;
+}
+
+struct ShaderDesc
+{
+    const char*        Name;
+    const std::string* pHLSL;
+    const std::string* pSidecar;
+    bool               ExpectFailure;
+};
+
+// Usage: StorageTextureFormats [--baseline] [--formats <sidecar file for ToneMapCS>]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        bool        PrintBaseline = false;
+        std::string SidecarPath;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--baseline")
+                PrintBaseline = true;
+            else if (Arg == "--formats" && i + 1 < argc)
+                SidecarPath = argv[++i];
+            else
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+        }
+
+        std::string ToneMapCSFormats = HLSL::ToneMapCSFormats;
+        if (!SidecarPath.empty())
+        {
+            std::ifstream File{SidecarPath};
+            if (!File)
+                LOG_ERROR_AND_THROW("Failed to open '", SidecarPath, "'");
+            ToneMapCSFormats.assign(std::istreambuf_iterator<char>{File}, std::istreambuf_iterator<char>{});
+        }
+
+        const ShaderDesc Shaders[] = {
+            {"FillTextureCS", &HLSL::FillTextureCS, nullptr, false},
+            {"ToneMapCS", &HLSL::ToneMapCS, &ToneMapCSFormats, false},
+            {"AccumulateCS", &HLSL::AccumulateCS, nullptr, true},
+        };
+
+        bool Success = true;
+        for (const auto& Shader : Shaders)
+        {
+            std::cout << "==== " << Shader.Name << " ====\n";
+
+            if (PrintBaseline)
+            {
+                try
+                {
+                    std::cout << "---- Without format hints ----\n"
+                              << ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(*Shader.pHLSL)) << "\n";
+                }
+                catch (const std::exception&)
+                {
+                }
+            }
+
+            std::map<std::string, std::string> Sidecar;
+            if (Shader.pSidecar != nullptr)
+            {
+                std::istringstream Stream{*Shader.pSidecar};
+                Sidecar = ParseFormatSidecar(Stream);
+            }
+
+            try
+            {
+                const auto WGSL = ConvertWithFormatHints(*Shader.pHLSL, Sidecar);
+                std::cout << "---- With format hints ----\n"
+                          << WGSL << "\n";
+                Success = Success && !Shader.ExpectFailure;
+            }
+            catch (const std::exception&)
+            {
+                std::cout << (Shader.ExpectFailure ? "Rejected as expected\n" : "Unexpected failure\n");
+                Success = Success && Shader.ExpectFailure;
+            }
+        }
+        return Success ? 0 : -1;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,653 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+#define LOG_WARNING_MESSAGE(...)                            \
+    do                                                      \
+    {                                                       \
+        std::string Message = ConcatenateArgs(__VA_ARGS__); \
+        std::cerr << "Warning: " << Message << std::endl;   \
+    } while (false)
+
+
+namespace HLSL
+{
+
+const std::string GenerateMipsCS = R"(
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+// The reason for separating channels is to reduce bank conflicts in the
+// local data memory controller.  A large stride will cause more threads
+// to collide on the same memory bank.
+groupshared float gs_R[64];
+groupshared float gs_G[64];
+groupshared float gs_B[64];
+groupshared float gs_A[64];
+
+void StoreColor(uint Index, float4 Color)
+{
+    gs_R[Index] = Color.r;
+    gs_G[Index] = Color.g;
+    gs_B[Index] = Color.b;
+    gs_A[Index] = Color.a;
+}
+
+float4 LoadColor(uint Index)
+{
+    return float4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);
+}
+
+float3 LinearToSRGB(float3 x)
+{
+    // This is exactly the sRGB curve
+    //return x < 0.0031308 ? 12.92 * x : 1.055 * pow(abs(x), 1.0 / 2.4) - 0.055;
+
+    // This is cheaper but nearly equivalent
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+[numthreads(8, 8, 1)] 
+void main(uint GI : SV_GroupIndex, uint3 DTid: SV_DispatchThreadID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    bool IsValidThread = all(DTid.xy < DstMipSize);
+    uint ArraySlice    = FirstArraySlice + DTid.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+        // One bilinear sample is insufficient when scaling down by more than 2x.
+        // You will slightly undersample in the case where the source dimension
+        // is odd.  This is why it's a really good idea to only generate mips on
+        // power-of-two sized textures.  Trying to handle the undersampling case
+        // will force this shader to be slower and more complicated as it will
+        // have to take more source texture samples.
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (DTid.xy + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        // > 2:1 in X dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // horizontally.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        // > 2:1 in Y dimension
+        // Use 2 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // vertically.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        // > 2:1 in in both dimensions
+        // Use 4 bilinear samples to guarantee we don't undersample when downsizing by more than 2x
+        // in both directions.
+        float2 UV1 = TexelSize * (DTid.xy + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(DTid.xy, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    if (IsValidThread)
+    {
+        // Without lane swizzle operations, the only way to share data with other
+        // threads is through LDS.
+        StoreColor(GI, Src1);
+    }
+
+    // This guarantees all LDS writes are complete and that all threads have
+    // executed all instructions so far (and therefore have issued their LDS
+    // write instructions.)
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // With low three bits for X and high three bits for Y, this bit mask
+        // (binary: 001001) checks that X and Y are even.
+        if ((GI & 0x9) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x01);
+            float4 Src3 = LoadColor(GI + 0x08);
+            float4 Src4 = LoadColor(GI + 0x09);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip2[uint3(DTid.xy / 2, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 2)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask (binary: 011011) checks that X and Y are multiples of four.
+        if ((GI & 0x1B) == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x02);
+            float4 Src3 = LoadColor(GI + 0x10);
+            float4 Src4 = LoadColor(GI + 0x12);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip3[uint3(DTid.xy / 4, ArraySlice)] = PackColor(Src1);
+            StoreColor(GI, Src1);
+        }
+    }
+
+    if (NumMipLevels == 3)
+        return;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsValidThread)
+    {
+        // This bit mask would be 111111 (X & Y multiples of 8), but only one
+        // thread fits that criteria.
+        if (GI == 0)
+        {
+            float4 Src2 = LoadColor(GI + 0x04);
+            float4 Src3 = LoadColor(GI + 0x20);
+            float4 Src4 = LoadColor(GI + 0x24);
+            Src1        = 0.25 * (Src1 + Src2 + Src3 + Src4);
+
+            OutMip4[uint3(DTid.xy / 8, ArraySlice)] = PackColor(Src1);
+        }
+    }
+}
+
+)";
+
+// GenerateMipsCS with the LDS exchanges replaced by quad and lane reads.
+//
+// Threads are assigned to texels in Morton order, so lanes 4k..4k+3 cover a 2x2 block,
+// lanes 16k..16k+15 a 4x4 block and the 64 threads of the group the 8x8 block. Every
+// level is then a reduction over lanes whose indices differ in two bits. This assumes
+// that lanes are assigned to threads in SV_GroupIndex order, which is how all current
+// GPUs fill subgroups of a 1D group.
+//
+// MIN_WAVE_SIZE is the smallest subgroup size the shader may run with: the levels that
+// span more lanes than that still go through LDS.
+const std::string GenerateMipsWaveCS = R"(
+#ifndef NON_POWER_OF_TWO
+#    define NON_POWER_OF_TWO 0
+#endif
+
+#ifndef MIN_WAVE_SIZE
+#    define MIN_WAVE_SIZE 4
+#endif
+
+RWTexture2DArray<float4> OutMip1;
+RWTexture2DArray<float4> OutMip2;
+RWTexture2DArray<float4> OutMip3;
+RWTexture2DArray<float4> OutMip4;
+Texture2DArray<float4>   SrcTex;
+SamplerState             BilinearClamp;
+
+cbuffer CB
+{
+    uint   SrcMipLevel;  // Texture level of source mip
+    uint   NumMipLevels; // Number of OutMips to write: [1, 4]
+    uint   FirstArraySlice;
+    uint   Dummy;
+    float2 TexelSize; // 1.0 / OutMip1.Dimensions
+}
+
+#if MIN_WAVE_SIZE < 16
+// One entry per quad
+groupshared float4 gs_Color[16];
+#elif MIN_WAVE_SIZE < 64
+// One entry per 16 lanes
+groupshared float4 gs_Color[4];
+#endif
+
+float3 LinearToSRGB(float3 x)
+{
+    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;
+}
+
+float4 PackColor(float4 Linear)
+{
+#ifdef CONVERT_TO_SRGB
+    return float4(LinearToSRGB(Linear.rgb), Linear.a);
+#else
+    return Linear;
+#endif
+}
+
+// X from the even bits of the index, Y from the odd bits
+uint2 MortonDecode(uint Index)
+{
+    return uint2((Index & 0x1) | ((Index >> 1) & 0x2) | ((Index >> 2) & 0x4),
+                 ((Index >> 1) & 0x1) | ((Index >> 2) & 0x2) | ((Index >> 3) & 0x4));
+}
+
+float4 ReduceQuad(float4 Color)
+{
+    Color += QuadReadAcrossX(Color);
+    Color += QuadReadAcrossY(Color);
+    return 0.25 * Color;
+}
+
+// Averages over the lanes whose indices differ from this one in the XMask and YMask bits
+float4 ReduceLanes(float4 Color, uint XMask, uint YMask)
+{
+    uint Lane = WaveGetLaneIndex();
+    Color += WaveReadLaneAt(Color, Lane ^ XMask);
+    Color += WaveReadLaneAt(Color, Lane ^ YMask);
+    return 0.25 * Color;
+}
+
+[numthreads(64, 1, 1)]
+void main(uint GI : SV_GroupIndex, uint3 GroupId : SV_GroupID)
+{
+    uint2 DstMipSize;
+    uint  Elements;
+    SrcTex.GetDimensions(DstMipSize.x, DstMipSize.y, Elements);
+    DstMipSize >>= SrcMipLevel;
+    uint2 Pos           = GroupId.xy * 8 + MortonDecode(GI);
+    bool  IsValidThread = all(Pos < DstMipSize);
+    uint  ArraySlice    = FirstArraySlice + GroupId.z;
+
+    float4 Src1 = 0;
+    if (IsValidThread)
+    {
+#if NON_POWER_OF_TWO == 0
+        float2 UV = TexelSize * (Pos + 0.5);
+        Src1      = SrcTex.SampleLevel(BilinearClamp, float3(UV, ArraySlice), SrcMipLevel);
+#elif NON_POWER_OF_TWO == 1
+        float2 UV1 = TexelSize * (Pos + float2(0.25, 0.5));
+        float2 Off = TexelSize * float2(0.5, 0.0);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 2
+        float2 UV1 = TexelSize * (Pos + float2(0.5, 0.25));
+        float2 Off = TexelSize * float2(0.0, 0.5);
+        Src1       = 0.5 * (SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel) + SrcTex.SampleLevel(BilinearClamp, float3(UV1 + Off, ArraySlice), SrcMipLevel));
+#elif NON_POWER_OF_TWO == 3
+        float2 UV1 = TexelSize * (Pos + float2(0.25, 0.25));
+        float2 Off = TexelSize * 0.5;
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1, ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, 0.0), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(0.0, Off.y), ArraySlice), SrcMipLevel);
+        Src1 += SrcTex.SampleLevel(BilinearClamp, float3(UV1 + float2(Off.x, Off.y), ArraySlice), SrcMipLevel);
+        Src1 *= 0.25;
+#endif
+
+        OutMip1[uint3(Pos, ArraySlice)] = PackColor(Src1);
+    }
+
+    // A scalar (constant) branch can exit all threads coherently.
+    if (NumMipLevels == 1)
+        return;
+
+    // All lanes take part in the reductions, threads outside of the texture contribute zero
+    Src1 = ReduceQuad(Src1);
+    if (IsValidThread && (GI & 0x3) == 0)
+        OutMip2[uint3(Pos / 2, ArraySlice)] = PackColor(Src1);
+
+    if (NumMipLevels == 2)
+        return;
+
+#if MIN_WAVE_SIZE >= 16
+    Src1 = ReduceLanes(Src1, 0x4, 0x8);
+#else
+    if ((GI & 0x3) == 0)
+        gs_Color[GI >> 2] = Src1;
+    GroupMemoryBarrierWithGroupSync();
+    if ((GI & 0xF) == 0)
+        Src1 = 0.25 * (gs_Color[GI >> 2] + gs_Color[(GI >> 2) + 1] + gs_Color[(GI >> 2) + 2] + gs_Color[(GI >> 2) + 3]);
+#endif
+    if (IsValidThread && (GI & 0xF) == 0)
+        OutMip3[uint3(Pos / 4, ArraySlice)] = PackColor(Src1);
+
+    if (NumMipLevels == 3)
+        return;
+
+#if MIN_WAVE_SIZE >= 64
+    Src1 = ReduceLanes(Src1, 0x10, 0x20);
+#else
+#    if MIN_WAVE_SIZE < 16
+    // Every lane overwrites the first entry it has just read: no other thread accesses
+    // it, so no barrier is needed before the store
+    const uint Stride = 4;
+#    else
+    const uint Stride = 1;
+#    endif
+    if ((GI & 0xF) == 0)
+        gs_Color[(GI >> 4) * Stride] = Src1;
+    GroupMemoryBarrierWithGroupSync();
+    if (GI == 0)
+        Src1 = 0.25 * (gs_Color[0] + gs_Color[Stride] + gs_Color[2 * Stride] + gs_Color[3 * Stride]);
+#endif
+    if (IsValidThread && GI == 0)
+        OutMip4[uint3(Pos / 8, ArraySlice)] = PackColor(Src1);
+}
+)";
+;
+} // namespace HLSL
+
+struct GenerateMipsVariant
+{
+    std::string Name;
+    uint32_t    MinWaveSize = 0; // 0 for the LDS version, which does not use subgroups
+    std::string WGSL;
+    bool        IsAvailable = false;
+};
+
+// The part of the WebGPU adapter info that selects the variant
+struct AdapterDesc
+{
+    const char* Name;
+    bool        HasSubgroups;    // The "subgroups" feature
+    uint32_t    SubgroupMinSize; // GPUAdapterInfo.subgroupMinSize
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+// Wave intrinsics become OpGroupNonUniform* instructions, which need SPIR-V 1.3
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, const std::string& Preamble, bool UseSubgroups)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangCompute};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble(Preamble.c_str());
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, UseSubgroups ? glslang::EShTargetVulkan_1_1 : glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, UseSubgroups ? glslang::EShTargetSpv_1_3 : glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    return OptimizeSPIRV(SPIRV, UseSubgroups ? SPV_ENV_VULKAN_1_1 : SPV_ENV_VULKAN_1_0);
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+// The LDS version is always built. A subgroup variant that fails to convert is kept as
+// unavailable, and adapters that would have used it fall back to a smaller one or LDS.
+std::vector<GenerateMipsVariant> BuildVariants(const std::string& Preamble)
+{
+    std::vector<GenerateMipsVariant> Variants;
+
+    GenerateMipsVariant LDS;
+    LDS.Name        = "lds";
+    LDS.WGSL        = ConvertSPIRVtoWGSL(ConvertHLSLtoSPIRV(HLSL::GenerateMipsCS, Preamble, false));
+    LDS.IsAvailable = true;
+    Variants.emplace_back(std::move(LDS));
+
+    for (uint32_t MinWaveSize : {4u, 16u, 64u})
+    {
+        GenerateMipsVariant Variant;
+        Variant.Name        = ConcatenateArgs("wave", MinWaveSize);
+        Variant.MinWaveSize = MinWaveSize;
+        try
+        {
+            const auto SPIRV    = ConvertHLSLtoSPIRV(HLSL::GenerateMipsWaveCS, ConcatenateArgs(Preamble, "#define MIN_WAVE_SIZE ", MinWaveSize, "\n"), true);
+            Variant.WGSL        = ConvertSPIRVtoWGSL(SPIRV);
+            Variant.IsAvailable = true;
+        }
+        catch (const std::exception&)
+        {
+            LOG_WARNING_MESSAGE("Subgroup variant ", Variant.Name, " is not available, adapters will fall back to LDS");
+        }
+        Variants.emplace_back(std::move(Variant));
+    }
+    return Variants;
+}
+
+// Picks the variant that keeps the most levels in registers and is guaranteed to fit
+// in the smallest subgroup the adapter may use
+const GenerateMipsVariant& SelectVariant(const std::vector<GenerateMipsVariant>& Variants, const AdapterDesc& Adapter)
+{
+    const GenerateMipsVariant* pSelected = &Variants.front();
+    for (const auto& Variant : Variants)
+    {
+        if (Variant.IsAvailable && Adapter.HasSubgroups && Variant.MinWaveSize <= Adapter.SubgroupMinSize && Variant.MinWaveSize > pSelected->MinWaveSize)
+            pSelected = &Variant;
+    }
+    return *pSelected;
+}
+
+size_t CountOccurrences(const std::string& Str, const std::string& Pattern)
+{
+    size_t Count = 0;
+    for (size_t Pos = Str.find(Pattern); Pos != std::string::npos; Pos = Str.find(Pattern, Pos + Pattern.size()))
+        ++Count;
+    return Count;
+}
+
+// Usage: SubgroupGenerateMips [--define NAME=VALUE]... [--print-wgsl]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        std::string Preamble;
+        bool        PrintWGSL = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            if (Arg == "--define" && i + 1 < argc)
+            {
+                std::string Define = argv[++i];
+                std::replace(Define.begin(), Define.end(), '=', ' ');
+                Preamble += "#define " + Define + "\n";
+            }
+            else if (Arg == "--print-wgsl")
+            {
+                PrintWGSL = true;
+            }
+            else
+            {
+                LOG_ERROR_AND_THROW("Unknown argument '", Arg, "'");
+            }
+        }
+
+        const auto Variants = BuildVariants(Preamble);
+
+        std::cout << std::left << std::setw(10) << "Variant" << std::setw(10) << "Barriers" << std::setw(14) << "LDS arrays"
+                  << std::setw(15) << "Subgroup ops" << "Status\n";
+        for (const auto& Variant : Variants)
+        {
+            std::cout << std::setw(10) << Variant.Name;
+            if (Variant.IsAvailable)
+            {
+                std::cout << std::setw(10) << CountOccurrences(Variant.WGSL, "workgroupBarrier()")
+                          << std::setw(14) << CountOccurrences(Variant.WGSL, "var<workgroup>")
+                          << std::setw(15) << CountOccurrences(Variant.WGSL, "subgroupShuffle(") + CountOccurrences(Variant.WGSL, "quadSwap")
+                          << "ok\n";
+            }
+            else
+            {
+                std::cout << std::setw(39) << "" << "unavailable\n";
+            }
+        }
+        std::cout << std::right << "\n";
+
+        const AdapterDesc Adapters[] = {
+            {"No subgroups", false, 0},
+            {"Subgroups 4..64", true, 4},
+            {"Subgroups 16..32", true, 16},
+            {"Subgroups 32..64", true, 32},
+            {"Subgroups 64", true, 64},
+        };
+        for (const auto& Adapter : Adapters)
+            std::cout << std::left << std::setw(20) << Adapter.Name << std::right << SelectVariant(Variants, Adapter).Name << "\n";
+
+        if (PrintWGSL)
+        {
+            for (const auto& Variant : Variants)
+            {
+                if (Variant.IsAvailable)
+                    std::cout << "\n---- " << Variant.Name << " ----\n"
+                              << Variant.WGSL << "\n";
+            }
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <tint/tint.h>
+
+#include "src/tint/lang/core/ir/access.h"
+#include "src/tint/lang/core/ir/binary.h"
+#include "src/tint/lang/core/ir/bitcast.h"
+#include "src/tint/lang/core/ir/builder.h"
+#include "src/tint/lang/core/ir/call.h"
+#include "src/tint/lang/core/ir/constant.h"
+#include "src/tint/lang/core/ir/construct.h"
+#include "src/tint/lang/core/ir/control_instruction.h"
+#include "src/tint/lang/core/ir/convert.h"
+#include "src/tint/lang/core/ir/let.h"
+#include "src/tint/lang/core/ir/load.h"
+#include "src/tint/lang/core/ir/load_vector_element.h"
+#include "src/tint/lang/core/ir/module.h"
+#include "src/tint/lang/core/ir/swizzle.h"
+#include "src/tint/lang/core/ir/unary.h"
+#include "src/tint/lang/core/type/pointer.h"
+
+struct TintIROptimizerOptions
+{
+    bool FoldIdentityBitcasts    = true;
+    bool FoldConstants           = true;
+    bool EliminateCommonSubexprs = true;
+    bool EliminateRedundantLoads = true;
+    bool EliminateDeadCode       = true;
+};
+
+struct TintIROptimizerStatistics
+{
+    uint32_t FoldedBitcasts   = 0;
+    uint32_t FoldedConstants  = 0;
+    uint32_t CommonSubexprs   = 0;
+    uint32_t RedundantLoads   = 0;
+    uint32_t DeadInstructions = 0;
+};
+
+// Conservative clean-up of the IR produced by the SPIR-V reader before it is handed to a
+// writer. Only side-effect-free instructions are folded, merged or removed:
+//  - bitcasts to the operand's own type, and bitcast round trips;
+//  - scalar i32/u32/f32 arithmetic on constants;
+//  - value numbering of pure instructions over the block tree (values of an enclosing block
+//    are visible in nested blocks);
+//  - repeated loads from function, private, uniform or handle memory with no store, call or
+//    control flow in between;
+//  - pure instructions whose results are never used.
+class TintIROptimizer
+{
+public:
+    explicit TintIROptimizer(const TintIROptimizerOptions& Options = {}) :
+        m_Options{Options}
+    {}
+
+    TintIROptimizerStatistics Run(tint::core::ir::Module& Module)
+    {
+        m_Stats = {};
+
+        tint::core::ir::Builder Builder{Module};
+        m_pBuilder = &Builder;
+        for (auto& Function : Module.functions)
+        {
+            ValueNumbers Numbers;
+            OptimizeBlock(Function->Block(), Numbers);
+        }
+        m_pBuilder = nullptr;
+
+        if (m_Options.EliminateDeadCode)
+        {
+            for (auto& Function : Module.functions)
+            {
+                while (EliminateDeadCode(Function->Block()))
+                    ;
+            }
+        }
+        return m_Stats;
+    }
+
+private:
+    using ValueNumberKey = std::vector<uintptr_t>;
+    using ValueNumbers   = std::map<ValueNumberKey, tint::core::ir::Value*>;
+    using LoadKey        = tint::core::ir::Value*;
+
+    static bool IsPure(const tint::core::ir::Instruction* pInst)
+    {
+        return pInst->IsAnyOf<tint::core::ir::Binary,
+                              tint::core::ir::Unary,
+                              tint::core::ir::Construct,
+                              tint::core::ir::Convert,
+                              tint::core::ir::Bitcast,
+                              tint::core::ir::Swizzle,
+                              tint::core::ir::Access>();
+    }
+
+    static bool IsReadOnlyDuringInvocation(tint::core::ir::Value* pPointer)
+    {
+        const auto* pPtrType = pPointer->Type()->As<tint::core::type::Pointer>();
+        if (pPtrType == nullptr)
+            return false;
+
+        switch (pPtrType->AddressSpace())
+        {
+            case tint::core::AddressSpace::kFunction:
+            case tint::core::AddressSpace::kPrivate:
+            case tint::core::AddressSpace::kUniform:
+            case tint::core::AddressSpace::kHandle:
+                return true;
+            default:
+                // Storage and workgroup memory may be written by other invocations
+                return false;
+        }
+    }
+
+    static ValueNumberKey GetValueNumberKey(tint::core::ir::Instruction* pInst)
+    {
+        ValueNumberKey Key;
+        Key.push_back(reinterpret_cast<uintptr_t>(&pInst->TypeInfo()));
+        Key.push_back(reinterpret_cast<uintptr_t>(pInst->Results()[0]->Type()));
+        if (const auto* pBinary = pInst->As<tint::core::ir::Binary>())
+            Key.push_back(static_cast<uintptr_t>(pBinary->Op()));
+        else if (const auto* pUnary = pInst->As<tint::core::ir::Unary>())
+            Key.push_back(static_cast<uintptr_t>(pUnary->Op()));
+        else if (auto* pSwizzle = pInst->As<tint::core::ir::Swizzle>())
+        {
+            for (uint32_t Index : pSwizzle->Indices())
+                Key.push_back(Index);
+        }
+        for (auto* pOperand : pInst->Operands())
+            Key.push_back(reinterpret_cast<uintptr_t>(pOperand));
+        return Key;
+    }
+
+    void Replace(tint::core::ir::Instruction* pInst, tint::core::ir::Value* pReplacement)
+    {
+        pInst->Results()[0]->ReplaceAllUsesWith(pReplacement);
+        pInst->Destroy();
+    }
+
+    bool TryFoldBitcast(tint::core::ir::Bitcast* pBitcast)
+    {
+        auto* pValue = pBitcast->Val();
+        if (pValue->Type() == pBitcast->Results()[0]->Type())
+        {
+            Replace(pBitcast, pValue);
+            return true;
+        }
+
+        // bitcast<T>(bitcast<U>(x)) where x is of type T
+        if (auto* pInner = pValue->As<tint::core::ir::InstructionResult>())
+        {
+            auto* pInnerBitcast = pInner->Instruction()->As<tint::core::ir::Bitcast>();
+            if (pInnerBitcast != nullptr && pInnerBitcast->Val()->Type() == pBitcast->Results()[0]->Type())
+            {
+                Replace(pBitcast, pInnerBitcast->Val());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename T>
+    static bool FoldArithmetic(tint::core::BinaryOp Op, T LHS, T RHS, T& Result)
+    {
+        switch (Op)
+        {
+            case tint::core::BinaryOp::kAdd: Result = LHS + RHS; return true;
+            case tint::core::BinaryOp::kSubtract: Result = LHS - RHS; return true;
+            case tint::core::BinaryOp::kMultiply: Result = LHS * RHS; return true;
+            default: return false;
+        }
+    }
+
+    bool TryFoldConstants(tint::core::ir::Binary* pBinary)
+    {
+        auto* pLHS = pBinary->LHS()->As<tint::core::ir::Constant>();
+        auto* pRHS = pBinary->RHS()->As<tint::core::ir::Constant>();
+        if (pLHS == nullptr || pRHS == nullptr || pLHS->Type() != pRHS->Type())
+            return false;
+
+        const auto* pType = pLHS->Type();
+
+        tint::core::ir::Constant* pFolded = nullptr;
+        if (pType->Is<tint::core::type::F32>())
+        {
+            float Result = 0;
+            if (FoldArithmetic<float>(pBinary->Op(), pLHS->Value()->ValueAs<float>(), pRHS->Value()->ValueAs<float>(), Result) && std::isfinite(Result))
+                pFolded = m_pBuilder->Constant(tint::core::f32(Result));
+        }
+        else if (pType->IsAnyOf<tint::core::type::I32, tint::core::type::U32>())
+        {
+            // Two's complement wrap-around, as WGSL defines for runtime integer arithmetic
+            const uint32_t LHS    = pLHS->Value()->ValueAs<uint32_t>();
+            const uint32_t RHS    = pRHS->Value()->ValueAs<uint32_t>();
+            uint32_t       Result = 0;
+            switch (pBinary->Op())
+            {
+                case tint::core::BinaryOp::kAnd: Result = LHS & RHS; break;
+                case tint::core::BinaryOp::kOr: Result = LHS | RHS; break;
+                case tint::core::BinaryOp::kXor: Result = LHS ^ RHS; break;
+                default:
+                    if (!FoldArithmetic<uint32_t>(pBinary->Op(), LHS, RHS, Result))
+                        return false;
+            }
+            pFolded = pType->Is<tint::core::type::I32>() ?
+                m_pBuilder->Constant(tint::core::i32(static_cast<int32_t>(Result))) :
+                m_pBuilder->Constant(tint::core::u32(Result));
+        }
+
+        if (pFolded == nullptr)
+            return false;
+
+        Replace(pBinary, pFolded);
+        return true;
+    }
+
+    void OptimizeBlock(tint::core::ir::Block* pBlock, ValueNumbers Numbers)
+    {
+        std::map<LoadKey, tint::core::ir::Value*> AvailableLoads;
+        for (tint::core::ir::Instruction* pInst = pBlock->Front(); pInst != nullptr;)
+        {
+            tint::core::ir::Instruction* pNext = pInst->next;
+
+            if (auto* pControl = pInst->As<tint::core::ir::ControlInstruction>())
+            {
+                // Nested blocks see the enclosing values, but may store to memory and may
+                // execute repeatedly, so loads are neither inherited nor kept.
+                pControl->ForeachBlock([&](tint::core::ir::Block* pChild) { OptimizeBlock(pChild, Numbers); });
+                AvailableLoads.clear();
+            }
+            else if (auto* pBitcast = pInst->As<tint::core::ir::Bitcast>(); pBitcast != nullptr && m_Options.FoldIdentityBitcasts && TryFoldBitcast(pBitcast))
+            {
+                ++m_Stats.FoldedBitcasts;
+            }
+            else if (auto* pBinary = pInst->As<tint::core::ir::Binary>(); pBinary != nullptr && m_Options.FoldConstants && TryFoldConstants(pBinary))
+            {
+                ++m_Stats.FoldedConstants;
+            }
+            else if (IsPure(pInst))
+            {
+                if (m_Options.EliminateCommonSubexprs)
+                {
+                    auto Key      = GetValueNumberKey(pInst);
+                    auto Existing = Numbers.find(Key);
+                    if (Existing != Numbers.end())
+                    {
+                        Replace(pInst, Existing->second);
+                        ++m_Stats.CommonSubexprs;
+                    }
+                    else
+                    {
+                        Numbers.emplace(std::move(Key), pInst->Results()[0]);
+                    }
+                }
+            }
+            else if (auto* pLoad = pInst->As<tint::core::ir::Load>())
+            {
+                if (m_Options.EliminateRedundantLoads && IsReadOnlyDuringInvocation(pLoad->From()))
+                {
+                    auto Existing = AvailableLoads.find(pLoad->From());
+                    if (Existing != AvailableLoads.end())
+                    {
+                        Replace(pLoad, Existing->second);
+                        ++m_Stats.RedundantLoads;
+                    }
+                    else
+                    {
+                        AvailableLoads.emplace(pLoad->From(), pLoad->Results()[0]);
+                    }
+                }
+            }
+            else if (!pInst->Is<tint::core::ir::Let>())
+            {
+                // Stores, calls and everything else may write memory
+                AvailableLoads.clear();
+            }
+
+            pInst = pNext;
+        }
+    }
+
+    bool EliminateDeadCode(tint::core::ir::Block* pBlock)
+    {
+        bool IsChanged = false;
+        for (tint::core::ir::Instruction* pInst = pBlock->Back(); pInst != nullptr;)
+        {
+            tint::core::ir::Instruction* pPrev = pInst->prev;
+
+            if (auto* pControl = pInst->As<tint::core::ir::ControlInstruction>())
+            {
+                pControl->ForeachBlock([&](tint::core::ir::Block* pChild) { IsChanged = EliminateDeadCode(pChild) || IsChanged; });
+            }
+            else if ((IsPure(pInst) || pInst->IsAnyOf<tint::core::ir::Load, tint::core::ir::LoadVectorElement, tint::core::ir::Let>()) &&
+                     !pInst->Results()[0]->IsUsed())
+            {
+                pInst->Destroy();
+                ++m_Stats.DeadInstructions;
+                IsChanged = true;
+            }
+
+            pInst = pPrev;
+        }
+        return IsChanged;
+    }
+
+private:
+    const TintIROptimizerOptions m_Options;
+    TintIROptimizerStatistics    m_Stats;
+    tint::core::ir::Builder*     m_pBuilder = nullptr;
+};
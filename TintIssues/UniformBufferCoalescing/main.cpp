@@ -0,0 +1,930 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/build_module.h"
+#include "source/opt/ir_builder.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+#include "source/util/string_utils.h"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+
+namespace HLSL
+{
+
+// From ConstantBufferNameCollision
+const std::string TestVS = R"(
+struct Inner
+{
+    float2x4 Transform;     // 2x4 matrix -> requires a padded layout struct in a uniform buffer
+    float4   Offset;
+};
+
+cbuffer Params      // source name: "Params"
+{
+    Inner    g_Data;
+    float4x4 g_WorldViewProj;
+}
+
+cbuffer Params_1    // source name: literally "Params_1"
+{
+    float4 g_Color;
+}
+
+void main(out float4 Pos : SV_POSITION)
+{
+    Pos = mul(g_WorldViewProj, g_Data.Offset) + g_Color;
+}
+)";
+
+const std::string MaterialVS = R"(
+cbuffer cbCamera
+{
+    float4x4 g_ViewProj;
+    float4   g_CameraPos;
+}
+
+cbuffer cbObject
+{
+    float4x4 g_World;
+    float4   g_ObjectColor;
+}
+
+struct VSOutput
+{
+    float4 Pos      : SV_POSITION;
+    float3 WorldPos : WORLD_POS;
+    float3 Normal   : NORMAL;
+    float2 UV       : TEXCOORD;
+    float4 Color    : COLOR;
+};
+
+void main(in float3 Pos    : ATTRIB0,
+          in float3 Normal : ATTRIB1,
+          in float2 UV     : ATTRIB2,
+          out VSOutput Out)
+{
+    float4 WorldPos = mul(g_World, float4(Pos, 1.0));
+    Out.Pos      = mul(g_ViewProj, WorldPos);
+    Out.WorldPos = WorldPos.xyz;
+    Out.Normal   = mul((float3x3)g_World, Normal);
+    Out.UV       = UV;
+    Out.Color    = g_ObjectColor;
+}
+)";
+
+const std::string MaterialPS = R"(
+cbuffer cbCamera
+{
+    float4x4 g_ViewProj;
+    float4   g_CameraPos;
+}
+
+cbuffer cbLights
+{
+    float4 g_LightDir;
+    float4 g_LightColor;
+}
+
+cbuffer cbMaterial
+{
+    float4 g_BaseColor;
+    float2 g_UVScale;
+    float  g_Roughness;
+    float  g_Metallic;
+}
+
+cbuffer cbMaterialExtra
+{
+    float3 g_Emissive;
+    float  g_Opacity;
+}
+
+Texture2D    g_BaseColorMap;
+SamplerState g_BaseColorMap_sampler;
+
+struct VSOutput
+{
+    float4 Pos      : SV_POSITION;
+    float3 WorldPos : WORLD_POS;
+    float3 Normal   : NORMAL;
+    float2 UV       : TEXCOORD;
+    float4 Color    : COLOR;
+};
+
+float4 main(in VSOutput In) : SV_Target
+{
+    float4 Base = g_BaseColorMap.Sample(g_BaseColorMap_sampler, In.UV * g_UVScale) * g_BaseColor * In.Color;
+
+    float3 N     = normalize(In.Normal);
+    float3 V     = normalize(g_CameraPos.xyz - In.WorldPos);
+    float3 L     = -g_LightDir.xyz;
+    float3 H     = normalize(L + V);
+    float  Spec  = pow(saturate(dot(N, H)), lerp(64.0, 4.0, g_Roughness)) * lerp(0.04, 1.0, g_Metallic);
+    float3 Color = Base.rgb * saturate(dot(N, L)) * g_LightColor.rgb + Spec * g_LightColor.rgb + g_Emissive;
+    return float4(Color, Base.a * g_Opacity);
+}
+)";
+;
+} // namespace HLSL
+
+// cbuffers that are updated at the same frequency, e.g. once per frame or per material,
+// and are merged into one uniform buffer at the given binding
+struct UniformGroup
+{
+    std::string              Name;
+    uint32_t                 Set     = 0;
+    uint32_t                 Binding = 0;
+    std::vector<std::string> Buffers; // The order defines the offsets in the merged buffer
+};
+
+struct UniformMemberInfo
+{
+    std::string Name;
+    uint32_t    Offset = 0;
+    uint32_t    Size   = 0;
+};
+
+struct UniformBufferInfo
+{
+    std::string                    Name;
+    uint32_t                       Size = 0; // Rounded up to 16 bytes
+    std::vector<UniformMemberInfo> Members;
+};
+
+struct PlacedUniformBuffer
+{
+    UniformBufferInfo Buffer;
+    uint32_t          Offset = 0; // Offset of the cbuffer in the merged buffer
+};
+
+// Layout of a merged buffer, shared by all stages of a pipeline
+struct UniformGroupLayout
+{
+    std::string                      Name;
+    uint32_t                         Set     = 0;
+    uint32_t                         Binding = 0;
+    uint32_t                         Size    = 0;
+    std::vector<PlacedUniformBuffer> Buffers;
+};
+
+constexpr uint32_t AlignUp(uint32_t Value, uint32_t Alignment)
+{
+    return (Value + Alignment - 1) / Alignment * Alignment;
+}
+
+bool IsResourceStorageClass(uint32_t StorageClass)
+{
+    switch (static_cast<spv::StorageClass>(StorageClass))
+    {
+        case spv::StorageClass::UniformConstant:
+        case spv::StorageClass::Uniform:
+        case spv::StorageClass::StorageBuffer:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string GetName(spvtools::opt::IRContext& Context, uint32_t Id)
+{
+    for (const auto& Name : Context.GetNames(Id))
+    {
+        if (Name.second->opcode() == spv::Op::OpName)
+            return Name.second->GetInOperand(1).AsString();
+    }
+    return {};
+}
+
+// Returns the block struct of a uniform buffer variable, 0 if the variable is not a uniform buffer
+uint32_t GetUniformBlockId(spvtools::opt::IRContext& Context, const spvtools::opt::Instruction& Variable)
+{
+    if (Variable.opcode() != spv::Op::OpVariable || static_cast<spv::StorageClass>(Variable.GetSingleWordInOperand(0)) != spv::StorageClass::Uniform)
+        return 0;
+
+    const uint32_t StructId = Context.get_def_use_mgr()->GetDef(Variable.type_id())->GetSingleWordInOperand(1);
+    if (Context.get_def_use_mgr()->GetDef(StructId)->opcode() != spv::Op::OpTypeStruct)
+        return 0;
+
+    for (const auto* pDecoration : Context.get_decoration_mgr()->GetDecorationsFor(StructId, false))
+    {
+        if (pDecoration->opcode() == spv::Op::OpDecorate && static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(1)) == spv::Decoration::Block)
+            return StructId;
+    }
+    return 0;
+}
+
+// glslang names cbuffers through their block type, the variable itself is unnamed
+std::string GetUniformBufferName(spvtools::opt::IRContext& Context, const spvtools::opt::Instruction& Variable)
+{
+    std::string Name = GetName(Context, Variable.result_id());
+    return !Name.empty() ? Name : GetName(Context, GetUniformBlockId(Context, Variable));
+}
+
+// Reads the cbuffer layouts glslang emitted (Offset, ArrayStride and MatrixStride decorations)
+class UniformBufferReflection
+{
+public:
+    explicit UniformBufferReflection(spvtools::opt::IRContext& Context) :
+        m_Context{Context}
+    {}
+
+    std::vector<UniformBufferInfo> GetUniformBuffers() const
+    {
+        std::vector<UniformBufferInfo> Buffers;
+        for (auto& Instruction : m_Context.module()->types_values())
+        {
+            const uint32_t StructId = GetUniformBlockId(m_Context, Instruction);
+            if (StructId == 0)
+                continue;
+
+            UniformBufferInfo Buffer;
+            Buffer.Name = GetUniformBufferName(m_Context, Instruction);
+            Buffer.Size = AlignUp(GetDecoratedSize(StructId, false, 16), 16);
+
+            const auto* pStruct = GetDef(StructId);
+            for (uint32_t MemberIdx = 0; MemberIdx < pStruct->NumInOperands(); ++MemberIdx)
+            {
+                UniformMemberInfo Member;
+                Member.Name   = GetMemberName(StructId, MemberIdx);
+                Member.Offset = GetMemberDecoration(StructId, MemberIdx, spv::Decoration::Offset, 0);
+                Member.Size   = GetDecoratedSize(pStruct->GetSingleWordInOperand(MemberIdx),
+                                                 GetMemberDecoration(StructId, MemberIdx, spv::Decoration::RowMajor, 0) != 0,
+                                                 GetMemberDecoration(StructId, MemberIdx, spv::Decoration::MatrixStride, 16));
+                Buffer.Members.emplace_back(std::move(Member));
+            }
+            Buffers.emplace_back(std::move(Buffer));
+        }
+        return Buffers;
+    }
+
+private:
+    const spvtools::opt::Instruction* GetDef(uint32_t Id) const
+    {
+        return m_Context.get_def_use_mgr()->GetDef(Id);
+    }
+
+    std::string GetMemberName(uint32_t StructId, uint32_t MemberIdx) const
+    {
+        for (const auto& Name : m_Context.GetNames(StructId))
+        {
+            if (Name.second->opcode() == spv::Op::OpMemberName && Name.second->GetSingleWordInOperand(1) == MemberIdx)
+                return Name.second->GetInOperand(2).AsString();
+        }
+        return ConcatenateArgs("member", MemberIdx);
+    }
+
+    uint32_t GetDecoration(uint32_t Id, spv::Decoration Decoration, uint32_t DefaultValue) const
+    {
+        for (const auto* pDecoration : m_Context.get_decoration_mgr()->GetDecorationsFor(Id, false))
+        {
+            if (pDecoration->opcode() == spv::Op::OpDecorate && static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(1)) == Decoration)
+                return pDecoration->NumInOperands() > 2 ? pDecoration->GetSingleWordInOperand(2) : 1u;
+        }
+        return DefaultValue;
+    }
+
+    uint32_t GetMemberDecoration(uint32_t StructId, uint32_t MemberIdx, spv::Decoration Decoration, uint32_t DefaultValue) const
+    {
+        for (const auto* pDecoration : m_Context.get_decoration_mgr()->GetDecorationsFor(StructId, false))
+        {
+            if (pDecoration->opcode() == spv::Op::OpMemberDecorate && pDecoration->GetSingleWordInOperand(1) == MemberIdx &&
+                static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(2)) == Decoration)
+                return pDecoration->NumInOperands() > 3 ? pDecoration->GetSingleWordInOperand(3) : 1u;
+        }
+        return DefaultValue;
+    }
+
+    uint32_t GetScalarSize(uint32_t TypeId) const
+    {
+        const auto* pType = GetDef(TypeId);
+        while (pType->opcode() == spv::Op::OpTypeVector || pType->opcode() == spv::Op::OpTypeMatrix)
+            pType = GetDef(pType->GetSingleWordInOperand(0));
+        return pType->opcode() == spv::Op::OpTypeBool ? 4 : pType->GetSingleWordInOperand(0) / 8;
+    }
+
+    // Size of a type as described by its Offset/ArrayStride/MatrixStride decorations. A
+    // matrix decorated RowMajor is stored as R vectors of C components, otherwise as C
+    // vectors of R components.
+    uint32_t GetDecoratedSize(uint32_t TypeId, bool RowMajor, uint32_t MatrixStride) const
+    {
+        const auto* pType = GetDef(TypeId);
+        switch (pType->opcode())
+        {
+            case spv::Op::OpTypeVector:
+                return GetScalarSize(TypeId) * pType->GetSingleWordInOperand(1);
+
+            case spv::Op::OpTypeMatrix:
+            {
+                const uint32_t Columns = pType->GetSingleWordInOperand(1);
+                const uint32_t Rows    = GetDef(pType->GetSingleWordInOperand(0))->GetSingleWordInOperand(1);
+                return ((RowMajor ? Rows : Columns) - 1) * MatrixStride + (RowMajor ? Columns : Rows) * GetScalarSize(TypeId);
+            }
+
+            case spv::Op::OpTypeArray:
+            {
+                const auto*    pLength = GetDef(pType->GetSingleWordInOperand(1));
+                const uint32_t Length  = pLength->opcode() == spv::Op::OpConstant ? pLength->GetSingleWordInOperand(0) : 1;
+                return (Length - 1) * GetDecoration(TypeId, spv::Decoration::ArrayStride, 16) + GetDecoratedSize(pType->GetSingleWordInOperand(0), RowMajor, MatrixStride);
+            }
+
+            case spv::Op::OpTypeStruct:
+            {
+                uint32_t Size = 0;
+                for (uint32_t MemberIdx = 0; MemberIdx < pType->NumInOperands(); ++MemberIdx)
+                {
+                    const uint32_t Offset     = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::Offset, 0);
+                    const uint32_t Stride     = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::MatrixStride, 16);
+                    const bool     IsRowMajor = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::RowMajor, 0) != 0;
+                    Size                      = std::max(Size, Offset + GetDecoratedSize(pType->GetSingleWordInOperand(MemberIdx), IsRowMajor, Stride));
+                }
+                return Size;
+            }
+
+            default:
+                return GetScalarSize(TypeId);
+        }
+    }
+
+private:
+    spvtools::opt::IRContext& m_Context;
+};
+
+bool HasSameLayout(const UniformBufferInfo& LHS, const UniformBufferInfo& RHS)
+{
+    if (LHS.Size != RHS.Size || LHS.Members.size() != RHS.Members.size())
+        return false;
+    for (size_t MemberIdx = 0; MemberIdx < LHS.Members.size(); ++MemberIdx)
+    {
+        if (LHS.Members[MemberIdx].Offset != RHS.Members[MemberIdx].Offset || LHS.Members[MemberIdx].Size != RHS.Members[MemberIdx].Size)
+            return false;
+    }
+    return true;
+}
+
+// Places the cbuffers of every group one after another, in the order of the group, each at
+// a 16-byte aligned offset. Offsets only depend on the group definition and the cbuffer
+// declarations, never on which stage uses which cbuffer: all stages of a pipeline share
+// one layout, and a stage that does not use a cbuffer simply leaves its range alone.
+// StageBuffers must be reflected before optimization, which removes unused cbuffers.
+std::vector<UniformGroupLayout> ComputeGroupLayouts(const std::vector<UniformGroup>& Groups, const std::vector<std::vector<UniformBufferInfo>>& StageBuffers)
+{
+    std::set<std::string>           GroupedBuffers;
+    std::vector<UniformGroupLayout> Layouts;
+    for (const auto& Group : Groups)
+    {
+        UniformGroupLayout Layout;
+        Layout.Name    = Group.Name;
+        Layout.Set     = Group.Set;
+        Layout.Binding = Group.Binding;
+
+        for (const auto& BufferName : Group.Buffers)
+        {
+            if (!GroupedBuffers.insert(BufferName).second)
+                LOG_ERROR_AND_THROW("cbuffer '", BufferName, "' is listed in more than one group");
+
+            const UniformBufferInfo* pBuffer = nullptr;
+            for (const auto& Buffers : StageBuffers)
+            {
+                for (const auto& Buffer : Buffers)
+                {
+                    if (Buffer.Name != BufferName)
+                        continue;
+                    if (pBuffer != nullptr && !HasSameLayout(*pBuffer, Buffer))
+                        LOG_ERROR_AND_THROW("cbuffer '", BufferName, "' is declared differently in different stages");
+                    pBuffer = &Buffer;
+                }
+            }
+            // Its range can't be reserved without knowing its size
+            if (pBuffer == nullptr)
+                LOG_ERROR_AND_THROW("cbuffer '", BufferName, "' of group '", Group.Name, "' is not declared in any stage");
+
+            Layout.Buffers.push_back({*pBuffer, Layout.Size});
+            Layout.Size += pBuffer->Size;
+        }
+
+        if (!Layout.Buffers.empty())
+            Layouts.emplace_back(std::move(Layout));
+    }
+    return Layouts;
+}
+
+struct CoalescingReport
+{
+    uint32_t    NumUniformBuffersBefore = 0;
+    uint32_t    NumUniformBuffersAfter  = 0;
+    std::string Error;
+};
+
+// Replaces the uniform buffers of every group with a single uniform buffer whose block
+// contains the original cbuffer blocks as members, at the offsets of the group layout:
+//
+//   cbuffer cbCamera {...}              struct PerFrame
+//   cbuffer cbLights {...}      ->      {
+//                                           cbCamera cbCamera; // Offset 0
+//                                           cbLights cbLights; // Offset 80
+//                                       };
+//
+// Nesting keeps every member at its original offset within its cbuffer, so host code can
+// keep writing each cbuffer with its own struct, just at the cbuffer offset in the merged
+// buffer. Access chains into a merged cbuffer get the cbuffer index as a new first index.
+// A group is merged even if the stage only uses one of its cbuffers: the binding and the
+// layout must be the same in all stages.
+class UniformBufferCoalescingPass final : public spvtools::opt::Pass
+{
+public:
+    UniformBufferCoalescingPass(const std::vector<UniformGroupLayout>& Layouts, CoalescingReport* pReport) :
+        m_Layouts{Layouts},
+        m_pReport{pReport}
+    {}
+
+    const char* name() const override
+    {
+        return "coalesce-uniform-buffers";
+    }
+
+    Status Process() override
+    {
+        std::unordered_map<std::string, spvtools::opt::Instruction*> UniformBuffers;
+        for (auto& Instruction : get_module()->types_values())
+        {
+            if (GetUniformBlockId(*context(), Instruction) != 0)
+                UniformBuffers.emplace(GetUniformBufferName(*context(), Instruction), &Instruction);
+        }
+        m_pReport->NumUniformBuffersBefore = static_cast<uint32_t>(UniformBuffers.size());
+
+        std::vector<std::vector<std::pair<uint32_t, spvtools::opt::Instruction*>>> GroupBuffers; // Buffer index in the layout, variable
+        std::set<const spvtools::opt::Instruction*>                                MergedVariables;
+        for (const auto& Layout : m_Layouts)
+        {
+            auto& Buffers = GroupBuffers.emplace_back();
+            for (uint32_t BufferIdx = 0; BufferIdx < Layout.Buffers.size(); ++BufferIdx)
+            {
+                auto It = UniformBuffers.find(Layout.Buffers[BufferIdx].Buffer.Name);
+                if (It == UniformBuffers.end())
+                    continue;
+                Buffers.emplace_back(BufferIdx, It->second);
+                MergedVariables.insert(It->second);
+            }
+        }
+
+        // The bindings of the merged buffers must not be taken by resources that stay
+        std::set<std::pair<uint32_t, uint32_t>> UsedBindings;
+        for (auto& Instruction : get_module()->types_values())
+        {
+            if (Instruction.opcode() == spv::Op::OpVariable && IsResourceStorageClass(Instruction.GetSingleWordInOperand(0)) && MergedVariables.count(&Instruction) == 0)
+                UsedBindings.insert(GetBinding(Instruction.result_id()));
+        }
+
+        uint32_t NumMerged = 0;
+        uint32_t NumAdded  = 0;
+        for (size_t LayoutIdx = 0; LayoutIdx < m_Layouts.size(); ++LayoutIdx)
+        {
+            const auto& Layout = m_Layouts[LayoutIdx];
+            if (GroupBuffers[LayoutIdx].empty())
+                continue;
+
+            if (!UsedBindings.insert({Layout.Set, Layout.Binding}).second)
+                return Fail(ConcatenateArgs("Binding ", Layout.Binding, " in set ", Layout.Set, " of group '", Layout.Name, "' is already used"));
+
+            MergeBuffers(Layout, GroupBuffers[LayoutIdx]);
+            NumMerged += static_cast<uint32_t>(GroupBuffers[LayoutIdx].size());
+            ++NumAdded;
+        }
+        m_pReport->NumUniformBuffersAfter = m_pReport->NumUniformBuffersBefore - NumMerged + NumAdded;
+
+        return NumAdded != 0 ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+    }
+
+private:
+    Status Fail(std::string Error)
+    {
+        m_pReport->Error = std::move(Error);
+        return Status::Failure;
+    }
+
+    // (set, binding) of a resource variable
+    std::pair<uint32_t, uint32_t> GetBinding(uint32_t VariableId)
+    {
+        std::pair<uint32_t, uint32_t> Binding{0, 0};
+        for (const auto* pDecoration : get_decoration_mgr()->GetDecorationsFor(VariableId, false))
+        {
+            if (pDecoration->opcode() != spv::Op::OpDecorate || pDecoration->NumInOperands() < 3)
+                continue;
+
+            const auto Decoration = static_cast<spv::Decoration>(pDecoration->GetSingleWordInOperand(1));
+            if (Decoration == spv::Decoration::DescriptorSet)
+                Binding.first = pDecoration->GetSingleWordInOperand(2);
+            else if (Decoration == spv::Decoration::Binding)
+                Binding.second = pDecoration->GetSingleWordInOperand(2);
+        }
+        return Binding;
+    }
+
+    uint32_t AddType(spv::Op Opcode, const spvtools::opt::Instruction::OperandList& Operands)
+    {
+        const uint32_t ResultId = context()->TakeNextId();
+
+        auto pType = std::make_unique<spvtools::opt::Instruction>(context(), Opcode, 0, ResultId, Operands);
+        get_def_use_mgr()->AnalyzeInstDefUse(pType.get());
+        get_module()->AddType(std::move(pType));
+        return ResultId;
+    }
+
+    void AddName(uint32_t Id, const std::string& Name)
+    {
+        context()->AddDebug2Inst(std::make_unique<spvtools::opt::Instruction>(
+            context(), spv::Op::OpName, 0, 0,
+            spvtools::opt::Instruction::OperandList{
+                {SPV_OPERAND_TYPE_ID, {Id}},
+                {SPV_OPERAND_TYPE_LITERAL_STRING, spvtools::utils::MakeVector(Name)},
+            }));
+    }
+
+    void AddMemberName(uint32_t StructId, uint32_t MemberIdx, const std::string& Name)
+    {
+        context()->AddDebug2Inst(std::make_unique<spvtools::opt::Instruction>(
+            context(), spv::Op::OpMemberName, 0, 0,
+            spvtools::opt::Instruction::OperandList{
+                {SPV_OPERAND_TYPE_ID, {StructId}},
+                {SPV_OPERAND_TYPE_LITERAL_INTEGER, {MemberIdx}},
+                {SPV_OPERAND_TYPE_LITERAL_STRING, spvtools::utils::MakeVector(Name)},
+            }));
+    }
+
+    void MergeBuffers(const UniformGroupLayout& Layout, const std::vector<std::pair<uint32_t, spvtools::opt::Instruction*>>& Buffers)
+    {
+        // Member index constants are created first: new types are appended after them
+        std::vector<uint32_t> MemberIndexIds;
+        for (uint32_t MemberIdx = 0; MemberIdx < Buffers.size(); ++MemberIdx)
+            MemberIndexIds.push_back(context()->get_constant_mgr()->GetUIntConstId(MemberIdx));
+
+        spvtools::opt::Instruction::OperandList MemberTypes;
+        for (const auto& [BufferIdx, pVariable] : Buffers)
+            MemberTypes.push_back({SPV_OPERAND_TYPE_ID, {GetUniformBlockId(*context(), *pVariable)}});
+
+        const uint32_t StructId      = AddType(spv::Op::OpTypeStruct, MemberTypes);
+        const uint32_t PointerTypeId = AddType(spv::Op::OpTypePointer, {{SPV_OPERAND_TYPE_STORAGE_CLASS, {static_cast<uint32_t>(spv::StorageClass::Uniform)}}, {SPV_OPERAND_TYPE_ID, {StructId}}});
+
+        const uint32_t VariableId = context()->TakeNextId();
+        auto           pVariable  = std::make_unique<spvtools::opt::Instruction>(context(), spv::Op::OpVariable, PointerTypeId, VariableId,
+                                                                      spvtools::opt::Instruction::OperandList{{SPV_OPERAND_TYPE_STORAGE_CLASS, {static_cast<uint32_t>(spv::StorageClass::Uniform)}}});
+        get_def_use_mgr()->AnalyzeInstDefUse(pVariable.get());
+        get_module()->AddGlobalValue(std::move(pVariable));
+
+        AddName(StructId, Layout.Name);
+        AddName(VariableId, "g_" + Layout.Name);
+        get_decoration_mgr()->AddDecoration(StructId, static_cast<uint32_t>(spv::Decoration::Block));
+        get_decoration_mgr()->AddDecorationVal(VariableId, static_cast<uint32_t>(spv::Decoration::DescriptorSet), Layout.Set);
+        get_decoration_mgr()->AddDecorationVal(VariableId, static_cast<uint32_t>(spv::Decoration::Binding), Layout.Binding);
+
+        for (uint32_t MemberIdx = 0; MemberIdx < Buffers.size(); ++MemberIdx)
+        {
+            const auto& [BufferIdx, pOldVariable] = Buffers[MemberIdx];
+            const auto& Placement                 = Layout.Buffers[BufferIdx];
+            const auto  BlockId                   = GetUniformBlockId(*context(), *pOldVariable);
+
+            AddMemberName(StructId, MemberIdx, Placement.Buffer.Name);
+            get_decoration_mgr()->AddDecoration(spv::Op::OpMemberDecorate,
+                                                {
+                                                    {SPV_OPERAND_TYPE_ID, {StructId}},
+                                                    {SPV_OPERAND_TYPE_LITERAL_INTEGER, {MemberIdx}},
+                                                    {SPV_OPERAND_TYPE_DECORATION, {static_cast<uint32_t>(spv::Decoration::Offset)}},
+                                                    {SPV_OPERAND_TYPE_LITERAL_INTEGER, {Placement.Offset}},
+                                                });
+
+            // A Block struct cannot be nested in another block
+            get_decoration_mgr()->RemoveDecorationsFrom(BlockId, [](const spvtools::opt::Instruction& Decoration) {
+                return Decoration.opcode() == spv::Op::OpDecorate && static_cast<spv::Decoration>(Decoration.GetSingleWordInOperand(1)) == spv::Decoration::Block;
+            });
+
+            RedirectUses(pOldVariable, VariableId, MemberIndexIds[MemberIdx]);
+        }
+
+        // SPIR-V 1.4+ lists all global variables in the entry point interfaces
+        for (auto& EntryPoint : get_module()->entry_points())
+        {
+            bool IsRemoved = false;
+            for (uint32_t OperandIdx = EntryPoint.NumInOperands(); OperandIdx > 3; --OperandIdx)
+            {
+                const uint32_t Id = EntryPoint.GetSingleWordInOperand(OperandIdx - 1);
+                for (const auto& Buffer : Buffers)
+                {
+                    if (Buffer.second->result_id() == Id)
+                    {
+                        EntryPoint.RemoveInOperand(OperandIdx - 1);
+                        IsRemoved = true;
+                        break;
+                    }
+                }
+            }
+            if (IsRemoved)
+                EntryPoint.AddOperand({SPV_OPERAND_TYPE_ID, {VariableId}});
+            get_def_use_mgr()->AnalyzeInstUse(&EntryPoint);
+        }
+
+        for (const auto& Buffer : Buffers)
+        {
+            context()->KillNamesAndDecorates(Buffer.second);
+            context()->KillInst(Buffer.second);
+        }
+    }
+
+    // Rebases every use of the old cbuffer variable on the merged one
+    void RedirectUses(spvtools::opt::Instruction* pOldVariable, uint32_t NewVariableId, uint32_t MemberIndexId)
+    {
+        const uint32_t OldVariableId = pOldVariable->result_id();
+
+        std::vector<spvtools::opt::Instruction*> Users;
+        get_def_use_mgr()->ForEachUser(pOldVariable, [&](spvtools::opt::Instruction* pUser) {
+            if (!spvtools::opt::IsAnnotationInst(pUser->opcode()) && !spvtools::opt::IsDebug2Inst(pUser->opcode()) && pUser->opcode() != spv::Op::OpEntryPoint)
+                Users.push_back(pUser);
+        });
+
+        for (auto* pUser : Users)
+        {
+            const bool IsAccessChain = pUser->opcode() == spv::Op::OpAccessChain || pUser->opcode() == spv::Op::OpInBoundsAccessChain;
+            if (IsAccessChain && pUser->GetSingleWordInOperand(0) == OldVariableId)
+            {
+                spvtools::opt::Instruction::OperandList Operands{{SPV_OPERAND_TYPE_ID, {NewVariableId}}, {SPV_OPERAND_TYPE_ID, {MemberIndexId}}};
+                for (uint32_t OperandIdx = 1; OperandIdx < pUser->NumInOperands(); ++OperandIdx)
+                    Operands.push_back(pUser->GetInOperand(OperandIdx));
+                pUser->SetInOperands(std::move(Operands));
+            }
+            else
+            {
+                // E.g. a load of the whole cbuffer: point to the nested block instead
+                spvtools::opt::InstructionBuilder Builder{context(), pUser, spvtools::opt::IRContext::kAnalysisDefUse | spvtools::opt::IRContext::kAnalysisInstrToBlockMapping};
+                const uint32_t                    BlockPointerId = Builder.AddAccessChain(pOldVariable->type_id(), NewVariableId, {MemberIndexId})->result_id();
+                pUser->ForEachInId([&](uint32_t* pId) {
+                    if (*pId == OldVariableId)
+                        *pId = BlockPointerId;
+                });
+            }
+            get_def_use_mgr()->AnalyzeInstUse(pUser);
+        }
+    }
+
+private:
+    const std::vector<UniformGroupLayout>& m_Layouts;
+    CoalescingReport* const                m_pReport;
+};
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+
+    return OptimizedSPIRV;
+}
+
+std::vector<UniformBufferInfo> ReflectUniformBuffers(const std::vector<uint32_t>& SPIRV, spv_target_env TargetEnv)
+{
+    auto Context = spvtools::BuildModule(TargetEnv, {}, SPIRV.data(), SPIRV.size());
+    if (!Context)
+        LOG_ERROR_AND_THROW("Failed to parse SPIR-V binary");
+
+    return UniformBufferReflection{*Context}.GetUniformBuffers();
+}
+
+std::vector<uint32_t> CoalesceUniformBuffers(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv, const std::vector<UniformGroupLayout>& Layouts, CoalescingReport& Report)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterPass(spvtools::Optimizer::PassToken{std::make_unique<UniformBufferCoalescingPass>(Layouts, &Report)});
+
+    std::vector<uint32_t> SPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &SPIRV))
+        LOG_ERROR_AND_THROW("Failed to coalesce uniform buffers: ", Report.Error);
+
+    spvtools::SpirvTools Tools{TargetEnv};
+    if (!Tools.Validate(SPIRV))
+        LOG_ERROR_AND_THROW("SPIR-V with coalesced uniform buffers is invalid.");
+
+    return SPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL, EShLanguage Stage)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{Stage};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setEnvTargetHlslFunctionality1();
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    if (!Shader.parse(&Resources, 100, false, EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to parse HLSL: \n", Shader.getInfoLog());
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    return SPIRV;
+}
+
+std::string ConvertSPIRVtoWGSL(const std::vector<uint32_t>& SPIRV)
+{
+    TintInitializer InitScope{};
+
+    std::string WGSL;
+    auto        Module = tint::spirv::reader::ReadIR(SPIRV);
+
+    if (Module != tint::Success)
+        LOG_ERROR_AND_THROW("Tint SPIR-V reader failure:\nParser: ", Module.Failure(), "\n");
+
+    tint::wgsl::writer::Options Options;
+    Options.allow_non_uniform_derivatives = true;
+    Options.allowed_features              = tint::wgsl::AllowedFeatures::Everything();
+
+    auto Program = tint::wgsl::writer::WgslFromIR(Module.Get(), Options);
+
+    if (Program != tint::Success)
+        LOG_ERROR_AND_THROW("Tint WGSL writer failure:\nGenerate: ", Program.Failure().reason, "\n");
+    WGSL = std::move(Program.Get().wgsl);
+    return WGSL;
+}
+
+// Host-side description of the merged buffers. Every cbuffer keeps its own layout, so it can
+// be written as a whole at its offset.
+std::string EmitHostLayouts(const std::vector<UniformGroupLayout>& Layouts)
+{
+    std::ostringstream Stream;
+    Stream << "struct UniformRangeDesc\n{\n    const char* Name;\n    uint32_t    Offset;\n    uint32_t    Size;\n};\n";
+    for (const auto& Layout : Layouts)
+    {
+        Stream << "\nstruct " << Layout.Name << "Layout\n{\n";
+        Stream << "    static constexpr uint32_t Set     = " << Layout.Set << ";\n";
+        Stream << "    static constexpr uint32_t Binding = " << Layout.Binding << ";\n";
+        Stream << "    static constexpr uint32_t Size    = " << Layout.Size << ";\n\n";
+        Stream << "    static constexpr UniformRangeDesc Buffers[] = {\n";
+        for (const auto& Placed : Layout.Buffers)
+            Stream << "        {\"" << Placed.Buffer.Name << "\", " << Placed.Offset << ", " << Placed.Buffer.Size << "},\n";
+        Stream << "    };\n\n";
+        Stream << "    static constexpr UniformRangeDesc Members[] = {\n";
+        for (const auto& Placed : Layout.Buffers)
+        {
+            for (const auto& Member : Placed.Buffer.Members)
+                Stream << "        {\"" << Placed.Buffer.Name << "." << Member.Name << "\", " << Placed.Offset + Member.Offset << ", " << Member.Size << "},\n";
+        }
+        Stream << "    };\n};\n";
+    }
+    return Stream.str();
+}
+
+struct ShaderStageDesc
+{
+    const char*        Name;
+    EShLanguage        Stage;
+    const std::string* pHLSL;
+};
+
+struct PipelineDesc
+{
+    const char*                  Name;
+    std::vector<ShaderStageDesc> Stages;
+    std::vector<UniformGroup>    Groups;
+};
+
+// Usage: UniformBufferCoalescing [--baseline]
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        // Pass --baseline to print the WGSL of the original cbuffers too
+        const bool PrintBaseline = argc > 1 && std::string{argv[1]} == "--baseline";
+
+        const std::vector<PipelineDesc> Pipelines = {
+            {
+                "ConstantBufferNameCollision",
+                {{"TestVS", EShLangVertex, &HLSL::TestVS}},
+                {{"PerDraw", 1, 0, {"Params", "Params_1"}}},
+            },
+            {
+                "Material",
+                {{"MaterialVS", EShLangVertex, &HLSL::MaterialVS}, {"MaterialPS", EShLangFragment, &HLSL::MaterialPS}},
+                {
+                    {"PerFrame", 1, 0, {"cbCamera", "cbLights"}},
+                    {"PerMaterial", 2, 0, {"cbMaterial", "cbMaterialExtra"}},
+                    {"PerObject", 3, 0, {"cbObject"}},
+                },
+            },
+        };
+
+        for (const auto& Pipeline : Pipelines)
+        {
+            std::cout << "==== Pipeline " << Pipeline.Name << " ====\n";
+
+            // Layouts are reflected before optimization, so a cbuffer a stage declares but does
+            // not use still gets its range
+            std::vector<std::vector<uint32_t>>          StageSPIRV;
+            std::vector<std::vector<UniformBufferInfo>> StageBuffers;
+            for (const auto& Stage : Pipeline.Stages)
+            {
+                const auto SPIRV = ConvertHLSLtoSPIRV(*Stage.pHLSL, Stage.Stage);
+                StageBuffers.emplace_back(ReflectUniformBuffers(SPIRV, SPV_ENV_VULKAN_1_0));
+                StageSPIRV.emplace_back(OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0));
+            }
+
+            // One layout for the whole pipeline
+            const auto Layouts = ComputeGroupLayouts(Pipeline.Groups, StageBuffers);
+
+            for (size_t StageIdx = 0; StageIdx < Pipeline.Stages.size(); ++StageIdx)
+            {
+                CoalescingReport Report;
+                const auto       SPIRV = CoalesceUniformBuffers(StageSPIRV[StageIdx], SPV_ENV_VULKAN_1_0, Layouts, Report);
+
+                std::cout << "---- " << Pipeline.Stages[StageIdx].Name << ": " << Report.NumUniformBuffersBefore << " -> "
+                          << Report.NumUniformBuffersAfter << " uniform buffers ----\n";
+                if (PrintBaseline)
+                    std::cout << ConvertSPIRVtoWGSL(StageSPIRV[StageIdx]) << "\n---- Coalesced ----\n";
+                std::cout << ConvertSPIRVtoWGSL(SPIRV) << "\n";
+            }
+
+            std::cout << EmitHostLayouts(Layouts) << "\n";
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}
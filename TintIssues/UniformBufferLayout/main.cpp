@@ -0,0 +1,748 @@
+#define ENABLE_HLSL
+
+#include <iostream>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+#include <regex>
+
+#include <tint/tint.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include <SPIRV/GlslangToSpv.h>
+
+#include <spirv-tools/optimizer.hpp>
+#include <spirv-tools/libspirv.hpp>
+
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+
+struct TintInitializer
+{
+    TintInitializer()
+    {
+        tint::Initialize();
+    }
+    ~TintInitializer()
+    {
+        tint::Shutdown();
+    }
+};
+
+struct GlslangInitilizer
+{
+
+    GlslangInitilizer()
+    {
+        glslang::InitializeProcess();
+    }
+    ~GlslangInitilizer()
+    {
+        glslang::FinalizeProcess();
+    }
+};
+
+template <typename... Args>
+std::string ConcatenateArgs(Args... args)
+{
+    std::ostringstream OutputStream;
+    (OutputStream << ... << args); // Fold expression to concatenate all arguments
+    return OutputStream.str();
+}
+
+#define LOG_ERROR_AND_THROW(...)                                        \
+    do                                                                  \
+    {                                                                   \
+        std::string Message = ConcatenateArgs(__VA_ARGS__);             \
+        std::cerr << "Error: " << Message << " (in " << __FILE__ << ":" \
+                  << __LINE__ << ", function " << __func__ << ")"       \
+                  << std::endl;                                         \
+        throw std::runtime_error(Message);                              \
+    } while (false)
+
+namespace HLSL
+{
+
+const std::string TestVS = R"(
+struct Inner
+{
+    float2x4 Transform;     // 2x4 matrix -> requires a padded layout struct in a uniform buffer
+    float4   Offset;
+};
+
+cbuffer Params      // source name: "Params"
+{
+    Inner    g_Data;
+    float4x4 g_WorldViewProj;
+}
+
+cbuffer Params_1    // source name: literally "Params_1"
+{
+    float4 g_Color;
+}
+
+cbuffer Material
+{
+    float    g_Roughness;
+    float3   g_Albedo;
+    float    g_Metallic;
+    float2   g_UVScale;
+    float    g_Opacity;
+    float3   g_Emissive;
+    float2   g_UVOffset;
+}
+
+void main(out float4 Pos : SV_POSITION)
+{
+    Pos = mul(g_WorldViewProj, g_Data.Offset) + g_Color;
+    Pos.xyz += g_Albedo * g_Roughness + g_Emissive * g_Metallic;
+    Pos.xy  += g_UVScale * g_UVOffset * g_Opacity;
+}
+)";
+;
+} // namespace HLSL
+
+// Size and alignment of a type under a particular set of layout rules.
+// Payload is the number of bytes that actually carry data.
+struct TypeLayout
+{
+    uint32_t Size    = 0;
+    uint32_t Align   = 1;
+    uint32_t Payload = 0;
+};
+
+struct UniformMemberLayout
+{
+    std::string Name;
+    std::string TypeName;
+    uint32_t    TypeId   = 0;
+    bool        RowMajor = false;
+
+    uint32_t SPIRVOffset = 0; // Offset emitted by glslang
+    uint32_t HLSLOffset  = 0; // HLSL cbuffer packing rules
+    uint32_t WGSLOffset  = 0; // WGSL uniform address space rules
+    uint32_t SPIRVSize   = 0;
+    uint32_t HLSLSize    = 0;
+    uint32_t WGSLSize    = 0;
+    uint32_t WGSLAlign   = 0;
+    uint32_t Payload     = 0;
+};
+
+struct UniformBufferLayout
+{
+    std::string                      Name;
+    uint32_t                         StructId = 0;
+    std::vector<UniformMemberLayout> Members;
+
+    uint32_t SPIRVSize = 0;
+    uint32_t HLSLSize  = 0;
+    uint32_t WGSLSize  = 0;
+    uint32_t Payload   = 0;
+};
+
+constexpr uint32_t AlignUp(uint32_t Value, uint32_t Alignment)
+{
+    return (Value + Alignment - 1) / Alignment * Alignment;
+}
+
+// Computes HLSL cbuffer and WGSL uniform layouts of all uniform buffers in a SPIR-V module.
+//
+// Matrices are described by the vectors they are stored as: a matrix decorated RowMajor
+// is stored as R vectors of C components, otherwise as C vectors of R components. Note that
+// glslang swaps rows and columns of HLSL matrices, so HLSL float2x4 becomes a SPIR-V matrix
+// of two vec4 columns that is decorated RowMajor (HLSL column_major).
+class UniformLayoutAnalyzer
+{
+public:
+    explicit UniformLayoutAnalyzer(spvtools::opt::IRContext& Context) :
+        m_Context{Context}
+    {
+        for (auto& Instruction : Context.module()->debugs2())
+        {
+            if (Instruction.opcode() == spv::Op::OpName)
+                m_Names[Instruction.GetSingleWordInOperand(0)] = Instruction.GetInOperand(1).AsString();
+            else if (Instruction.opcode() == spv::Op::OpMemberName)
+                m_MemberNames[{Instruction.GetSingleWordInOperand(0), Instruction.GetSingleWordInOperand(1)}] = Instruction.GetInOperand(2).AsString();
+        }
+
+        for (auto& Instruction : Context.module()->annotations())
+        {
+            if (Instruction.opcode() == spv::Op::OpDecorate)
+            {
+                const auto Decoration = static_cast<spv::Decoration>(Instruction.GetSingleWordInOperand(1));
+                const auto Value      = Instruction.NumInOperands() > 2 ? Instruction.GetSingleWordInOperand(2) : 1u;
+                m_Decorations[{Instruction.GetSingleWordInOperand(0), Decoration}] = Value;
+            }
+            else if (Instruction.opcode() == spv::Op::OpMemberDecorate)
+            {
+                const auto Decoration = static_cast<spv::Decoration>(Instruction.GetSingleWordInOperand(2));
+                const auto Value      = Instruction.NumInOperands() > 3 ? Instruction.GetSingleWordInOperand(3) : 1u;
+                m_MemberDecorations[{Instruction.GetSingleWordInOperand(0), Instruction.GetSingleWordInOperand(1), Decoration}] = Value;
+            }
+        }
+    }
+
+    std::vector<UniformBufferLayout> Analyze() const
+    {
+        std::vector<UniformBufferLayout> Buffers;
+        for (auto& Instruction : m_Context.module()->types_values())
+        {
+            if (Instruction.opcode() != spv::Op::OpVariable || static_cast<spv::StorageClass>(Instruction.GetSingleWordInOperand(0)) != spv::StorageClass::Uniform)
+                continue;
+
+            const auto* pPointerType = GetDef(Instruction.type_id());
+            const auto  StructId     = pPointerType->GetSingleWordInOperand(1);
+            if (GetDef(StructId)->opcode() != spv::Op::OpTypeStruct || !HasDecoration(StructId, spv::Decoration::Block))
+                continue;
+
+            UniformBufferLayout Buffer;
+            Buffer.Name     = GetName(StructId);
+            Buffer.StructId = StructId;
+            Buffer.Members  = GetMembers(StructId);
+            ComputeLayouts(Buffer);
+            Buffers.emplace_back(std::move(Buffer));
+        }
+        return Buffers;
+    }
+
+    // Lays out the members in their current order and updates all offsets and sizes
+    void ComputeLayouts(UniformBufferLayout& Buffer) const
+    {
+        uint32_t HLSLOffset = 0;
+        uint32_t WGSLOffset = 0;
+        uint32_t WGSLAlign  = 16;
+
+        Buffer.SPIRVSize = 0;
+        Buffer.Payload   = 0;
+        for (auto& Member : Buffer.Members)
+        {
+            const auto HLSL = GetHLSLLayout(Member.TypeId, Member.RowMajor);
+            const auto WGSL = GetWGSLLayout(Member.TypeId, Member.RowMajor);
+
+            Member.HLSLOffset = PlaceHLSLMember(HLSLOffset, Member.TypeId, HLSL.Size);
+            Member.HLSLSize   = HLSL.Size;
+            Member.SPIRVSize  = GetDecoratedSize(Member.TypeId, Member.RowMajor);
+            Member.WGSLOffset = AlignUp(WGSLOffset, WGSL.Align);
+            Member.WGSLSize   = WGSL.Size;
+            Member.WGSLAlign  = WGSL.Align;
+            Member.Payload    = HLSL.Payload;
+
+            HLSLOffset = Member.HLSLOffset + HLSL.Size;
+            if (GetDef(Member.TypeId)->opcode() == spv::Op::OpTypeStruct)
+                HLSLOffset = AlignUp(HLSLOffset, 16); // Structs force the next member to a new register
+            WGSLOffset = Member.WGSLOffset + WGSL.Size;
+            WGSLAlign  = std::max(WGSLAlign, WGSL.Align);
+
+            Buffer.SPIRVSize = std::max(Buffer.SPIRVSize, Member.SPIRVOffset + Member.SPIRVSize);
+            Buffer.Payload += HLSL.Payload;
+        }
+        Buffer.SPIRVSize = AlignUp(Buffer.SPIRVSize, 16);
+        Buffer.HLSLSize  = AlignUp(HLSLOffset, 16);
+        Buffer.WGSLSize  = AlignUp(WGSLOffset, WGSLAlign);
+    }
+
+private:
+    using MemberKey           = std::pair<uint32_t, uint32_t>;
+    using DecorationKey       = std::pair<uint32_t, spv::Decoration>;
+    using MemberDecorationKey = std::tuple<uint32_t, uint32_t, spv::Decoration>;
+
+    const spvtools::opt::Instruction* GetDef(uint32_t Id) const
+    {
+        return m_Context.get_def_use_mgr()->GetDef(Id);
+    }
+
+    std::string GetName(uint32_t Id) const
+    {
+        auto It = m_Names.find(Id);
+        return It != m_Names.end() ? It->second : ConcatenateArgs("_", Id);
+    }
+
+    bool HasDecoration(uint32_t Id, spv::Decoration Decoration) const
+    {
+        return m_Decorations.find({Id, Decoration}) != m_Decorations.end();
+    }
+
+    uint32_t GetDecoration(uint32_t Id, spv::Decoration Decoration, uint32_t DefaultValue = 0) const
+    {
+        auto It = m_Decorations.find({Id, Decoration});
+        return It != m_Decorations.end() ? It->second : DefaultValue;
+    }
+
+    uint32_t GetMemberDecoration(uint32_t StructId, uint32_t MemberIdx, spv::Decoration Decoration, uint32_t DefaultValue = 0) const
+    {
+        auto It = m_MemberDecorations.find({StructId, MemberIdx, Decoration});
+        return It != m_MemberDecorations.end() ? It->second : DefaultValue;
+    }
+
+    std::vector<UniformMemberLayout> GetMembers(uint32_t StructId) const
+    {
+        const auto* pStruct = GetDef(StructId);
+
+        std::vector<UniformMemberLayout> Members;
+        for (uint32_t MemberIdx = 0; MemberIdx < pStruct->NumInOperands(); ++MemberIdx)
+        {
+            UniformMemberLayout Member;
+            Member.TypeId      = pStruct->GetSingleWordInOperand(MemberIdx);
+            Member.RowMajor    = GetMemberDecoration(StructId, MemberIdx, spv::Decoration::RowMajor) != 0;
+            Member.SPIRVOffset = GetMemberDecoration(StructId, MemberIdx, spv::Decoration::Offset);
+            Member.TypeName    = GetHLSLTypeName(Member.TypeId);
+
+            auto NameIt = m_MemberNames.find({StructId, MemberIdx});
+            Member.Name = NameIt != m_MemberNames.end() ? NameIt->second : ConcatenateArgs("member", MemberIdx);
+            Members.emplace_back(std::move(Member));
+        }
+        return Members;
+    }
+
+    uint32_t GetArrayLength(const spvtools::opt::Instruction* pArrayType) const
+    {
+        const auto* pLength = GetDef(pArrayType->GetSingleWordInOperand(1));
+        return pLength->opcode() == spv::Op::OpConstant ? pLength->GetSingleWordInOperand(0) : 1;
+    }
+
+    // Stored vector count and component count of a matrix
+    std::pair<uint32_t, uint32_t> GetMatrixVectors(const spvtools::opt::Instruction* pMatrixType, bool RowMajor) const
+    {
+        const uint32_t Columns = pMatrixType->GetSingleWordInOperand(1);
+        const uint32_t Rows    = GetDef(pMatrixType->GetSingleWordInOperand(0))->GetSingleWordInOperand(1);
+        return RowMajor ? std::make_pair(Rows, Columns) : std::make_pair(Columns, Rows);
+    }
+
+    uint32_t GetScalarSize(uint32_t TypeId) const
+    {
+        const auto* pType = GetDef(TypeId);
+        while (pType->opcode() == spv::Op::OpTypeVector || pType->opcode() == spv::Op::OpTypeMatrix)
+            pType = GetDef(pType->GetSingleWordInOperand(0));
+        return pType->opcode() == spv::Op::OpTypeBool ? 4 : pType->GetSingleWordInOperand(0) / 8;
+    }
+
+    std::string GetHLSLTypeName(uint32_t TypeId) const
+    {
+        const auto* pType = GetDef(TypeId);
+        switch (pType->opcode())
+        {
+            case spv::Op::OpTypeBool: return "bool";
+            case spv::Op::OpTypeFloat: return pType->GetSingleWordInOperand(0) == 16 ? "half" : (pType->GetSingleWordInOperand(0) == 64 ? "double" : "float");
+            case spv::Op::OpTypeInt: return pType->GetSingleWordInOperand(1) != 0 ? "int" : "uint";
+            case spv::Op::OpTypeVector: return ConcatenateArgs(GetHLSLTypeName(pType->GetSingleWordInOperand(0)), pType->GetSingleWordInOperand(1));
+            case spv::Op::OpTypeMatrix:
+            {
+                // SPIR-V columns are HLSL rows
+                const auto* pColumnType = GetDef(pType->GetSingleWordInOperand(0));
+                return ConcatenateArgs(GetHLSLTypeName(pColumnType->GetSingleWordInOperand(0)), pType->GetSingleWordInOperand(1), "x", pColumnType->GetSingleWordInOperand(1));
+            }
+            case spv::Op::OpTypeArray: return ConcatenateArgs(GetHLSLTypeName(pType->GetSingleWordInOperand(0)), "[", GetArrayLength(pType), "]");
+            case spv::Op::OpTypeStruct: return GetName(TypeId);
+            default: return "<unknown>";
+        }
+    }
+
+    TypeLayout GetHLSLLayout(uint32_t TypeId, bool RowMajor) const
+    {
+        const auto* pType = GetDef(TypeId);
+        switch (pType->opcode())
+        {
+            case spv::Op::OpTypeBool:
+            case spv::Op::OpTypeInt:
+            case spv::Op::OpTypeFloat:
+            {
+                const uint32_t Size = GetScalarSize(TypeId);
+                return {Size, Size, Size};
+            }
+
+            case spv::Op::OpTypeVector:
+            {
+                const uint32_t Size = GetScalarSize(TypeId) * pType->GetSingleWordInOperand(1);
+                return {Size, GetScalarSize(TypeId), Size};
+            }
+
+            case spv::Op::OpTypeMatrix:
+            {
+                // Every stored vector starts a new register
+                const auto [VectorCount, ComponentCount] = GetMatrixVectors(pType, RowMajor);
+                const uint32_t VectorSize                = GetScalarSize(TypeId) * ComponentCount;
+                return {(VectorCount - 1) * 16 + VectorSize, 16, VectorCount * VectorSize};
+            }
+
+            case spv::Op::OpTypeArray:
+            {
+                // Every element starts a new register; the last one may share it with the next member
+                const auto     Element = GetHLSLLayout(pType->GetSingleWordInOperand(0), RowMajor);
+                const uint32_t Length  = GetArrayLength(pType);
+                return {(Length - 1) * AlignUp(Element.Size, 16) + Element.Size, 16, Length * Element.Payload};
+            }
+
+            case spv::Op::OpTypeStruct:
+            {
+                uint32_t Offset  = 0;
+                uint32_t Payload = 0;
+                for (uint32_t MemberIdx = 0; MemberIdx < pType->NumInOperands(); ++MemberIdx)
+                {
+                    const uint32_t MemberTypeId = pType->GetSingleWordInOperand(MemberIdx);
+                    const bool     IsRowMajor   = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::RowMajor) != 0;
+                    const auto     Member       = GetHLSLLayout(MemberTypeId, IsRowMajor);
+
+                    Offset = PlaceHLSLMember(Offset, MemberTypeId, Member.Size) + Member.Size;
+                    if (GetDef(MemberTypeId)->opcode() == spv::Op::OpTypeStruct)
+                        Offset = AlignUp(Offset, 16);
+                    Payload += Member.Payload;
+                }
+                return {Offset, 16, Payload};
+            }
+
+            default:
+                LOG_ERROR_AND_THROW("Unexpected type in uniform buffer: ", TypeId);
+        }
+    }
+
+    // Returns the HLSL offset of a member placed after the given offset
+    uint32_t PlaceHLSLMember(uint32_t Offset, uint32_t TypeId, uint32_t Size) const
+    {
+        const auto Opcode = GetDef(TypeId)->opcode();
+        if (Opcode == spv::Op::OpTypeMatrix || Opcode == spv::Op::OpTypeArray || Opcode == spv::Op::OpTypeStruct)
+            return AlignUp(Offset, 16);
+
+        // Scalars and vectors are packed, but may not straddle a 16-byte register
+        Offset = AlignUp(Offset, GetScalarSize(TypeId));
+        if (Offset / 16 != (Offset + Size - 1) / 16)
+            Offset = AlignUp(Offset, 16);
+        return Offset;
+    }
+
+    TypeLayout GetWGSLLayout(uint32_t TypeId, bool RowMajor) const
+    {
+        const auto* pType = GetDef(TypeId);
+        switch (pType->opcode())
+        {
+            case spv::Op::OpTypeBool:
+            case spv::Op::OpTypeInt:
+            case spv::Op::OpTypeFloat:
+            {
+                const uint32_t Size = GetScalarSize(TypeId);
+                return {Size, Size, Size};
+            }
+
+            case spv::Op::OpTypeVector:
+            {
+                const uint32_t ComponentCount = pType->GetSingleWordInOperand(1);
+                const uint32_t ScalarSize     = GetScalarSize(TypeId);
+                return {ScalarSize * ComponentCount, ScalarSize * (ComponentCount == 2 ? 2 : 4), ScalarSize * ComponentCount};
+            }
+
+            case spv::Op::OpTypeMatrix:
+            {
+                // matNxM: N column vectors of M components, each padded to the vector alignment
+                const auto [VectorCount, ComponentCount] = GetMatrixVectors(pType, RowMajor);
+                const uint32_t ScalarSize                = GetScalarSize(TypeId);
+                const uint32_t VectorAlign               = ScalarSize * (ComponentCount == 2 ? 2 : 4);
+                return {VectorCount * AlignUp(ScalarSize * ComponentCount, VectorAlign), VectorAlign, VectorCount * ComponentCount * ScalarSize};
+            }
+
+            case spv::Op::OpTypeArray:
+            {
+                // Uniform address space: element stride and alignment are multiples of 16
+                const auto     Element = GetWGSLLayout(pType->GetSingleWordInOperand(0), RowMajor);
+                const uint32_t Length  = GetArrayLength(pType);
+                const uint32_t Stride  = AlignUp(AlignUp(Element.Size, Element.Align), 16);
+                return {Length * Stride, AlignUp(Element.Align, 16), Length * Element.Payload};
+            }
+
+            case spv::Op::OpTypeStruct:
+            {
+                uint32_t Offset  = 0;
+                uint32_t Align   = 16; // Uniform address space rounds struct alignment up to 16
+                uint32_t Payload = 0;
+                for (uint32_t MemberIdx = 0; MemberIdx < pType->NumInOperands(); ++MemberIdx)
+                {
+                    const bool IsRowMajor = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::RowMajor) != 0;
+                    const auto Member     = GetWGSLLayout(pType->GetSingleWordInOperand(MemberIdx), IsRowMajor);
+
+                    Offset = AlignUp(Offset, Member.Align) + Member.Size;
+                    Align  = std::max(Align, Member.Align);
+                    Payload += Member.Payload;
+                }
+                return {AlignUp(Offset, Align), Align, Payload};
+            }
+
+            default:
+                LOG_ERROR_AND_THROW("Unexpected type in uniform buffer: ", TypeId);
+        }
+    }
+
+    // Size of a type as described by the Offset/ArrayStride/MatrixStride decorations
+    uint32_t GetDecoratedSize(uint32_t TypeId, bool RowMajor, uint32_t MatrixStride = 16) const
+    {
+        const auto* pType = GetDef(TypeId);
+        switch (pType->opcode())
+        {
+            case spv::Op::OpTypeMatrix:
+            {
+                const auto [VectorCount, ComponentCount] = GetMatrixVectors(pType, RowMajor);
+                return (VectorCount - 1) * MatrixStride + ComponentCount * GetScalarSize(TypeId);
+            }
+
+            case spv::Op::OpTypeArray:
+            {
+                const uint32_t Stride = GetDecoration(TypeId, spv::Decoration::ArrayStride, 16);
+                return (GetArrayLength(pType) - 1) * Stride + GetDecoratedSize(pType->GetSingleWordInOperand(0), RowMajor, MatrixStride);
+            }
+
+            case spv::Op::OpTypeStruct:
+            {
+                uint32_t Size = 0;
+                for (uint32_t MemberIdx = 0; MemberIdx < pType->NumInOperands(); ++MemberIdx)
+                {
+                    const uint32_t Offset     = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::Offset);
+                    const uint32_t Stride     = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::MatrixStride, 16);
+                    const bool     IsRowMajor = GetMemberDecoration(TypeId, MemberIdx, spv::Decoration::RowMajor) != 0;
+                    Size                      = std::max(Size, Offset + GetDecoratedSize(pType->GetSingleWordInOperand(MemberIdx), IsRowMajor, Stride));
+                }
+                return Size;
+            }
+
+            default:
+                return GetHLSLLayout(TypeId, RowMajor).Size;
+        }
+    }
+
+private:
+    spvtools::opt::IRContext& m_Context;
+
+    std::unordered_map<uint32_t, std::string> m_Names;
+    std::map<MemberKey, std::string>          m_MemberNames;
+    std::map<DecorationKey, uint32_t>         m_Decorations;
+    std::map<MemberDecorationKey, uint32_t>   m_MemberDecorations;
+};
+
+// Tries a few member orders and returns the one with the smallest WGSL uniform size
+// (ties are broken by the HLSL size). The original order is kept unless another order
+// is strictly better.
+UniformBufferLayout RepackUniformBuffer(const UniformLayoutAnalyzer& Analyzer, const UniformBufferLayout& Buffer)
+{
+    std::vector<std::vector<UniformMemberLayout>> Candidates;
+
+    // Largest alignment first: 16-byte aligned members leave no holes
+    auto ByAlignment = Buffer.Members;
+    std::stable_sort(ByAlignment.begin(), ByAlignment.end(), [](const UniformMemberLayout& LHS, const UniformMemberLayout& RHS) {
+        return std::make_pair(LHS.WGSLAlign, LHS.WGSLSize) > std::make_pair(RHS.WGSLAlign, RHS.WGSLSize);
+    });
+    Candidates.emplace_back(std::move(ByAlignment));
+
+    // First-fit decreasing: each member that leaves a partially filled register is
+    // followed by the largest remaining member that fits into the hole.
+    std::vector<UniformMemberLayout> Remaining = Buffer.Members;
+    std::stable_sort(Remaining.begin(), Remaining.end(), [](const UniformMemberLayout& LHS, const UniformMemberLayout& RHS) { return LHS.WGSLSize > RHS.WGSLSize; });
+
+    std::vector<UniformMemberLayout> FirstFit;
+    uint32_t                         Offset = 0;
+    while (!Remaining.empty())
+    {
+        const uint32_t Hole = Offset % 16 != 0 ? 16 - Offset % 16 : 16;
+
+        auto It = std::find_if(Remaining.begin(), Remaining.end(), [&](const UniformMemberLayout& Member) { return Member.WGSLSize <= Hole; });
+        if (It == Remaining.end())
+            It = Remaining.begin();
+
+        Offset = AlignUp(Offset, It->WGSLAlign) + It->WGSLSize;
+        FirstFit.emplace_back(std::move(*It));
+        Remaining.erase(It);
+    }
+    Candidates.emplace_back(std::move(FirstFit));
+
+    UniformBufferLayout Best = Buffer;
+    for (auto& Members : Candidates)
+    {
+        UniformBufferLayout Candidate = Buffer;
+        Candidate.Members             = std::move(Members);
+        Analyzer.ComputeLayouts(Candidate);
+        if (std::make_pair(Candidate.WGSLSize, Candidate.HLSLSize) < std::make_pair(Best.WGSLSize, Best.HLSLSize))
+            Best = std::move(Candidate);
+    }
+    return Best;
+}
+
+// SPIR-V offsets are only meaningful for the layout that glslang actually emitted
+void PrintLayoutReport(const UniformBufferLayout& Buffer, bool IsEmitted)
+{
+    std::cout << "cbuffer " << Buffer.Name << ": HLSL packed " << Buffer.HLSLSize << " bytes, WGSL uniform " << Buffer.WGSLSize << " bytes, ";
+    if (IsEmitted)
+        std::cout << "emitted by glslang " << Buffer.SPIRVSize << " bytes, ";
+    std::cout << "payload " << Buffer.Payload << " bytes, wasted " << Buffer.HLSLSize - Buffer.Payload << " (HLSL) / "
+              << Buffer.WGSLSize - Buffer.Payload << " (WGSL) bytes\n";
+
+    for (const auto& Member : Buffer.Members)
+    {
+        std::cout << "    " << std::left << std::setw(12) << Member.TypeName << std::setw(20) << Member.Name << std::right
+                  << " HLSL " << std::setw(4) << Member.HLSLOffset << " +" << std::setw(4) << Member.HLSLSize
+                  << "   WGSL " << std::setw(4) << Member.WGSLOffset << " +" << std::setw(4) << Member.WGSLSize;
+        if (IsEmitted)
+        {
+            std::cout << "   SPIR-V " << std::setw(4) << Member.SPIRVOffset;
+            if (Member.WGSLOffset != Member.SPIRVOffset)
+                std::cout << "   <- needs explicit @align/@size or a padded layout struct in WGSL";
+        }
+        std::cout << "\n";
+    }
+}
+
+// Emits the cbuffer declaration of the repacked member order
+std::string EmitRepackedDeclaration(const UniformBufferLayout& Buffer)
+{
+    std::ostringstream Stream;
+    Stream << "cbuffer " << Buffer.Name << "\n{\n";
+    for (const auto& Member : Buffer.Members)
+    {
+        const size_t ArrayPos = Member.TypeName.find('[');
+        if (ArrayPos != std::string::npos)
+            Stream << "    " << Member.TypeName.substr(0, ArrayPos) << " " << Member.Name << Member.TypeName.substr(ArrayPos) << ";\n";
+        else
+            Stream << "    " << Member.TypeName << " " << Member.Name << ";\n";
+    }
+    Stream << "}\n";
+    return Stream.str();
+}
+
+// Emits the host-side layout of a cbuffer as glslang emitted it. Tint keeps the SPIR-V
+// offsets in the WGSL it generates, so these, not the natural WGSL layout, are what the
+// shader reads.
+std::string EmitHostLayout(const UniformBufferLayout& Emitted)
+{
+    std::ostringstream Stream;
+    Stream << "struct UniformMemberDesc\n{\n    const char* Name;\n    uint32_t    Offset;\n    uint32_t    Size;\n};\n\n";
+    Stream << "struct " << Emitted.Name << "Layout\n{\n";
+    Stream << "    static constexpr uint32_t Size = " << Emitted.SPIRVSize << ";\n\n";
+    Stream << "    static constexpr UniformMemberDesc Members[] = {\n";
+    for (const auto& Member : Emitted.Members)
+        Stream << "        {\"" << Member.Name << "\", " << Member.SPIRVOffset << ", " << Member.SPIRVSize << "},\n";
+    Stream << "    };\n};\n";
+    return Stream.str();
+}
+
+// Replaces the declaration of cbuffer Name in HLSL, up to its closing brace
+std::string ReplaceCBuffer(const std::string& HLSL, const std::string& Name, const std::string& Declaration)
+{
+    std::smatch Match;
+    if (!std::regex_search(HLSL, Match, std::regex{"cbuffer\\s+" + Name + "\\b"}))
+        LOG_ERROR_AND_THROW("Declaration of cbuffer '", Name, "' is not found");
+
+    const size_t Begin = static_cast<size_t>(Match.position(0));
+    size_t       End   = HLSL.find('{', Begin);
+    for (int Depth = 0; End < HLSL.size(); ++End)
+    {
+        if (HLSL[End] == '{')
+            ++Depth;
+        else if (HLSL[End] == '}' && --Depth == 0)
+            break;
+    }
+    if (End >= HLSL.size())
+        LOG_ERROR_AND_THROW("Declaration of cbuffer '", Name, "' is not terminated");
+
+    return HLSL.substr(0, Begin) + Declaration + HLSL.substr(End + 1);
+}
+
+std::vector<uint32_t> OptimizeSPIRV(const std::vector<uint32_t>& SrcSPIRV, spv_target_env TargetEnv)
+{
+    spvtools::Optimizer SpirvOptimizer(TargetEnv);
+    SpirvOptimizer.RegisterLegalizationPasses();
+    SpirvOptimizer.RegisterPerformancePasses();
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SrcSPIRV.data(), SrcSPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
+std::vector<uint32_t> ConvertHLSLtoSPIRV(const std::string& HLSL)
+{
+    GlslangInitilizer InitScope{};
+
+    glslang::TShader Shader{EShLangVertex};
+
+    auto* pHLSL = HLSL.c_str();
+    Shader.setStrings(&pHLSL, 1);
+    Shader.setPreamble("#define WEBGPU 1\n");
+    Shader.setEntryPoint("main");
+    Shader.setEnvInput(glslang::EShSourceHlsl, Shader.getStage(), glslang::EShClientVulkan, 100);
+    Shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    Shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    Shader.setHlslIoMapping(true);
+    Shader.setDxPositionW(true);
+    Shader.setAutoMapBindings(true);
+    Shader.setAutoMapLocations(true);
+
+    TBuiltInResource Resources{};
+    Shader.parse(&Resources, 100, false, EShMsgDefault);
+
+    glslang::TProgram Program;
+    Program.addShader(&Shader);
+
+    if (!Program.link(EShMsgDefault))
+        LOG_ERROR_AND_THROW("Failed to link program: \n", Program.getInfoLog());
+
+    if (!Program.mapIO())
+        LOG_ERROR_AND_THROW("Failed to map IO: \n", Program.getInfoLog());
+
+    std::vector<uint32_t> SPIRV;
+    glslang::GlslangToSpv(*Program.getIntermediate(Shader.getStage()), SPIRV);
+
+    auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, SPV_ENV_VULKAN_1_0);
+
+    if (!OptimizedSPIRV.empty())
+        return OptimizedSPIRV;
+
+    LOG_ERROR_AND_THROW("Failed to optimize SPIR-V.");
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        // Pass --repack to also print the repacked declarations and host-side layouts
+        const bool Repack = argc > 1 && std::string{argv[1]} == "--repack";
+
+        auto SPIRV   = ConvertHLSLtoSPIRV(HLSL::TestVS);
+        auto Context = spvtools::BuildModule(SPV_ENV_VULKAN_1_0, {}, SPIRV.data(), SPIRV.size());
+        if (!Context)
+            LOG_ERROR_AND_THROW("Failed to parse SPIR-V binary");
+
+        UniformLayoutAnalyzer Analyzer{*Context};
+        for (const auto& Buffer : Analyzer.Analyze())
+        {
+            std::cout << "==== Uniform buffer layout ====\n";
+            PrintLayoutReport(Buffer, true);
+
+            if (!Repack)
+                continue;
+
+            const auto Repacked = RepackUniformBuffer(Analyzer, Buffer);
+            if (Repacked.WGSLSize < Buffer.WGSLSize || Repacked.HLSLSize < Buffer.HLSLSize)
+            {
+                std::cout << "==== Repacked (" << Buffer.WGSLSize - Repacked.WGSLSize << " bytes saved in WGSL) ====\n";
+                PrintLayoutReport(Repacked, false);
+            }
+            const auto Declaration = EmitRepackedDeclaration(Repacked);
+            std::cout << Declaration << "\n";
+
+            // The host layout comes from the offsets glslang emits for the new declaration
+            auto RepackedSPIRV   = ConvertHLSLtoSPIRV(ReplaceCBuffer(HLSL::TestVS, Buffer.Name, Declaration));
+            auto RepackedContext = spvtools::BuildModule(SPV_ENV_VULKAN_1_0, {}, RepackedSPIRV.data(), RepackedSPIRV.size());
+            if (!RepackedContext)
+                LOG_ERROR_AND_THROW("Failed to parse SPIR-V binary");
+
+            const auto EmittedBuffers = UniformLayoutAnalyzer{*RepackedContext}.Analyze();
+            auto       EmittedIt      = std::find_if(EmittedBuffers.begin(), EmittedBuffers.end(), [&](const UniformBufferLayout& Emitted) { return Emitted.Name == Buffer.Name; });
+            if (EmittedIt == EmittedBuffers.end())
+                LOG_ERROR_AND_THROW("Repacked cbuffer '", Buffer.Name, "' is missing from the compiled shader, its layout is unknown");
+            std::cout << EmitHostLayout(*EmittedIt) << "\n";
+        }
+        return 0;
+    }
+    catch (const std::exception&)
+    {
+        return -1;
+    }
+}